@@ -2,14 +2,17 @@
 #include <iostream>
 #include <vector>
 #include <algorithm>
+#include <list>
 
 
 #include "moses/Util.h"
 #include "moses/ChartManager.h"
+#include "moses/DecodingOptions.h"
 #include "moses/Hypothesis.h"
 #include "moses/Manager.h"
 #include "moses/StaticData.h"
 #include "moses/ThreadPool.h"
+#include "moses/FF/FeatureFunction.h"
 #include "moses/TranslationModel/PhraseDictionaryDynSuffixArray.h"
 #include "moses/TranslationModel/PhraseDictionaryMultiModelCounts.h"
 #if PT_UG
@@ -22,6 +25,8 @@
 #ifdef WITH_THREADS
 #include <boost/thread.hpp>
 #endif
+#include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
 
 #include <xmlrpc-c/base.hpp>
 #include <xmlrpc-c/registry.hpp>
@@ -50,13 +55,14 @@ public:
     breakOutParams(params);
 #if PT_UG
     Mmsapt* pdsa = reinterpret_cast<Mmsapt*>(PhraseDictionary::GetColl()[0]);
-    pdsa->add(source_,target_,alignment_);
+    for (size_t i = 0; i < source_.size(); ++i)
+      pdsa->add(source_[i],target_[i],alignment_[i]);
 #else
     const PhraseDictionary* pdf = PhraseDictionary::GetColl()[0];
     PhraseDictionaryDynSuffixArray* 
       pdsa = (PhraseDictionaryDynSuffixArray*) pdf;
-    cerr << "Inserting into address " << pdsa << endl;
-    pdsa->insertSnt(source_, target_, alignment_);
+    cerr << "Inserting " << source_.size() << " sentence pairs into address " << pdsa << endl;
+    pdsa->insertSnts(source_, target_, alignment_);
 #endif
     if(add2ORLM_) {
       //updateORLM();
@@ -71,7 +77,8 @@ public:
     pdsa = 0;
     *retvalP = xmlrpc_c::value_string("Phrase table updated");
   }
-  string source_, target_, alignment_;
+  // one entry per sentence pair of the update
+  vector<string> source_, target_, alignment_;
   bool bounded_, add2ORLM_;
   /*
   void updateORLM() {
@@ -117,22 +124,37 @@ public:
   }
   */
   
+  // a parameter is either one string or an array of strings, one per sentence pair
+  void breakOutStrings(const xmlrpc_c::value& value, vector<string>& strings) {
+    strings.clear();
+    if (value.type() == xmlrpc_c::value::TYPE_ARRAY) {
+      const vector<xmlrpc_c::value> values = xmlrpc_c::value_array(value).vectorValueValue();
+      for (size_t i = 0; i < values.size(); ++i)
+        strings.push_back(xmlrpc_c::value_string(values[i]));
+    } else {
+      strings.push_back(xmlrpc_c::value_string(value));
+    }
+  }
+
   void breakOutParams(const params_t& params) {
     params_t::const_iterator si = params.find("source");
     if(si == params.end())
       throw xmlrpc_c::fault("Missing source sentence", xmlrpc_c::fault::CODE_PARSE);
-    source_ = xmlrpc_c::value_string(si->second);
-    XVERBOSE(1,"source = " << source_ << endl);
+    breakOutStrings(si->second, source_);
+    XVERBOSE(1,"source = " << Join(" ||| ", source_) << endl);
     si = params.find("target");
     if(si == params.end())
       throw xmlrpc_c::fault("Missing target sentence", xmlrpc_c::fault::CODE_PARSE);
-    target_ = xmlrpc_c::value_string(si->second);
-    XVERBOSE(1,"target = " << target_ << endl);
+    breakOutStrings(si->second, target_);
+    XVERBOSE(1,"target = " << Join(" ||| ", target_) << endl);
     si = params.find("alignment");
     if(si == params.end())
       throw xmlrpc_c::fault("Missing alignment", xmlrpc_c::fault::CODE_PARSE);
-    alignment_ = xmlrpc_c::value_string(si->second);
-    XVERBOSE(1,"alignment = " << alignment_ << endl);
+    breakOutStrings(si->second, alignment_);
+    XVERBOSE(1,"alignment = " << Join(" ||| ", alignment_) << endl);
+    if(target_.size() != source_.size() || alignment_.size() != source_.size())
+      throw xmlrpc_c::fault("Numbers of source, target and alignment strings differ",
+                            xmlrpc_c::fault::CODE_PARSE);
     si = params.find("bounded");
     bounded_ = (si != params.end());
     si = params.find("updateORLM");
@@ -210,8 +232,27 @@ public:
    : m_paramList(paramList),
      m_cond(cond),
      m_mut(mut),
-     m_done(false)
-     {}
+     m_done(false),
+     m_sourceLength(0),
+     m_deadline(0),
+     m_pruningScale(1),
+     m_minStackSize(0)
+  {
+    // what the scheduler needs to know before decoding
+    const params_t params = m_paramList.getStruct(0);
+    params_t::const_iterator si = params.find("text");
+    if (si != params.end()) {
+      istringstream words((string) xmlrpc_c::value_string(si->second));
+      string word;
+      while (words >> word) {
+        ++m_sourceLength;
+      }
+    }
+    si = params.find("deadline");
+    if (si != params.end()) {
+      m_deadline = xmlrpc_c::value_int(si->second);
+    }
+  }
 
   virtual bool DeleteAfterExecution() {return false;}
 
@@ -219,7 +260,46 @@ public:
 
   const map<string, xmlrpc_c::value>& GetRetData() { return m_retData;}
 
+  //! the fault to return instead of the translation, if any
+  const xmlrpc_c::fault *GetFault() const {
+    return m_fault.get();
+  }
+
+  size_t GetSourceLength() const {
+    return m_sourceLength;
+  }
+
+  //! milliseconds that the client is willing to wait, 0 if not given
+  size_t GetDeadline() const {
+    return m_deadline;
+  }
+
+  /**
+    * Decode with the stack size and cube pruning pop limit multiplied by
+    * scale, but not less than minStackSize. Both are kept at 1 or more,
+    * since 0 would mean unlimited.
+    **/
+  void ReducePruning(float scale, size_t minStackSize) {
+    m_pruningScale = scale;
+    m_minStackSize = std::max(minStackSize, size_t(1));
+  }
+
   virtual void Run() {
+    try {
+      Translate();
+    } catch (const xmlrpc_c::fault &fault) {
+      m_fault.reset(new xmlrpc_c::fault(fault));
+    } catch (const std::exception &e) {
+      m_fault.reset(new xmlrpc_c::fault(e.what(), xmlrpc_c::fault::CODE_INTERNAL));
+    }
+    {
+      boost::lock_guard<boost::mutex> lock(m_mut);
+      m_done = true;
+    }
+    m_cond.notify_one();
+  }
+
+  void Translate() {
 
     const params_t params = m_paramList.getStruct(0);
     m_paramList.verifyEnd(1);
@@ -269,8 +349,36 @@ public:
 
     const StaticData &staticData = StaticData::Instance();
 
+    // settings for this request only, StaticData is shared by all threads
+    DecodingOptions options;
+    si = params.find("stack");
+    if (si != params.end()) {
+      options.maxHypoStackSize = xmlrpc_c::value_int(si->second);
+    }
+    si = params.find("beam-threshold");
+    if (si != params.end()) {
+      options.beamWidth = TransformScore(xmlrpc_c::value_double(si->second));
+    }
+    si = params.find("cube-pruning-pop-limit");
+    if (si != params.end()) {
+      options.cubePruningPopLimit = xmlrpc_c::value_int(si->second);
+    }
+    si = params.find("weights");
+    if (si != params.end()) {
+      options.weights.reset(parseWeights(xmlrpc_c::value_struct(si->second)));
+    }
+    if (nbest_size > 0) {
+      options.nBestEnabled = true;
+      options.nBestSize = std::max(options.nBestSize, size_t(nbest_size));
+      options.distinctNBest = options.distinctNBest || nbest_distinct;
+    }
     if (addGraphInfo) {
-      (const_cast<StaticData&>(staticData)).SetOutputSearchGraph(true);
+      options.nBestEnabled = true;
+      options.outputSearchGraph = true;
+    }
+    if (m_pruningScale < 1) {
+      options.maxHypoStackSize = std::max(m_minStackSize, size_t(options.maxHypoStackSize * m_pruningScale));
+      options.cubePruningPopLimit = std::max(m_minStackSize, size_t(options.cubePruningPopLimit * m_pruningScale));
     }
 
     stringstream out, graphInfo, transCollOpts;
@@ -281,7 +389,7 @@ public:
 	      inputFactorOrder = staticData.GetInputFactorOrder();
         stringstream in(source + "\n");
         tinput.Read(in,inputFactorOrder);
-        ChartManager manager(0,tinput);
+        ChartManager manager(0,tinput,options);
         manager.ProcessSentence();
         const ChartHypothesis *hypo = manager.GetBestHypothesis();
         outputChartHypo(out,hypo);
@@ -298,7 +406,7 @@ public:
         stringstream in(source + "\n");
         sentence.Read(in,inputFactorOrder);
 	      size_t lineNumber = 0; // TODO: Include sentence request number here?
-        Manager manager(lineNumber, sentence, staticData.GetSearchAlgorithm());
+        Manager manager(lineNumber, sentence, staticData.GetSearchAlgorithm(), options);
 	      manager.ProcessSentence();
         const Hypothesis* hypo = manager.GetBestHypothesis();
 
@@ -324,7 +432,6 @@ public:
 
         if (addGraphInfo) {
           insertGraphInfo(manager,m_retData);
-            (const_cast<StaticData&>(staticData)).SetOutputSearchGraph(false);
         }
         if (addTopts) {
           insertTranslationOptions(manager,m_retData);
@@ -338,12 +445,37 @@ public:
     text("text", xmlrpc_c::value_string(out.str()));
     m_retData.insert(text);
     XVERBOSE(1,"Output: " << out.str() << endl);
-    {
-      boost::lock_guard<boost::mutex> lock(m_mut);
-      m_done = true;
-    }
-    m_cond.notify_one();
+  }
 
+  /**
+    * Weights of the features named in the request, the configured weights
+    * of all other features.
+    **/
+  ScoreComponentCollection *parseWeights(const params_t& weightParams) {
+    std::auto_ptr<ScoreComponentCollection> weights(
+      new ScoreComponentCollection(StaticData::Instance().GetAllWeights()));
+    const std::vector<FeatureFunction*> &ffs = FeatureFunction::GetFeatureFunctions();
+    for (params_t::const_iterator i = weightParams.begin(); i != weightParams.end(); ++i) {
+      const FeatureFunction *ff = NULL;
+      for (size_t j = 0; j < ffs.size() && !ff; ++j) {
+        if (ffs[j]->GetScoreProducerDescription() == i->first) {
+          ff = ffs[j];
+        }
+      }
+      if (!ff) {
+        throw xmlrpc_c::fault("Unknown feature " + i->first, xmlrpc_c::fault::CODE_PARSE);
+      }
+      vector<xmlrpc_c::value> values(xmlrpc_c::value_array(i->second).vectorValueValue());
+      if (values.size() != ff->GetNumScoreComponents()) {
+        throw xmlrpc_c::fault("Wrong number of weights for " + i->first, xmlrpc_c::fault::CODE_PARSE);
+      }
+      vector<float> ffWeights;
+      for (size_t j = 0; j < values.size(); ++j) {
+        ffWeights.push_back(xmlrpc_c::value_double(values[j]));
+      }
+      weights->Assign(ff, ffWeights);
+    }
+    return weights.release();
   }
 
   void outputHypo(ostream& out, const Hypothesis* hypo, bool addAlignmentInfo, vector<xmlrpc_c::value>& alignInfo, bool reportAllFactors = false) {
@@ -539,12 +671,198 @@ private:
   boost::condition_variable& m_cond;
   boost::mutex& m_mut;
   bool m_done;
+  std::auto_ptr<xmlrpc_c::fault> m_fault;
+  size_t m_sourceLength;
+  size_t m_deadline;
+  float m_pruningScale;
+  size_t m_minStackSize;
+};
+
+/**
+  * Queues translation tasks for a fixed set of worker threads. A worker
+  * takes the oldest task. With a batch size above 1, it also takes other
+  * queued tasks of similar length and decodes them one after the other,
+  * so that they share the phrase table caches of that thread, at the cost
+  * of latency for all but the first. Tasks are refused when the queue is
+  * full, and decoded with smaller stacks when less than half of their
+  * deadline is left.
+**/
+class TranslationScheduler
+{
+public:
+  TranslationScheduler(size_t numThreads, size_t queueLimit, size_t batchSize,
+                       size_t defaultDeadline, size_t minStackSize)
+    : m_numThreads(numThreads),
+      m_queueLimit(queueLimit),
+      m_batchSize(std::max(batchSize, size_t(1))),
+      m_defaultDeadline(defaultDeadline),
+      m_minStackSize(minStackSize),
+      m_stopping(false),
+      m_busy(0),
+      m_served(0),
+      m_rejected(0),
+      m_reduced(0),
+      m_batches(0),
+      m_nextLatency(0) {
+    for (size_t i = 0; i < numThreads; ++i) {
+      m_threads.create_thread(boost::bind(&TranslationScheduler::Execute, this));
+    }
+  }
+
+  ~TranslationScheduler() {
+    {
+      boost::mutex::scoped_lock lock(m_mutex);
+      m_stopping = true;
+    }
+    m_taskAvailable.notify_all();
+    m_threads.join_all();
+  }
+
+  //! queue a task, false if the queue is full
+  bool Submit(TranslationTask *task) {
+    {
+      boost::mutex::scoped_lock lock(m_mutex);
+      if (m_queueLimit && m_queue.size() >= m_queueLimit) {
+        ++m_rejected;
+        return false;
+      }
+      Pending pending;
+      pending.task = task;
+      pending.arrival = boost::posix_time::microsec_clock::universal_time();
+      m_queue.push_back(pending);
+    }
+    m_taskAvailable.notify_one();
+    return true;
+  }
+
+  map<string, xmlrpc_c::value> GetStats() const {
+    vector<float> latencies;
+    map<string, xmlrpc_c::value> stats;
+    {
+      boost::mutex::scoped_lock lock(m_mutex);
+      latencies = m_latencies;
+      stats["queue-depth"] = xmlrpc_c::value_int(m_queue.size());
+      stats["busy-workers"] = xmlrpc_c::value_int(m_busy);
+      stats["served"] = xmlrpc_c::value_int(m_served);
+      stats["rejected"] = xmlrpc_c::value_int(m_rejected);
+      stats["reduced-pruning"] = xmlrpc_c::value_int(m_reduced);
+      stats["mean-batch-size"] = xmlrpc_c::value_double(m_batches ? double(m_served) / m_batches : 0);
+    }
+    // over the last MAX_LATENCIES requests, in milliseconds
+    std::sort(latencies.begin(), latencies.end());
+    const size_t percentiles[] = {50, 90, 99};
+    for (size_t i = 0; i < 3; ++i) {
+      ostringstream name;
+      name << "latency-p" << percentiles[i];
+      size_t index = latencies.size() * percentiles[i] / 100;
+      float latency = latencies.empty() ? 0 : latencies[std::min(index, latencies.size() - 1)];
+      stats[name.str()] = xmlrpc_c::value_double(latency);
+    }
+    return stats;
+  }
+
+private:
+  static const size_t MAX_LATENCIES = 1000;
+
+  struct Pending {
+    TranslationTask *task;
+    boost::posix_time::ptime arrival;
+  };
+
+  struct LengthOrderer {
+    bool operator()(const Pending &a, const Pending &b) const {
+      return a.task->GetSourceLength() < b.task->GetSourceLength();
+    }
+  };
+
+  /**
+    * move the oldest task and up to m_batchSize-1 tasks of similar length
+    * into batch, leaving enough tasks for the idle workers
+    **/
+  void TakeBatch(vector<Pending> &batch) {
+    const size_t idle = m_numThreads - m_busy;
+    const size_t batchSize = std::min(m_batchSize, std::max(m_queue.size() / idle, size_t(1)));
+    const size_t length = m_queue.front().task->GetSourceLength();
+    const size_t tolerance = std::max(length / 5, size_t(2));
+    std::list<Pending>::iterator iter = m_queue.begin();
+    while (iter != m_queue.end() && batch.size() < batchSize) {
+      const size_t otherLength = iter->task->GetSourceLength();
+      if (otherLength + tolerance >= length && otherLength <= length + tolerance) {
+        batch.push_back(*iter);
+        iter = m_queue.erase(iter);
+      } else {
+        ++iter;
+      }
+    }
+    std::stable_sort(batch.begin() + 1, batch.end(), LengthOrderer());
+  }
+
+  void Execute() {
+    while (true) {
+      vector<Pending> batch;
+      {
+        boost::mutex::scoped_lock lock(m_mutex);
+        while (m_queue.empty() && !m_stopping) {
+          m_taskAvailable.wait(lock);
+        }
+        if (m_queue.empty()) {
+          return;
+        }
+        TakeBatch(batch);
+        ++m_busy;
+        ++m_batches;
+      }
+
+      for (size_t i = 0; i < batch.size(); ++i) {
+        TranslationTask &task = *batch[i].task;
+        const size_t deadline = task.GetDeadline() ? task.GetDeadline() : m_defaultDeadline;
+        float waited = (boost::posix_time::microsec_clock::universal_time() - batch[i].arrival).total_microseconds() / 1000.0;
+        bool reduced = deadline && 2 * waited > deadline;
+        if (reduced) {
+          task.ReducePruning(std::max(2 * (deadline - waited) / deadline, 0.0f), m_minStackSize);
+        }
+
+        // the task belongs to the caller once it has run
+        task.Run();
+
+        float latency = (boost::posix_time::microsec_clock::universal_time() - batch[i].arrival).total_microseconds() / 1000.0;
+        boost::mutex::scoped_lock lock(m_mutex);
+        if (m_latencies.size() < MAX_LATENCIES) {
+          m_latencies.push_back(latency);
+        } else {
+          m_latencies[m_nextLatency] = latency;
+        }
+        m_nextLatency = (m_nextLatency + 1) % MAX_LATENCIES;
+        ++m_served;
+        m_reduced += reduced;
+      }
+
+      boost::mutex::scoped_lock lock(m_mutex);
+      --m_busy;
+    }
+  }
+
+  size_t m_numThreads;
+  size_t m_queueLimit;
+  size_t m_batchSize;
+  size_t m_defaultDeadline;
+  size_t m_minStackSize;
+
+  std::list<Pending> m_queue;
+  boost::thread_group m_threads;
+  mutable boost::mutex m_mutex;
+  boost::condition_variable m_taskAvailable;
+  bool m_stopping;
+
+  size_t m_busy, m_served, m_rejected, m_reduced, m_batches;
+  vector<float> m_latencies; /**< recent latencies in milliseconds */
+  size_t m_nextLatency;
 };
 
 class Translator : public xmlrpc_c::method
 {
 public:
-  Translator(size_t numThreads = 10) : m_threadPool(numThreads) {
+  Translator(TranslationScheduler &scheduler) : m_scheduler(scheduler) {
     // signature and help strings are documentation -- the client
     // can query this information with a system.methodSignature and
     // system.methodHelp RPC.
@@ -558,15 +876,38 @@ public:
     boost::condition_variable cond;
     boost::mutex mut;
     TranslationTask task(paramList,cond,mut);
-    m_threadPool.Submit(&task);
+    if (!m_scheduler.Submit(&task)) {
+      throw xmlrpc_c::fault("Too many queued requests", xmlrpc_c::fault::CODE_LIMIT_EXCEEDED);
+    }
     boost::unique_lock<boost::mutex> lock(mut);
     while (!task.IsDone()) {
       cond.wait(lock);
     }
+    if (task.GetFault()) {
+      throw *task.GetFault();
+    }
     *retvalP = xmlrpc_c::value_struct(task.GetRetData());
   }
 private:
-  Moses::ThreadPool m_threadPool;
+  TranslationScheduler &m_scheduler;
+};
+
+class Stats : public xmlrpc_c::method
+{
+public:
+  Stats(const TranslationScheduler &scheduler) : m_scheduler(scheduler) {
+    this->_signature = "S:";
+    this->_help = "Reports queue depth and translation latencies";
+  }
+
+  void
+  execute(xmlrpc_c::paramList const& paramList,
+          xmlrpc_c::value *   const  retvalP) {
+    paramList.verifyEnd(0);
+    *retvalP = xmlrpc_c::value_struct(m_scheduler.GetStats());
+  }
+private:
+  const TranslationScheduler &m_scheduler;
 };
 
 static 
@@ -627,6 +968,10 @@ int main(int argc, char** argv)
   const char* logfile = "/dev/null";
   bool isSerial = false;
   size_t numThreads = 10; //for translation tasks
+  size_t queueLimit = 0; // unlimited
+  size_t batchSize = 1; // no length batching unless asked for
+  size_t deadline = 0; // milliseconds, none
+  size_t minStackSize = 10; // when close to the deadline
 
   for (int i = 0; i < argc; ++i) {
     if (!strcmp(argv[i],"--server-port")) {
@@ -653,6 +998,31 @@ int main(int argc, char** argv)
       } else {
         numThreads = atoi(argv[i]);
       }
+    } else if (!strcmp(argv[i], "--queue-limit")
+               || !strcmp(argv[i], "--batch-size")
+               || !strcmp(argv[i], "--deadline")
+               || !strcmp(argv[i], "--min-stack")) {
+      const char *name = argv[i];
+      ++i;
+      if (i>=argc) {
+        cerr << "Error: Missing argument to " << name << endl;
+        exit(1);
+      }
+      size_t value = atoi(argv[i]);
+      if (!strcmp(name, "--queue-limit")) {
+        queueLimit = value;
+      } else if (!strcmp(name, "--batch-size")) {
+        batchSize = value;
+      } else if (!strcmp(name, "--deadline")) {
+        deadline = value;
+      } else {
+        // a stack size of 0 means unlimited, the opposite of what is wanted
+        if (value == 0) {
+          cerr << "Error: --min-stack must be at least 1" << endl;
+          exit(1);
+        }
+        minStackSize = value;
+      }
     } else if (!strcmp(argv[i], "--serial")) {
       cerr << "Running single-threaded server" << endl;
       isSerial = true;
@@ -682,13 +1052,16 @@ int main(int argc, char** argv)
 
   xmlrpc_c::registry myRegistry;
 
-  xmlrpc_c::methodPtr const translator(new Translator(numThreads));
+  TranslationScheduler scheduler(numThreads, queueLimit, batchSize, deadline, minStackSize);
+  xmlrpc_c::methodPtr const translator(new Translator(scheduler));
   xmlrpc_c::methodPtr const updater(new Updater);
   xmlrpc_c::methodPtr const optimizer(new Optimizer);
+  xmlrpc_c::methodPtr const stats(new Stats(scheduler));
 
   myRegistry.addMethod("translate", translator);
   myRegistry.addMethod("updater", updater);
   myRegistry.addMethod("optimize", optimizer);
+  myRegistry.addMethod("stats", stats);
 
   xmlrpc_c::serverAbyss myAbyssServer(
 				      myRegistry,
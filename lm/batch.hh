@@ -0,0 +1,119 @@
+#ifndef LM_BATCH_H
+#define LM_BATCH_H
+
+/* Score many independent sentences at once.  Scoring a word is a chain of
+ * dependent lookups, each of which is usually a cache miss, so one query at a
+ * time leaves the memory system idle.  BatchScorer keeps width sentences in
+ * flight and round-robins between them: each turn does one lookup for a
+ * sentence and prefetches that sentence's next lookup, which then has the
+ * rest of the round to arrive.  Results are the same as calling FullScore on
+ * each word in turn.
+ *
+ * Works with any model built on detail::GenericModel.
+ */
+
+#include "lm/return.hh"
+#include "lm/state.hh"
+#include "lm/word_index.hh"
+
+#include <cstddef>
+#include <vector>
+
+namespace lm {
+namespace ngram {
+
+struct BatchSentence {
+  // Vocabulary ids to score, excluding <s> and </s>.
+  const WordIndex *begin, *end;
+  // Output: log10 probability of the sentence.
+  float total;
+};
+
+template <class Model> class BatchScorer {
+  public:
+    // With sentence_context, sentences start with <s> and end with </s> like
+    // the query program.
+    BatchScorer(const Model &model, std::size_t width = 8, bool sentence_context = true)
+      : model_(model), slots_(width ? width : 1), sentence_context_(sentence_context) {}
+
+    // Sets total for each sentence in [begin, end).
+    void Score(BatchSentence *begin, BatchSentence *end) {
+      BatchSentence *next = begin;
+      std::size_t active = 0;
+      for (typename std::vector<Slot>::iterator s = slots_.begin(); s != slots_.end(); ++s) {
+        if (Load(*s, next, end)) ++active;
+      }
+      while (active) {
+        for (typename std::vector<Slot>::iterator s = slots_.begin(); s != slots_.end(); ++s) {
+          if (!s->sentence) continue;
+          if (!model_.ContinueFullScore(*s->in, s->word, *s->out, s->pending, s->ret)) continue;
+          s->sentence->total += s->ret.prob;
+          std::swap(s->in, s->out);
+          if (!Advance(*s) && !Load(*s, next, end)) --active;
+        }
+      }
+    }
+
+  private:
+    struct Slot {
+      Slot() : sentence(NULL), in(&states[0]), out(&states[1]) {}
+      // Copying would leave in and out pointing at the original's states.
+      Slot(const Slot &) : sentence(NULL), in(&states[0]), out(&states[1]) {}
+
+      BatchSentence *sentence;
+      // Next word after the one being scored.
+      const WordIndex *position;
+      // Word being scored.
+      WordIndex word;
+      // Scoring </s>.
+      bool ending;
+
+      State states[2];
+      State *in, *out;
+
+      typename Model::PendingScore pending;
+      FullScoreReturn ret;
+    };
+
+    // Start the next sentence from [next, end) in slot.  Returns false if none is left.
+    bool Load(Slot &slot, BatchSentence *&next, BatchSentence *end) {
+      for (; next != end; ++next) {
+        next->total = 0.0;
+        slot.sentence = next;
+        slot.position = next->begin;
+        slot.ending = false;
+        *slot.in = sentence_context_ ? model_.BeginSentenceState() : model_.NullContextState();
+        if (Advance(slot)) {
+          ++next;
+          return true;
+        }
+      }
+      slot.sentence = NULL;
+      return false;
+    }
+
+    // Begin scoring the next word in slot.  Returns false if the sentence is done.
+    bool Advance(Slot &slot) {
+      if (slot.position != slot.sentence->end) {
+        slot.word = *slot.position++;
+      } else if (sentence_context_ && !slot.ending) {
+        slot.word = model_.GetVocabulary().EndSentence();
+        slot.ending = true;
+      } else {
+        return false;
+      }
+      model_.BeginFullScore(*slot.in, slot.word, slot.pending);
+      return true;
+    }
+
+    const Model &model_;
+
+    std::vector<Slot> slots_;
+
+    const bool sentence_context_;
+};
+
+} // namespace ngram
+} // namespace lm
+
+#endif // LM_BATCH_H
@@ -0,0 +1,218 @@
+#include "lm/batch.hh"
+#include "lm/model.hh"
+#include "util/file_piece.hh"
+#include "util/getopt.hh"
+#include "util/usage.hh"
+
+#ifdef WITH_THREADS
+#include <boost/thread/thread.hpp>
+#endif
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <stdlib.h>
+#include <string.h>
+
+namespace {
+
+void Usage(const char *name) {
+  std::cerr <<
+    "Benchmark scoring the sentences on stdin with FullScore and with BatchScorer.\n"
+    "Usage: " << name << " [-n] [-w widths] [-t threads] lm_file <text\n"
+    "-n: Do not wrap the input in <s> and </s>.\n"
+    "-w: Comma-separated batch widths to try.  Default 1,2,4,8,16,32.\n"
+    "-t: Comma-separated thread counts to try.  Default 1.\n"
+    "Each thread scores a contiguous share of the sentences.\n";
+  exit(1);
+}
+
+std::vector<std::size_t> ParseList(const char *from) {
+  std::vector<std::size_t> ret;
+  while (true) {
+    char *end;
+    ret.push_back(strtoul(from, &end, 10));
+    if (end == from || !ret.back() || (*end && *end != ',')) throw util::ParseNumberException(from);
+    if (!*end) return ret;
+    from = end + 1;
+  }
+}
+
+template <class Model> struct Job {
+  // Batch width or 0 to call FullScore one word at a time.
+  std::size_t width;
+  bool sentence_context;
+  const Model *model;
+  lm::ngram::BatchSentence *begin, *end;
+
+  void operator()() {
+    if (width) {
+      lm::ngram::BatchScorer<Model> scorer(*model, width, sentence_context);
+      scorer.Score(begin, end);
+      return;
+    }
+    lm::ngram::State states[2];
+    for (lm::ngram::BatchSentence *s = begin; s != end; ++s) {
+      states[0] = sentence_context ? model->BeginSentenceState() : model->NullContextState();
+      s->total = 0.0;
+      unsigned int in = 0;
+      for (const lm::WordIndex *w = s->begin; w != s->end; ++w, in ^= 1) {
+        s->total += model->FullScore(states[in], *w, states[in ^ 1]).prob;
+      }
+      if (sentence_context) {
+        s->total += model->FullScore(states[in], model->GetVocabulary().EndSentence(), states[in ^ 1]).prob;
+      }
+    }
+  }
+};
+
+template <class Model> double Run(const Model &model, std::vector<lm::ngram::BatchSentence> &sentences, std::size_t threads, std::size_t width, bool sentence_context) {
+  std::vector<Job<Model> > jobs(threads);
+  for (std::size_t i = 0; i < threads; ++i) {
+    jobs[i].width = width;
+    jobs[i].sentence_context = sentence_context;
+    jobs[i].model = &model;
+    jobs[i].begin = &sentences[0] + sentences.size() * i / threads;
+    jobs[i].end = &sentences[0] + sentences.size() * (i + 1) / threads;
+  }
+  double start = util::WallTime();
+#ifdef WITH_THREADS
+  boost::thread_group group;
+  for (std::size_t i = 1; i < threads; ++i) {
+    group.create_thread(jobs[i]);
+  }
+  jobs[0]();
+  group.join_all();
+#else
+  jobs[0]();
+#endif
+  return util::WallTime() - start;
+}
+
+template <class Model> void Benchmark(const char *file, const lm::ngram::Config &config, bool sentence_context, const std::vector<std::size_t> &widths, const std::vector<std::size_t> &threads) {
+  Model model(file, config);
+
+  std::vector<lm::WordIndex> words;
+  std::vector<std::size_t> ends;
+  util::FilePiece in(0);
+  StringPiece word;
+  while (true) {
+    while (in.ReadWordSameLine(word)) {
+      words.push_back(model.GetVocabulary().Index(word));
+    }
+    ends.push_back(words.size());
+    try {
+      UTIL_THROW_IF('\n' != in.get(), util::Exception, "FilePiece is confused.");
+    } catch (const util::EndOfFileException &e) { break; }
+  }
+  // The last "sentence" is whatever followed the final newline.
+  if (ends.size() > 1 && ends.back() == ends[ends.size() - 2]) ends.pop_back();
+  UTIL_THROW_IF(ends.empty() || words.empty(), util::Exception, "No text on stdin to score.");
+
+  std::vector<lm::ngram::BatchSentence> sentences(ends.size());
+  uint64_t queries = words.size() + (sentence_context ? ends.size() : 0);
+  for (std::size_t i = 0; i < ends.size(); ++i) {
+    sentences[i].begin = &words[0] + (i ? ends[i - 1] : 0);
+    sentences[i].end = &words[0] + ends[i];
+  }
+
+  std::cout << "Sentences: " << sentences.size() << " Queries: " << queries << '\n'
+    << "threads\twidth\tqueries/s\tns/query\tlog10 total\n";
+  std::vector<std::size_t> all_widths(1, 0);
+  all_widths.insert(all_widths.end(), widths.begin(), widths.end());
+  for (std::vector<std::size_t>::const_iterator t = threads.begin(); t != threads.end(); ++t) {
+    for (std::vector<std::size_t>::const_iterator w = all_widths.begin(); w != all_widths.end(); ++w) {
+      double seconds = Run(model, sentences, std::min<std::size_t>(*t, sentences.size()), *w, sentence_context);
+      double total = 0.0;
+      for (std::vector<lm::ngram::BatchSentence>::const_iterator s = sentences.begin(); s != sentences.end(); ++s) {
+        total += s->total;
+      }
+      std::cout << *t << '\t';
+      if (*w) {
+        std::cout << *w;
+      } else {
+        std::cout << "serial";
+      }
+      std::cout << '\t' << std::setprecision(4) << (static_cast<double>(queries) / seconds)
+        << '\t' << (seconds * 1e9 / static_cast<double>(queries))
+        << '\t' << std::setprecision(10) << total << std::endl;
+    }
+  }
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  if (argc == 1 || (argc == 2 && !strcmp(argv[1], "--help")))
+    Usage(argv[0]);
+
+  lm::ngram::Config config;
+  bool sentence_context = true;
+  std::vector<std::size_t> widths, threads(1, 1);
+  widths.push_back(1);
+  widths.push_back(2);
+  widths.push_back(4);
+  widths.push_back(8);
+  widths.push_back(16);
+  widths.push_back(32);
+
+  try {
+    int opt;
+    while ((opt = getopt(argc, argv, "hnw:t:")) != -1) {
+      switch (opt) {
+        case 'n':
+          sentence_context = false;
+          break;
+        case 'w':
+          widths = ParseList(optarg);
+          break;
+        case 't':
+          threads = ParseList(optarg);
+#ifndef WITH_THREADS
+          UTIL_THROW_IF(threads.size() != 1 || threads[0] != 1, util::Exception, "This was compiled without thread support, so -t must be 1.");
+#endif
+          break;
+        case 'h':
+        default:
+          Usage(argv[0]);
+      }
+    }
+    if (optind + 1 != argc)
+      Usage(argv[0]);
+    const char *file = argv[optind];
+
+    using namespace lm::ngram;
+    ModelType model_type;
+    if (!RecognizeBinary(file, model_type)) model_type = PROBING;
+    switch (model_type) {
+      case PROBING:
+        Benchmark<ProbingModel>(file, config, sentence_context, widths, threads);
+        break;
+      case REST_PROBING:
+        Benchmark<RestProbingModel>(file, config, sentence_context, widths, threads);
+        break;
+      case TRIE:
+        Benchmark<TrieModel>(file, config, sentence_context, widths, threads);
+        break;
+      case QUANT_TRIE:
+        Benchmark<QuantTrieModel>(file, config, sentence_context, widths, threads);
+        break;
+      case ARRAY_TRIE:
+        Benchmark<ArrayTrieModel>(file, config, sentence_context, widths, threads);
+        break;
+      case QUANT_ARRAY_TRIE:
+        Benchmark<QuantArrayTrieModel>(file, config, sentence_context, widths, threads);
+        break;
+      default:
+        std::cerr << "Unrecognized kenlm model type " << model_type << std::endl;
+        abort();
+    }
+    util::PrintUsage(std::cerr);
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
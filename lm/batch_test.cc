@@ -0,0 +1,97 @@
+#include "lm/batch.hh"
+
+#include "lm/model.hh"
+#include "util/tokenize_piece.hh"
+
+#define BOOST_TEST_MODULE BatchTest
+#include <boost/test/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+#include <string>
+#include <vector>
+
+namespace lm {
+namespace ngram {
+namespace {
+
+const char *TestLocation() {
+  if (boost::unit_test::framework::master_test_suite().argc < 2) {
+    return "test.arpa";
+  }
+  return boost::unit_test::framework::master_test_suite().argv[1];
+}
+
+const char *kSentences[] = {
+  "looking on a little more loin",
+  "also would consider higher looking on a little more loin",
+  "",
+  "biarritz is little more",
+  "looking on a little more loin foo bar",
+  "on a little more loin .",
+  "also would consider higher looking",
+};
+
+template <class M> float Serial(const M &model, const std::vector<WordIndex> &words, bool sentence_context) {
+  State states[2];
+  states[0] = sentence_context ? model.BeginSentenceState() : model.NullContextState();
+  float total = 0.0;
+  unsigned int in = 0;
+  for (std::vector<WordIndex>::const_iterator i = words.begin(); i != words.end(); ++i, in ^= 1) {
+    total += model.FullScore(states[in], *i, states[in ^ 1]).prob;
+  }
+  if (sentence_context) total += model.FullScore(states[in], model.GetVocabulary().EndSentence(), states[in ^ 1]).prob;
+  return total;
+}
+
+template <class M> void Everything(bool elias_fano = false) {
+  Config config;
+  config.arpa_complain = Config::NONE;
+  config.messages = NULL;
+  config.pointer_bhiksha_elias_fano = elias_fano;
+  M model(TestLocation(), config);
+
+  const std::size_t kCount = sizeof(kSentences) / sizeof(const char*);
+  std::vector<std::vector<WordIndex> > words(kCount);
+  for (std::size_t i = 0; i < kCount; ++i) {
+    for (util::TokenIter<util::SingleCharacter, true> w(kSentences[i], ' '); w; ++w) {
+      words[i].push_back(model.GetVocabulary().Index(*w));
+    }
+  }
+  // Repeat the sentences so every slot is reused.
+  std::vector<BatchSentence> sentences;
+  for (std::size_t repeat = 0; repeat < 3; ++repeat) {
+    for (std::size_t i = 0; i < kCount; ++i) {
+      BatchSentence add;
+      add.begin = words[i].empty() ? NULL : &words[i][0];
+      add.end = add.begin + words[i].size();
+      sentences.push_back(add);
+    }
+  }
+
+  for (unsigned int context = 0; context < 2; ++context) {
+    for (std::size_t width = 1; width < 6; width += 2) {
+      BatchScorer<M> scorer(model, width, context);
+      scorer.Score(&sentences[0], &sentences[0] + sentences.size());
+      for (std::size_t i = 0; i < sentences.size(); ++i) {
+        BOOST_CHECK_CLOSE(Serial(model, words[i % kCount], context), sentences[i].total, 0.001);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Probing) {
+  Everything<Model>();
+}
+BOOST_AUTO_TEST_CASE(Trie) {
+  Everything<TrieModel>();
+}
+BOOST_AUTO_TEST_CASE(QuantArrayTrie) {
+  Everything<QuantArrayTrieModel>();
+}
+BOOST_AUTO_TEST_CASE(EliasFanoTrie) {
+  Everything<ArrayTrieModel>(true);
+}
+
+} // namespace
+} // namespace ngram
+} // namespace lm
@@ -15,6 +15,8 @@ DontBhiksha::DontBhiksha(const void * /*base*/, uint64_t /*max_offset*/, uint64_
   next_(util::BitsMask::ByMax(max_next)) {}
 
 const uint8_t kArrayBhikshaVersion = 0;
+// The same layout of the trie, but the high bits are coded with Elias-Fano.
+const uint8_t kArrayBhikshaEliasFanoVersion = 1;
 
 // TODO: put this in binary file header instead when I change the binary file format again.  
 void ArrayBhiksha::UpdateConfigFromBinary(const BinaryFormat &file, uint64_t offset, Config &config) {
@@ -22,8 +24,9 @@ void ArrayBhiksha::UpdateConfigFromBinary(const BinaryFormat &file, uint64_t off
   file.ReadForConfig(buffer, 2, offset);
   uint8_t version = buffer[0];
   uint8_t configured_bits = buffer[1];
-  if (version != kArrayBhikshaVersion) UTIL_THROW(FormatLoadException, "This file has sorted array compression version " << (unsigned) version << " but the code expects version " << (unsigned)kArrayBhikshaVersion);
+  if (version != kArrayBhikshaVersion && version != kArrayBhikshaEliasFanoVersion) UTIL_THROW(FormatLoadException, "This file has sorted array compression version " << (unsigned) version << " but the code expects version " << (unsigned)kArrayBhikshaVersion << " or " << (unsigned)kArrayBhikshaEliasFanoVersion);
   config.pointer_bhiksha_bits = configured_bits;
+  config.pointer_bhiksha_elias_fano = (version == kArrayBhikshaEliasFanoVersion);
 }
 
 namespace {
@@ -50,13 +53,36 @@ std::size_t ArrayCount(uint64_t max_offset, uint64_t max_next, const Config &con
   uint8_t chopping = ChopBits(max_offset, max_next, config);
   return (max_next >> (required - chopping)) + 1 /* we store 0 too */;
 }
+
+// floor(log2(max_next / entries)) so the unary part has at most two bits per entry.
+uint8_t EliasFanoLowBits(uint64_t max_offset, uint64_t max_next) {
+  // An empty level has nothing to split; keep everything in the unary part.
+  if (!max_offset || max_next <= max_offset) return 0;
+  return util::RequiredBits(max_next / max_offset) - 1;
+}
+
+uint64_t EliasFanoSamples(uint64_t max_offset) {
+  if (!max_offset) return 0;
+  return ((max_offset - 1) >> 8) + 1;
+}
+
+uint64_t EliasFanoWords(uint64_t max_offset, uint64_t max_next) {
+  uint64_t bits = max_offset + (max_next >> EliasFanoLowBits(max_offset, max_next)) + 1;
+  // +1 so ReadNext can look one word past the last set bit.
+  return (bits + 63) / 64 + 1;
+}
+
 } // namespace
 
 uint64_t ArrayBhiksha::Size(uint64_t max_offset, uint64_t max_next, const Config &config) {
+  if (config.pointer_bhiksha_elias_fano) {
+    return sizeof(uint64_t) * (1 /* header */ + EliasFanoSamples(max_offset) + EliasFanoWords(max_offset, max_next)) + 7 /* 8-byte alignment */;
+  }
   return sizeof(uint64_t) * (1 /* header */ + ArrayCount(max_offset, max_next, config)) + 7 /* 8-byte alignment */;
 }
 
 uint8_t ArrayBhiksha::InlineBits(uint64_t max_offset, uint64_t max_next, const Config &config) {
+  if (config.pointer_bhiksha_elias_fano) return EliasFanoLowBits(max_offset, max_next);
   return util::RequiredBits(max_next) - ChopBits(max_offset, max_next, config);
 }
 
@@ -72,20 +98,31 @@ void *AlignTo8(void *from) {
 } // namespace
 
 ArrayBhiksha::ArrayBhiksha(void *base, uint64_t max_offset, uint64_t max_next, const Config &config)
-  : next_inline_(util::BitsMask::ByBits(InlineBits(max_offset, max_next, config))),
+  : elias_fano_(config.pointer_bhiksha_elias_fano),
+    next_inline_(util::BitsMask::ByBits(InlineBits(max_offset, max_next, config))),
     offset_begin_(reinterpret_cast<const uint64_t*>(AlignTo8(base)) + 1 /* 8-byte header */),
-    offset_end_(offset_begin_ + ArrayCount(max_offset, max_next, config)),
+    offset_end_(offset_begin_ + (elias_fano_ ? 0 : ArrayCount(max_offset, max_next, config))),
     write_to_(reinterpret_cast<uint64_t*>(AlignTo8(base)) + 1 /* 8-byte header */ + 1 /* first entry is 0 */),
+    samples_(reinterpret_cast<uint64_t*>(AlignTo8(base)) + 1 /* 8-byte header */),
+    bits_(samples_ + (elias_fano_ ? EliasFanoSamples(max_offset) : 0)),
+    bits_end_(bits_ + (elias_fano_ ? EliasFanoWords(max_offset, max_next) : 0)),
+    entries_(max_offset),
+    written_(0),
     original_base_(base) {}
 
 void ArrayBhiksha::FinishedLoading(const Config &config) {
-  // *offset_begin_ = 0 but without a const_cast.
-  *(write_to_ - (write_to_ - offset_begin_)) = 0;
+  uint8_t *head_write = reinterpret_cast<uint8_t*>(original_base_);
+  if (elias_fano_) {
+    UTIL_THROW_IF(written_ != entries_, util::Exception, "Wrote " << written_ << " Elias-Fano pointers but expected " << entries_);
+    *(head_write++) = kArrayBhikshaEliasFanoVersion;
+  } else {
+    // *offset_begin_ = 0 but without a const_cast.
+    *(write_to_ - (write_to_ - offset_begin_)) = 0;
 
-  if (write_to_ != offset_end_) UTIL_THROW(util::Exception, "Did not get all the array entries that were expected.");
+    if (write_to_ != offset_end_) UTIL_THROW(util::Exception, "Did not get all the array entries that were expected.");
 
-  uint8_t *head_write = reinterpret_cast<uint8_t*>(original_base_);
-  *(head_write++) = kArrayBhikshaVersion;
+    *(head_write++) = kArrayBhikshaVersion;
+  }
   *(head_write++) = config.pointer_bhiksha_bits;
 }
 
@@ -8,6 +8,16 @@
  *  }
  *
  *  Currently only used for next pointers.  
+ *
+ * ArrayBhiksha can also code the high bits with Elias-Fano, the code for
+ * monotone sequences:
+ * @inproceedings{eliasfano,
+ *  author={Sebastiano Vigna},
+ *  year={2013},
+ *  title={Quasi-Succinct Indices},
+ *  booktitle={Proceedings of the Sixth ACM International Conference on Web Search and Data Mining},
+ *  pages={83--92},
+ *  }
  */
 
 #ifndef LM_BHIKSHA_H
@@ -62,6 +72,21 @@ class DontBhiksha {
     util::BitsMask next_;
 };
 
+/* Next pointers are nondecreasing, so their high bits are stored once for
+ * all the pointers that share them instead of inline.  By default that is an
+ * array of the first index with each value of the high bits.  With
+ * Config::pointer_bhiksha_elias_fano it is Elias-Fano instead: pointer i with
+ * high bits h sets bit h + i of a bit vector.  That costs about 2 bits per
+ * entry on top of the low bits, which are log2(max_next / entries).  Finding
+ * the i-th set bit starts from a sample taken every kSampleRate entries.
+ * Which one a file uses is recorded in its header, so both are the same model
+ * type.
+ *
+ * Only next pointers are coded this way.  Word ids stay bit packed as in the
+ * other tries: they restart in every node, so a monotone sequence would need
+ * the parent index folded in and cost log2(vocab) + 2 bits per entry, more
+ * than the log2(vocab) they take now.
+ */
 class ArrayBhiksha {
   public:
     static const ModelType kModelTypeAdd = kArrayAdd;
@@ -75,6 +100,10 @@ class ArrayBhiksha {
     ArrayBhiksha(void *base, uint64_t max_offset, uint64_t max_value, const Config &config);
 
     void ReadNext(const void *base, uint64_t bit_offset, uint64_t index, uint8_t total_bits, NodeRange &out) const {
+      if (elias_fano_) {
+        ReadNextEliasFano(base, bit_offset, index, total_bits, out);
+        return;
+      }
       // Some assertions are commented out because they are expensive.
       // assert(*offset_begin_ == 0);
       // std::upper_bound returns the first element that is greater.  Want the
@@ -96,6 +125,10 @@ class ArrayBhiksha {
     }
 
     void WriteNext(void *base, uint64_t bit_offset, uint64_t index, uint64_t value) {
+      if (elias_fano_) {
+        WriteNextEliasFano(base, bit_offset, index, value);
+        return;
+      }
       uint64_t encode = value >> next_inline_.bits;
       for (; write_to_ <= offset_begin_ + encode; ++write_to_) *write_to_ = index;
       util::WriteInt57(base, bit_offset, next_inline_.bits, value & next_inline_.mask);
@@ -106,13 +139,78 @@ class ArrayBhiksha {
     uint8_t InlineBits() const { return next_inline_.bits; }
 
   private:
+    static const unsigned int kSampleShift = 8;
+    static const uint64_t kSampleRate = 1ULL << kSampleShift;
+
+    static unsigned int PopCount(uint64_t value) {
+#if defined(__GNUC__)
+      return __builtin_popcountll(value);
+#else
+      unsigned int ret = 0;
+      for (; value; value &= value - 1) ++ret;
+      return ret;
+#endif
+    }
+
+    static unsigned int TrailingZeros(uint64_t value) {
+#if defined(__GNUC__)
+      return __builtin_ctzll(value);
+#else
+      unsigned int ret = 0;
+      for (; !(value & 1); value >>= 1) ++ret;
+      return ret;
+#endif
+    }
+
+    void ReadNextEliasFano(const void *base, uint64_t bit_offset, uint64_t index, uint8_t total_bits, NodeRange &out) const {
+      uint64_t sample = samples_[index >> kSampleShift];
+      uint64_t skip = index & (kSampleRate - 1);
+      const uint64_t *word = bits_ + (sample >> 6);
+      uint64_t value = *word & (~0ULL << (sample & 63));
+      // Find the set bit for index.
+      for (uint64_t count; skip >= (count = PopCount(value)); skip -= count) {
+        value = *++word;
+      }
+      for (; skip; --skip) value &= value - 1;
+      uint64_t high = ((word - bits_) << 6) + TrailingZeros(value) - index;
+      out.begin = (high << next_inline_.bits) |
+        util::ReadInt57(base, bit_offset, next_inline_.bits, next_inline_.mask);
+      // The next set bit is for index + 1.
+      value &= value - 1;
+      while (!value) value = *++word;
+      high = ((word - bits_) << 6) + TrailingZeros(value) - index - 1;
+      out.end = (high << next_inline_.bits) |
+        util::ReadInt57(base, bit_offset + total_bits, next_inline_.bits, next_inline_.mask);
+      assert(out.end >= out.begin);
+    }
+
+    void WriteNextEliasFano(void *base, uint64_t bit_offset, uint64_t index, uint64_t value) {
+      // The memory may be recycled, so clear the bits before the first write.
+      if (!index) std::fill(bits_, bits_end_, 0);
+      util::WriteInt57(base, bit_offset, next_inline_.bits, value & next_inline_.mask);
+      uint64_t position = (value >> next_inline_.bits) + index;
+      bits_[position >> 6] |= 1ULL << (position & 63);
+      if (!(index & (kSampleRate - 1))) samples_[index >> kSampleShift] = position;
+      written_ = index + 1;
+    }
+
+    const bool elias_fano_;
+
     const util::BitsMask next_inline_;
 
+    // Array of offsets.
     const uint64_t *const offset_begin_;
     const uint64_t *const offset_end_;
 
     uint64_t *write_to_;
 
+    // Elias-Fano.
+    uint64_t *const samples_;
+    uint64_t *const bits_, *const bits_end_;
+
+    const uint64_t entries_;
+    uint64_t written_;
+
     void *original_base_;
 };
 
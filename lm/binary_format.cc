@@ -6,6 +6,7 @@
 
 #include <cstddef>
 #include <cstring>
+#include <iostream>
 #include <limits>
 #include <string>
 #include <cstdlib>
@@ -136,7 +137,7 @@ void MatchCheck(ModelType model_type, unsigned int search_version, const Paramet
 const std::size_t kInvalidSize = static_cast<std::size_t>(-1);
 
 BinaryFormat::BinaryFormat(const Config &config) 
-  : write_method_(config.write_method), write_mmap_(config.write_mmap), load_method_(config.load_method),
+  : write_method_(config.write_method), write_mmap_(config.write_mmap), load_method_(config.load_method), messages_(config.messages),
     header_size_(kInvalidSize), vocab_size_(kInvalidSize), vocab_string_offset_(kInvalidOffset) {}
 
 void BinaryFormat::InitializeBinary(int fd, ModelType model_type, unsigned int search_version, Parameters &params) {
@@ -159,7 +160,11 @@ void *BinaryFormat::LoadBinary(std::size_t size) {
   uint64_t total_map = static_cast<uint64_t>(header_size_) + static_cast<uint64_t>(size);
   UTIL_THROW_IF(file_size != util::kBadSize && file_size < total_map, FormatLoadException, "Binary file has size " << file_size << " but the headers say it should be at least " << total_map);
 
-  util::MapRead(load_method_, file_.get(), 0, util::CheckOverflow(total_map), mapping_);
+  util::PageKind pages = util::MapRead(load_method_, file_.get(), 0, util::CheckOverflow(total_map), mapping_);
+  // Huge pages are not guaranteed, so say what happened.
+  if (messages_ && (load_method_ == util::HUGE_READ || load_method_ == util::HUGE_INTERLEAVE_READ)) {
+    *messages_ << "Loaded " << total_map << " bytes into " << util::PageKindName(pages) << (load_method_ == util::HUGE_INTERLEAVE_READ ? " interleaved across NUMA nodes" : "") << std::endl;
+  }
 
   vocab_string_offset_ = total_map;
   return reinterpret_cast<uint8_t*>(mapping_.get()) + header_size_;
@@ -78,6 +78,7 @@ class BinaryFormat {
     const Config::WriteMethod write_method_;
     const char *write_mmap_;
     util::LoadMethod load_method_;
+    std::ostream *messages_;
 
     // File behind memory, if any.  
     util::scoped_fd file_;
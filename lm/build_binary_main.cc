@@ -24,7 +24,7 @@ namespace ngram {
 namespace {
 
 void Usage(const char *name, const char *default_mem) {
-  std::cerr << "Usage: " << name << " [-u log10_unknown_probability] [-s] [-i] [-w mmap|after] [-p probing_multiplier] [-T trie_temporary] [-S trie_building_mem] [-q bits] [-b bits] [-a bits] [type] input.arpa [output.mmap]\n\n"
+  std::cerr << "Usage: " << name << " [-u log10_unknown_probability] [-s] [-i] [-w mmap|after] [-p probing_multiplier] [-T trie_temporary] [-S trie_building_mem] [-q bits] [-b bits] [-a bits] [-e] [-j threads] [type] input.arpa [output.mmap]\n\n"
 "-u sets the log10 probability for <unk> if the ARPA file does not have one.\n"
 "   Default is -100.  The ARPA file will always take precedence.\n"
 "-s allows models to be built even if they do not have <s> and </s>.\n"
@@ -51,7 +51,10 @@ void Usage(const char *name, const char *default_mem) {
 "-b sets backoff quantization bits.  Requires -q and defaults to that value.\n"
 "-a compresses pointers using an array of offsets.  The parameter is the\n"
 "   maximum number of bits encoded by the array.  Memory is minimized subject\n"
-"   to the maximum, so pick 255 to minimize memory.\n\n"
+"   to the maximum, so pick 255 to minimize memory.\n"
+"-e compresses pointers like -a but codes them with Elias-Fano instead of an\n"
+"   array.  This is usually smaller than -a and slightly slower to query.\n\n"
+"-j parses the ARPA file with this many threads.  Default is 1.\n\n"
 "-h print this help message.\n\n"
 "Get a memory estimate by passing an ARPA file without an output file name.\n";
   exit(1);
@@ -109,11 +112,11 @@ int main(int argc, char *argv[]) {
     Usage(argv[0], default_mem);
 
   try {
-    bool quantize = false, set_backoff_bits = false, bhiksha = false, set_write_method = false, rest = false;
+    bool quantize = false, set_backoff_bits = false, bhiksha = false, elias_fano = false, set_write_method = false, rest = false;
     lm::ngram::Config config;
     config.building_memory = util::ParseSize(default_mem);
     int opt;
-    while ((opt = getopt(argc, argv, "q:b:a:u:p:t:T:m:S:w:sir:h")) != -1) {
+    while ((opt = getopt(argc, argv, "q:b:a:eu:p:t:T:m:S:w:sir:j:h")) != -1) {
       switch(opt) {
         case 'q':
           config.prob_bits = ParseBitCount(optarg);
@@ -128,6 +131,10 @@ int main(int argc, char *argv[]) {
           config.pointer_bhiksha_bits = ParseBitCount(optarg);
           bhiksha = true;
           break;
+        case 'e':
+          config.pointer_bhiksha_elias_fano = true;
+          elias_fano = true;
+          break;
         case 'u':
           config.unknown_missing_logprob = ParseFloat(optarg);
           break;
@@ -165,6 +172,9 @@ int main(int argc, char *argv[]) {
           ParseFileList(optarg, config.rest_lower_files);
           config.rest_function = Config::REST_LOWER;
           break;
+        case 'j':
+          config.arpa_threads = ParseUInt(optarg);
+          break;
         case 'h': // help
         default:
           Usage(argv[0], default_mem);
@@ -174,6 +184,10 @@ int main(int argc, char *argv[]) {
       std::cerr << "You specified backoff quantization (-b) but not probability quantization (-q)" << std::endl;
       abort();
     }
+    if (bhiksha && elias_fano) {
+      std::cerr << "Array pointer compression (-a) and Elias-Fano pointer compression (-e) are mutually exclusive" << std::endl;
+      abort();
+    }
     if (optind + 1 == argc) {
       ShowSizes(argv[optind], config);
       return 0;
@@ -208,13 +222,13 @@ int main(int argc, char *argv[]) {
       }
       if (!set_write_method) config.write_method = Config::WRITE_MMAP;
       if (quantize) {
-        if (bhiksha) {
+        if (bhiksha || elias_fano) {
           QuantArrayTrieModel(from_file, config);
         } else {
           QuantTrieModel(from_file, config);
         }
       } else {
-        if (bhiksha) {
+        if (bhiksha || elias_fano) {
           ArrayTrieModel(from_file, config);
         } else {
           TrieModel(from_file, config);
@@ -0,0 +1,105 @@
+#include "lm/builder/binary.hh"
+
+#include "lm/builder/ngram_stream.hh"
+#include "lm/builder/print.hh"
+#include "lm/model.hh"
+#include "lm/ngram_source.hh"
+#include "util/exception.hh"
+#include "util/stream/timer.hh"
+
+namespace lm { namespace builder {
+
+namespace {
+
+class ChainSource : public lm::NGramSource {
+  public:
+    ChainSource(const VocabReconstitute &vocab, const std::vector<uint64_t> &counts, const util::stream::ChainPositions &positions, const std::string &name)
+      : vocab_(vocab), counts_(counts), streams_(positions), current_(NULL), advance_(false), name_(name) {}
+
+    void ReadCounts(std::vector<uint64_t> &counts) {
+      counts = counts_;
+    }
+
+    void BeginOrder(unsigned int length) {
+      FinishOrder();
+      UTIL_THROW_IF(length > streams_.size(), util::Exception, "Asked for " << length << "-grams but the model has order " << streams_.size());
+      current_ = &streams_[length - 1];
+      advance_ = false;
+    }
+
+    const WordIndex *Next() {
+      // Only advance now so the previous record stays valid until this call.
+      if (advance_) ++*current_;
+      advance_ = true;
+      UTIL_THROW_IF(!*current_, util::Exception, "Ran out of " << (*current_)->Order() << "-grams before the count was reached");
+      return (*current_)->begin();
+    }
+
+    void End() {
+      FinishOrder();
+    }
+
+    StringPiece Word(WordIndex source_id) const {
+      return vocab_.LookupPiece(source_id);
+    }
+
+    const char *Name() const { return name_.c_str(); }
+
+  private:
+    void FinishOrder() {
+      if (!current_) return;
+      if (advance_) ++*current_;
+      UTIL_THROW_IF(*current_, util::Exception, "There are more " << (*current_)->Order() << "-grams than counted");
+      current_ = NULL;
+    }
+
+    const VocabReconstitute &vocab_;
+    const std::vector<uint64_t> &counts_;
+
+    NGramStreams streams_;
+    NGramStream *current_;
+    bool advance_;
+
+    const std::string &name_;
+};
+
+template <class Model> void Build(ChainSource &source, const lm::ngram::Config &config) {
+  // Constructing the model writes it to config.write_mmap.
+  Model model(source, config);
+}
+
+} // namespace
+
+WriteBinary::WriteBinary(const VocabReconstitute &vocab, const std::vector<uint64_t> &counts, const BinaryConfig &config)
+  : vocab_(vocab), counts_(counts), config_(config) {}
+
+void WriteBinary::Run(const util::stream::ChainPositions &positions) {
+  UTIL_TIMER("(%w s) Wrote binary file\n");
+  ChainSource source(vocab_, counts_, positions, config_.file);
+  lm::ngram::Config config(config_.model);
+  config.write_mmap = config_.file.c_str();
+  switch (config_.type) {
+    case lm::ngram::PROBING:
+      Build<lm::ngram::ProbingModel>(source, config);
+      break;
+    case lm::ngram::REST_PROBING:
+      Build<lm::ngram::RestProbingModel>(source, config);
+      break;
+    case lm::ngram::TRIE:
+      Build<lm::ngram::TrieModel>(source, config);
+      break;
+    case lm::ngram::QUANT_TRIE:
+      Build<lm::ngram::QuantTrieModel>(source, config);
+      break;
+    case lm::ngram::ARRAY_TRIE:
+      Build<lm::ngram::ArrayTrieModel>(source, config);
+      break;
+    case lm::ngram::QUANT_ARRAY_TRIE:
+      Build<lm::ngram::QuantArrayTrieModel>(source, config);
+      break;
+    default:
+      UTIL_THROW(util::Exception, "Unsupported binary model type " << config_.type);
+  }
+}
+
+}} // namespaces
@@ -0,0 +1,45 @@
+#ifndef LM_BUILDER_BINARY_H
+#define LM_BUILDER_BINARY_H
+
+#include "lm/config.hh"
+#include "lm/model_type.hh"
+#include "util/stream/multi_stream.hh"
+
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+namespace lm { namespace builder {
+
+class VocabReconstitute;
+
+struct BinaryConfig {
+  // Where to write.  Empty means write ARPA instead.
+  std::string file;
+
+  // PROBING, REST_PROBING, or any of the tries.
+  lm::ngram::ModelType type;
+
+  // Quantization bits, pointer compression, and sizing.  write_mmap is
+  // overwritten with file.
+  lm::ngram::Config model;
+};
+
+// Builds a binary model straight from the final suffix-sorted n-grams, skipping
+// the ARPA round trip.  Like PrintARPA, this reads all unigrams before bigrams
+// etc.
+class WriteBinary {
+  public:
+    WriteBinary(const VocabReconstitute &vocab, const std::vector<uint64_t> &counts, const BinaryConfig &config);
+
+    void Run(const util::stream::ChainPositions &positions);
+
+  private:
+    const VocabReconstitute &vocab_;
+    const std::vector<uint64_t> &counts_;
+    const BinaryConfig &config_;
+};
+
+}} // namespaces
+#endif // LM_BUILDER_BINARY_H
@@ -78,6 +78,35 @@ lm::builder::Discount ParseDiscountFallback(const std::vector<std::string> &para
   return ret;
 }
 
+uint8_t BinaryBits(const boost::program_options::variables_map &vm, const char *name, unsigned limit = 25) {
+  unsigned bits = vm[name].as<unsigned>();
+  UTIL_THROW_IF(bits > limit, util::Exception, "--" << name << " is " << bits << " but it is limited to " << limit << ".");
+  return bits;
+}
+
+// Mirrors build_binary's handling of type and quantization options.
+void SetupBinary(const boost::program_options::variables_map &vm, const std::string &type, lm::builder::BinaryConfig &binary) {
+  lm::ngram::Config &config = binary.model;
+  bool quantize = vm.count("binary_quantize"), bhiksha = vm.count("binary_array"), elias_fano = vm["binary_elias_fano"].as<bool>();
+  if (type == "probing") {
+    UTIL_THROW_IF(quantize || bhiksha || elias_fano || vm.count("binary_backoff_bits"), util::Exception, "Quantization and pointer compression are only implemented in the trie data structure.");
+    binary.type = lm::ngram::PROBING;
+    config.write_method = lm::ngram::Config::WRITE_AFTER;
+    return;
+  }
+  UTIL_THROW_IF(type != "trie", util::Exception, "Unknown binary type " << type << ".  Use probing or trie.");
+  UTIL_THROW_IF(!quantize && vm.count("binary_backoff_bits"), util::Exception, "You specified backoff quantization (--binary_backoff_bits) but not probability quantization (--binary_quantize)");
+  UTIL_THROW_IF(bhiksha && elias_fano, util::Exception, "--binary_array and --binary_elias_fano are mutually exclusive");
+  config.write_method = lm::ngram::Config::WRITE_MMAP;
+  if (quantize) {
+    config.prob_bits = BinaryBits(vm, "binary_quantize");
+    config.backoff_bits = vm.count("binary_backoff_bits") ? BinaryBits(vm, "binary_backoff_bits") : config.prob_bits;
+  }
+  if (bhiksha) config.pointer_bhiksha_bits = BinaryBits(vm, "binary_array", 255);
+  config.pointer_bhiksha_elias_fano = elias_fano;
+  binary.type = static_cast<lm::ngram::ModelType>(lm::ngram::TRIE + (quantize ? lm::ngram::kQuantAdd : 0) + (bhiksha || elias_fano ? lm::ngram::kArrayAdd : 0));
+}
+
 } // namespace
 
 int main(int argc, char *argv[]) {
@@ -86,7 +115,7 @@ int main(int argc, char *argv[]) {
     po::options_description options("Language model building options");
     lm::builder::PipelineConfig pipeline;
 
-    std::string text, arpa;
+    std::string text, arpa, binary_type;
     std::vector<std::string> pruning;
     std::vector<std::string> discount_fallback;
     std::vector<std::string> discount_fallback_default;
@@ -114,6 +143,14 @@ int main(int argc, char *argv[]) {
       ("verbose_header", po::bool_switch(&pipeline.verbose_header), "Add a verbose header to the ARPA file that includes information such as token count, smoothing type, etc.")
       ("text", po::value<std::string>(&text), "Read text from a file instead of stdin")
       ("arpa", po::value<std::string>(&arpa), "Write ARPA to a file instead of stdout")
+      ("binary", po::value<std::string>(&pipeline.binary.file), "Write a binary file directly instead of ARPA.  This skips printing and parsing the ARPA file with build_binary.")
+      ("binary_type", po::value<std::string>(&binary_type)->default_value("probing"), "Binary data structure: probing or trie")
+      ("binary_quantize", po::value<unsigned>(), "Quantize trie probabilities to this many bits, like build_binary -q")
+      ("binary_backoff_bits", po::value<unsigned>(), "Quantize trie backoffs to this many bits, like build_binary -b.  Defaults to --binary_quantize")
+      ("binary_array", po::value<unsigned>(), "Compress trie pointers using an array of offsets with at most this many bits, like build_binary -a.  Pick 255 to minimize memory")
+      ("binary_elias_fano", po::bool_switch(), "Compress trie pointers with Elias-Fano coding, like build_binary -e")
+      ("write_counts", po::value<std::string>(&pipeline.counts_out), "Count and sort n-grams, write them to this file and the vocabulary to the file name plus .vocab, then stop.  Use this to count pieces of a corpus in separate processes or on separate machines.")
+      ("read_counts", po::value<std::vector<std::string> >(&pipeline.counts_in)->multitoken(), "Instead of reading text, merge count files written by --write_counts with the same order.  This can be combined with --write_counts to merge in stages.")
       ("collapse_values", po::bool_switch(&pipeline.output_q), "Collapse probability and backoff into a single value, q that yields the same sentence-level probabilities.  See http://kheafield.com/professional/edinburgh/rest_paper.pdf for more details, including a proof.")
       ("prune", po::value<std::vector<std::string> >(&pruning)->multitoken(), "Prune n-grams with count less than or equal to the given threshold.  Specify one value for each order i.e. 0 0 1 to prune singleton trigrams and above.  The sequence of values must be non-decreasing and the last value applies to any remaining orders.  Unigram pruning is not implemented, so the first value must be zero.  Default is to not prune, which is equivalent to --prune 0.")
       ("discount_fallback", po::value<std::vector<std::string> >(&discount_fallback)->multitoken()->implicit_value(discount_fallback_default, "0.5 1 1.5"), "The closed-form estimate for Kneser-Ney discounts does not work without singletons or doubletons.  It can also fail if these values are out of range.  This option falls back to user-specified discounts when the closed-form estimate fails.  Note that this option is generally a bad idea: you should deduplicate your corpus instead.  However, class-based models need custom discounts because they lack singleton unigrams.  Provide up to three discounts (for adjusted counts 1, 2, and 3+), which will be applied to all orders where the closed-form estimates fail.");
@@ -179,6 +216,13 @@ int main(int argc, char *argv[]) {
       pipeline.discount.bad_action = lm::THROW_UP;
     }
 
+    if (!pipeline.binary.file.empty()) {
+      SetupBinary(vm, binary_type, pipeline.binary);
+    } else if (vm.count("binary_quantize") || vm.count("binary_backoff_bits") || vm.count("binary_array") || vm["binary_elias_fano"].as<bool>()) {
+      std::cerr << "Binary options require --binary" << std::endl;
+      return 1;
+    }
+
     // parse pruning thresholds.  These depend on order, so it is not done as a notifier.
     pipeline.prune_thresholds = ParsePruning(pruning, pipeline.order);
     
@@ -194,10 +238,20 @@ int main(int argc, char *argv[]) {
 
     util::scoped_fd in(0), out(1);
     if (vm.count("text")) {
+      UTIL_THROW_IF(!pipeline.counts_in.empty(), util::Exception, "Specify either --text or --read_counts, not both");
       in.reset(util::OpenReadOrThrow(text.c_str()));
+    } else if (!pipeline.counts_in.empty()) {
+      in.release();
+    }
+    if (!pipeline.counts_out.empty()) {
+      UTIL_THROW_IF(vm.count("arpa") || !pipeline.binary.file.empty(), util::Exception, "--write_counts stops before the model is built, so it cannot be combined with --arpa or --binary");
+      out.release();
     }
     if (vm.count("arpa")) {
+      UTIL_THROW_IF(!pipeline.binary.file.empty(), util::Exception, "Specify either --arpa or --binary, not both");
       out.reset(util::CreateOrThrow(arpa.c_str()));
+    } else if (!pipeline.binary.file.empty()) {
+      out.release();
     }
 
     // Read from stdin
@@ -1,11 +1,13 @@
 #include "lm/builder/pipeline.hh"
 
 #include "lm/builder/adjust_counts.hh"
+#include "lm/builder/binary.hh"
 #include "lm/builder/corpus_count.hh"
 #include "lm/builder/hash_gamma.hh"
 #include "lm/builder/initial_probabilities.hh"
 #include "lm/builder/interpolate.hh"
 #include "lm/builder/print.hh"
+#include "lm/builder/shard.hh"
 #include "lm/builder/sort.hh"
 
 #include "lm/sizes.hh"
@@ -207,6 +209,24 @@ class Master {
     util::FixedArray<util::stream::FileBuffer> files_;
 };
 
+// Hand sorted counts to the rest of the pipeline or, when counting a shard, write them out.
+void FinishCounts(util::stream::Sort<SuffixOrder, AddCombiner> &sorter, WordIndex type_count, Master &master) {
+  const PipelineConfig &config = master.Config();
+  if (config.counts_out.empty()) {
+    std::cerr << "=== 2/5 Calculating and sorting adjusted counts ===" << std::endl;
+    master.InitForAdjust(sorter, type_count);
+    return;
+  }
+  std::cerr << "=== Writing counts to " << config.counts_out << " ===" << std::endl;
+  util::scoped_fd out(util::CreateOrThrow(config.counts_out.c_str()));
+  const std::size_t min_chain = config.minimum_block * config.block_count;
+  const std::size_t merge_using = sorter.Merge(std::min(config.TotalMemory() - min_chain, sorter.DefaultLazy()));
+  util::stream::Chain chain(util::stream::ChainConfig(NGram::TotalSize(config.order), config.block_count, config.TotalMemory() - merge_using));
+  sorter.Output(chain, merge_using);
+  chain >> util::stream::WriteAndRecycle(out.get());
+  chain.Wait(true);
+}
+
 void CountText(int text_file /* input */, int vocab_file /* output */, Master &master, uint64_t &token_count, std::string &text_file_name) {
   const PipelineConfig &config = master.Config();
   std::cerr << "=== 1/5 Counting and sorting n-grams ===" << std::endl;
@@ -231,8 +251,26 @@ void CountText(int text_file /* input */, int vocab_file /* output */, Master &m
   util::stream::Sort<SuffixOrder, AddCombiner> sorter(chain, config.sort, SuffixOrder(config.order), AddCombiner());
   chain.Wait(true);
   std::cerr << "Unigram tokens " << token_count << " types " << type_count << std::endl;
-  std::cerr << "=== 2/5 Calculating and sorting adjusted counts ===" << std::endl;
-  master.InitForAdjust(sorter, type_count);
+  FinishCounts(sorter, type_count, master);
+}
+
+void MergeShards(int vocab_file /* output */, Master &master, uint64_t &token_count, std::string &text_file_name) {
+  const PipelineConfig &config = master.Config();
+  std::cerr << "=== 1/5 Merging counts from " << config.counts_in.size() << " shards ===" << std::endl;
+  ShardReader shards(config.counts_in, vocab_file, config.vocab_estimate);
+  UTIL_THROW_IF(config.TotalMemory() < shards.MemUsage(), util::Exception, "Renumbering shard vocabularies takes " << shards.MemUsage() << " bytes which exceeds total memory " << config.TotalMemory());
+  util::stream::Chain chain(util::stream::ChainConfig(NGram::TotalSize(config.order), config.block_count, config.TotalMemory() - shards.MemUsage()));
+  chain >> boost::ref(shards);
+  // Renumbering breaks the shards' order, so this sorts again while summing counts.
+  util::stream::Sort<SuffixOrder, AddCombiner> sorter(chain, config.sort, SuffixOrder(config.order), AddCombiner());
+  chain.Wait(true);
+  token_count = shards.Tokens();
+  for (std::vector<std::string>::const_iterator i = config.counts_in.begin(); i != config.counts_in.end(); ++i) {
+    text_file_name += (i == config.counts_in.begin()) ? "" : " ";
+    text_file_name += *i;
+  }
+  std::cerr << "Unigram tokens " << token_count << " types " << shards.Types() << std::endl;
+  FinishCounts(sorter, shards.Types(), master);
 }
 
 void InitialProbabilities(const std::vector<uint64_t> &counts, const std::vector<uint64_t> &counts_pruned, const std::vector<Discount> &discounts, Master &master, Sorts<SuffixOrder> &primary,
@@ -307,12 +345,22 @@ void Pipeline(PipelineConfig config, int text_file, int out_arpa) {
   // master's destructor will wait for chains.  But they might be deadlocked if
   // this thread dies because e.g. it ran out of memory.
   try {
-    util::scoped_fd vocab_file(config.vocab_file.empty() ? 
+    std::string vocab_name(config.counts_out.empty() ? config.vocab_file : (config.counts_out + ".vocab"));
+    util::scoped_fd vocab_file(vocab_name.empty() ? 
         util::MakeTemp(config.TempPrefix()) : 
-        util::CreateOrThrow(config.vocab_file.c_str()));
+        util::CreateOrThrow(vocab_name.c_str()));
     uint64_t token_count;
     std::string text_file_name;
-    CountText(text_file, vocab_file.get(), master, token_count, text_file_name);
+    if (config.counts_in.empty()) {
+      CountText(text_file, vocab_file.get(), master, token_count, text_file_name);
+    } else {
+      util::scoped_fd unused(text_file);
+      MergeShards(vocab_file.get(), master, token_count, text_file_name);
+    }
+    if (!config.counts_out.empty()) {
+      util::scoped_fd unused(out_arpa);
+      return;
+    }
 
     std::vector<uint64_t> counts;
     std::vector<uint64_t> counts_pruned;
@@ -326,11 +374,20 @@ void Pipeline(PipelineConfig config, int text_file, int out_arpa) {
       InterpolateProbabilities(counts_pruned, master, primary, gammas);
     }
 
-    std::cerr << "=== 5/5 Writing ARPA model ===" << std::endl;
     VocabReconstitute vocab(vocab_file.get());
     UTIL_THROW_IF(vocab.Size() != counts[0], util::Exception, "Vocab words don't match up.  Is there a null byte in the input?");
-    HeaderInfo header_info(text_file_name, token_count);
-    master >> PrintARPA(vocab, counts_pruned, (config.verbose_header ? &header_info : NULL), out_arpa) >> util::stream::kRecycle;
+    if (config.binary.file.empty()) {
+      std::cerr << "=== 5/5 Writing ARPA model ===" << std::endl;
+      HeaderInfo header_info(text_file_name, token_count);
+      master >> PrintARPA(vocab, counts_pruned, (config.verbose_header ? &header_info : NULL), out_arpa) >> util::stream::kRecycle;
+    } else {
+      std::cerr << "=== 5/5 Writing binary model ===" << std::endl;
+      util::scoped_fd unused(out_arpa);
+      // The chains only hold small buffers by now, so the trie sort can have the rest.
+      config.binary.model.building_memory = config.TotalMemory();
+      if (!config.binary.model.temporary_directory_prefix) config.binary.model.temporary_directory_prefix = config.TempPrefix().c_str();
+      master >> WriteBinary(vocab, counts_pruned, config.binary) >> util::stream::kRecycle;
+    }
     master.MutableChains().Wait(true);
   } catch (const util::Exception &e) {
     std::cerr << e.what() << std::endl;
@@ -2,6 +2,7 @@
 #define LM_BUILDER_PIPELINE_H
 
 #include "lm/builder/adjust_counts.hh"
+#include "lm/builder/binary.hh"
 #include "lm/builder/initial_probabilities.hh"
 #include "lm/builder/header_info.hh"
 #include "lm/lm_exception.hh"
@@ -10,6 +11,7 @@
 #include "util/file_piece.hh"
 
 #include <string>
+#include <vector>
 #include <cstddef>
 
 namespace lm { namespace builder {
@@ -62,11 +64,22 @@ struct PipelineConfig {
    */
   WarningAction disallowed_symbol_action;
 
+  // Write a binary file directly instead of ARPA if binary.file is set.
+  BinaryConfig binary;
+
+  // Sharding.  If counts_out is set, stop after counting and write the sorted
+  // counts there and the vocabulary to counts_out + ".vocab".  If counts_in is
+  // set, merge these files instead of reading text.  Both may be set to merge
+  // shards into a larger shard.
+  std::string counts_out;
+  std::vector<std::string> counts_in;
+
   const std::string &TempPrefix() const { return sort.temp_prefix; }
   std::size_t TotalMemory() const { return sort.total_memory; }
 };
 
-// Takes ownership of text_file and out_arpa.
+// Takes ownership of text_file and out_arpa.  text_file may be -1 when reading
+// counts_in and out_arpa may be -1 when writing a binary file or counts_out.
 void Pipeline(PipelineConfig config, int text_file, int out_arpa);
 
 }} // namespaces
@@ -0,0 +1,64 @@
+#include "lm/builder/shard.hh"
+
+#include "lm/builder/ngram.hh"
+#include "lm/builder/print.hh"
+#include "lm/vocab.hh"
+#include "util/exception.hh"
+#include "util/file.hh"
+#include "util/stream/chain.hh"
+
+namespace lm { namespace builder {
+
+ShardReader::ShardReader(const std::vector<std::string> &files, int vocab_write, WordIndex vocab_estimate)
+  : files_(files), mappings_(files.size()), tokens_(0) {
+  ngram::GrowableVocab<ngram::WriteUniqueWords> vocab(vocab_estimate, vocab_write);
+  for (std::size_t i = 0; i < files_.size(); ++i) {
+    util::scoped_fd vocab_file(util::OpenReadOrThrow((files_[i] + ".vocab").c_str()));
+    VocabReconstitute words(vocab_file.get());
+    std::vector<WordIndex> &mapping = mappings_[i];
+    mapping.resize(words.Size());
+    for (WordIndex w = 0; w < words.Size(); ++w) {
+      mapping[w] = vocab.FindOrInsert(words.LookupPiece(w));
+    }
+  }
+  types_ = vocab.Size();
+}
+
+std::size_t ShardReader::MemUsage() const {
+  std::size_t ret = 0;
+  for (std::vector<std::vector<WordIndex> >::const_iterator i = mappings_.begin(); i != mappings_.end(); ++i) {
+    ret += i->size() * sizeof(WordIndex);
+  }
+  return ret;
+}
+
+void ShardReader::Run(const util::stream::ChainPosition &position) {
+  const std::size_t block_size = position.GetChain().BlockSize();
+  const std::size_t entry_size = position.GetChain().EntrySize();
+  const std::size_t order = NGram::OrderFromSize(entry_size);
+  uint64_t total = 0, sentences = 0;
+  util::stream::Link link(position);
+  for (std::size_t i = 0; i < files_.size(); ++i) {
+    util::scoped_fd file(util::OpenReadOrThrow(files_[i].c_str()));
+    const std::vector<WordIndex> &mapping = mappings_[i];
+    while (true) {
+      std::size_t got = util::ReadOrEOF(file.get(), link->Get(), block_size);
+      UTIL_THROW_IF(got % entry_size, util::Exception, "Counts file " << files_[i] << " does not contain whole " << order << "-grams.  Was it written with a different order?");
+      if (!got) break;
+      for (NGram gram(link->Get(), order); gram.Base() != static_cast<uint8_t*>(link->Get()) + got; gram.NextInMemory()) {
+        for (WordIndex *w = gram.begin(); w != gram.end(); ++w) {
+          UTIL_THROW_IF(*w >= mapping.size(), util::Exception, "Word id " << *w << " in " << files_[i] << " is not in its vocabulary " << files_[i] << ".vocab");
+          *w = mapping[*w];
+        }
+        total += gram.Count();
+        if (*(gram.end() - 1) == kEOS) sentences += gram.Count();
+      }
+      link->SetValidSize(got);
+      ++link;
+    }
+  }
+  link.Poison();
+  tokens_ = total - sentences;
+}
+
+}} // namespaces
@@ -0,0 +1,51 @@
+#ifndef LM_BUILDER_SHARD_H
+#define LM_BUILDER_SHARD_H
+
+#include "lm/word_index.hh"
+
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+namespace util { namespace stream { class ChainPosition; } }
+
+namespace lm { namespace builder {
+
+/* lmplz can count disjoint pieces of a corpus in separate processes, possibly
+ * on different machines, with --write_counts.  Each piece is a file of
+ * suffix-sorted n-grams with counts plus the piece's vocabulary in file.vocab.
+ * This reads the pieces back as one stream for sorting and summing.  Every
+ * piece numbers words on its own, so words are mapped into one vocabulary.
+ */
+class ShardReader {
+  public:
+    // Reads the vocabulary of every shard, writing the combined vocabulary to
+    // vocab_write in the same format CorpusCount uses.
+    ShardReader(const std::vector<std::string> &files, int vocab_write, WordIndex vocab_estimate);
+
+    // Vocabulary size across all shards.
+    WordIndex Types() const { return types_; }
+
+    // Total size of the renumbering tables.
+    std::size_t MemUsage() const;
+
+    // Set by Run.  Tokens are recovered from the counts: every token ends one
+    // n-gram, as does every </s>, which is not a token.
+    uint64_t Tokens() const { return tokens_; }
+
+    void Run(const util::stream::ChainPosition &position);
+
+  private:
+    std::vector<std::string> files_;
+
+    // shard -> shard's word id -> combined word id.
+    std::vector<std::vector<WordIndex> > mappings_;
+
+    WordIndex types_;
+
+    uint64_t tokens_;
+};
+
+}} // namespaces
+#endif // LM_BUILDER_SHARD_H
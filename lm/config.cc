@@ -13,6 +13,7 @@ Config::Config() :
   sentence_marker_missing(THROW_UP),
   positive_log_probability(THROW_UP),
   unknown_missing_logprob(-100.0),
+  arpa_threads(1),
   probing_multiplier(1.5),
   building_memory(1073741824ULL), // 1 GB
   temporary_directory_prefix(NULL),
@@ -24,6 +25,7 @@ Config::Config() :
   prob_bits(8),
   backoff_bits(8),
   pointer_bhiksha_bits(22),
+  pointer_bhiksha_elias_fano(false),
   load_method(util::POPULATE_OR_READ) {}
 
 } // namespace ngram
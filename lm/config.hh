@@ -52,6 +52,10 @@ struct Config {
   // No effect if the model has <unk> or unknown_missing == THROW_UP.
   float unknown_missing_logprob;
 
+  // Threads to parse n-grams with.  Reading the file and inserting n-grams
+  // happen on one thread each regardless.  1 parses on the calling thread.
+  std::size_t arpa_threads;
+
   // Size multiplier for probing hash table.  Must be > 1.  Space is linear in
   // this.  Time is probing_multiplier / (probing_multiplier - 1).  No effect
   // for sorted variant.
@@ -105,6 +109,9 @@ struct Config {
 
   // Bhiksha compression (simple form).  Only works with trie.
   uint8_t pointer_bhiksha_bits;
+  // Code the high bits of the pointers with Elias-Fano instead of an array
+  // of offsets.  Also only works with trie.  pointer_bhiksha_bits is unused.
+  bool pointer_bhiksha_elias_fano;
 
 
   // ONLY EFFECTIVE WHEN READING BINARY
@@ -1,3 +1,4 @@
+#include "lm/binary_format.hh"
 #include "lm/filter/arpa_io.hh"
 #include "lm/filter/format.hh"
 #include "lm/filter/phrase.hh"
@@ -38,7 +39,11 @@ void DisplayHelp(const char *name) {
     "The file format is set by [raw|arpa] with default arpa:\n"
     "raw means space-separated tokens, optionally followed by a tab and arbitrary\n"
     "    text.  This is useful for ngram count files.\n"
-    "arpa means the ARPA file format for n-gram language models.\n\n"
+    "arpa means the ARPA file format for n-gram language models.\n"
+    "If the model is a KenLM trie binary file given with model:, it is detected\n"
+    "    and the output is a binary file of the same type built from the n-grams\n"
+    "    that pass, with the same quantization and pointer compression.  Probing\n"
+    "    binaries store hashes instead of words and cannot be filtered.\n\n"
 #ifndef NTHREAD
     "threads:m sets m threads (default: conccurrency detected by boost)\n"
     "batch_size:m sets the batch size for threading.  Expect memory usage from this\n"
@@ -55,7 +60,7 @@ void DisplayHelp(const char *name) {
 }
 
 typedef enum {MODE_COPY, MODE_SINGLE, MODE_MULTIPLE, MODE_UNION, MODE_UNSET} FilterMode;
-typedef enum {FORMAT_ARPA, FORMAT_COUNT} Format;
+typedef enum {FORMAT_ARPA, FORMAT_COUNT, FORMAT_KENLM} Format;
 
 struct Config {
   Config() : 
@@ -238,12 +243,19 @@ int main(int argc, char *argv[]) {
       vocab = &cmd_file;
     }
 
+    lm::ngram::ModelType binary_type;
+    if (cmd_is_model && lm::ngram::RecognizeBinary(cmd_input, binary_type)) {
+      config.format = lm::FORMAT_KENLM;
+    }
+
     util::FilePiece model(cmd_is_model ? util::OpenReadOrThrow(cmd_input) : 0, cmd_is_model ? cmd_input : NULL, &std::cerr);
 
     if (config.format == lm::FORMAT_ARPA) {
       lm::DispatchFilterModes<lm::ARPAFormat>(config, *vocab, model, argv[argc - 1]);
     } else if (config.format == lm::FORMAT_COUNT) {
       lm::DispatchFilterModes<lm::CountFormat>(config, *vocab, model, argv[argc - 1]);
+    } else if (config.format == lm::FORMAT_KENLM) {
+      lm::DispatchFilterModes<lm::KenLMFormat>(config, *vocab, model, argv[argc - 1]);
     }
     return 0;
   } catch (const std::exception &e) {
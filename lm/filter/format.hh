@@ -3,6 +3,7 @@
 
 #include "lm/filter/arpa_io.hh"
 #include "lm/filter/count_io.hh"
+#include "lm/filter/kenlm_io.hh"
 
 #include <boost/lexical_cast.hpp>
 #include <boost/ptr_container/ptr_vector.hpp>
@@ -74,6 +75,31 @@ class MultipleARPAOutput : public MultipleOutput<ARPAOutput> {
     }
 };
 
+class MultipleKenLMOutput : public MultipleOutput<KenLMOutput> {
+  public:
+    MultipleKenLMOutput(const char *prefix, size_t number) : MultipleOutput<KenLMOutput>(prefix, number) {}
+
+    void BeginModel(const KenLMInput &input) {
+      for (boost::ptr_vector<KenLMOutput>::iterator i = files_.begin(); i != files_.end(); ++i)
+        i->BeginModel(input);
+    }
+
+    void BeginLength(unsigned int length) {
+      for (boost::ptr_vector<KenLMOutput>::iterator i = files_.begin(); i != files_.end(); ++i)
+        i->BeginLength(length);
+    }
+
+    void EndLength(unsigned int length) {
+      for (boost::ptr_vector<KenLMOutput>::iterator i = files_.begin(); i != files_.end(); ++i)
+        i->EndLength(length);
+    }
+
+    void Finish() {
+      for (boost::ptr_vector<KenLMOutput>::iterator i = files_.begin(); i != files_.end(); ++i)
+        i->Finish();
+    }
+};
+
 template <class Filter, class Output> class DispatchInput {
   public:
     DispatchInput(Filter &filter, Output &output) : filter_(filter), output_(output) {}
@@ -108,6 +134,24 @@ template <class Filter, class Output> class DispatchARPAInput : public DispatchI
     void Finish() { B::output_.Finish(); }
 };
 
+template <class Filter, class Output> class DispatchKenLMInput : public DispatchInput<Filter, Output> {
+  private:
+    typedef DispatchInput<Filter, Output> B;
+
+  public:
+    DispatchKenLMInput(Filter &filter, Output &output) : B(filter, output) {}
+
+    void BeginModel(const KenLMInput &input) { B::output_.BeginModel(input); }
+    void BeginLength(unsigned int length) { B::output_.BeginLength(length); }
+
+    // Unigrams must all arrive before higher orders so they can be renumbered.
+    void EndLength(unsigned int length) {
+      B::filter_.Flush();
+      B::output_.EndLength(length);
+    }
+    void Finish() { B::output_.Finish(); }
+};
+
 struct ARPAFormat {
   typedef ARPAOutput Output;
   typedef MultipleARPAOutput Multiple;
@@ -132,6 +176,19 @@ struct CountFormat {
   }
 };
 
+// The model must be a file, not a stream, because it is mapped.
+struct KenLMFormat {
+  typedef KenLMOutput Output;
+  typedef MultipleKenLMOutput Multiple;
+  static void Copy(util::FilePiece &in, Output &out) {
+    ReadKenLM(in.FileName().c_str(), out);
+  }
+  template <class Filter, class Out> static void RunFilter(util::FilePiece &in, Filter &filter, Out &output) {
+    DispatchKenLMInput<Filter, Out> dispatcher(filter, output);
+    ReadKenLM(in.FileName().c_str(), dispatcher);
+  }
+};
+
 /* For multithreading, the buffer classes hold batches of filter inputs and
  * outputs in memory.  The strings get reused a lot, so keep them around
  * instead of clearing each time.  
@@ -0,0 +1,139 @@
+#include "lm/filter/kenlm_io.hh"
+
+#include "lm/model.hh"
+#include "lm/ngram_source.hh"
+#include "util/file.hh"
+
+#include <cstdio>
+#include <iostream>
+#include <limits>
+
+#include <string.h>
+
+namespace lm {
+namespace {
+
+const WordIndex kNotKept = std::numeric_limits<WordIndex>::max();
+
+// Serves the kept n-grams to the model's ARPA loading code.
+class RecordSource : public NGramSource {
+  public:
+    RecordSource(util::scoped_FILE *records, const uint64_t *counts, unsigned int order, const std::vector<WordIndex> &original, const std::vector<std::string> &words, const std::string &name)
+      : records_(records), counts_(counts), order_(order), original_(original), words_(words), name_(name), current_(NULL) {}
+
+    void ReadCounts(std::vector<uint64_t> &counts) {
+      counts.assign(counts_, counts_ + order_);
+    }
+
+    void BeginOrder(unsigned int length) {
+      UTIL_THROW_IF(length > order_, util::Exception, "Asked for " << length << "-grams but the model has order " << order_);
+      current_ = records_[length - 1].get();
+      UTIL_THROW_IF(std::fseek(current_, 0, SEEK_SET), util::ErrnoException, "Could not rewind the temporary file of " << length << "-grams for " << name_);
+      bytes_ = sizeof(WordIndex) * length + sizeof(ProbBackoff);
+    }
+
+    const WordIndex *Next() {
+      UTIL_THROW_IF(std::fread(record_, bytes_, 1, current_) != 1, util::ErrnoException, "Short read from a temporary file of n-grams for " << name_);
+      return record_;
+    }
+
+    void End() {}
+
+    StringPiece Word(WordIndex source_id) const {
+      return words_[original_[source_id]];
+    }
+
+    const char *Name() const { return name_.c_str(); }
+
+  private:
+    util::scoped_FILE *const records_;
+    const uint64_t *const counts_;
+    const unsigned int order_;
+    const std::vector<WordIndex> &original_;
+    const std::vector<std::string> &words_;
+    const std::string &name_;
+
+    std::FILE *current_;
+    std::size_t bytes_;
+    WordIndex record_[KENLM_MAX_ORDER + sizeof(ProbBackoff) / sizeof(WordIndex)];
+};
+
+template <class Model> void Build(RecordSource &source, const ngram::Config &config) {
+  // Constructing the model writes it to config.write_mmap.
+  Model model(source, config);
+}
+
+} // namespace
+
+KenLMOutput::KenLMOutput(const char *name) : file_name_(name), input_(NULL), order_(0), dropped_(0) {}
+
+void KenLMOutput::BeginModel(const KenLMInput &input) {
+  input_ = &input;
+  renumber_.assign(input.words.size(), kNotKept);
+  original_.clear();
+  for (unsigned int i = 0; i < order_; ++i) records_[i].reset();
+  order_ = 0;
+  dropped_ = 0;
+}
+
+void KenLMOutput::BeginLength(unsigned int length) {
+  UTIL_THROW_IF(length > KENLM_MAX_ORDER, util::Exception, "This model has order at least " << length << " but KenLM was compiled with a maximum of " << KENLM_MAX_ORDER << ".  Recompile with --max-kenlm-order=" << length << ".");
+  const std::string temporary_prefix(input_->config.temporary_directory_prefix ? input_->config.temporary_directory_prefix : file_name_.c_str());
+  for (; order_ < length; ++order_) {
+    records_[order_].reset(util::FMakeTemp(temporary_prefix));
+    counts_[order_] = 0;
+  }
+}
+
+void KenLMOutput::AddNGram(const StringPiece &line) {
+  const unsigned char length = kenlm_line::Length(line);
+  WordIndex record[KENLM_MAX_ORDER + sizeof(ProbBackoff) / sizeof(WordIndex)];
+  const std::size_t bytes = sizeof(WordIndex) * length + sizeof(ProbBackoff);
+  // The line is not aligned.
+  memcpy(record, kenlm_line::Record(line), bytes);
+  if (length == 1) {
+    renumber_[record[0]] = original_.size();
+    original_.push_back(record[0]);
+  }
+  for (WordIndex *i = record; i != record + length; ++i) {
+    if ((*i = renumber_[*i]) == kNotKept) {
+      ++dropped_;
+      return;
+    }
+  }
+  util::WriteOrThrow(records_[length - 1].get(), record, bytes);
+  ++counts_[length - 1];
+}
+
+void KenLMOutput::Finish() {
+  UTIL_THROW_IF(!input_, util::Exception, "No model was read for " << file_name_);
+  if (dropped_ && input_->config.messages) {
+    *input_->config.messages << "Dropped " << dropped_ << " n-grams from " << file_name_ << " because they contain words that were filtered as unigrams." << std::endl;
+  }
+  // Highest orders with nothing left would make an invalid model.
+  while (order_ > 1 && !counts_[order_ - 1]) records_[--order_].reset();
+
+  RecordSource source(records_, counts_, order_, original_, input_->words, file_name_);
+  ngram::Config config(input_->config);
+  config.write_mmap = file_name_.c_str();
+  switch (input_->type) {
+    case ngram::TRIE:
+      Build<ngram::TrieModel>(source, config);
+      break;
+    case ngram::QUANT_TRIE:
+      Build<ngram::QuantTrieModel>(source, config);
+      break;
+    case ngram::ARRAY_TRIE:
+      Build<ngram::ArrayTrieModel>(source, config);
+      break;
+    case ngram::QUANT_ARRAY_TRIE:
+      Build<ngram::QuantArrayTrieModel>(source, config);
+      break;
+    default:
+      UTIL_THROW(util::Exception, "Unsupported binary model type " << input_->type);
+  }
+  for (unsigned int i = 0; i < order_; ++i) records_[i].reset();
+  order_ = 0;
+}
+
+} // namespace lm
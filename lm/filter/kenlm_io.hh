@@ -0,0 +1,208 @@
+#ifndef LM_FILTER_KENLM_IO_H
+#define LM_FILTER_KENLM_IO_H
+/* Read and write KenLM binary files so filtering does not go through ARPA.
+ * N-grams are read from a trie binary and the survivors are built into a
+ * binary of the same type with the same quantization and pointer compression.
+ *
+ * Probing binaries are not supported.  Their tables are keyed by a hash of the
+ * n-gram's vocabulary ids, so the words of an n-gram can only be recovered by
+ * trying every vocabulary word against every entry one order down, which costs
+ * |vocab| lookups per n-gram.  Filter the ARPA file or a trie binary instead.
+ *
+ * Filters see each n-gram as a line of text.  Here the line is the n-gram's
+ * text followed by its vocabulary ids, weights, and length in binary, so the
+ * output does not parse anything.
+ */
+#include "lm/binary_format.hh"
+#include "lm/config.hh"
+#include "lm/enumerate_vocab.hh"
+#include "lm/model.hh"
+#include "lm/model_type.hh"
+#include "lm/weights.hh"
+#include "lm/word_index.hh"
+#include "util/exception.hh"
+#include "util/file.hh"
+#include "util/string_piece.hh"
+
+#include <boost/noncopyable.hpp>
+
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+namespace lm {
+
+// What the output needs to know about the model being filtered.
+struct KenLMInput {
+  ngram::ModelType type;
+  // Includes the quantization and pointer compression settings of the file.
+  ngram::Config config;
+  // Strings indexed by the model's vocabulary ids.
+  std::vector<std::string> words;
+};
+
+namespace kenlm_line {
+
+inline std::size_t BinarySize(unsigned char length) {
+  return sizeof(WordIndex) * length + sizeof(ProbBackoff) + 1;
+}
+
+inline void Encode(const KenLMInput &input, const WordIndex *words, unsigned char length, const ProbBackoff &weights, std::string &out) {
+  out.clear();
+  for (const WordIndex *i = words; i != words + length; ++i) {
+    if (i != words) out += ' ';
+    out += input.words[*i];
+  }
+  out.append(reinterpret_cast<const char*>(words), sizeof(WordIndex) * length);
+  out.append(reinterpret_cast<const char*>(&weights), sizeof(ProbBackoff));
+  out += static_cast<char>(length);
+}
+
+inline unsigned char Length(const StringPiece &line) {
+  return static_cast<unsigned char>(line.data()[line.size() - 1]);
+}
+
+inline StringPiece Text(const StringPiece &line) {
+  return StringPiece(line.data(), line.size() - BinarySize(Length(line)));
+}
+
+// Vocabulary ids followed by ProbBackoff.
+inline const char *Record(const StringPiece &line) {
+  return line.data() + line.size() - BinarySize(Length(line));
+}
+
+} // namespace kenlm_line
+
+/* Spools n-grams to a temporary file per order and builds the binary file
+ * from them on Finish, so memory does not grow with the filtered model.
+ * N-grams containing a word that did not survive as a unigram are dropped.
+ */
+class KenLMOutput : boost::noncopyable {
+  public:
+    explicit KenLMOutput(const char *name);
+
+    void BeginModel(const KenLMInput &input);
+
+    void BeginLength(unsigned int length);
+
+    void AddNGram(const StringPiece &line);
+
+    void AddNGram(const StringPiece &/*ngram*/, const StringPiece &line) {
+      AddNGram(line);
+    }
+
+    void EndLength(unsigned int /*length*/) {}
+
+    void Finish();
+
+  private:
+    const std::string file_name_;
+
+    const KenLMInput *input_;
+
+    // Input vocabulary id to output id, or kNotKept.
+    std::vector<WordIndex> renumber_;
+    // Output id to input id.
+    std::vector<WordIndex> original_;
+
+    // By length - 1: records in the layout NGramSource uses.
+    util::scoped_FILE records_[KENLM_MAX_ORDER];
+    uint64_t counts_[KENLM_MAX_ORDER];
+    unsigned int order_;
+
+    uint64_t dropped_;
+};
+
+namespace detail {
+
+class CollectWords : public EnumerateVocab {
+  public:
+    explicit CollectWords(std::vector<std::string> &to) : to_(to) {}
+
+    void Add(WordIndex index, const StringPiece &str) {
+      if (index >= to_.size()) to_.resize(index + 1);
+      to_[index].assign(str.data(), str.size());
+    }
+
+  private:
+    std::vector<std::string> &to_;
+};
+
+template <class Output> class SendNGrams {
+  public:
+    SendNGrams(const KenLMInput &input, Output &out) : input_(input), out_(out) {}
+
+    void operator()(const WordIndex *words, unsigned char length, const ProbBackoff &weights) {
+      kenlm_line::Encode(input_, words, length, weights, line_);
+      out_.AddNGram(kenlm_line::Text(line_), line_);
+    }
+
+  private:
+    const KenLMInput &input_;
+    Output &out_;
+    std::string line_;
+};
+
+template <class Quant, class Bhiksha, class Output> void ReadTrie(const char *file, ngram::ModelType type, Output &out) {
+  typedef ngram::trie::TrieSearch<Quant, Bhiksha> Search;
+  typedef ngram::detail::GenericModel<Search, ngram::SortedVocabulary> Model;
+
+  KenLMInput input;
+  input.type = type;
+  // Recover the settings the file was built with.
+  {
+    ngram::BinaryFormat format(input.config);
+    ngram::Parameters parameters;
+    format.InitializeBinary(util::OpenReadOrThrow(file), type, Search::kVersion, parameters);
+    Search::UpdateConfigFromBinary(format, parameters.counts, ngram::SortedVocabulary::Size(parameters.counts[0], input.config), input.config);
+  }
+
+  CollectWords collect(input.words);
+  ngram::Config load_config;
+  load_config.enumerate_vocab = &collect;
+  Model model(file, load_config);
+  const WordIndex bound = model.GetVocabulary().Bound();
+  UTIL_THROW_IF(input.words.size() != bound, util::Exception, "Expected " << bound << " vocabulary words in " << file << " but got " << input.words.size());
+
+  out.BeginModel(input);
+  SendNGrams<Output> send(input, out);
+  for (unsigned char length = 1; length <= model.Order(); ++length) {
+    out.BeginLength(length);
+    model.GetSearch().ForEachNGram(length, bound, send);
+    out.EndLength(length);
+  }
+  out.Finish();
+}
+
+} // namespace detail
+
+// Calls out.BeginModel, then BeginLength, AddNGram(ngram, line), and EndLength for each order, then Finish.
+template <class Output> void ReadKenLM(const char *file, Output &out) {
+  ngram::ModelType type;
+  UTIL_THROW_IF(!ngram::RecognizeBinary(file, type), util::Exception, file << " is not a KenLM binary file.");
+  switch (type) {
+    case ngram::TRIE:
+      detail::ReadTrie<ngram::DontQuantize, ngram::trie::DontBhiksha>(file, type, out);
+      break;
+    case ngram::QUANT_TRIE:
+      detail::ReadTrie<ngram::SeparatelyQuantize, ngram::trie::DontBhiksha>(file, type, out);
+      break;
+    case ngram::ARRAY_TRIE:
+      detail::ReadTrie<ngram::DontQuantize, ngram::trie::ArrayBhiksha>(file, type, out);
+      break;
+    case ngram::QUANT_ARRAY_TRIE:
+      detail::ReadTrie<ngram::SeparatelyQuantize, ngram::trie::ArrayBhiksha>(file, type, out);
+      break;
+    case ngram::PROBING:
+    case ngram::REST_PROBING:
+      // See the comment at the top of this file.
+      UTIL_THROW(util::Exception, file << " is a probing binary, which stores hashes of n-grams instead of their words so they cannot be filtered.  Filter the ARPA file or a trie binary instead.");
+    default:
+      UTIL_THROW(util::Exception, "Unrecognized kenlm model type " << type << " in " << file);
+  }
+}
+
+} // namespace lm
+
+#endif // LM_FILTER_KENLM_IO_H
@@ -0,0 +1,141 @@
+#include "lm/filter/format.hh"
+#include "lm/filter/vocab.hh"
+#include "lm/filter/wrapper.hh"
+#include "lm/model.hh"
+#include "util/file_piece.hh"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <string.h>
+#include <unistd.h>
+
+#define BOOST_TEST_MODULE KenLMIOTest
+#include <boost/test/unit_test.hpp>
+
+namespace lm {
+namespace {
+
+const char *TestLocation() {
+  if (boost::unit_test::framework::master_test_suite().argc < 2) {
+    return "../test.arpa";
+  }
+  return boost::unit_test::framework::master_test_suite().argv[1];
+}
+
+ngram::Config SilentConfig() {
+  ngram::Config config;
+  config.arpa_complain = ngram::Config::NONE;
+  config.messages = NULL;
+  return config;
+}
+
+struct Entry {
+  std::string text;
+  float prob, backoff;
+
+  bool operator<(const Entry &other) const { return text < other.text; }
+  bool operator==(const Entry &other) const {
+    return text == other.text && prob == other.prob && backoff == other.backoff;
+  }
+  bool operator!=(const Entry &other) const { return !(*this == other); }
+};
+
+std::ostream &operator<<(std::ostream &o, const Entry &entry) {
+  return o << entry.text << ' ' << entry.prob << ' ' << entry.backoff;
+}
+
+// Output for ReadKenLM that keeps every n-gram with its weights.
+class Collect {
+  public:
+    void BeginModel(const KenLMInput &) {}
+    void BeginLength(unsigned int) {}
+    void EndLength(unsigned int) {}
+    void Finish() {}
+
+    void AddNGram(const StringPiece &ngram, const StringPiece &line) {
+      Entry entry;
+      entry.text.assign(ngram.data(), ngram.size());
+      ProbBackoff weights;
+      memcpy(&weights, kenlm_line::Record(line) + sizeof(WordIndex) * kenlm_line::Length(line), sizeof(ProbBackoff));
+      entry.prob = weights.prob;
+      entry.backoff = weights.backoff;
+      entries.push_back(entry);
+    }
+
+    std::vector<Entry> entries;
+};
+
+std::vector<Entry> ReadSorted(const char *file) {
+  Collect collect;
+  ReadKenLM(file, collect);
+  std::sort(collect.entries.begin(), collect.entries.end());
+  return collect.entries;
+}
+
+template <class Model> void BuildBinary(const char *arpa, const char *binary, bool elias_fano = false) {
+  ngram::Config config(SilentConfig());
+  config.write_mmap = binary;
+  config.pointer_bhiksha_elias_fano = elias_fano;
+  Model model(arpa, config);
+}
+
+// Filtering the ARPA file and filtering its binary keep the same n-grams.
+template <class Model> void RoundTrip(bool elias_fano = false) {
+  vocab::Single::Words words;
+  const char *kept[] = {"looking", "on", "a", "little", "more", "loin", "screening", ",", "."};
+  words.insert(kept, kept + sizeof(kept) / sizeof(const char*));
+  typedef BinaryFilter<vocab::Single> Filter;
+
+  BuildBinary<Model>(TestLocation(), "kenlm_io_test.binary", elias_fano);
+  {
+    util::FilePiece in("kenlm_io_test.binary");
+    KenLMOutput out("kenlm_io_test.filtered.binary");
+    Filter filter((vocab::Single(words)));
+    KenLMFormat::RunFilter(in, filter, out);
+  }
+  {
+    util::FilePiece in(TestLocation());
+    ARPAOutput out("kenlm_io_test.filtered.arpa");
+    Filter filter((vocab::Single(words)));
+    ARPAFormat::RunFilter(in, filter, out);
+  }
+  BuildBinary<Model>("kenlm_io_test.filtered.arpa", "kenlm_io_test.reference.binary", elias_fano);
+
+  std::vector<Entry> from_binary(ReadSorted("kenlm_io_test.filtered.binary"));
+  std::vector<Entry> from_arpa(ReadSorted("kenlm_io_test.reference.binary"));
+  BOOST_CHECK_EQUAL_COLLECTIONS(from_arpa.begin(), from_arpa.end(), from_binary.begin(), from_binary.end());
+  // Something was filtered, but not everything.
+  BOOST_CHECK_LT(from_binary.size(), ReadSorted("kenlm_io_test.binary").size());
+  Entry longest;
+  longest.text = "on a little more loin";
+  BOOST_CHECK(std::binary_search(from_binary.begin(), from_binary.end(), longest));
+
+  unlink("kenlm_io_test.binary");
+  unlink("kenlm_io_test.filtered.binary");
+  unlink("kenlm_io_test.filtered.arpa");
+  unlink("kenlm_io_test.reference.binary");
+}
+
+BOOST_AUTO_TEST_CASE(trie) {
+  RoundTrip<ngram::TrieModel>();
+}
+
+BOOST_AUTO_TEST_CASE(array_trie) {
+  RoundTrip<ngram::ArrayTrieModel>();
+}
+
+BOOST_AUTO_TEST_CASE(elias_fano_trie) {
+  RoundTrip<ngram::ArrayTrieModel>(true);
+}
+
+BOOST_AUTO_TEST_CASE(probing_rejected) {
+  BuildBinary<ngram::ProbingModel>(TestLocation(), "kenlm_io_test.probing");
+  Collect collect;
+  BOOST_CHECK_THROW(ReadKenLM("kenlm_io_test.probing", collect), util::Exception);
+  unlink("kenlm_io_test.probing");
+}
+
+} // namespace
+} // namespace lm
@@ -286,6 +286,7 @@ template <class Output> void Multiple::Evaluate(const StringPiece &line, Output
 
 template void Multiple::Evaluate<CountFormat::Multiple>(const StringPiece &line, CountFormat::Multiple &output);
 template void Multiple::Evaluate<ARPAFormat::Multiple>(const StringPiece &line, ARPAFormat::Multiple &output);
+template void Multiple::Evaluate<KenLMFormat::Multiple>(const StringPiece &line, KenLMFormat::Multiple &output);
 template void Multiple::Evaluate<MultipleOutputBuffer>(const StringPiece &line, MultipleOutputBuffer &output);
 
 } // namespace phrase
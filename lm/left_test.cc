@@ -356,9 +356,10 @@ const char *FileLocation() {
   return boost::unit_test::framework::master_test_suite().argv[1];
 }
 
-template <class M> void Everything() {
+template <class M> void Everything(bool elias_fano = false) {
   Config config;
   config.messages = NULL;
+  config.pointer_bhiksha_elias_fano = elias_fano;
   M m(FileLocation(), config);
 
   Short(m);
@@ -384,6 +385,12 @@ BOOST_AUTO_TEST_CASE(ArrayQuantTrieAll) {
 BOOST_AUTO_TEST_CASE(ArrayTrieAll) {
   Everything<ArrayTrieModel>();
 }
+BOOST_AUTO_TEST_CASE(EliasFanoTrieAll) {
+  Everything<ArrayTrieModel>(true);
+}
+BOOST_AUTO_TEST_CASE(EliasFanoQuantTrieAll) {
+  Everything<QuantArrayTrieModel>(true);
+}
 
 BOOST_AUTO_TEST_CASE(RestProbing) {
   Config config;
@@ -2,6 +2,8 @@
 
 #include "lm/blank.hh"
 #include "lm/lm_exception.hh"
+#include "lm/ngram_source.hh"
+#include "lm/parallel_arpa.hh"
 #include "lm/search_hashed.hh"
 #include "lm/search_trie.hh"
 #include "lm/read_arpa.hh"
@@ -75,7 +77,15 @@ template <class Search, class VocabularyT> GenericModel<Search, VocabularyT>::Ge
     ComplainAboutARPA(init_config, kModelType);
     InitializeFromARPA(fd.release(), file, init_config);
   }
+  InitializeStates();
+}
+
+template <class Search, class VocabularyT> GenericModel<Search, VocabularyT>::GenericModel(NGramSource &source, const Config &config) : backing_(config) {
+  InitializeFromSource(source.Name(), source, config);
+  InitializeStates();
+}
 
+template <class Search, class VocabularyT> void GenericModel<Search, VocabularyT>::InitializeStates() {
   // g++ prints warnings unless these are fully initialized.
   State begin_sentence = State();
   begin_sentence.length = 1;
@@ -93,44 +103,54 @@ template <class Search, class VocabularyT> void GenericModel<Search, VocabularyT
   // Backing file is the ARPA.
   util::FilePiece f(fd, file, config.ProgressMessages());
   try {
-    std::vector<uint64_t> counts;
-    // File counts do not include pruned trigrams that extend to quadgrams etc.   These will be fixed by search_.
-    ReadARPACounts(f, counts);
-    CheckCounts(counts);
-    if (counts.size() < 2) UTIL_THROW(FormatLoadException, "This ngram implementation assumes at least a bigram model.");
-    if (config.probing_multiplier <= 1.0) UTIL_THROW(ConfigException, "probing multiplier must be > 1.0");
-
-    std::size_t vocab_size = util::CheckOverflow(VocabularyT::Size(counts[0], config));
-    // Setup the binary file for writing the vocab lookup table.  The search_ is responsible for growing the binary file to its needs.
-    vocab_.SetupMemory(backing_.SetupJustVocab(vocab_size, counts.size()), vocab_size, counts[0], config);
-
-    if (config.write_mmap && config.include_vocab) {
-      WriteWordsWrapper wrap(config.enumerate_vocab);
-      vocab_.ConfigureEnumerate(&wrap, counts[0]);
-      search_.InitializeFromARPA(file, f, counts, config, vocab_, backing_);
-      void *vocab_rebase, *search_rebase;
-      backing_.WriteVocabWords(wrap.Buffer(), vocab_rebase, search_rebase);
-      // Due to writing at the end of file, mmap may have relocated data.  So remap.
-      vocab_.Relocate(vocab_rebase);
-      search_.SetupMemory(reinterpret_cast<uint8_t*>(search_rebase), counts, config);
+    if (config.arpa_threads > 1) {
+      ParallelARPA parallel(f, config.arpa_threads);
+      NGramSource &source = parallel;
+      InitializeFromSource(file, source, config);
     } else {
-      vocab_.ConfigureEnumerate(config.enumerate_vocab, counts[0]);
-      search_.InitializeFromARPA(file, f, counts, config, vocab_, backing_);
+      InitializeFromSource(file, f, config);
     }
-
-    if (!vocab_.SawUnk()) {
-      assert(config.unknown_missing != THROW_UP);
-      // Default probabilities for unknown.
-      search_.UnknownUnigram().backoff = 0.0;
-      search_.UnknownUnigram().prob = config.unknown_missing_logprob;
-    }
-    backing_.FinishFile(config, kModelType, kVersion, counts);
   } catch (util::Exception &e) {
     e << " Byte: " << f.Offset();
     throw;
   }
 }
 
+template <class Search, class VocabularyT> template <class Source> void GenericModel<Search, VocabularyT>::InitializeFromSource(const char *file, Source &f, const Config &config) {
+  std::vector<uint64_t> counts;
+  // File counts do not include pruned trigrams that extend to quadgrams etc.   These will be fixed by search_.
+  ReadARPACounts(f, counts);
+  CheckCounts(counts);
+  if (counts.size() < 2) UTIL_THROW(FormatLoadException, "This ngram implementation assumes at least a bigram model.");
+  if (config.probing_multiplier <= 1.0) UTIL_THROW(ConfigException, "probing multiplier must be > 1.0");
+
+  std::size_t vocab_size = util::CheckOverflow(VocabularyT::Size(counts[0], config));
+  // Setup the binary file for writing the vocab lookup table.  The search_ is responsible for growing the binary file to its needs.
+  vocab_.SetupMemory(backing_.SetupJustVocab(vocab_size, counts.size()), vocab_size, counts[0], config);
+
+  if (config.write_mmap && config.include_vocab) {
+    WriteWordsWrapper wrap(config.enumerate_vocab);
+    vocab_.ConfigureEnumerate(&wrap, counts[0]);
+    search_.InitializeFromARPA(file, f, counts, config, vocab_, backing_);
+    void *vocab_rebase, *search_rebase;
+    backing_.WriteVocabWords(wrap.Buffer(), vocab_rebase, search_rebase);
+    // Due to writing at the end of file, mmap may have relocated data.  So remap.
+    vocab_.Relocate(vocab_rebase);
+    search_.SetupMemory(reinterpret_cast<uint8_t*>(search_rebase), counts, config);
+  } else {
+    vocab_.ConfigureEnumerate(config.enumerate_vocab, counts[0]);
+    search_.InitializeFromARPA(file, f, counts, config, vocab_, backing_);
+  }
+
+  if (!vocab_.SawUnk()) {
+    assert(config.unknown_missing != THROW_UP);
+    // Default probabilities for unknown.
+    search_.UnknownUnigram().backoff = 0.0;
+    search_.UnknownUnigram().prob = config.unknown_missing_logprob;
+  }
+  backing_.FinishFile(config, kModelType, kVersion, counts);
+}
+
 template <class Search, class VocabularyT> FullScoreReturn GenericModel<Search, VocabularyT>::FullScore(const State &in_state, const WordIndex new_word, State &out_state) const {
   FullScoreReturn ret = ScoreExceptBackoff(in_state.words, in_state.words + in_state.length, new_word, out_state);
   for (const float *i = in_state.backoff + ret.ngram_length - 1; i < in_state.backoff + in_state.length; ++i) {
@@ -295,6 +315,58 @@ template <class Search, class VocabularyT> void GenericModel<Search, VocabularyT
   }
 }
 
+template <class Search, class VocabularyT> bool GenericModel<Search, VocabularyT>::ContinueFullScore(const State &in_state, const WordIndex new_word, State &out_state, PendingScore &pending, FullScoreReturn &ret) const {
+  // The same steps as ScoreExceptBackoff and ResumeScore, one lookup at a time.
+  bool last;
+  if (pending.length == 1) {
+    assert(new_word < vocab_.Bound());
+    ret.ngram_length = 1;
+    typename Search::UnigramPointer uni(search_.LookupUnigram(new_word, pending.node, ret.independent_left, ret.extend_left));
+    out_state.backoff[0] = uni.Backoff();
+    ret.prob = uni.Prob();
+    ret.rest = uni.Rest();
+    out_state.length = HasExtension(out_state.backoff[0]) ? 1 : 0;
+    out_state.words[0] = new_word;
+    last = false;
+  } else if (pending.length < P::Order()) {
+    typename Search::MiddlePointer pointer(search_.LookupMiddle(pending.length - 2, in_state.words[pending.length - 2], pending.node, ret.independent_left, ret.extend_left));
+    last = !pointer.Found();
+    if (!last) {
+      out_state.backoff[pending.length - 1] = pointer.Backoff();
+      ret.prob = pointer.Prob();
+      ret.rest = pointer.Rest();
+      ret.ngram_length = pending.length;
+      if (HasExtension(out_state.backoff[pending.length - 1])) {
+        out_state.length = pending.length;
+      }
+    }
+  } else {
+    typename Search::LongestPointer longest(search_.LookupLongest(in_state.words[pending.length - 2], pending.node));
+    if (longest.Found()) {
+      ret.prob = longest.Prob();
+      ret.rest = ret.prob;
+      ret.ngram_length = P::Order();
+    }
+    last = true;
+  }
+  // Continue unless out of context or the n-gram does not extend left.
+  if (!last && pending.length <= in_state.length && !ret.independent_left) {
+    ++pending.length;
+    if (pending.length == P::Order()) {
+      ret.independent_left = true;
+      search_.PrefetchLongest(in_state.words[pending.length - 2], pending.node);
+    } else {
+      search_.PrefetchMiddle(pending.length - 2, in_state.words[pending.length - 2], pending.node);
+    }
+    return false;
+  }
+  CopyRemainingHistory(in_state.words, out_state);
+  for (const float *i = in_state.backoff + ret.ngram_length - 1; i < in_state.backoff + in_state.length; ++i) {
+    ret.prob += *i;
+  }
+  return true;
+}
+
 template <class Search, class VocabularyT> float GenericModel<Search, VocabularyT>::InternalUnRest(const uint64_t *pointers_begin, const uint64_t *pointers_end, unsigned char first_length) const {
   float ret;
   typename Search::Node node;
@@ -23,6 +23,7 @@
 namespace util { class FilePiece; }
 
 namespace lm {
+class NGramSource;
 namespace ngram {
 namespace detail {
 
@@ -51,6 +52,11 @@ template <class Search, class VocabularyT> class GenericModel : public base::Mod
      */
     explicit GenericModel(const char *file, const Config &config = Config());
 
+    /* Build the model from n-grams that have already been parsed, such as the
+     * output of lmplz.  Set config.write_mmap to save a binary file.
+     */
+    explicit GenericModel(NGramSource &source, const Config &config = Config());
+
     /* Score p(new_word | in_state) and incorporate new_word into out_state.
      * Note that in_state and out_state must be different references:
      * &in_state != &out_state.  
@@ -66,6 +72,27 @@ template <class Search, class VocabularyT> class GenericModel : public base::Mod
      */
     FullScoreReturn FullScoreForgotState(const WordIndex *context_rbegin, const WordIndex *context_rend, const WordIndex new_word, State &out_state) const;
 
+    /* FullScore split into one lookup per call so that independent queries
+     * can be interleaved and their memory accesses overlap.  See lm/batch.hh.
+     * BeginFullScore prefetches the first lookup, or all of them when the
+     * search can.  Each ContinueFullScore does one lookup and prefetches the
+     * next one.  It returns true when
+     * ret and out_state are what FullScore would have produced.  Pass the same
+     * arguments every time.
+     */
+    struct PendingScore {
+      typename Search::Node node;
+      // Length of the n-gram to look up next.
+      unsigned char length;
+    };
+
+    void BeginFullScore(const State &in_state, const WordIndex new_word, PendingScore &pending) const {
+      search_.PrefetchQuery(new_word, in_state.words, in_state.words + in_state.length);
+      pending.length = 1;
+    }
+
+    bool ContinueFullScore(const State &in_state, const WordIndex new_word, State &out_state, PendingScore &pending, FullScoreReturn &ret) const;
+
     /* Get the state for a context.  Don't use this if you can avoid it.  Use
      * BeginSentenceState or NullContextState and extend from those.  If
      * you're only going to use this state to call FullScore once, use
@@ -103,6 +130,9 @@ template <class Search, class VocabularyT> class GenericModel : public base::Mod
       return Search::kDifferentRest ? InternalUnRest(pointers_begin, pointers_end, first_length) : 0.0;
     }
 
+    // Direct access to the n-grams, e.g. to enumerate a trie.
+    const Search &GetSearch() const { return search_; }
+
   private:
     FullScoreReturn ScoreExceptBackoff(const WordIndex *const context_rbegin, const WordIndex *const context_rend, const WordIndex new_word, State &out_state) const;
 
@@ -114,6 +144,11 @@ template <class Search, class VocabularyT> class GenericModel : public base::Mod
 
     void InitializeFromARPA(int fd, const char *file, const Config &config);
 
+    template <class Source> void InitializeFromSource(const char *file, Source &f, const Config &config);
+
+    // Sentence and null context states after the vocabulary and search are ready.
+    void InitializeStates();
+
     float InternalUnRest(const uint64_t *pointers_begin, const uint64_t *pointers_end, unsigned char first_length) const;
 
     BinaryFormat backing_;
@@ -132,6 +167,7 @@ template <class Search, class VocabularyT> class GenericModel : public base::Mod
 class name : public from {\
   public:\
     name(const char *file, const Config &config = Config()) : from(file, config) {}\
+    name(NGramSource &source, const Config &config = Config()) : from(source, config) {}\
 };
 
 LM_NAME_MODEL(ProbingModel, detail::GenericModel<detail::HashedSearch<BackoffValue> LM_COMMA() ProbingVocabulary>);
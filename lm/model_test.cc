@@ -321,8 +321,10 @@ class ExpectEnumerateVocab : public EnumerateVocab {
     std::vector<std::string> seen;
 };
 
-template <class ModelT> void LoadingTest() {
+template <class ModelT> void LoadingTest(std::size_t arpa_threads = 1, bool elias_fano = false) {
   Config config;
+  config.arpa_threads = arpa_threads;
+  config.pointer_bhiksha_elias_fano = elias_fano;
   config.arpa_complain = Config::NONE;
   config.messages = NULL;
   config.probing_multiplier = 2.0;
@@ -359,12 +361,25 @@ BOOST_AUTO_TEST_CASE(bhiksha_trie) {
 BOOST_AUTO_TEST_CASE(quant_bhiksha_trie) {
   LoadingTest<QuantArrayTrieModel>();
 }
+BOOST_AUTO_TEST_CASE(elias_fano_trie) {
+  LoadingTest<ArrayTrieModel>(1, true);
+}
+BOOST_AUTO_TEST_CASE(quant_elias_fano_trie) {
+  LoadingTest<QuantArrayTrieModel>(1, true);
+}
+BOOST_AUTO_TEST_CASE(probing_threads) {
+  LoadingTest<Model>(3);
+}
+BOOST_AUTO_TEST_CASE(trie_threads) {
+  LoadingTest<TrieModel>(3);
+}
 
-template <class ModelT> void BinaryTest(Config::WriteMethod write_method) {
+template <class ModelT> void BinaryTest(Config::WriteMethod write_method, bool elias_fano) {
   Config config;
   config.write_mmap = "test.binary";
   config.messages = NULL;
   config.write_method = write_method;
+  config.pointer_bhiksha_elias_fano = elias_fano;
   ExpectEnumerateVocab enumerate;
   config.enumerate_vocab = &enumerate;
 
@@ -382,9 +397,12 @@ template <class ModelT> void BinaryTest(Config::WriteMethod write_method) {
   BOOST_CHECK_EQUAL(ModelT::kModelType, type);
 
   {
+    // The file says how its pointers are coded.
+    config.pointer_bhiksha_elias_fano = !elias_fano;
     ModelT binary("test.binary", config);
     enumerate.Check(binary.GetVocabulary());
     Everything(binary);
+    config.pointer_bhiksha_elias_fano = elias_fano;
   }
   unlink("test.binary");
 
@@ -407,9 +425,9 @@ template <class ModelT> void BinaryTest(Config::WriteMethod write_method) {
   unlink("test_nounk.binary");
 }
 
-template <class ModelT> void BinaryTest() {
-  BinaryTest<ModelT>(Config::WRITE_MMAP);
-  BinaryTest<ModelT>(Config::WRITE_AFTER);
+template <class ModelT> void BinaryTest(bool elias_fano = false) {
+  BinaryTest<ModelT>(Config::WRITE_MMAP, elias_fano);
+  BinaryTest<ModelT>(Config::WRITE_AFTER, elias_fano);
 }
 
 BOOST_AUTO_TEST_CASE(write_and_read_probing) {
@@ -430,6 +448,12 @@ BOOST_AUTO_TEST_CASE(write_and_read_array_trie) {
 BOOST_AUTO_TEST_CASE(write_and_read_quant_array_trie) {
   BinaryTest<QuantArrayTrieModel>();
 }
+BOOST_AUTO_TEST_CASE(write_and_read_elias_fano_trie) {
+  BinaryTest<ArrayTrieModel>(true);
+}
+BOOST_AUTO_TEST_CASE(write_and_read_quant_elias_fano_trie) {
+  BinaryTest<QuantArrayTrieModel>(true);
+}
 
 BOOST_AUTO_TEST_CASE(rest_max) {
   Config config;
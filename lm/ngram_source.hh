@@ -0,0 +1,126 @@
+#ifndef LM_NGRAM_SOURCE_H
+#define LM_NGRAM_SOURCE_H
+
+/* Build models from n-grams that are already split into vocabulary ids and
+ * weights, such as the sorted streams inside lmplz.  This provides the same
+ * functions as read_arpa.hh so the data structures can be templated on where
+ * the n-grams come from without printing and re-parsing ARPA text.
+ */
+
+#include "lm/blank.hh"
+#include "lm/lm_exception.hh"
+#include "lm/read_arpa.hh"
+#include "lm/weights.hh"
+#include "lm/word_index.hh"
+#include "util/string_piece.hh"
+
+#include <cstddef>
+#include <vector>
+
+#include <stdint.h>
+
+namespace lm {
+
+/* N-grams must be presented in ARPA order: all unigrams, then all bigrams,
+ * etc.  Within an order, any order is fine.  Each record is the n-gram's
+ * vocabulary ids in natural order followed by ProbBackoff with log10 values.
+ * The backoff of the highest order is ignored.  Unigram records must cover
+ * source ids [0, counts[0]).
+ */
+class NGramSource {
+  public:
+    virtual ~NGramSource() {}
+
+    // Counts, as would appear in the ARPA header.
+    virtual void ReadCounts(std::vector<uint64_t> &counts) = 0;
+
+    // Start reading n-grams of the given length.  Called with 1, 2, ...
+    virtual void BeginOrder(unsigned int length) = 0;
+
+    // Next record of the current order.  Valid until the next call.
+    virtual const WordIndex *Next() = 0;
+
+    // Done with all orders.
+    virtual void End() = 0;
+
+    // Text of a word using the source's ids.
+    virtual StringPiece Word(WordIndex source_id) const = 0;
+
+    // Used for temporary file names if nothing better is configured.
+    virtual const char *Name() const = 0;
+
+    // Map from source ids to the model's ids.  Filled in by Read1Grams.
+    std::vector<WordIndex> &Mapping() { return mapping_; }
+    const std::vector<WordIndex> &Mapping() const { return mapping_; }
+
+  private:
+    std::vector<WordIndex> mapping_;
+};
+
+inline void ReadARPACounts(NGramSource &in, std::vector<uint64_t> &number) {
+  in.ReadCounts(number);
+}
+
+inline void ReadNGramHeader(NGramSource &in, unsigned int length) {
+  in.BeginOrder(length);
+}
+
+inline void ReadEnd(NGramSource &in) {
+  in.End();
+}
+
+namespace detail {
+// Same treatment of zero as ReadBackoff: the structures decide later whether it extends left.
+inline void CopyBackoff(float from, float &to) {
+  to = (from == ngram::kExtensionBackoff) ? ngram::kNoExtensionBackoff : from;
+}
+inline void CopyBackoff(float /*from*/, Prob &/*weights*/) {}
+inline void CopyBackoff(float from, ProbBackoff &weights) {
+  CopyBackoff(from, weights.backoff);
+}
+inline void CopyBackoff(float from, RestWeights &weights) {
+  CopyBackoff(from, weights.backoff);
+}
+
+inline float CheckProb(float prob, PositiveProbWarn &warn) {
+  if (prob > 0.0) {
+    warn.Warn(prob);
+    return 0.0;
+  }
+  return prob;
+}
+} // namespace detail
+
+template <class Voc, class Weights> void Read1Grams(NGramSource &f, std::size_t count, Voc &vocab, Weights *unigrams, PositiveProbWarn &warn) {
+  f.BeginOrder(1);
+  for (std::size_t i = 0; i < count; ++i) {
+    const WordIndex *record = f.Next();
+    const ProbBackoff &from = *reinterpret_cast<const ProbBackoff*>(record + 1);
+    Weights &w = unigrams[vocab.Insert(f.Word(*record))];
+    w.prob = detail::CheckProb(from.prob, warn);
+    detail::CopyBackoff(from.backoff, w);
+  }
+  vocab.FinishedLoading(unigrams);
+  // Ids are only final after FinishedLoading because it may sort the vocabulary.
+  std::vector<WordIndex> &mapping = f.Mapping();
+  mapping.resize(count);
+  for (WordIndex i = 0; i < count; ++i) {
+    mapping[i] = vocab.Index(f.Word(i));
+  }
+}
+
+template <class Voc, class Weights, class Iterator> void ReadNGram(NGramSource &f, const unsigned char n, const Voc &/*vocab*/, Iterator indices_out, Weights &weights, PositiveProbWarn &warn) {
+  const WordIndex *record = f.Next();
+  const std::vector<WordIndex> &mapping = f.Mapping();
+  for (const WordIndex *i = record; i != record + n; ++i, ++indices_out) {
+    UTIL_THROW_IF(*i >= mapping.size(), FormatLoadException, "Word id " << *i << " in a " << static_cast<unsigned int>(n) << "-gram was not in the unigrams");
+    *indices_out = mapping[*i];
+  }
+  const ProbBackoff &from = *reinterpret_cast<const ProbBackoff*>(record + n);
+  weights.prob = detail::CheckProb(from.prob, warn);
+  detail::CopyBackoff(from.backoff, weights);
+}
+
+} // namespace lm
+
+#endif // LM_NGRAM_SOURCE_H
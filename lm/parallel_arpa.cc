@@ -0,0 +1,441 @@
+#include "lm/parallel_arpa.hh"
+
+#include "lm/blank.hh"
+#include "lm/lm_exception.hh"
+#include "lm/read_arpa.hh"
+#include "lm/vocab.hh"
+#include "lm/weights.hh"
+#include "util/double-conversion/double-conversion.h"
+#include "util/exception.hh"
+#include "util/file_piece.hh"
+
+#ifdef WITH_THREADS
+#include "util/pcqueue.hh"
+#include "util/thread_pool.hh"
+
+#include <boost/bind.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#endif
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <string>
+
+namespace lm {
+
+// Lines of one order and, once parsed, their records.
+struct ParallelARPA::Block {
+  std::string text;
+  std::size_t lines;
+  unsigned int length;
+  bool highest;
+  // Position within the order so the consumer can restore file order.
+  std::size_t sequence;
+  std::vector<WordIndex> records;
+  // Parsing threads report errors here instead of throwing.
+  std::string error;
+};
+
+namespace {
+
+// Aim for this many bytes of text per block.
+const std::size_t kBlockBytes = 1 << 20;
+
+// Same settings as FilePiece.
+const double_conversion::StringToDoubleConverter kConverter(
+    double_conversion::StringToDoubleConverter::ALLOW_TRAILING_JUNK | double_conversion::StringToDoubleConverter::ALLOW_LEADING_SPACES,
+    std::numeric_limits<double>::quiet_NaN(),
+    std::numeric_limits<double>::quiet_NaN(),
+    "inf",
+    "NaN");
+
+float ParseFloat(const StringPiece &token) {
+  int count;
+  float ret = kConverter.StringToFloat(token.data(), token.size(), &count);
+  UTIL_THROW_IF(static_cast<std::size_t>(count) != token.size(), FormatLoadException, "Bad number " << token);
+  return ret;
+}
+
+// Advance over kARPASpaces to the next token on the line.
+bool NextToken(const char *&it, const char *end, StringPiece &out) {
+  for (; it != end && kARPASpaces[static_cast<unsigned char>(*it)]; ++it) {}
+  if (it == end) return false;
+  const char *start = it;
+  for (; it != end && !kARPASpaces[static_cast<unsigned char>(*it)]; ++it) {}
+  out = StringPiece(start, it - start);
+  return true;
+}
+
+// Same checks as ReadNGram and ReadBackoff.  The weights go after the words
+// as NGramSource expects.
+void ParseLine(const ParallelARPA::Lookup &lookup, unsigned int length, bool highest, const StringPiece &line, WordIndex *out) {
+  const char *it = line.data(), *end = line.data() + line.size();
+  StringPiece token;
+  ProbBackoff weights;
+  UTIL_THROW_IF(!NextToken(it, end, token), FormatLoadException, "Blank line");
+  weights.prob = ParseFloat(token);
+  for (unsigned int i = 0; i < length; ++i) {
+    UTIL_THROW_IF(!NextToken(it, end, token), FormatLoadException, "Expected " << length << " words");
+    ParallelARPA::Lookup::const_iterator found = lookup.find(ngram::detail::HashForVocab(token));
+    UTIL_THROW_IF(found == lookup.end(), FormatLoadException, "Word " << token << " was not seen in the unigrams (which are supposed to list the entire vocabulary) but appears");
+    out[i] = found->second;
+  }
+  weights.backoff = ngram::kNoExtensionBackoff;
+  if (NextToken(it, end, token)) {
+    float backoff = ParseFloat(token);
+    if (highest) {
+      UTIL_THROW_IF(backoff != 0.0, FormatLoadException, "Non-zero backoff " << backoff << " provided for an n-gram that should have no backoff");
+    } else {
+      int float_class = std::fpclassify(backoff);
+      UTIL_THROW_IF(float_class == FP_NAN || float_class == FP_INFINITE, FormatLoadException, "Bad backoff " << backoff);
+      weights.backoff = backoff;
+    }
+    UTIL_THROW_IF(NextToken(it, end, token), FormatLoadException, "Expected newline after backoff");
+  }
+  std::memcpy(out + length, &weights, sizeof(ProbBackoff));
+}
+
+void ParseBlock(const ParallelARPA::Lookup &lookup, ParallelARPA::Block &block) {
+  const std::size_t record_words = block.length + sizeof(ProbBackoff) / sizeof(WordIndex);
+  block.records.resize(block.lines * record_words);
+  WordIndex *out = &block.records[0];
+  const char *it = block.text.data(), *end = block.text.data() + block.text.size();
+  while (it != end) {
+    const char *newline = static_cast<const char*>(std::memchr(it, '\n', end - it));
+    StringPiece line(it, newline - it);
+    try {
+      ParseLine(lookup, block.length, block.highest, line, out);
+    } catch (util::Exception &e) {
+      e << " in the " << block.length << "-gram \"" << line << "\"";
+      throw;
+    }
+    out += record_words;
+    it = newline + 1;
+  }
+}
+
+// Copy lines into the block, reducing remaining.
+void FillBlock(util::FilePiece &f, uint64_t &remaining, ParallelARPA::Block &block) {
+  block.text.clear();
+  block.lines = 0;
+  while (remaining && block.text.size() < kBlockBytes) {
+    StringPiece line(f.ReadLine());
+    block.text.append(line.data(), line.size());
+    block.text.push_back('\n');
+    ++block.lines;
+    --remaining;
+  }
+}
+
+} // namespace
+
+#ifdef WITH_THREADS
+
+namespace {
+
+class Parser {
+  public:
+    typedef ParallelARPA::Block *Request;
+
+    Parser(const ParallelARPA::Lookup &lookup, util::PCQueue<ParallelARPA::Block*> &out) : lookup_(&lookup), out_(&out) {}
+
+    void operator()(ParallelARPA::Block *block) {
+      try {
+        ParseBlock(*lookup_, *block);
+      } catch (const util::Exception &e) {
+        block->error = e.what();
+      }
+      out_->Produce(block);
+    }
+
+  private:
+    const ParallelARPA::Lookup *lookup_;
+    util::PCQueue<ParallelARPA::Block*> *out_;
+};
+
+} // namespace
+
+/* Blocks cycle from free_ to the reader, the parsing pool, parsed_, and the
+ * consumer, which returns them to free_.  Blocks come out of parsed_ in any
+ * order.  The consumer puts them back in file order because the probing
+ * tables depend on insertion order and binary files should not depend on
+ * thread timing.  The reader ends each order by sending end_ through parsed_
+ * after sent_ is final.
+ */
+class ParallelARPA::Threads {
+  public:
+    Threads(const Lookup &lookup, std::size_t threads)
+      : free_(threads * 2 + 2),
+        parsed_(threads * 2 + 3),
+        pool_(threads * 2 + 2, threads, Parser(lookup, parsed_), NULL),
+        reading_(false) {
+      for (std::size_t i = 0; i < threads * 2 + 2; ++i) {
+        blocks_.push_back(new Block());
+        free_.Produce(&blocks_.back());
+      }
+    }
+
+    ~Threads() {
+      Stop();
+    }
+
+    void Start(util::FilePiece &f, unsigned int length, bool highest, uint64_t count) {
+      sent_ = 0;
+      received_ = 0;
+      next_ = 0;
+      end_seen_ = false;
+      stop_ = false;
+      end_.error.clear();
+      reader_.reset(new boost::thread(boost::bind(&Threads::Read, this, &f, length, highest, count)));
+      reading_ = true;
+    }
+
+    // Next parsed block in file order or NULL if the order is done.
+    Block *Get() {
+      while (true) {
+        for (std::vector<Block*>::iterator i = waiting_.begin(); i != waiting_.end(); ++i) {
+          if ((*i)->sequence == next_) {
+            Block *ret = *i;
+            waiting_.erase(i);
+            ++next_;
+            return ret;
+          }
+        }
+        if (end_seen_ && received_ == sent_) return NULL;
+        Block *got = parsed_.Consume();
+        if (got == &end_) {
+          end_seen_ = true;
+          UTIL_THROW_IF(!end_.error.empty(), FormatLoadException, end_.error);
+        } else {
+          ++received_;
+          waiting_.push_back(got);
+        }
+      }
+    }
+
+    void Recycle(Block *block) {
+      free_.Produce(block);
+    }
+
+    // Wait for the reader.  After an error, this stops it early.
+    void Stop() {
+      if (!reading_) return;
+      {
+        boost::mutex::scoped_lock lock(stop_mutex_);
+        stop_ = true;
+      }
+      while (!end_seen_ || received_ != sent_) {
+        Block *got = parsed_.Consume();
+        if (got == &end_) {
+          end_seen_ = true;
+        } else {
+          ++received_;
+          free_.Produce(got);
+        }
+      }
+      for (std::vector<Block*>::iterator i = waiting_.begin(); i != waiting_.end(); ++i) {
+        free_.Produce(*i);
+      }
+      waiting_.clear();
+      reader_->join();
+      reading_ = false;
+    }
+
+  private:
+    bool Stopping() {
+      boost::mutex::scoped_lock lock(stop_mutex_);
+      return stop_;
+    }
+
+    void Read(util::FilePiece *f, unsigned int length, bool highest, uint64_t count) {
+      while (count && !Stopping()) {
+        Block *block = free_.Consume();
+        try {
+          FillBlock(*f, count, *block);
+        } catch (const util::Exception &e) {
+          end_.error = e.what();
+          free_.Produce(block);
+          break;
+        }
+        block->length = length;
+        block->highest = highest;
+        block->error.clear();
+        block->sequence = sent_++;
+        pool_.Produce(block);
+      }
+      parsed_.Produce(&end_);
+    }
+
+    boost::ptr_vector<Block> blocks_;
+
+    util::PCQueue<Block*> free_, parsed_;
+
+    util::ThreadPool<Parser> pool_;
+
+    boost::scoped_ptr<boost::thread> reader_;
+    bool reading_;
+
+    // Written by the reader before it sends end_.
+    std::size_t sent_;
+    Block end_;
+
+    // Only used by the consumer.
+    std::size_t received_, next_;
+    // Parsed out of order.
+    std::vector<Block*> waiting_;
+    bool end_seen_;
+
+    boost::mutex stop_mutex_;
+    bool stop_;
+};
+
+#else // WITH_THREADS
+
+class ParallelARPA::Threads {};
+
+#endif // WITH_THREADS
+
+ParallelARPA::ParallelARPA(util::FilePiece &f, std::size_t threads)
+  : f_(f), length_(0), current_(NULL), position_(0), remaining_(0) {
+#ifdef WITH_THREADS
+  if (threads > 1) {
+    threads_.reset(new Threads(lookup_, threads));
+    return;
+  }
+#endif
+  inline_block_.reset(new Block());
+}
+
+ParallelARPA::~ParallelARPA() {}
+
+void ParallelARPA::ReadCounts(std::vector<uint64_t> &counts) {
+  ReadARPACounts(f_, counts);
+  counts_ = counts;
+}
+
+void ParallelARPA::BeginOrder(unsigned int length) {
+  FinishOrder();
+  UTIL_THROW_IF(length > counts_.size(), FormatLoadException, "Asked for " << length << "-grams but the ARPA file has order " << counts_.size());
+  ReadNGramHeader(f_, length);
+  length_ = length;
+  position_ = 0;
+  if (length == 1) {
+    ReadUnigrams();
+    return;
+  }
+  if (length == 2) AddUnknown();
+  const bool highest = (length == counts_.size());
+#ifdef WITH_THREADS
+  if (threads_.get()) {
+    threads_->Start(f_, length, highest, counts_[length - 1]);
+    return;
+  }
+#endif
+  remaining_ = counts_[length - 1];
+  inline_block_->length = length;
+  inline_block_->highest = highest;
+}
+
+const WordIndex *ParallelARPA::Next() {
+  if (length_ == 1) {
+    UTIL_THROW_IF(position_ == counts_[0], FormatLoadException, "Asked for more unigrams than the file has");
+    return &unigrams_[3 * position_++];
+  }
+  while (!current_ || position_ == current_->lines) {
+    NextBlock();
+  }
+  return &current_->records[(length_ + 2) * position_++];
+}
+
+void ParallelARPA::End() {
+  FinishOrder();
+  ReadEnd(f_);
+}
+
+const char *ParallelARPA::Name() const {
+  return f_.FileName().c_str();
+}
+
+void ParallelARPA::ReadUnigrams() {
+  const uint64_t count = counts_[0];
+  unigrams_.resize(3 * count);
+  words_.resize(count);
+  lookup_.rehash(count);
+  for (WordIndex i = 0; i < count; ++i) {
+    try {
+      ProbBackoff weights;
+      weights.prob = f_.ReadFloat();
+      UTIL_THROW_IF(f_.get() != '\t', FormatLoadException, "Expected tab after probability");
+      StringPiece word(f_.ReadDelimited(kARPASpaces));
+      char *copy = static_cast<char*>(word_pool_.Allocate(word.size()));
+      std::memcpy(copy, word.data(), word.size());
+      words_[i] = StringPiece(copy, word.size());
+      lookup_.insert(Lookup::value_type(ngram::detail::HashForVocab(word), i));
+      ReadBackoff(f_, weights.backoff);
+      unigrams_[3 * i] = i;
+      std::memcpy(&unigrams_[3 * i + 1], &weights, sizeof(ProbBackoff));
+    } catch(util::Exception &e) {
+      e << " in the 1-gram at byte " << f_.Offset();
+      throw;
+    }
+  }
+}
+
+// The ARPA reader maps <unk> in higher orders to the model's <unk> even if it
+// is not a unigram.  Give it a source id that maps there.
+void ParallelARPA::AddUnknown() {
+  const uint64_t kUnknownHash = ngram::detail::HashForVocab("<unk>", 5);
+  const uint64_t kUnknownCapHash = ngram::detail::HashForVocab("<UNK>", 5);
+  Lookup::const_iterator found = lookup_.find(kUnknownHash);
+  if (found == lookup_.end()) found = lookup_.find(kUnknownCapHash);
+  WordIndex id;
+  if (found == lookup_.end()) {
+    id = words_.size();
+    words_.push_back(StringPiece("<unk>", 5));
+    Mapping().push_back(0);
+  } else {
+    id = found->second;
+  }
+  lookup_.insert(Lookup::value_type(kUnknownHash, id));
+  lookup_.insert(Lookup::value_type(kUnknownCapHash, id));
+}
+
+void ParallelARPA::NextBlock() {
+#ifdef WITH_THREADS
+  if (threads_.get()) {
+    if (current_) threads_->Recycle(current_);
+    current_ = NULL;
+    current_ = threads_->Get();
+    UTIL_THROW_IF(!current_, FormatLoadException, "Asked for more " << length_ << "-grams than the file has");
+    position_ = 0;
+    if (!current_->error.empty()) {
+      std::string error(current_->error);
+      threads_->Recycle(current_);
+      current_ = NULL;
+      UTIL_THROW(FormatLoadException, error);
+    }
+    return;
+  }
+#endif
+  UTIL_THROW_IF(!remaining_, FormatLoadException, "Asked for more " << length_ << "-grams than the file has");
+  current_ = inline_block_.get();
+  position_ = 0;
+  current_->lines = 0;
+  FillBlock(f_, remaining_, *current_);
+  ParseBlock(lookup_, *current_);
+}
+
+void ParallelARPA::FinishOrder() {
+#ifdef WITH_THREADS
+  if (threads_.get()) {
+    if (current_) threads_->Recycle(current_);
+    threads_->Stop();
+  }
+#endif
+  current_ = NULL;
+}
+
+} // namespace lm
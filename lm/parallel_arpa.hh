@@ -0,0 +1,94 @@
+#ifndef LM_PARALLEL_ARPA_H
+#define LM_PARALLEL_ARPA_H
+
+/* Parse ARPA files with several threads.  One thread copies whole lines of an
+ * order into blocks, a pool of threads converts the blocks into records, and
+ * the calling thread consumes records through the NGramSource interface.
+ * Inserting into the data structures stays on the calling thread because
+ * inserting an n-gram also updates its lower-order entries.
+ */
+
+#include "lm/ngram_source.hh"
+#include "lm/word_index.hh"
+#include "util/pool.hh"
+#include "util/string_piece.hh"
+
+#include <boost/scoped_ptr.hpp>
+#include <boost/unordered_map.hpp>
+
+#include <cstddef>
+#include <vector>
+
+#include <stdint.h>
+
+namespace util { class FilePiece; }
+
+namespace lm {
+
+class ParallelARPA : public NGramSource {
+  public:
+    // Hash of a word, as used by the vocabularies, to its source id.
+    typedef boost::unordered_map<uint64_t, WordIndex> Lookup;
+
+    struct Block;
+
+    // threads is the number of parsing threads.  Without thread support, the
+    // calling thread parses.  f must outlive this.
+    ParallelARPA(util::FilePiece &f, std::size_t threads);
+
+    ~ParallelARPA();
+
+    void ReadCounts(std::vector<uint64_t> &counts);
+
+    void BeginOrder(unsigned int length);
+
+    const WordIndex *Next();
+
+    void End();
+
+    StringPiece Word(WordIndex source_id) const { return words_[source_id]; }
+
+    const char *Name() const;
+
+  private:
+    void ReadUnigrams();
+
+    void AddUnknown();
+
+    void NextBlock();
+
+    void FinishOrder();
+
+    util::FilePiece &f_;
+
+    std::vector<uint64_t> counts_;
+
+    unsigned int length_;
+
+    // Unigram records.
+    std::vector<WordIndex> unigrams_;
+
+    // Unigram strings, owned by word_pool_.
+    util::Pool word_pool_;
+    std::vector<StringPiece> words_;
+
+    Lookup lookup_;
+
+    // Current block of higher-order records.
+    Block *current_;
+    std::size_t position_;
+
+    // Lines of the current order not yet handed to a block.
+    uint64_t remaining_;
+
+    // Used when parsing on the calling thread.
+    boost::scoped_ptr<Block> inline_block_;
+
+    class Threads;
+    // Last so the threads stop before anything they use is destroyed.
+    boost::scoped_ptr<Threads> threads_;
+};
+
+} // namespace lm
+
+#endif // LM_PARALLEL_ARPA_H
@@ -13,7 +13,9 @@ void Usage(const char *name) {
     "Usage: " << name << " [-n] [-s] lm_file\n"
     "-n: Do not wrap the input in <s> and </s>.\n"
     "-s: Sentence totals only.\n"
-    "-l lazy|populate|read|parallel: Load lazily, with populate, or malloc+read\n"
+    "-l lazy|populate|read|parallel|huge|interleave: Load lazily, with populate,\n"
+    "   or malloc+read.  huge reads into huge pages and interleave also spreads\n"
+    "   them across NUMA nodes.\n"
     "The default loading method is populate on Linux and read on others.\n";
   exit(1);
 }
@@ -44,6 +46,10 @@ int main(int argc, char *argv[]) {
           config.load_method = util::READ;
         } else if (!strcmp(optarg, "parallel")) {
           config.load_method = util::PARALLEL_READ;
+        } else if (!strcmp(optarg, "huge")) {
+          config.load_method = util::HUGE_READ;
+        } else if (!strcmp(optarg, "interleave")) {
+          config.load_method = util::HUGE_INTERLEAVE_READ;
         } else {
           Usage(argv[0]);
         }
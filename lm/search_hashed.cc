@@ -4,6 +4,7 @@
 #include "lm/blank.hh"
 #include "lm/lm_exception.hh"
 #include "lm/model.hh"
+#include "lm/ngram_source.hh"
 #include "lm/read_arpa.hh"
 #include "lm/value.hh"
 #include "lm/vocab.hh"
@@ -156,8 +157,8 @@ template <class Build> void MarkLower(
   }
 }
 
-template <class Build, class Activate, class Store> void ReadNGrams(
-    util::FilePiece &f,
+template <class Source, class Build, class Activate, class Store> void ReadNGrams(
+    Source &f,
     const unsigned int n,
     const size_t count,
     const ProbingVocabulary &vocab,
@@ -229,7 +230,7 @@ template <class Value> uint8_t *HashedSearch<Value>::SetupMemory(uint8_t *start,
   longest_.Relocate(start);
 }*/
 
-template <class Value> void HashedSearch<Value>::InitializeFromARPA(const char * /*file*/, util::FilePiece &f, const std::vector<uint64_t> &counts, const Config &config, ProbingVocabulary &vocab, BinaryFormat &backing) {
+template <class Value> template <class Source> void HashedSearch<Value>::InitializeFromARPA(const char * /*file*/, Source &f, const std::vector<uint64_t> &counts, const Config &config, ProbingVocabulary &vocab, BinaryFormat &backing) {
   void *vocab_rebase;
   void *search_base = backing.GrowForSearch(Size(counts, config), vocab.UnkCountChangePadding(), vocab_rebase);
   vocab.Relocate(vocab_rebase);
@@ -241,12 +242,12 @@ template <class Value> void HashedSearch<Value>::InitializeFromARPA(const char *
   DispatchBuild(f, counts, config, vocab, warn);
 }
 
-template <> void HashedSearch<BackoffValue>::DispatchBuild(util::FilePiece &f, const std::vector<uint64_t> &counts, const Config &config, const ProbingVocabulary &vocab, PositiveProbWarn &warn) {
+template <> template <class Source> void HashedSearch<BackoffValue>::DispatchBuild(Source &f, const std::vector<uint64_t> &counts, const Config &config, const ProbingVocabulary &vocab, PositiveProbWarn &warn) {
   NoRestBuild build;
   ApplyBuild(f, counts, vocab, warn, build);
 }
 
-template <> void HashedSearch<RestValue>::DispatchBuild(util::FilePiece &f, const std::vector<uint64_t> &counts, const Config &config, const ProbingVocabulary &vocab, PositiveProbWarn &warn) {
+template <> template <class Source> void HashedSearch<RestValue>::DispatchBuild(Source &f, const std::vector<uint64_t> &counts, const Config &config, const ProbingVocabulary &vocab, PositiveProbWarn &warn) {
   switch (config.rest_function) {
     case Config::REST_MAX:
       {
@@ -263,25 +264,25 @@ template <> void HashedSearch<RestValue>::DispatchBuild(util::FilePiece &f, cons
   }
 }
 
-template <class Value> template <class Build> void HashedSearch<Value>::ApplyBuild(util::FilePiece &f, const std::vector<uint64_t> &counts, const ProbingVocabulary &vocab, PositiveProbWarn &warn, const Build &build) {
+template <class Value> template <class Source, class Build> void HashedSearch<Value>::ApplyBuild(Source &f, const std::vector<uint64_t> &counts, const ProbingVocabulary &vocab, PositiveProbWarn &warn, const Build &build) {
   for (WordIndex i = 0; i < counts[0]; ++i) {
     build.SetRest(&i, (unsigned int)1, unigram_.Raw()[i]);
   }
 
   try {
     if (counts.size() > 2) {
-      ReadNGrams<Build, ActivateUnigram<typename Value::Weights>, Middle>(
+      ReadNGrams<Source, Build, ActivateUnigram<typename Value::Weights>, Middle>(
           f, 2, counts[1], vocab, build, unigram_.Raw(), middle_, ActivateUnigram<typename Value::Weights>(unigram_.Raw()), middle_[0], warn);
     }
     for (unsigned int n = 3; n < counts.size(); ++n) {
-      ReadNGrams<Build, ActivateLowerMiddle<Middle>, Middle>(
+      ReadNGrams<Source, Build, ActivateLowerMiddle<Middle>, Middle>(
           f, n, counts[n-1], vocab, build, unigram_.Raw(), middle_, ActivateLowerMiddle<Middle>(middle_[n-3]), middle_[n-2], warn);
     }
     if (counts.size() > 2) {
-      ReadNGrams<Build, ActivateLowerMiddle<Middle>, Longest>(
+      ReadNGrams<Source, Build, ActivateLowerMiddle<Middle>, Longest>(
           f, counts.size(), counts[counts.size() - 1], vocab, build, unigram_.Raw(), middle_, ActivateLowerMiddle<Middle>(middle_.back()), longest_, warn);
     } else {
-      ReadNGrams<Build, ActivateUnigram<typename Value::Weights>, Longest>(
+      ReadNGrams<Source, Build, ActivateUnigram<typename Value::Weights>, Longest>(
           f, counts.size(), counts[counts.size() - 1], vocab, build, unigram_.Raw(), middle_, ActivateUnigram<typename Value::Weights>(unigram_.Raw()), longest_, warn);
     }
   } catch (util::ProbingSizeException &e) {
@@ -293,6 +294,11 @@ template <class Value> template <class Build> void HashedSearch<Value>::ApplyBui
 template class HashedSearch<BackoffValue>;
 template class HashedSearch<RestValue>;
 
+template void HashedSearch<BackoffValue>::InitializeFromARPA(const char *, util::FilePiece &, const std::vector<uint64_t> &, const Config &, ProbingVocabulary &, BinaryFormat &);
+template void HashedSearch<BackoffValue>::InitializeFromARPA(const char *, NGramSource &, const std::vector<uint64_t> &, const Config &, ProbingVocabulary &, BinaryFormat &);
+template void HashedSearch<RestValue>::InitializeFromARPA(const char *, util::FilePiece &, const std::vector<uint64_t> &, const Config &, ProbingVocabulary &, BinaryFormat &);
+template void HashedSearch<RestValue>::InitializeFromARPA(const char *, NGramSource &, const std::vector<uint64_t> &, const Config &, ProbingVocabulary &, BinaryFormat &);
+
 } // namespace detail
 } // namespace ngram
 } // namespace lm
@@ -8,6 +8,7 @@
 #include "lm/weights.hh"
 
 #include "util/bit_packing.hh"
+#include "util/prefetch.hh"
 #include "util/probing_hash_table.hh"
 
 #include <algorithm>
@@ -84,7 +85,8 @@ template <class Value> class HashedSearch {
 
     uint8_t *SetupMemory(uint8_t *start, const std::vector<uint64_t> &counts, const Config &config);
 
-    void InitializeFromARPA(const char *file, util::FilePiece &f, const std::vector<uint64_t> &counts, const Config &config, ProbingVocabulary &vocab, BinaryFormat &backing);
+    // Source is util::FilePiece for ARPA or NGramSource.
+    template <class Source> void InitializeFromARPA(const char *file, Source &f, const std::vector<uint64_t> &counts, const Config &config, ProbingVocabulary &vocab, BinaryFormat &backing);
 
     unsigned char Order() const {
       return middle_.size() + 2;
@@ -125,6 +127,28 @@ template <class Value> class HashedSearch {
       return LongestPointer(found->value.prob);
     }
 
+    /* Prefetch for scoring new_word after context.  Hashes depend only on the
+     * words, so every lookup can be prefetched up front and PrefetchMiddle and
+     * PrefetchLongest have nothing left to do.
+     */
+    void PrefetchQuery(WordIndex new_word, const WordIndex *context_rbegin, const WordIndex *context_rend) const {
+      util::Prefetch(&unigram_.Lookup(new_word));
+      Node node = static_cast<Node>(new_word);
+      typename std::vector<Middle>::const_iterator middle = middle_.begin();
+      for (const WordIndex *i = context_rbegin; i != context_rend; ++i, ++middle) {
+        node = CombineWordHash(node, *i);
+        if (middle == middle_.end()) {
+          longest_.Prefetch(node);
+          return;
+        }
+        middle->Prefetch(node);
+      }
+    }
+
+    void PrefetchMiddle(unsigned char, WordIndex, const Node &) const {}
+
+    void PrefetchLongest(WordIndex, const Node &) const {}
+
     // Generate a node without necessarily checking that it actually exists.
     // Optionally return false if it's know to not exist.
     bool FastMakeNode(const WordIndex *begin, const WordIndex *end, Node &node) const {
@@ -138,9 +162,9 @@ template <class Value> class HashedSearch {
 
   private:
     // Interpret config's rest cost build policy and pass the right template argument to ApplyBuild.
-    void DispatchBuild(util::FilePiece &f, const std::vector<uint64_t> &counts, const Config &config, const ProbingVocabulary &vocab, PositiveProbWarn &warn);
+    template <class Source> void DispatchBuild(Source &f, const std::vector<uint64_t> &counts, const Config &config, const ProbingVocabulary &vocab, PositiveProbWarn &warn);
 
-    template <class Build> void ApplyBuild(util::FilePiece &f, const std::vector<uint64_t> &counts, const ProbingVocabulary &vocab, PositiveProbWarn &warn, const Build &build);
+    template <class Source, class Build> void ApplyBuild(Source &f, const std::vector<uint64_t> &counts, const ProbingVocabulary &vocab, PositiveProbWarn &warn, const Build &build);
 
     class Unigram {
       public:
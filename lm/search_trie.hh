@@ -2,6 +2,7 @@
 #define LM_SEARCH_TRIE_H
 
 #include "lm/config.hh"
+#include "lm/max_order.hh"
 #include "lm/model_type.hh"
 #include "lm/return.hh"
 #include "lm/trie.hh"
@@ -60,7 +61,8 @@ template <class Quant, class Bhiksha> class TrieSearch {
 
     uint8_t *SetupMemory(uint8_t *start, const std::vector<uint64_t> &counts, const Config &config);
 
-    void InitializeFromARPA(const char *file, util::FilePiece &f, std::vector<uint64_t> &counts, const Config &config, SortedVocabulary &vocab, BinaryFormat &backing);
+    // Source is util::FilePiece for ARPA or NGramSource.
+    template <class Source> void InitializeFromARPA(const char *file, Source &f, std::vector<uint64_t> &counts, const Config &config, SortedVocabulary &vocab, BinaryFormat &backing);
 
     unsigned char Order() const {
       return middle_end_ - middle_begin_ + 2;
@@ -89,6 +91,22 @@ template <class Quant, class Bhiksha> class TrieSearch {
       return LongestPointer(quant_, longest_.Find(word, node));
     }
 
+    /* Prefetch what the corresponding Lookup call will read first.  Each
+     * lookup needs the range found by the one before, so only the unigram can
+     * be prefetched before scoring starts.
+     */
+    void PrefetchQuery(WordIndex new_word, const WordIndex *, const WordIndex *) const {
+      unigram_.Prefetch(new_word);
+    }
+
+    void PrefetchMiddle(unsigned char order_minus_2, WordIndex word, const Node &node) const {
+      middle_begin_[order_minus_2].Prefetch(word, node);
+    }
+
+    void PrefetchLongest(WordIndex word, const Node &node) const {
+      longest_.Prefetch(word, node);
+    }
+
     bool FastMakeNode(const WordIndex *begin, const WordIndex *end, Node &node) const {
       assert(begin != end);
       bool independent_left;
@@ -100,7 +118,57 @@ template <class Quant, class Bhiksha> class TrieSearch {
       return true;
     }
 
+    /* Call callback(words, length, weights) for every n-gram of the given
+     * length, where words are vocabulary ids in natural order and weights is
+     * ProbBackoff (backoff 0 for the highest order).  unigrams is the
+     * vocabulary's Bound().  This includes the blanks inserted when building,
+     * which carry the probability they stand in for.
+     */
+    template <class Callback> void ForEachNGram(unsigned char length, WordIndex unigrams, Callback &callback) const {
+      assert(length >= 1 && length <= Order());
+      WordIndex words[KENLM_MAX_ORDER];
+      ProbBackoff weights;
+      for (WordIndex word = 0; word < unigrams; ++word) {
+        // The trie is keyed by the last word first.
+        words[length - 1] = word;
+        Node node;
+        UnigramPointer pointer(unigram_.Find(word, node));
+        if (length == 1) {
+          weights.prob = pointer.Prob();
+          weights.backoff = pointer.Backoff();
+          callback(words, 1, weights);
+        } else {
+          ForEachChild(2, length, node, words, weights, callback);
+        }
+      }
+    }
+
   private:
+    template <class Callback> void ForEachChild(unsigned char depth, unsigned char length, const Node &node, WordIndex *words, ProbBackoff &weights, Callback &callback) const {
+      if (depth == Order()) {
+        for (uint64_t i = node.begin; i < node.end; ++i) {
+          words[length - depth] = longest_.ReadWord(i);
+          weights.prob = LongestPointer(quant_, longest_.ReadEntry(i)).Prob();
+          weights.backoff = 0.0;
+          callback(words, length, weights);
+        }
+        return;
+      }
+      const Middle &middle = middle_begin_[depth - 2];
+      for (uint64_t i = node.begin; i < node.end; ++i) {
+        words[length - depth] = middle.ReadWord(i);
+        Node child;
+        MiddlePointer pointer(quant_, depth - 2, middle_begin_[depth - 2].ReadEntry(i, child));
+        if (depth == length) {
+          weights.prob = pointer.Prob();
+          weights.backoff = pointer.Backoff();
+          callback(words, length, weights);
+        } else {
+          ForEachChild(depth + 1, length, child, words, weights, callback);
+        }
+      }
+    }
+
     friend void BuildTrie<Quant, Bhiksha>(SortedFiles &files, std::vector<uint64_t> &counts, const Config &config, TrieSearch<Quant, Bhiksha> &out, Quant &quant, SortedVocabulary &vocab, BinaryFormat &backing);
 
     // Middles are managed manually so we can delay construction and they don't have to be copyable.
@@ -9,13 +9,17 @@ namespace lm {
 namespace ngram {
 
 void ShowSizes(const std::vector<uint64_t> &counts, const lm::ngram::Config &config) {
-  uint64_t sizes[6];
+  uint64_t sizes[8];
   sizes[0] = ProbingModel::Size(counts, config);
   sizes[1] = RestProbingModel::Size(counts, config);
   sizes[2] = TrieModel::Size(counts, config);
   sizes[3] = QuantTrieModel::Size(counts, config);
   sizes[4] = ArrayTrieModel::Size(counts, config);
   sizes[5] = QuantArrayTrieModel::Size(counts, config);
+  lm::ngram::Config elias_fano(config);
+  elias_fano.pointer_bhiksha_elias_fano = true;
+  sizes[6] = ArrayTrieModel::Size(counts, elias_fano);
+  sizes[7] = QuantArrayTrieModel::Size(counts, elias_fano);
   uint64_t max_length = *std::max_element(sizes, sizes + sizeof(sizes) / sizeof(uint64_t));
   uint64_t min_length = *std::min_element(sizes, sizes + sizeof(sizes) / sizeof(uint64_t));
   uint64_t divide;
@@ -45,7 +49,9 @@ void ShowSizes(const std::vector<uint64_t> &counts, const lm::ngram::Config &con
     "trie    " << std::setw(length) << (sizes[2] / divide) << " without quantization\n"
     "trie    " << std::setw(length) << (sizes[3] / divide) << " assuming -q " << (unsigned)config.prob_bits << " -b " << (unsigned)config.backoff_bits << " quantization \n"
     "trie    " << std::setw(length) << (sizes[4] / divide) << " assuming -a " << (unsigned)config.pointer_bhiksha_bits << " array pointer compression\n"
-    "trie    " << std::setw(length) << (sizes[5] / divide) << " assuming -a " << (unsigned)config.pointer_bhiksha_bits << " -q " << (unsigned)config.prob_bits << " -b " << (unsigned)config.backoff_bits<< " array pointer compression and quantization\n";
+    "trie    " << std::setw(length) << (sizes[5] / divide) << " assuming -a " << (unsigned)config.pointer_bhiksha_bits << " -q " << (unsigned)config.prob_bits << " -b " << (unsigned)config.backoff_bits<< " array pointer compression and quantization\n"
+    "trie    " << std::setw(length) << (sizes[6] / divide) << " assuming -e Elias-Fano pointer compression\n"
+    "trie    " << std::setw(length) << (sizes[7] / divide) << " assuming -e -q " << (unsigned)config.prob_bits << " -b " << (unsigned)config.backoff_bits << " Elias-Fano pointer compression and quantization\n";
 }
 
 void ShowSizes(const std::vector<uint64_t> &counts) {
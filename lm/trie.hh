@@ -4,6 +4,7 @@
 #include "lm/weights.hh"
 #include "lm/word_index.hh"
 #include "util/bit_packing.hh"
+#include "util/prefetch.hh"
 
 #include <cstddef>
 
@@ -69,6 +70,10 @@ class Unigram {
       return UnigramPointer(val->weights);
     }
 
+    void Prefetch(WordIndex word) const {
+      util::Prefetch(unigram_ + word);
+    }
+
   private:
     UnigramValue *unigram_;
 };  
@@ -81,6 +86,17 @@ class BitPacked {
       return insert_index_;
     }
 
+    // Prefetch the first entry that Find will probe for word in range.  This
+    // mirrors the first pivot of the interpolation search.
+    void Prefetch(WordIndex word, const NodeRange &range) const {
+      uint64_t pivot = range.begin + (range.end - range.begin) * static_cast<uint64_t>(word) / (max_vocab_ + 1);
+      util::Prefetch(base_ + ((pivot * total_bits_) >> 3));
+    }
+
+    WordIndex ReadWord(uint64_t index) const {
+      return util::ReadInt57(base_, index * total_bits_, word_bits_, word_mask_);
+    }
+
   protected:
     static uint64_t BaseSize(uint64_t entries, uint64_t max_vocab, uint8_t remaining_bits);
 
@@ -137,6 +153,10 @@ class BitPackedLongest : public BitPacked {
     util::BitAddress Insert(WordIndex word);
 
     util::BitAddress Find(WordIndex word, const NodeRange &node) const;
+
+    util::BitAddress ReadEntry(uint64_t index) const {
+      return util::BitAddress(base_, index * total_bits_ + word_bits_);
+    }
 };
 
 } // namespace trie
@@ -0,0 +1,48 @@
+#include <iostream>
+#include <string>
+
+#include "moses/FF/GlobalLexicalModelBinary.h"
+#include "util/exception.hh"
+
+using namespace Moses;
+
+void printHelp()
+{
+  std::cerr << "Usage:\n"
+            "options: \n"
+            "\t-in  string -- global lexical model, one \"output input weight\" per line\n"
+            "\t-out string -- binary model file name\n"
+            "\n";
+}
+
+int main(int argc, char** argv)
+{
+  std::string inFilePath;
+  std::string outFilePath;
+  for(int i = 1; i < argc; ++i) {
+    std::string arg(argv[i]);
+    if("-in" == arg && i+1 < argc) {
+      ++i;
+      inFilePath = argv[i];
+    } else if("-out" == arg && i+1 < argc) {
+      ++i;
+      outFilePath = argv[i];
+    } else {
+      printHelp();
+      return 1;
+    }
+  }
+  if (inFilePath.empty() || outFilePath.empty()) {
+    printHelp();
+    return 1;
+  }
+
+  std::cerr << "processing " << inFilePath << " to " << outFilePath << "\n";
+  try {
+    GlobalLexicalModelBinary::Create(inFilePath, outFilePath);
+  } catch (const util::Exception &e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
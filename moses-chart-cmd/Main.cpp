@@ -56,6 +56,7 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "moses/TreeInput.h"
 #include "moses/ThreadPool.h"
 #include "moses/ChartManager.h"
+#include "moses/Profiler.h"
 #include "moses/ChartHypothesis.h"
 #include "moses/Incremental.h"
 #include "moses/FF/StatefulFeatureFunction.h"
@@ -333,6 +334,7 @@ int main(int argc, char* argv[])
     pool.Stop(true);  // flush remaining jobs
 #endif
 
+    Profiler::Write();
     delete ioWrapper;
     FeatureFunction::Destroy();
 
@@ -33,6 +33,7 @@ POSSIBILITY OF SUCH DAMAGE.
 // example file on how to use moses library
 
 #include <iostream>
+#include <sstream>
 #include <stack>
 #include <boost/algorithm/string.hpp>
 
@@ -198,6 +199,31 @@ GetInput(InputType* inputType)
   }
 }
 
+/** Parse an input line previously read with GetRawInput() */
+InputType*
+IOWrapper::
+GetInput(InputType* inputType, const std::string &line)
+{
+  istringstream in(line + "\n");
+  if(inputType->Read(in, m_inputFactorOrder)) {
+    if (long x = inputType->GetTranslationId()) {
+      if (x>=m_translationId) m_translationId = x+1;
+    } else inputType->SetTranslationId(m_translationId++);
+
+    return inputType;
+  } else {
+    delete inputType;
+    return NULL;
+  }
+}
+
+/** Read the next input line without parsing it, so that the line can be
+ * parsed by the thread that translates it */
+bool IOWrapper::GetRawInput(std::string &line)
+{
+  return !getline(*m_inputStream, line, '\n').eof();
+}
+
 std::map<size_t, const Factor*> GetPlaceholders(const Hypothesis &hypo, FactorType placeholderFactor)
 {
   const InputPath &inputPath = hypo.GetTranslationOption().GetInputPath();
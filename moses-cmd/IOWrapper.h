@@ -104,6 +104,12 @@ public:
   ~IOWrapper();
 
   Moses::InputType* GetInput(Moses::InputType *inputType);
+  Moses::InputType* GetInput(Moses::InputType *inputType, const std::string &line);
+  bool GetRawInput(std::string &line);
+
+  long GetNextTranslationId() {
+    return m_translationId++;
+  }
 
   void OutputBestHypo(const Moses::Hypothesis *hypo, long translationId, char reportSegmentation, bool reportAllFactors);
   void OutputLatticeMBRNBestList(const std::vector<LatticeMBRSolution>& solutions,long translationId);
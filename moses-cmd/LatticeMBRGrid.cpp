@@ -38,6 +38,9 @@ POSSIBILITY OF SUCH DAMAGE.
   -lmbr-pruning-factor and -mbr-scale). All other parameters are passed through to moses. If any of the lattice mbr
   parameters are missing, then they are set to their default values. Output is of the form:
    sentence-id ||| p r prune scale ||| translation-hypothesis
+
+  The points of the grid are decoded in parallel with the number of threads given by -threads,
+  and written in grid order.
 **/
 
 #include <cstdlib>
@@ -45,11 +48,13 @@ POSSIBILITY OF SUCH DAMAGE.
 #include <map>
 #include <stdexcept>
 #include <set>
+#include <sstream>
 
 #include "IOWrapper.h"
 #include "moses/LatticeMBR.h"
 #include "moses/Manager.h"
 #include "moses/StaticData.h"
+#include "moses/ThreadPool.h"
 #include "util/exception.hh"
 
 
@@ -134,6 +139,78 @@ private:
   map<string,gridkey> m_args;
 };
 
+/** Counts the grid points of the current sentence still being decoded, so
+ * that the thread pool can be kept for the next sentence */
+class PendingPoints
+{
+public:
+  PendingPoints() : m_pending(0) {}
+
+  void Add(size_t count) {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_mutex);
+#endif
+    m_pending += count;
+  }
+
+  void Done() {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_mutex);
+    if (--m_pending == 0) {
+      m_allDone.notify_all();
+    }
+#else
+    --m_pending;
+#endif
+  }
+
+  void Wait() {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_mutex);
+    while (m_pending) {
+      m_allDone.wait(lock);
+    }
+#endif
+  }
+
+private:
+  size_t m_pending;
+#ifdef WITH_THREADS
+  boost::mutex m_mutex;
+  boost::condition_variable m_allDone;
+#endif
+};
+
+/** Lattice MBR decoding of a sentence with the parameters of one grid point */
+class GridPointTask : public Task
+{
+public:
+  GridPointTask(size_t lineCount, const Manager& manager, const TrellisPathList& nBestList,
+                const LatticeMBRParams& params, string& output, PendingPoints& pending)
+    : m_lineCount(lineCount), m_manager(manager), m_nBestList(nBestList), m_params(params), m_output(output)
+    , m_pending(pending) {}
+
+  void Run() {
+    const StaticData& staticData = StaticData::Instance();
+    ostringstream out;
+    out << m_lineCount << " ||| " << m_params.precision << " " << m_params.ratio
+        << " " << m_params.pruningFactor << " " << m_params.scale << " ||| ";
+    vector<Word> mbrBestHypo = doLatticeMBR(m_manager, m_nBestList, m_params);
+    OutputBestHypo(mbrBestHypo, m_lineCount, staticData.GetReportSegmentation(),
+                   staticData.GetReportAllFactors(), out);
+    m_output = out.str();
+    m_pending.Done();
+  }
+
+private:
+  size_t m_lineCount;
+  const Manager& m_manager;
+  const TrellisPathList& m_nBestList;
+  const LatticeMBRParams& m_params;
+  string& m_output;
+  PendingPoints& m_pending;
+};
+
 } // namespace
 
 int main(int argc, char* argv[])
@@ -178,37 +255,51 @@ int main(int argc, char* argv[])
   const vector<float>& prune_grid = grid.getGrid(lmbr_prune);
   const vector<float>& scale_grid = grid.getGrid(lmbr_scale);
 
+  //the points of the grid, in output order
+  vector<LatticeMBRParams> gridPoints;
+  for (vector<float>::const_iterator pi = pgrid.begin(); pi != pgrid.end(); ++pi) {
+    for (vector<float>::const_iterator ri = rgrid.begin(); ri != rgrid.end(); ++ri) {
+      for (vector<float>::const_iterator prune_i = prune_grid.begin(); prune_i != prune_grid.end(); ++prune_i) {
+        for (vector<float>::const_iterator scale_i = scale_grid.begin(); scale_i != scale_grid.end(); ++scale_i) {
+          LatticeMBRParams point;
+          point.precision = *pi;
+          point.ratio = *ri;
+          point.pruningFactor = (size_t)(*prune_i);
+          point.scale = *scale_i;
+          gridPoints.push_back(point);
+        }
+      }
+    }
+  }
+  vector<string> outputs(gridPoints.size());
+
+#ifdef WITH_THREADS
+  //one pool for the whole input
+  ThreadPool pool(staticData.ThreadCount());
+#endif
+  PendingPoints pending;
+
   while(ReadInput(*ioWrapper,staticData.GetInputType(),source)) {
     ++lineCount;
-    Sentence sentence;
     Manager manager(lineCount, *source, staticData.GetSearchAlgorithm());
     manager.ProcessSentence();
     TrellisPathList nBestList;
     manager.CalcNBest(nBestSize, nBestList,true);
-    //grid search
-    for (vector<float>::const_iterator pi = pgrid.begin(); pi != pgrid.end(); ++pi) {
-      float p = *pi;
-      staticData.SetLatticeMBRPrecision(p);
-      for (vector<float>::const_iterator ri = rgrid.begin(); ri != rgrid.end(); ++ri) {
-        float r = *ri;
-        staticData.SetLatticeMBRPRatio(r);
-        for (vector<float>::const_iterator prune_i = prune_grid.begin(); prune_i != prune_grid.end(); ++prune_i) {
-          size_t prune = (size_t)(*prune_i);
-          staticData.SetLatticeMBRPruningFactor(prune);
-          for (vector<float>::const_iterator scale_i = scale_grid.begin(); scale_i != scale_grid.end(); ++scale_i) {
-            float scale = *scale_i;
-            staticData.SetMBRScale(scale);
-            cout << lineCount << " ||| " << p << " " << r << " " << prune << " " << scale << " ||| ";
-            vector<Word> mbrBestHypo = doLatticeMBR(manager,nBestList);
-            OutputBestHypo(mbrBestHypo, lineCount, staticData.GetReportSegmentation(),
-                           staticData.GetReportAllFactors(),cout);
-          }
-        }
-
-      }
+    //grid search, the decoding of a sentence is shared by all points
+    pending.Add(gridPoints.size());
+    for (size_t i = 0; i < gridPoints.size(); ++i) {
+      GridPointTask* task = new GridPointTask(lineCount, manager, nBestList, gridPoints[i], outputs[i], pending);
+#ifdef WITH_THREADS
+      pool.Submit(task);
+#else
+      task->Run();
+      delete task;
+#endif
+    }
+    pending.Wait(); //the points use manager and nBestList
+    for (size_t i = 0; i < outputs.size(); ++i) {
+      cout << outputs[i];
     }
-
-
   }
 
 }
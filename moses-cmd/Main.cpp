@@ -41,6 +41,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "moses/Hypothesis.h"
 #include "moses/HypergraphOutput.h"
 #include "moses/Manager.h"
+#include "moses/Profiler.h"
 #include "moses/StaticData.h"
 #include "moses/Util.h"
 #include "moses/Timer.h"
@@ -97,7 +98,15 @@ public:
     m_alignmentInfoCollector(alignmentInfoCollector),
     m_unknownsCollector(unknownsCollector),
     m_outputSearchGraphSLF(outputSearchGraphSLF),
-    m_hypergraphOutput(hypergraphOutput) {}
+    m_hypergraphOutput(hypergraphOutput),
+    m_translationId(0) {}
+
+  /** Defer parsing of the input to the thread running this task.
+   * Used when the task was created without a source */
+  void SetRawInput(const std::string &line, long translationId) {
+    m_rawInput = line;
+    m_translationId = translationId;
+  }
 
   /** Translate one sentence
    * gets called by main function implemented at end of this source file */
@@ -105,6 +114,15 @@ public:
     // shorthand for "global data"
     const StaticData &staticData = StaticData::Instance();
 
+    // parse input that the main thread only read
+    if (!m_source) {
+      istringstream in(m_rawInput + "\n");
+      m_source = new Sentence;
+      m_source->Read(in, staticData.GetInputFactorOrder());
+      m_source->SetTranslationId(m_translationId);
+      FeatureFunction::CallChangeSource(m_source);
+    }
+
     // input sentence
     Sentence sentence;
 
@@ -376,6 +394,8 @@ private:
   bool m_outputSearchGraphSLF;
   boost::shared_ptr<HypergraphOutput<Manager> > m_hypergraphOutput;
   std::ofstream *m_alignmentStream;
+  std::string m_rawInput;
+  long m_translationId;
 
 
 };
@@ -581,15 +601,35 @@ int main(int argc, char** argv)
     ThreadPool pool(staticData.ThreadCount());
 #endif
 
+    // plain sentences are only read by the main thread and parsed
+    // (including XML markup) by the thread translating them. Lines with
+    // SGML markup set the translation id of following lines, so they are
+    // still parsed in order here.
+#ifdef WITH_THREADS
+    bool parseInWorkers = staticData.GetInputType() == SentenceInput
+                          && staticData.ThreadCount() > 1;
+#else
+    bool parseInWorkers = false;
+#endif
+    std::string rawInput;
+
     // main loop over set of input sentences
     InputType* source = NULL;
     size_t lineCount = staticData.GetStartTranslationId();
-    while(ReadInput(*ioWrapper,staticData.GetInputType(),source)) {
+    while(parseInWorkers
+          ? ioWrapper->GetRawInput(rawInput)
+          : ReadInput(*ioWrapper,staticData.GetInputType(),source)) {
       IFVERBOSE(1) {
         ResetUserTime();
       }
 
-      FeatureFunction::CallChangeSource(source);
+      if (parseInWorkers && ToLower(rawInput).find("<seg") != string::npos) {
+        source = ioWrapper->GetInput(new Sentence, rawInput);
+        if (!source) break;
+      }
+      if (source) {
+        FeatureFunction::CallChangeSource(source);
+      }
 
       // set up task of translating one sentence
       TranslationTask* task =
@@ -603,6 +643,9 @@ int main(int argc, char** argv)
                             unknownsCollector.get(),
                             staticData.GetOutputSearchGraphSLF(),
                             hypergraphOutput);
+      if (!source) {
+        task->SetRawInput(rawInput, ioWrapper->GetNextTranslationId());
+      }
       // execute task
 #ifdef WITH_THREADS
       pool.Submit(task);
@@ -620,6 +663,7 @@ int main(int argc, char** argv)
     pool.Stop(true); //flush remaining jobs
 #endif
 
+    Profiler::Write();
     delete ioWrapper;
     FeatureFunction::Destroy();
 
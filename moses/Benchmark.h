@@ -0,0 +1,121 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2014 University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#ifndef moses_Benchmark_h
+#define moses_Benchmark_h
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace Moses
+{
+class Sentence;
+}
+
+namespace MosesBenchmark
+{
+
+/** Models written by the benchmark driver, so that runs are repeatable
+ * without model files. All of them use the same vocabulary: source words
+ * s0 s1 ... and target words t0 t1 ...
+ */
+struct SyntheticModel {
+  std::string dir;
+  std::vector<std::string> sentences; //!< input sentences, covered by the tables
+  std::string phraseTable;  //!< text phrase table, 4 scores, sorted
+  std::string ruleTable;    //!< hierarchical rule table, 4 scores
+  std::string glueGrammar;
+  std::string languageModel; //!< ARPA bigram model over the target words
+};
+
+const SyntheticModel &GetSyntheticModel();
+
+//! read a sentence with the loaded configuration
+Moses::Sentence *CreateSentence(const std::string &text);
+
+/** The decoder configuration that a benchmark needs. Benchmarks of each
+ * configuration run in their own process, as StaticData can only be
+ * loaded once. */
+enum Configuration {
+  NoConfiguration,
+  PhraseBased,
+  Chart
+};
+
+/** A benchmark of one operation. Instances are static objects that
+ * register themselves, so constructors must not do any work: data is set
+ * up in SetUp(), once the configuration is loaded. Run() is timed, so it
+ * should only do the operation. */
+class Benchmark
+{
+public:
+  Benchmark(const std::string &name, Configuration configuration = NoConfiguration);
+  virtual ~Benchmark() {}
+
+  const std::string &GetName() const {
+    return m_name;
+  }
+  Configuration GetConfiguration() const {
+    return m_configuration;
+  }
+
+  virtual void SetUp() {}
+
+  //! do the operation iterations * GetOpsPerIteration() times
+  virtual void Run(size_t iterations) = 0;
+
+  virtual size_t GetOpsPerIteration() const {
+    return 1;
+  }
+
+  static std::vector<Benchmark*> &GetAll();
+
+private:
+  std::string m_name;
+  Configuration m_configuration;
+};
+
+//! deterministic pseudo random numbers, the same on every platform
+class Random
+{
+public:
+  explicit Random(uint32_t seed = 1) : m_state(seed) {}
+  uint32_t Next(uint32_t bound) {
+    m_state = m_state * 1103515245 + 12345;
+    return (m_state >> 8) % bound;
+  }
+private:
+  uint32_t m_state;
+};
+
+//! keep the compiler from optimising away a result
+template <class T> inline void Use(const T &value)
+{
+#ifdef __GNUC__
+  __asm__ __volatile__("" : : "g"(&value) : "memory");
+#else
+  static const T * volatile sink;
+  sink = &value;
+#endif
+}
+
+}
+
+#endif
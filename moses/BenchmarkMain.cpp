@@ -0,0 +1,511 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2014 University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+// Driver of the micro benchmarks in *Benchmark.cpp: writes the synthetic
+// models, runs the benchmarks of each configuration in a child process,
+// prints ns/op and allocations/op and compares them with a previous run.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <new>
+#include <set>
+#include <sstream>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <boost/atomic.hpp>
+#include <boost/filesystem.hpp>
+
+#include "Benchmark.h"
+#include "Parameter.h"
+#include "Profiler.h"
+#include "Sentence.h"
+#include "StaticData.h"
+#include "Util.h"
+
+#ifdef HAVE_CMPH
+#include "TranslationModel/CompactPT/PhraseTableCreator.h"
+#endif
+#ifdef HAVE_PROBINGPT
+#include "TranslationModel/ProbingPT/storing.hh"
+#endif
+
+using namespace std;
+
+namespace
+{
+// heap allocations, counted by the replaced operator new below. Decoding
+// benchmarks allocate from several threads.
+boost::atomic<size_t> s_allocations(0);
+}
+
+void *operator new(size_t size)
+{
+  s_allocations.fetch_add(1, boost::memory_order_relaxed);
+  void *ret = malloc(size ? size : 1);
+  if (!ret) throw std::bad_alloc();
+  return ret;
+}
+
+void *operator new[](size_t size)
+{
+  return operator new(size);
+}
+
+void operator delete(void *ptr) throw()
+{
+  free(ptr);
+}
+
+void operator delete[](void *ptr) throw()
+{
+  free(ptr);
+}
+
+namespace MosesBenchmark
+{
+
+Benchmark::Benchmark(const std::string &name, Configuration configuration)
+  : m_name(name)
+  , m_configuration(configuration)
+{
+  GetAll().push_back(this);
+}
+
+std::vector<Benchmark*> &Benchmark::GetAll()
+{
+  // function static, so that benchmarks can register during static initialisation
+  static std::vector<Benchmark*> all;
+  return all;
+}
+
+namespace
+{
+
+const size_t NUM_SENTENCES = 20;
+const size_t SENTENCE_LENGTH = 20;
+const size_t VOCAB_SIZE = 500;
+const size_t MAX_PHRASE_LENGTH = 3;
+const size_t TRANSLATIONS = 4;
+
+SyntheticModel s_model;
+
+struct Options {
+  std::string filter;
+  double minSeconds;
+  size_t repetitions;
+  std::string baseline;
+  double tolerance;
+  std::string modelDir;
+
+  Options() : minSeconds(0.2), repetitions(5), tolerance(0.1) {}
+};
+
+struct Result {
+  double nsPerOp;
+  double allocationsPerOp;
+};
+
+std::string Word(char prefix, size_t id)
+{
+  std::ostringstream word;
+  word << prefix << id;
+  return word.str();
+}
+
+std::string Scores(Random &random, size_t count)
+{
+  std::ostringstream scores;
+  for (size_t i = 0; i < count; ++i) {
+    scores << (i ? " " : "") << (1 + random.Next(1000)) / 1000.0;
+  }
+  return scores.str();
+}
+
+void WriteSyntheticModel(const std::string &dir)
+{
+  Random random(42);
+  s_model.dir = dir;
+
+  std::vector<std::vector<std::string> > words(NUM_SENTENCES);
+  for (size_t s = 0; s < NUM_SENTENCES; ++s) {
+    std::string sentence;
+    for (size_t i = 0; i < SENTENCE_LENGTH; ++i) {
+      words[s].push_back(Word('s', random.Next(VOCAB_SIZE)));
+      sentence += (i ? " " : "") + words[s].back();
+    }
+    s_model.sentences.push_back(sentence);
+  }
+
+  // every phrase of every sentence, up to the maximum length, has a few
+  // translations of the same length, aligned monotonically
+  std::set<std::string> phrases, rules;
+  for (size_t s = 0; s < NUM_SENTENCES; ++s) {
+    for (size_t start = 0; start < SENTENCE_LENGTH; ++start) {
+      for (size_t length = 1; length <= MAX_PHRASE_LENGTH && start + length <= SENTENCE_LENGTH; ++length) {
+        std::string source, alignment;
+        for (size_t i = 0; i < length; ++i) {
+          source += (i ? " " : "") + words[s][start + i];
+          alignment += (i ? " " : "") + Moses::SPrint(i) + "-" + Moses::SPrint(i);
+        }
+        for (size_t t = 0; t < TRANSLATIONS; ++t) {
+          std::string target;
+          for (size_t i = 0; i < length; ++i) {
+            target += (i ? " " : "") + Word('t', random.Next(VOCAB_SIZE));
+          }
+          std::string scores = Scores(random, 4);
+          phrases.insert(source + " ||| " + target + " ||| " + scores + " ||| " + alignment + " ||| ");
+          rules.insert(source + " [X] ||| " + target + " [X] ||| " + scores + " ||| " + alignment + " ||| ");
+          if (length == 3) {
+            // and a rule with a gap in the middle
+            std::string gapSource = words[s][start] + " [X][X] " + words[s][start + 2] + " [X]";
+            std::string gapTarget = Word('t', random.Next(VOCAB_SIZE)) + " [X][X] " + Word('t', random.Next(VOCAB_SIZE)) + " [X]";
+            rules.insert(gapSource + " ||| " + gapTarget + " ||| " + Scores(random, 4) + " ||| 0-0 1-1 2-2 ||| ");
+          }
+        }
+      }
+    }
+  }
+
+  s_model.phraseTable = dir + "/phrase-table";
+  std::ofstream phraseTable(s_model.phraseTable.c_str());
+  std::copy(phrases.begin(), phrases.end(), std::ostream_iterator<std::string>(phraseTable, "\n"));
+
+  s_model.ruleTable = dir + "/rule-table";
+  std::ofstream ruleTable(s_model.ruleTable.c_str());
+  std::copy(rules.begin(), rules.end(), std::ostream_iterator<std::string>(ruleTable, "\n"));
+
+  s_model.glueGrammar = dir + "/glue-grammar";
+  std::ofstream glueGrammar(s_model.glueGrammar.c_str());
+  glueGrammar << "<s> [X] ||| <s> [S] ||| 1 ||| ||| 0\n"
+              << "[X][S] </s> [X] ||| [X][S] </s> [S] ||| 1 ||| 0-0 ||| 0\n"
+              << "[X][S] [X][X] [X] ||| [X][S] [X][X] [S] ||| 2.718 ||| 0-0 1-1 ||| 0\n";
+
+  // bigram model: all target words, and random bigrams between them
+  std::set<std::pair<size_t, size_t> > bigrams;
+  while (bigrams.size() < VOCAB_SIZE * 20) {
+    bigrams.insert(std::make_pair(random.Next(VOCAB_SIZE + 1), random.Next(VOCAB_SIZE + 1)));
+  }
+  s_model.languageModel = dir + "/lm.arpa";
+  std::ofstream lm(s_model.languageModel.c_str());
+  lm << "\\data\\\nngram 1=" << VOCAB_SIZE + 3 << "\nngram 2=" << bigrams.size() << "\n\n\\1-grams:\n";
+  lm << "-99\t<s>\t-0.5\n-1.5\t</s>\t0\n-3\t<unk>\t0\n";
+  for (size_t i = 0; i < VOCAB_SIZE; ++i) {
+    lm << -2.0 - random.Next(1000) / 1000.0 << "\t" << Word('t', i) << "\t" << -(random.Next(1000) / 1000.0) << "\n";
+  }
+  lm << "\n\\2-grams:\n";
+  std::set<std::pair<size_t, size_t> >::const_iterator bigram;
+  for (bigram = bigrams.begin(); bigram != bigrams.end(); ++bigram) {
+    // word VOCAB_SIZE stands for <s> as context and </s> as prediction
+    std::string context = bigram->first == VOCAB_SIZE ? "<s>" : Word('t', bigram->first);
+    std::string word = bigram->second == VOCAB_SIZE ? "</s>" : Word('t', bigram->second);
+    lm << -0.5 - random.Next(1000) / 1000.0 << "\t" << context << " " << word << "\n";
+  }
+  lm << "\n\\end\\\n";
+
+#ifdef HAVE_CMPH
+  phraseTable.close();
+  Moses::PhraseTableCreator creator(s_model.phraseTable, dir + "/phrase-table.minphr", dir, 4, 2,
+                                    Moses::PhraseTableCreator::PREnc, 10, 16, true, true, 0, 100, false);
+#endif
+#ifdef HAVE_PROBINGPT
+  phraseTable.close();
+  createProbingPT(s_model.phraseTable.c_str(), (dir + "/phrase-table.probing").c_str());
+#endif
+}
+
+void WriteConfiguration(const std::string &path, Configuration configuration)
+{
+  std::ofstream ini(path.c_str());
+  ini << "[input-factors]\n0\n\n[feature]\nUnknownWordPenalty\nWordPenalty\nPhrasePenalty\n";
+  if (configuration == PhraseBased) {
+    ini << "Distortion\n"
+        << "PhraseDictionaryMemory name=TranslationModel0 num-features=4 path=" << s_model.phraseTable
+        << " input-factor=0 output-factor=0 table-limit=20\n";
+#ifdef HAVE_CMPH
+    ini << "PhraseDictionaryCompact name=CompactTable num-features=4 cache-size=0 path="
+        << s_model.dir << "/phrase-table.minphr input-factor=0 output-factor=0 table-limit=20\n";
+#endif
+#ifdef HAVE_PROBINGPT
+    ini << "ProbingPT name=ProbingTable num-features=4 cache-size=0 path="
+        << s_model.dir << "/phrase-table.probing input-factor=0 output-factor=0 table-limit=20\n";
+#endif
+  } else {
+    ini << "PhraseDictionaryMemory name=TranslationModel0 num-features=4 path=" << s_model.ruleTable
+        << " input-factor=0 output-factor=0\n"
+        << "PhraseDictionaryMemory name=GlueGrammar num-features=1 path=" << s_model.glueGrammar
+        << " input-factor=0 output-factor=0\n";
+  }
+  ini << "KENLM name=LM0 factor=0 order=2 path=" << s_model.languageModel << "\n";
+
+  ini << "\n[weight]\nUnknownWordPenalty0= 1\nWordPenalty0= -0.5\nPhrasePenalty0= 0.2\n"
+      << "TranslationModel0= 0.2 0.2 0.2 0.2\nLM0= 0.5\n";
+  if (configuration == PhraseBased) {
+    ini << "Distortion0= 0.3\n";
+#ifdef HAVE_CMPH
+    ini << "CompactTable= 0.2 0.2 0.2 0.2\n";
+#endif
+#ifdef HAVE_PROBINGPT
+    ini << "ProbingTable= 0.2 0.2 0.2 0.2\n";
+#endif
+    ini << "\n[mapping]\n0 T 0\n\n[distortion-limit]\n6\n";
+  } else {
+    ini << "GlueGrammar= 1\n\n[mapping]\n0 T 0\n1 T 1\n\n[search-algorithm]\n3\n"
+        << "\n[cube-pruning-pop-limit]\n200\n\n[non-terminals]\nX\n\n[max-chart-span]\n20\n1000\n";
+  }
+}
+
+bool LoadConfiguration(Configuration configuration)
+{
+  const std::string path = s_model.dir + (configuration == PhraseBased ? "/moses.ini" : "/moses-chart.ini");
+  WriteConfiguration(path, configuration);
+  const char *argv[] = {"moses_benchmark", "-f", path.c_str(), "-v", "0"};
+  Moses::Parameter *params = new Moses::Parameter();
+  return params->LoadParam(5, const_cast<char**>(argv))
+         && Moses::StaticData::LoadDataStatic(params, argv[0]);
+}
+
+uint64_t Time(Benchmark &benchmark, size_t iterations, size_t &allocations)
+{
+  size_t startAllocations = s_allocations.load();
+  uint64_t start = Moses::Profiler::Now();
+  benchmark.Run(iterations);
+  uint64_t elapsed = Moses::Profiler::Now() - start;
+  allocations = s_allocations.load() - startAllocations;
+  return elapsed;
+}
+
+Result Measure(Benchmark &benchmark, const Options &options)
+{
+  benchmark.SetUp();
+
+  // find a number of iterations that takes at least the minimum time
+  const double minNs = options.minSeconds * 1e9;
+  size_t iterations = 1, allocations;
+  uint64_t elapsed = Time(benchmark, iterations, allocations);
+  while (elapsed < minNs) {
+    size_t next = elapsed ? (size_t) (iterations * minNs * 1.2 / elapsed) : iterations * 100;
+    iterations = std::min(iterations * 100, std::max(iterations + 1, next));
+    elapsed = Time(benchmark, iterations, allocations);
+  }
+
+  // the fastest repetition is the least disturbed by the rest of the machine
+  for (size_t i = 1; i < options.repetitions; ++i) {
+    size_t repAllocations;
+    uint64_t repElapsed = Time(benchmark, iterations, repAllocations);
+    if (repElapsed < elapsed) {
+      elapsed = repElapsed;
+      allocations = repAllocations;
+    }
+  }
+
+  const double ops = (double) iterations * benchmark.GetOpsPerIteration();
+  Result result;
+  result.nsPerOp = elapsed / ops;
+  result.allocationsPerOp = allocations / ops;
+  return result;
+}
+
+void PrintResult(std::ostream &out, const std::string &name, const Result &result)
+{
+  char line[256];
+  snprintf(line, sizeof(line), "%-55s %14.1f ns/op %12.2f allocs/op", name.c_str(), result.nsPerOp, result.allocationsPerOp);
+  out << line << std::endl;
+}
+
+// results of a previous run, as printed by PrintResult
+std::map<std::string, Result> ReadBaseline(const std::string &path)
+{
+  std::map<std::string, Result> baseline;
+  std::ifstream in(path.c_str());
+  UTIL_THROW_IF2(!in, "Cannot read baseline " << path);
+  std::string line;
+  while (getline(in, line)) {
+    std::istringstream fields(line);
+    std::string name, nsUnit, allocationsUnit;
+    Result result;
+    if (fields >> name >> result.nsPerOp >> nsUnit >> result.allocationsPerOp >> allocationsUnit
+        && nsUnit == "ns/op") {
+      baseline[name] = result;
+    }
+  }
+  return baseline;
+}
+
+//! runs the benchmarks of one configuration in a child process, which writes its results to a pipe
+bool RunConfiguration(Configuration configuration, const std::vector<Benchmark*> &benchmarks,
+                      const Options &options, std::map<std::string, Result> &results)
+{
+  int fds[2];
+  UTIL_THROW_IF2(pipe(fds), "pipe failed");
+  std::cout.flush();
+  pid_t pid = fork();
+  UTIL_THROW_IF2(pid < 0, "fork failed");
+
+  if (pid == 0) {
+    close(fds[0]);
+    FILE *out = fdopen(fds[1], "w");
+    if (configuration != NoConfiguration && !LoadConfiguration(configuration)) {
+      std::cerr << "Cannot load the synthetic configuration" << std::endl;
+      _exit(1);
+    }
+    for (size_t i = 0; i < benchmarks.size(); ++i) {
+      Result result = Measure(*benchmarks[i], options);
+      fprintf(out, "%zu %.17g %.17g\n", i, result.nsPerOp, result.allocationsPerOp);
+      fflush(out);
+    }
+    // skip destructors, as the decoder does
+    _exit(0);
+  }
+
+  close(fds[1]);
+  FILE *in = fdopen(fds[0], "r");
+  size_t index;
+  Result result;
+  while (fscanf(in, "%zu %lf %lf", &index, &result.nsPerOp, &result.allocationsPerOp) == 3
+         && index < benchmarks.size()) {
+    PrintResult(std::cout, benchmarks[index]->GetName(), result);
+    results[benchmarks[index]->GetName()] = result;
+  }
+  fclose(in);
+
+  int status;
+  waitpid(pid, &status, 0);
+  return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+void Usage()
+{
+  std::cerr << "Usage: moses_benchmark [options]\n"
+            << "  --filter TEXT       only run benchmarks whose name contains TEXT\n"
+            << "  --min-time SECONDS  time each benchmark for at least this long (0.2)\n"
+            << "  --repetitions N     report the fastest of N timings (5)\n"
+            << "  --baseline FILE     compare with the output of an earlier run and fail on regressions\n"
+            << "  --tolerance F       slowdown allowed by --baseline, as a fraction (0.1)\n"
+            << "  --model-dir DIR     write the synthetic models to DIR and keep them\n";
+}
+
+}
+
+const SyntheticModel &GetSyntheticModel()
+{
+  return s_model;
+}
+
+Moses::Sentence *CreateSentence(const std::string &text)
+{
+  std::istringstream in(text + "\n");
+  Moses::Sentence *sentence = new Moses::Sentence();
+  sentence->Read(in, Moses::StaticData::Instance().GetInputFactorOrder());
+  return sentence;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+  using namespace MosesBenchmark;
+
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (i + 1 == argc) {
+      Usage();
+      return EXIT_FAILURE;
+    }
+    if (arg == "--filter") {
+      options.filter = argv[++i];
+    } else if (arg == "--min-time") {
+      options.minSeconds = Moses::Scan<double>(argv[++i]);
+    } else if (arg == "--repetitions") {
+      options.repetitions = std::max<size_t>(1, Moses::Scan<size_t>(argv[++i]));
+    } else if (arg == "--baseline") {
+      options.baseline = argv[++i];
+    } else if (arg == "--tolerance") {
+      options.tolerance = Moses::Scan<double>(argv[++i]);
+    } else if (arg == "--model-dir") {
+      options.modelDir = argv[++i];
+    } else {
+      Usage();
+      return EXIT_FAILURE;
+    }
+  }
+
+  try {
+    std::map<std::string, Result> baseline;
+    if (!options.baseline.empty()) {
+      baseline = ReadBaseline(options.baseline);
+    }
+
+    namespace fs = boost::filesystem;
+    fs::path dir = options.modelDir.empty()
+                   ? fs::temp_directory_path() / fs::unique_path("moses-benchmark-%%%%%%%%")
+                   : fs::path(options.modelDir);
+    fs::create_directories(dir);
+    WriteSyntheticModel(dir.string());
+
+    bool ok = true;
+    std::map<std::string, Result> results;
+    const Configuration configurations[] = {NoConfiguration, PhraseBased, Chart};
+    for (size_t c = 0; c < sizeof(configurations) / sizeof(Configuration); ++c) {
+      std::vector<Benchmark*> benchmarks;
+      const std::vector<Benchmark*> &all = Benchmark::GetAll();
+      for (size_t i = 0; i < all.size(); ++i) {
+        if (all[i]->GetConfiguration() == configurations[c]
+            && all[i]->GetName().find(options.filter) != std::string::npos) {
+          benchmarks.push_back(all[i]);
+        }
+      }
+      if (!benchmarks.empty() && !RunConfiguration(configurations[c], benchmarks, options, results)) {
+        std::cerr << "Benchmarks stopped early" << std::endl;
+        ok = false;
+      }
+    }
+
+    if (options.modelDir.empty()) {
+      fs::remove_all(dir);
+    }
+
+    std::map<std::string, Result>::const_iterator base;
+    for (base = baseline.begin(); base != baseline.end(); ++base) {
+      std::map<std::string, Result>::const_iterator result = results.find(base->first);
+      if (result == results.end()) continue;
+      if (result->second.nsPerOp > base->second.nsPerOp * (1 + options.tolerance)) {
+        std::cerr << "Regression: " << base->first << " takes " << result->second.nsPerOp
+                  << " ns/op, was " << base->second.nsPerOp << std::endl;
+        ok = false;
+      }
+      if (result->second.allocationsPerOp > base->second.allocationsPerOp + 0.005) {
+        std::cerr << "Regression: " << base->first << " makes " << result->second.allocationsPerOp
+                  << " allocs/op, was " << base->second.allocationsPerOp << std::endl;
+        ok = false;
+      }
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+  } catch (const std::exception &e) {
+    std::cerr << "Exception: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -52,8 +52,7 @@ ChartCellBase::~ChartCellBase() {}
 ChartCell::ChartCell(size_t startPos, size_t endPos, ChartManager &manager) :
   ChartCellBase(startPos, endPos), m_manager(manager)
 {
-  const StaticData &staticData = StaticData::Instance();
-  m_nBestIsEnabled = staticData.IsNBestEnabled();
+  m_nBestIsEnabled = manager.GetOptions().nBestEnabled;
 }
 
 ChartCell::~ChartCell() {}
@@ -87,8 +86,6 @@ void ChartCell::PruneToSize()
 void ChartCell::ProcessSentence(const ChartTranslationOptionList &transOptList
                                 , const ChartCellCollection &allChartCells)
 {
-  const StaticData &staticData = StaticData::Instance();
-
   // priority queue for applicable rules with selected hypotheses
   RuleCubeQueue queue(m_manager);
 
@@ -100,7 +97,7 @@ void ChartCell::ProcessSentence(const ChartTranslationOptionList &transOptList
   }
 
   // pluck things out of queue and add to hypo collection
-  const size_t popLimit = staticData.GetCubePruningPopLimit();
+  const size_t popLimit = m_manager.GetOptions().cubePruningPopLimit;
   for (size_t numPops = 0; numPops < popLimit && !queue.IsEmpty(); ++numPops) {
     ChartHypothesis *hypo = queue.Pop();
     AddHypothesis(hypo);
@@ -28,6 +28,7 @@
 #include "Phrase.h"
 #include "StaticData.h"
 #include "ChartTranslationOptions.h"
+#include "Profiler.h"
 #include "moses/FF/FFState.h"
 #include "moses/FF/StatefulFeatureFunction.h"
 #include "moses/FF/StatelessFeatureFunction.h"
@@ -64,6 +65,7 @@ ChartHypothesis::ChartHypothesis(const ChartTranslationOptions &transOpt,
   for (iter = childEntries.begin(); iter != childEntries.end(); ++iter) {
     m_prevHypos.push_back(iter->GetHypothesis());
   }
+  Profiler::Count(Profiler::HypothesisCreated);
 }
 
 // Intended to be used by ChartKBestExtractor only.  This creates a mock
@@ -234,6 +236,7 @@ void ChartHypothesis::EvaluateWhenApplied()
     StatelessFeatureFunction::GetStatelessFeatureFunctions();
   for (unsigned i = 0; i < sfs.size(); ++i) {
     if (! staticData.IsFeatureFunctionIgnored( *sfs[i] )) {
+      Profiler::Scope profile(*sfs[i], Profiler::EvaluateWhenApplied);
       sfs[i]->EvaluateWhenApplied(*this,&m_scoreBreakdown);
     }
   }
@@ -242,6 +245,7 @@ void ChartHypothesis::EvaluateWhenApplied()
     StatefulFeatureFunction::GetStatefulFeatureFunctions();
   for (unsigned i = 0; i < ffs.size(); ++i) {
     if (! staticData.IsFeatureFunctionIgnored( *ffs[i] )) {
+      Profiler::Scope profile(*ffs[i], Profiler::EvaluateWhenApplied);
       m_ffStates[i] = ffs[i]->EvaluateWhenApplied(*this,i,&m_scoreBreakdown);
     }
   }
@@ -291,9 +295,9 @@ void ChartHypothesis::CleanupArcList()
    * However, may not be enough if only unique candidates are needed,
    * so we'll keep all of arc list if nedd distinct n-best list
    */
-  const StaticData &staticData = StaticData::Instance();
-  size_t nBestSize = staticData.GetNBestSize();
-  bool distinctNBest = staticData.GetDistinctNBest() || staticData.UseMBR() || staticData.GetOutputSearchGraph() || staticData.GetOutputSearchGraphHypergraph();
+  const DecodingOptions &options = m_manager.GetOptions();
+  size_t nBestSize = options.nBestSize;
+  bool distinctNBest = options.KeepAllArcs();
 
   if (!distinctNBest && m_arcList->size() > nBestSize) {
     // prune arc list only if there too many arcs
@@ -25,6 +25,7 @@
 #include "ChartHypothesis.h"
 #include "ChartManager.h"
 #include "HypergraphOutput.h"
+#include "Profiler.h"
 #include "util/exception.hh"
 
 using namespace std;
@@ -35,11 +36,6 @@ namespace Moses
 
 ChartHypothesisCollection::ChartHypothesisCollection()
 {
-  const StaticData &staticData = StaticData::Instance();
-
-  m_beamWidth = staticData.GetBeamWidth();
-  m_maxHypoStackSize = staticData.GetMaxHypoStackSize();
-  m_nBestIsEnabled = staticData.IsNBestEnabled();
   m_bestScore = -std::numeric_limits<float>::infinity();
 }
 
@@ -69,7 +65,7 @@ bool ChartHypothesisCollection::AddHypothesis(ChartHypothesis *hypo, ChartManage
     return false;
   }
 
-  if (hypo->GetTotalScore() < m_bestScore + m_beamWidth) {
+  if (hypo->GetTotalScore() < m_bestScore + manager.GetOptions().beamWidth) {
     // really bad score. don't bother adding hypo into collection
     manager.GetSentenceStats().AddDiscarded();
     VERBOSE(3,"discarded, too bad for stack" << std::endl);
@@ -93,13 +89,14 @@ bool ChartHypothesisCollection::AddHypothesis(ChartHypothesis *hypo, ChartManage
 		  "Adding a hypothesis should have returned a valid iterator");
 
   //StaticData::Instance().GetSentenceStats().AddRecombination(*hypo, **iterExisting);
+  Profiler::Count(Profiler::HypothesisRecombined);
 
   // found existing hypo with same target ending.
   // keep the best 1
   if (hypo->GetTotalScore() > hypoExisting->GetTotalScore()) {
     // incoming hypo is better than the one we have
     VERBOSE(3,"better than matching hyp " << hypoExisting->GetId() << ", recombining, ");
-    if (m_nBestIsEnabled) {
+    if (manager.GetOptions().nBestEnabled) {
       hypo->AddArc(hypoExisting);
       Detach(iterExisting);
     } else {
@@ -115,7 +112,7 @@ bool ChartHypothesisCollection::AddHypothesis(ChartHypothesis *hypo, ChartManage
   } else {
     // already storing the best hypo. discard current hypo
     VERBOSE(3,"worse than matching hyp " << hypoExisting->GetId() << ", recombining" << std::endl)
-    if (m_nBestIsEnabled) {
+    if (manager.GetOptions().nBestEnabled) {
       hypoExisting->AddArc(hypo);
     } else {
       ChartHypothesis::Delete(hypo);
@@ -144,7 +141,7 @@ pair<ChartHypothesisCollection::HCType::iterator, bool> ChartHypothesisCollectio
 
     // Prune only if stack is twice as big as needed (lazy pruning)
     VERBOSE(3,", now size " << m_hypos.size());
-    if (m_hypos.size() > 2*m_maxHypoStackSize-1) {
+    if (m_hypos.size() > 2*manager.GetOptions().maxHypoStackSize-1) {
       PruneToSize(manager);
     } else {
       VERBOSE(3,std::endl);
@@ -185,25 +182,28 @@ void ChartHypothesisCollection::Remove(const HCType::iterator &iter)
   ChartHypothesis::Delete(h);
 }
 
-/** prune number of hypo to a particular number of hypos, specified by m_maxHypoStackSize, according to score
-  * Don't prune of hypos have identical scores on the boundary, so occasionally number of hypo can remain above m_maxHypoStackSize.
+/** prune number of hypo to a particular number of hypos, specified by the manager's maximum stack size, according to score
+  * Don't prune of hypos have identical scores on the boundary, so occasionally number of hypo can remain above the maximum.
   * \param manager reference back to manager. Used for collecting stats
  */
 void ChartHypothesisCollection::PruneToSize(ChartManager &manager)
 {
-  if (m_maxHypoStackSize == 0) return; // no limit
+  const size_t maxHypoStackSize = manager.GetOptions().maxHypoStackSize;
+  const float beamWidth = manager.GetOptions().beamWidth;
+
+  if (maxHypoStackSize == 0) return; // no limit
 
-  if (GetSize() > m_maxHypoStackSize) { // ok, if not over the limit
+  if (GetSize() > maxHypoStackSize) { // ok, if not over the limit
     priority_queue<float> bestScores;
 
     // push all scores to a heap
-    // (but never push scores below m_bestScore+m_beamWidth)
+    // (but never push scores below m_bestScore+beamWidth)
     HCType::iterator iter = m_hypos.begin();
     float score = 0;
     while (iter != m_hypos.end()) {
       ChartHypothesis *hypo = *iter;
       score = hypo->GetTotalScore();
-      if (score > m_bestScore+m_beamWidth) {
+      if (score > m_bestScore+beamWidth) {
         bestScores.push(score);
       }
       ++iter;
@@ -211,7 +211,7 @@ void ChartHypothesisCollection::PruneToSize(ChartManager &manager)
 
     // pop the top newSize scores (and ignore them, these are the scores of hyps that will remain)
     //  ensure to never pop beyond heap size
-    size_t minNewSizeHeapSize = m_maxHypoStackSize > bestScores.size() ? bestScores.size() : m_maxHypoStackSize;
+    size_t minNewSizeHeapSize = maxHypoStackSize > bestScores.size() ? bestScores.size() : maxHypoStackSize;
     for (size_t i = 1 ; i < minNewSizeHeapSize ; i++)
       bestScores.pop();
 
@@ -243,7 +243,7 @@ void ChartHypothesisCollection::PruneToSize(ChartManager &manager)
     }
 
     // desperation pruning
-    if (m_hypos.size() > m_maxHypoStackSize * 2) {
+    if (m_hypos.size() > maxHypoStackSize * 2) {
       std::vector<ChartHypothesis*> hyposOrdered;
 
       // sort hypos
@@ -252,7 +252,7 @@ void ChartHypothesisCollection::PruneToSize(ChartManager &manager)
 
       //keep only |size|. delete the rest
       std::vector<ChartHypothesis*>::iterator iter;
-      for (iter = hyposOrdered.begin() + (m_maxHypoStackSize * 2); iter != hyposOrdered.end(); ++iter) {
+      for (iter = hyposOrdered.begin() + (maxHypoStackSize * 2); iter != hyposOrdered.end(); ++iter) {
         ChartHypothesis *hypo = *iter;
         HCType::iterator iterFindHypo = m_hypos.find(hypo);
         UTIL_THROW_IF2(iterFindHypo == m_hypos.end(),
@@ -73,9 +73,6 @@ protected:
   HypoList m_hyposOrdered;
 
   float m_bestScore; /**< score of the best hypothesis in collection */
-  float m_beamWidth; /**< minimum score due to threashold pruning */
-  size_t m_maxHypoStackSize; /**< maximum number of hypothesis allowed in this stack */
-  bool m_nBestIsEnabled; /**< flag to determine whether to keep track of old arcs */
 
   std::pair<HCType::iterator, bool> Add(ChartHypothesis *hypo, ChartManager &manager);
 
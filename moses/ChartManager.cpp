@@ -26,6 +26,7 @@
 #include "ChartKBestExtractor.h"
 #include "ChartTranslationOptions.h"
 #include "HypergraphOutput.h"
+#include "Profiler.h"
 #include "StaticData.h"
 #include "DecodeStep.h"
 #include "TreeInput.h"
@@ -42,8 +43,11 @@ extern bool g_mosesDebug;
  * \param source the sentence to be decoded
  * \param system which particular set of models to use.
  */
-ChartManager::ChartManager(size_t lineNumber,InputType const& source)
-  :m_source(source)
+ChartManager::ChartManager(size_t lineNumber,InputType const& source,
+                           const DecodingOptions &options)
+  :m_options(options)
+  ,m_threadWeights(m_options) // before the parser initializes the features
+  ,m_source(source)
   ,m_hypoStackColl(source, *this)
   ,m_start(clock())
   ,m_hypothesisId(0)
@@ -60,6 +64,8 @@ ChartManager::~ChartManager()
   et /= (float)CLOCKS_PER_SEC;
   VERBOSE(1, "Translation took " << et << " seconds" << endl);
 
+  Profiler::Count(Profiler::Sentence);
+  Profiler::WriteIfRequested();
 }
 
 //! decode the sentence. This contains the main laps. Basically, the CKY++ algorithm
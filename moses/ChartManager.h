@@ -31,6 +31,7 @@
 #include "ChartTranslationOptionList.h"
 #include "ChartParser.h"
 #include "ChartKBestExtractor.h"
+#include "DecodingOptions.h"
 
 #include <boost/shared_ptr.hpp>
 
@@ -45,6 +46,8 @@ class ChartSearchGraphWriter;
 class ChartManager
 {
 private:
+  DecodingOptions m_options; /**< search settings for this sentence */
+  ThreadWeightsGuard m_threadWeights; /**< installs m_options.weights while the manager exists */
   InputType const& m_source; /**< source sentence to be translated */
   ChartCellCollection m_hypoStackColl;
   std::auto_ptr<SentenceStats> m_sentenceStats;
@@ -62,8 +65,12 @@ private:
   void WriteSearchGraph(const ChartSearchGraphWriter& writer) const;
 
 public:
-  ChartManager(size_t lineNumber, InputType const& source);
+  ChartManager(size_t lineNumber, InputType const& source,
+               const DecodingOptions &options = DecodingOptions());
   ~ChartManager();
+  const DecodingOptions &GetOptions() const {
+    return m_options;
+  }
   void ProcessSentence();
   void AddXmlChartOptions();
   const ChartHypothesis *GetBestHypothesis() const;
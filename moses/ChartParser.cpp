@@ -26,6 +26,7 @@
 #include "TreeInput.h"
 #include "Sentence.h"
 #include "DecodeGraph.h"
+#include "Profiler.h"
 #include "moses/FF/UnknownWordPenaltyProducer.h"
 #include "moses/TranslationModel/PhraseDictionary.h"
 
@@ -192,6 +193,9 @@ void ChartParser::Create(const WordsRange &wordsRange, ChartParserCallback &to)
         last = min(last, wordsRange.GetStartPos()+maxSpan);
     }
     if (maxSpan == 0 || wordsRange.GetNumWordsCovered() <= maxSpan) {
+      // lookup managers are in the order of the phrase dictionaries
+      const PhraseDictionary &dictionary = *PhraseDictionary::GetColl()[iterRuleLookupManagers - m_ruleLookupManagers.begin()];
+      Profiler::Scope profile(dictionary, Profiler::Lookup);
       ruleLookupManager.GetChartRuleCollection(wordsRange, last, to);
     }
   }
@@ -0,0 +1,120 @@
+// $Id$
+
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2014 University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#ifdef WITH_THREADS
+#include <boost/thread/tss.hpp>
+#endif
+
+#include "DecodingContext.h"
+#include "TranslationOptionList.h"
+
+namespace Moses
+{
+
+namespace
+{
+#ifdef WITH_THREADS
+boost::thread_specific_ptr<DecodingContext> s_local;
+#else
+DecodingContext *s_local = NULL;
+#endif
+}
+
+DecodingContext::DecodingContext()
+{
+  for (size_t i = 0; i < NUM_SIZE_CLASSES; ++i) {
+    m_free[i] = NULL;
+  }
+}
+
+DecodingContext::~DecodingContext()
+{
+  for (size_t i = 0; i < NUM_SIZE_CLASSES; ++i) {
+    while (m_free[i]) {
+      FreeBlock *block = m_free[i];
+      m_free[i] = block->next;
+      ::operator delete(block);
+    }
+  }
+}
+
+DecodingContext &DecodingContext::Local()
+{
+#ifdef WITH_THREADS
+  DecodingContext *context = s_local.get();
+  if (!context) {
+    context = new DecodingContext();
+    s_local.reset(context);
+  }
+  return *context;
+#else
+  if (!s_local) {
+    s_local = new DecodingContext();
+  }
+  return *s_local;
+#endif
+}
+
+void *DecodingContext::Allocate(size_t size)
+{
+  const size_t sizeClass = SizeClass(size);
+  if (sizeClass >= NUM_SIZE_CLASSES) {
+    return ::operator new(size);
+  }
+  FreeBlock *block = m_free[sizeClass];
+  if (block) {
+    m_free[sizeClass] = block->next;
+    return block;
+  }
+  // a whole class, so that the block can be reused for any size of the class
+  return ::operator new(sizeClass * GRANULARITY);
+}
+
+void DecodingContext::Free(void *ptr, size_t size)
+{
+  const size_t sizeClass = SizeClass(size);
+  if (sizeClass >= NUM_SIZE_CLASSES) {
+    ::operator delete(ptr);
+    return;
+  }
+  FreeBlock *block = static_cast<FreeBlock*>(ptr);
+  block->next = m_free[sizeClass];
+  m_free[sizeClass] = block;
+}
+
+void DecodingContext::TakeOptionMatrix(OptionMatrix &matrix)
+{
+  m_optionMatrix.swap(matrix);
+}
+
+void DecodingContext::ReturnOptionMatrix(OptionMatrix &matrix)
+{
+  for (size_t startPos = 0; startPos < matrix.size(); ++startPos) {
+    std::vector<TranslationOptionList> &row = matrix[startPos];
+    for (size_t i = 0; i < row.size(); ++i) {
+      row[i].RemoveAll();
+    }
+  }
+  // if another collection returned its matrix meanwhile, that one is dropped
+  m_optionMatrix.swap(matrix);
+}
+
+}
@@ -0,0 +1,160 @@
+// $Id$
+
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2014 University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#ifndef moses_DecodingContext_h
+#define moses_DecodingContext_h
+
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <vector>
+#include "TranslationOptionList.h"
+
+namespace Moses
+{
+
+/** Memory that a decoding thread keeps from one sentence to the next, so
+ * that decoding many short sentences does not spend its time allocating and
+ * freeing the same structures again. Each thread (eg. each worker of the
+ * thread pool in moses-cmd) has its own context, which the Manager and the
+ * translation option collection of a sentence take from the thread that
+ * creates them.
+ *
+ * Hypotheses and the nodes of the hypothesis stacks are allocated from free
+ * lists of small blocks, and the option matrix and future score matrix of
+ * the translation option collection are handed back here, emptied but with
+ * their capacity, when the collection is deleted. The context therefore
+ * holds on to as much memory as the largest sentence decoded so far needed.
+ */
+class DecodingContext
+{
+public:
+  typedef std::vector< std::vector< TranslationOptionList > > OptionMatrix;
+
+  //! allocator of the context, for containers that live during one sentence
+  template <class T> class Allocator;
+
+  DecodingContext();
+  ~DecodingContext();
+
+  //! the context of the calling thread
+  static DecodingContext &Local();
+
+  /** memory for an object of the given size, reusing a block given back
+   * with Free() if there is one. Blocks are allocated with operator new, so
+   * they may also be deleted directly */
+  void *Allocate(size_t size);
+  //! give back a block from Allocate() of the same size
+  void Free(void *ptr, size_t size);
+
+  /** swap the kept option matrix with matrix, which should be empty.
+   * The lists of the matrix are empty, but may have capacity */
+  void TakeOptionMatrix(OptionMatrix &matrix);
+  //! keep the matrix for the next sentence, after removing its options
+  void ReturnOptionMatrix(OptionMatrix &matrix);
+
+  //! memory for a future score matrix, see SquareMatrix::ReleaseBuffer()
+  std::vector<float> &GetFutureScoreBuffer() {
+    return m_futureScoreBuffer;
+  }
+
+private:
+  // blocks of up to MAX_POOLED_SIZE bytes are kept in a free list per multiple of GRANULARITY
+  static const size_t GRANULARITY = 16;
+  static const size_t MAX_POOLED_SIZE = 512;
+  static const size_t NUM_SIZE_CLASSES = MAX_POOLED_SIZE / GRANULARITY + 1;
+
+  struct FreeBlock {
+    FreeBlock *next;
+  };
+  FreeBlock *m_free[NUM_SIZE_CLASSES];
+
+  // empty blocks are in class 1, as freed blocks have to hold a FreeBlock
+  static size_t SizeClass(size_t size) {
+    return size ? (size + GRANULARITY - 1) / GRANULARITY : 1;
+  }
+
+  OptionMatrix m_optionMatrix;
+  std::vector<float> m_futureScoreBuffer;
+
+  DecodingContext(const DecodingContext &); // not implemented
+  DecodingContext &operator=(const DecodingContext &); // not implemented
+};
+
+template <class T> class DecodingContext::Allocator
+{
+public:
+  typedef T value_type;
+  typedef T *pointer;
+  typedef const T *const_pointer;
+  typedef T &reference;
+  typedef const T &const_reference;
+  typedef size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+
+  template <class U> struct rebind {
+    typedef Allocator<U> other;
+  };
+
+  explicit Allocator(DecodingContext &context) : m_context(&context) {}
+  template <class U> Allocator(const Allocator<U> &other) : m_context(&other.GetContext()) {}
+
+  DecodingContext &GetContext() const {
+    return *m_context;
+  }
+
+  pointer address(reference value) const {
+    return &value;
+  }
+  const_pointer address(const_reference value) const {
+    return &value;
+  }
+
+  pointer allocate(size_type n, const void * = 0) {
+    return static_cast<pointer>(m_context->Allocate(n * sizeof(T)));
+  }
+  void deallocate(pointer ptr, size_type n) {
+    m_context->Free(ptr, n * sizeof(T));
+  }
+  size_type max_size() const {
+    return std::numeric_limits<size_type>::max() / sizeof(T);
+  }
+
+  void construct(pointer ptr, const T &value) {
+    new (ptr) T(value);
+  }
+  void destroy(pointer ptr) {
+    ptr->~T();
+  }
+
+  template <class U> bool operator==(const Allocator<U> &other) const {
+    return m_context == &other.GetContext();
+  }
+  template <class U> bool operator!=(const Allocator<U> &other) const {
+    return m_context != &other.GetContext();
+  }
+
+private:
+  DecodingContext *m_context;
+};
+
+}
+#endif
@@ -0,0 +1,80 @@
+// $Id$
+
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2014 University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#include "DecodingOptions.h"
+#include "StaticData.h"
+#include "TranslationModel/PhraseDictionary.h"
+#include "util/exception.hh"
+
+namespace Moses
+{
+
+DecodingOptions::DecodingOptions()
+{
+  const StaticData &staticData = StaticData::Instance();
+  maxHypoStackSize = staticData.GetMaxHypoStackSize();
+  minHypoStackDiversity = staticData.GetMinHypoStackDiversity();
+  beamWidth = staticData.GetBeamWidth();
+  cubePruningPopLimit = staticData.GetCubePruningPopLimit();
+  cubePruningDiversity = staticData.GetCubePruningDiversity();
+
+  nBestEnabled = staticData.IsNBestEnabled();
+  nBestSize = staticData.GetNBestSize();
+  distinctNBest = staticData.GetDistinctNBest();
+  outputSearchGraph = staticData.GetOutputSearchGraph();
+}
+
+bool DecodingOptions::KeepAllArcs() const
+{
+  const StaticData &staticData = StaticData::Instance();
+  return distinctNBest || outputSearchGraph
+         || staticData.GetLatticeSamplesSize() || staticData.UseMBR() || staticData.UseLatticeMBR()
+         || staticData.GetOutputSearchGraphSLF() || staticData.GetOutputSearchGraphHypergraph();
+}
+
+ThreadWeightsGuard::ThreadWeightsGuard(const DecodingOptions &options)
+  :m_previous(NULL)
+  ,m_set(false)
+{
+  if (!options.weights) {
+    return;
+  }
+  const std::vector<PhraseDictionary*> &pts = PhraseDictionary::GetColl();
+  for (size_t i = 0; i < pts.size(); ++i) {
+    UTIL_THROW_IF2(pts[i]->ScoresWhenLoading(),
+                   pts[i]->GetScoreProducerDescription()
+                   << " scored its phrases with the configured weights when it was loaded,"
+                   << " so the weights cannot be overridden for a single input");
+  }
+  const StaticData &staticData = StaticData::Instance();
+  m_previous = staticData.GetThreadWeights();
+  staticData.SetThreadWeights(options.weights.get());
+  m_set = true;
+}
+
+ThreadWeightsGuard::~ThreadWeightsGuard()
+{
+  if (m_set) {
+    StaticData::Instance().SetThreadWeights(m_previous);
+  }
+}
+
+}
@@ -0,0 +1,86 @@
+// $Id$
+
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2014 University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#ifndef moses_DecodingOptions_h
+#define moses_DecodingOptions_h
+
+#include <cstddef>
+#include <boost/shared_ptr.hpp>
+
+namespace Moses
+{
+
+class ScoreComponentCollection;
+
+/** Search settings for a single input.
+ * The defaults are those of the configuration (StaticData), but a Manager or
+ * ChartManager reads them from its own copy, so inputs that are decoded at
+ * the same time (eg. requests to the server) can use different settings
+ * without changing StaticData.
+ */
+struct DecodingOptions {
+  size_t maxHypoStackSize;
+  size_t minHypoStackDiversity;
+  float beamWidth; /**< log score, as in StaticData::GetBeamWidth() */
+  size_t cubePruningPopLimit;
+  size_t cubePruningDiversity;
+
+  bool nBestEnabled; /**< keep the arcs needed for n-best lists and search graphs */
+  size_t nBestSize;
+  bool distinctNBest;
+  bool outputSearchGraph;
+
+  /** weights that replace StaticData::GetAllWeights() while decoding this
+   * input, or NULL to use the configured weights. Phrase table caches are
+   * keyed on them, and tables that score their phrases when they are
+   * loaded do not accept them (see ThreadWeightsGuard). */
+  boost::shared_ptr<const ScoreComponentCollection> weights;
+
+  //! settings from StaticData
+  DecodingOptions();
+
+  //! whether all arcs have to be kept, rather than just those of the n best
+  bool KeepAllArcs() const;
+};
+
+/** Installs the weights of a DecodingOptions, if it has any, as the weights
+ * of the calling thread (StaticData::SetThreadWeights()) and restores the
+ * previous ones when it goes out of scope. Manager and ChartManager hold
+ * one, so the weights are also restored if their constructor throws.
+ * Throws if a phrase table scored its phrases with the configured weights
+ * when it was loaded, as those scores cannot follow the override.
+ */
+class ThreadWeightsGuard
+{
+public:
+  explicit ThreadWeightsGuard(const DecodingOptions &options);
+  ~ThreadWeightsGuard();
+
+private:
+  const ScoreComponentCollection *m_previous;
+  bool m_set;
+
+  ThreadWeightsGuard(const ThreadWeightsGuard&);
+  void operator=(const ThreadWeightsGuard&);
+};
+
+}
+#endif
@@ -4,6 +4,7 @@
 #include "moses/TranslationModel/PhraseDictionaryTreeAdaptor.h"
 #include "moses/TranslationModel/RuleTable/PhraseDictionaryOnDisk.h"
 #include "moses/TranslationModel/PhraseDictionaryMemory.h"
+#include "moses/TranslationModel/PhraseDictionaryMemoryShared.h"
 #include "moses/TranslationModel/PhraseDictionaryMultiModel.h"
 #include "moses/TranslationModel/PhraseDictionaryMultiModelCounts.h"
 #include "moses/TranslationModel/RuleTable/PhraseDictionaryALSuffixArray.h"
@@ -155,6 +156,20 @@ public:
   }
 };
 
+class PhraseDictionaryMemoryFactory : public FeatureFactory
+{
+public:
+  void Create(const std::string &line) {
+    // with shared-model-dir, phrase-based decoding maps the table from an image
+    const StaticData &staticData = StaticData::Instance();
+    if (!staticData.GetSharedModelDir().empty() && !staticData.IsChart()) {
+      DefaultSetup(new PhraseDictionaryMemoryShared(line));
+    } else {
+      DefaultSetup(new PhraseDictionaryMemory(line));
+    }
+  }
+};
+
 } // namespace
 
 FeatureRegistry::FeatureRegistry()
@@ -166,7 +181,7 @@ FeatureRegistry::FeatureRegistry()
 
   MOSES_FNAME2("PhraseDictionaryBinary", PhraseDictionaryTreeAdaptor);
   MOSES_FNAME(PhraseDictionaryOnDisk);
-  MOSES_FNAME(PhraseDictionaryMemory);
+  Add("PhraseDictionaryMemory", new PhraseDictionaryMemoryFactory());
   MOSES_FNAME(PhraseDictionaryScope3);
   MOSES_FNAME(PhraseDictionaryMultiModel);
   MOSES_FNAME(PhraseDictionaryMultiModelCounts);
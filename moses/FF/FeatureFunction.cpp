@@ -66,6 +66,7 @@ Initialize(const std::string &line)
   ParseLine(line);
 
   ScoreComponentCollection::RegisterScoreProducer(this);
+  m_index = s_staticColl.size();
   s_staticColl.push_back(this);
 }
 
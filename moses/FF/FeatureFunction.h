@@ -35,6 +35,7 @@ protected:
   std::vector<std::vector<std::string> > m_args;
   bool m_tuneable;
   size_t m_numScoreComponents;
+  size_t m_index; //! position in s_staticColl
   //In case there's multiple producers with the same description
   static std::multiset<std::string> description_counts;
 
@@ -69,6 +70,11 @@ public:
     return m_numScoreComponents;
   }
 
+  //! position of this feature function in GetFeatureFunctions()
+  size_t GetIndex() const {
+    return m_index;
+  }
+
   //! returns a string description of this producer
   const std::string& GetScoreProducerDescription() const {
     return m_description;
@@ -6,6 +6,7 @@
 #include "moses/UserMessage.h"
 #include "moses/FactorCollection.h"
 #include "util/exception.hh"
+#include <algorithm>
 
 using namespace std;
 
@@ -60,6 +61,25 @@ void GlobalLexicalModel::Load()
 
   m_inputFactors = FactorMask(m_inputFactorsVec);
   m_outputFactors = FactorMask(m_outputFactorsVec);
+
+  if (GlobalLexicalModelBinary::IsBinary(m_filePath)) {
+    m_binary.reset(new GlobalLexicalModelBinary(m_filePath));
+
+    m_biasSums.assign(m_binary->GetOutputSize(), 0);
+    const GlobalLexicalModelBinary::Weight *begin, *end;
+    if (m_binary->GetWeights(GlobalLexicalModelBinary::HashWord("**BIAS**"), begin, end)) {
+      for (; begin != end; ++begin) {
+        m_biasSums[begin->output] = begin->weight;
+      }
+    }
+    m_biasScores.resize(m_biasSums.size());
+    for (size_t i = 0; i < m_biasSums.size(); ++i) {
+      m_biasScores[i] = FloorScore( log(1/(1+exp(-m_biasSums[i]))) );
+    }
+    m_unknownScore = FloorScore( log(1/(1+exp(-0.0f))) );
+    return;
+  }
+
   InputFileStream inFile(m_filePath);
 
   // reading in data one line at a time
@@ -109,10 +129,109 @@ void GlobalLexicalModel::Load()
   }
 }
 
-void GlobalLexicalModel::InitializeForInput( Sentence const& in )
+void GlobalLexicalModel::InitializeForInput( InputType const& in )
 {
-  m_local.reset(new ThreadLocalStorage);
-  m_local->input = &in;
+  const Sentence *sentence = dynamic_cast<const Sentence*>(&in);
+  UTIL_THROW_IF2(sentence == NULL, "Global lexical model only supports sentence input");
+
+  if (m_local.get() == NULL) {
+    m_local.reset(new ThreadLocalStorage);
+  }
+  m_local->cache.clear();
+  m_local->input = sentence;
+
+  if (m_binary.get()) {
+    InitializeSums(*sentence);
+  }
+}
+
+uint64_t GlobalLexicalModel::HashWord(const Word &word, const std::vector<FactorType> &factors) const
+{
+  if (factors.size() == 1) {
+    const Factor *factor = word[factors[0]];
+    return GlobalLexicalModelBinary::HashWord(factor ? factor->GetString() : StringPiece());
+  }
+  // as written in the model
+  const std::string& factorDelimiter = StaticData::Instance().GetFactorDelimiter();
+  std::string str;
+  for (size_t i = 0; i < factors.size(); ++i) {
+    if (i) str += factorDelimiter;
+    const Factor *factor = word[factors[i]];
+    if (factor) str += factor->GetString().as_string();
+  }
+  return GlobalLexicalModelBinary::HashWord(str);
+}
+
+void GlobalLexicalModel::InitializeSums(const Sentence &input) const
+{
+  ThreadLocalStorage &local = *m_local;
+  if (local.sums.empty()) {
+    local.sums = m_biasSums;
+    local.scores = m_biasScores;
+    local.isTouched.assign(m_biasSums.size(), false);
+  }
+
+  // undo the previous sentence
+  for (size_t i = 0; i < local.touched.size(); ++i) {
+    const uint32_t output = local.touched[i];
+    local.sums[output] = m_biasSums[output];
+    local.scores[output] = m_biasScores[output];
+    local.isTouched[output] = false;
+  }
+  local.touched.clear();
+
+  std::vector<uint64_t> alreadyScored; // do not score a word twice
+  for(size_t inputIndex = 0; inputIndex < input.GetSize(); inputIndex++ ) {
+    const uint64_t inputHash = HashWord(input.GetWord(inputIndex), m_inputFactorsVec);
+    if (std::find(alreadyScored.begin(), alreadyScored.end(), inputHash) != alreadyScored.end()) {
+      continue;
+    }
+    alreadyScored.push_back(inputHash);
+
+    const GlobalLexicalModelBinary::Weight *begin, *end;
+    if (!m_binary->GetWeights(inputHash, begin, end)) {
+      continue;
+    }
+    for (; begin != end; ++begin) {
+      local.sums[begin->output] += begin->weight;
+      if (!local.isTouched[begin->output]) {
+        local.isTouched[begin->output] = true;
+        local.touched.push_back(begin->output);
+      }
+    }
+  }
+
+  for (size_t i = 0; i < local.touched.size(); ++i) {
+    const uint32_t output = local.touched[i];
+    local.scores[output] = FloorScore( log(1/(1+exp(-local.sums[output]))) );
+  }
+}
+
+boost::shared_ptr<std::vector<uint32_t> > GlobalLexicalModel::GetOutputIds( const TargetPhrase& targetPhrase ) const
+{
+  boost::shared_ptr<std::vector<uint32_t> > ids(new std::vector<uint32_t>(targetPhrase.GetSize()));
+  for(size_t targetIndex = 0; targetIndex < targetPhrase.GetSize(); targetIndex++ ) {
+    (*ids)[targetIndex] = m_binary->GetOutputId(HashWord(targetPhrase.GetWord(targetIndex), m_outputFactorsVec));
+  }
+  return ids;
+}
+
+float GlobalLexicalModel::ScorePhraseBinary( const TargetPhrase& targetPhrase ) const
+{
+  boost::shared_ptr<std::vector<uint32_t> > computed;
+  const std::vector<uint32_t> *ids = static_cast<const std::vector<uint32_t>*>(targetPhrase.GetFFData(this));
+  if (ids == NULL) {
+    computed = GetOutputIds(targetPhrase);
+    ids = computed.get();
+  }
+
+  const std::vector<float> &scores = m_local->scores;
+  float score = 0;
+  for (size_t i = 0; i < ids->size(); ++i) {
+    const uint32_t output = (*ids)[i];
+    score += (output == GlobalLexicalModelBinary::NOT_FOUND_ID) ? m_unknownScore : scores[output];
+  }
+  return score;
 }
 
 float GlobalLexicalModel::ScorePhrase( const TargetPhrase& targetPhrase ) const
@@ -170,7 +289,24 @@ void GlobalLexicalModel::EvaluateInIsolation(const Phrase &source
               , ScoreComponentCollection &scoreBreakdown
               , ScoreComponentCollection &estimatedFutureScore) const
 {
-	scoreBreakdown.PlusEquals( this, GetFromCacheOrScorePhrase(targetPhrase) );
+  // the score needs the input. Look up the words once for all sentences
+  if (m_binary.get()) {
+    targetPhrase.SetFFData(this, GetOutputIds(targetPhrase));
+  }
+}
+
+void GlobalLexicalModel::EvaluateWithSourceContext(const InputType &input
+              , const InputPath &inputPath
+              , const TargetPhrase &targetPhrase
+              , const StackVec *stackVec
+              , ScoreComponentCollection &scoreBreakdown
+              , ScoreComponentCollection *estimatedFutureScore) const
+{
+  if (m_binary.get()) {
+    scoreBreakdown.PlusEquals( this, ScorePhraseBinary(targetPhrase) );
+  } else {
+    scoreBreakdown.PlusEquals( this, GetFromCacheOrScorePhrase(targetPhrase) );
+  }
 }
 
 bool GlobalLexicalModel::IsUseable(const FactorMask &mask) const
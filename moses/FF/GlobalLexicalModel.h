@@ -13,6 +13,9 @@
 #include "moses/WordsRange.h"
 #include "moses/FactorTypeSet.h"
 #include "moses/Sentence.h"
+#include "GlobalLexicalModelBinary.h"
+
+#include <boost/shared_ptr.hpp>
 
 #ifdef WITH_THREADS
 #include <boost/thread/tss.hpp>
@@ -30,6 +33,10 @@ class InputType;
  * This is a implementation of Mauser et al., 2009's model that predicts
  * each output word from _all_ the input words. The intuition behind this
  * feature is that it uses context words for disambiguation
+ *
+ * If path is a binary model made by processGlobalLexicalModel, the scores of
+ * all output words are computed once per sentence and a phrase is scored
+ * by looking up its words.
  */
 class GlobalLexicalModel : public StatelessFeatureFunction
 {
@@ -40,6 +47,11 @@ class GlobalLexicalModel : public StatelessFeatureFunction
   struct ThreadLocalStorage {
     LexiconCache cache;
     const Sentence *input;
+
+    // binary model: scores of the output words given the input, by output id
+    std::vector<float> sums, scores;
+    std::vector<uint32_t> touched;
+    std::vector<bool> isTouched;
   };
 
 private:
@@ -51,6 +63,11 @@ private:
 #endif
   Word *m_bias;
 
+  std::auto_ptr<GlobalLexicalModelBinary> m_binary;
+  // binary model: sums and scores of the output words from the bias alone
+  std::vector<float> m_biasSums, m_biasScores;
+  float m_unknownScore;
+
   FactorMask m_inputFactors, m_outputFactors;
   std::vector<FactorType> m_inputFactorsVec, m_outputFactorsVec;
   std::string m_filePath;
@@ -60,13 +77,18 @@ private:
   float ScorePhrase( const TargetPhrase& targetPhrase ) const;
   float GetFromCacheOrScorePhrase( const TargetPhrase& targetPhrase ) const;
 
+  uint64_t HashWord(const Word &word, const std::vector<FactorType> &factors) const;
+  void InitializeSums(const Sentence &input) const;
+  boost::shared_ptr<std::vector<uint32_t> > GetOutputIds(const TargetPhrase& targetPhrase) const;
+  float ScorePhraseBinary(const TargetPhrase& targetPhrase) const;
+
 public:
   GlobalLexicalModel(const std::string &line);
   virtual ~GlobalLexicalModel();
 
   void SetParameter(const std::string& key, const std::string& value);
 
-  void InitializeForInput( Sentence const& in );
+  void InitializeForInput( InputType const& in );
 
   bool IsUseable(const FactorMask &mask) const;
 
@@ -87,8 +109,7 @@ public:
                 , const TargetPhrase &targetPhrase
                 , const StackVec *stackVec
                 , ScoreComponentCollection &scoreBreakdown
-                , ScoreComponentCollection *estimatedFutureScore = NULL) const
-  {}
+                , ScoreComponentCollection *estimatedFutureScore = NULL) const;
 
 };
 
@@ -0,0 +1,165 @@
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include <boost/unordered_map.hpp>
+#include "GlobalLexicalModelBinary.h"
+#include "moses/InputFileStream.h"
+#include "moses/Util.h"
+#include "util/exception.hh"
+#include "util/file.hh"
+#include "util/murmur_hash.hh"
+#include "util/tokenize_piece.hh"
+
+using namespace std;
+
+namespace Moses
+{
+
+namespace
+{
+const char MAGIC[8] = {'m', 'o', 's', 'e', 's', 'G', 'L', '1'};
+
+// for sorting the weights of an input word by output, keeping the file order of duplicates
+struct WeightOrder {
+  bool operator()(const GlobalLexicalModelBinary::Weight &a, const GlobalLexicalModelBinary::Weight &b) const {
+    return a.output < b.output;
+  }
+};
+}
+
+struct GlobalLexicalModelBinary::Header {
+  char magic[8];
+  uint64_t outputSize;
+  uint64_t outputBytes, inputBytes, weights;
+};
+
+uint64_t GlobalLexicalModelBinary::HashWord(const StringPiece &word)
+{
+  uint64_t hash = util::MurmurHashNative(word.data(), word.size());
+  // 0 marks empty buckets
+  return hash ? hash : 1;
+}
+
+bool GlobalLexicalModelBinary::IsBinary(const std::string &path)
+{
+  util::scoped_fd fd(util::OpenReadOrThrow(path.c_str()));
+  char magic[sizeof(MAGIC)];
+  return util::ReadOrEOF(fd.get(), magic, sizeof(MAGIC)) == sizeof(MAGIC)
+         && !memcmp(magic, MAGIC, sizeof(MAGIC));
+}
+
+void GlobalLexicalModelBinary::Create(const std::string &textPath, const std::string &binaryPath)
+{
+  boost::unordered_map<uint64_t, uint32_t> outputIds;
+  boost::unordered_map<uint64_t, vector<Weight> > inputs;
+  size_t numWeights = 0;
+
+  InputFileStream inFile(textPath);
+  size_t lineNum = 0;
+  string line;
+  while(getline(inFile, line)) {
+    ++lineNum;
+    StringPiece token[3];
+    size_t numTokens = 0;
+    for (util::TokenIter<util::SingleCharacter, true> it(line, ' '); it; ++it, ++numTokens) {
+      if (numTokens < 3) token[numTokens] = *it;
+    }
+    UTIL_THROW_IF2(numTokens != 3, "Syntax error at " << textPath << ":" << lineNum << ":" << line);
+    const StringPiece &output = token[0], &input = token[1], &score = token[2];
+
+    Weight weight;
+    weight.output = outputIds.insert(make_pair(HashWord(output), (uint32_t) outputIds.size())).first->second;
+    weight.weight = Scan<float>(score.as_string());
+    inputs[HashWord(input)].push_back(weight);
+    ++numWeights;
+  }
+
+  Header header;
+  memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.outputSize = outputIds.size();
+  header.outputBytes = OutputTable::Size(outputIds.size(), 1.5);
+  header.inputBytes = InputTable::Size(inputs.size(), 1.5);
+
+  vector<char> outputMem(header.outputBytes), inputMem(header.inputBytes);
+  OutputTable outputTable(&outputMem[0], outputMem.size());
+  InputTable inputTable(&inputMem[0], inputMem.size());
+  outputTable.Clear();
+  inputTable.Clear();
+
+  for (boost::unordered_map<uint64_t, uint32_t>::const_iterator i = outputIds.begin(); i != outputIds.end(); ++i) {
+    OutputEntry entry;
+    entry.key = i->first;
+    entry.id = i->second;
+    outputTable.Insert(entry);
+  }
+
+  vector<Weight> weights;
+  weights.reserve(numWeights);
+  boost::unordered_map<uint64_t, vector<Weight> >::iterator iter;
+  for (iter = inputs.begin(); iter != inputs.end(); ++iter) {
+    // a repeated pair overrides earlier ones, as in the text model
+    vector<Weight> &from = iter->second;
+    stable_sort(from.begin(), from.end(), WeightOrder());
+    InputEntry entry;
+    entry.key = iter->first;
+    entry.begin = weights.size();
+    for (size_t i = 0; i < from.size(); ++i) {
+      if (i + 1 < from.size() && from[i + 1].output == from[i].output) continue;
+      weights.push_back(from[i]);
+    }
+    entry.end = weights.size();
+    inputTable.Insert(entry);
+  }
+  header.weights = weights.size();
+
+  util::scoped_fd out(util::CreateOrThrow(binaryPath.c_str()));
+  util::WriteOrThrow(out.get(), &header, sizeof(Header));
+  util::WriteOrThrow(out.get(), &outputMem[0], outputMem.size());
+  util::WriteOrThrow(out.get(), &inputMem[0], inputMem.size());
+  if (!weights.empty()) {
+    util::WriteOrThrow(out.get(), &weights[0], weights.size() * sizeof(Weight));
+  }
+}
+
+GlobalLexicalModelBinary::GlobalLexicalModelBinary(const std::string &path)
+{
+  util::scoped_fd fd(util::OpenReadOrThrow(path.c_str()));
+  const uint64_t size = util::SizeOrThrow(fd.get());
+  UTIL_THROW_IF2(size < sizeof(Header), path << " is too small to be a binary global lexical model");
+  util::MapRead(util::POPULATE_OR_READ, fd.get(), 0, size, m_memory);
+
+  const Header &header = *reinterpret_cast<const Header*>(m_memory.get());
+  UTIL_THROW_IF2(memcmp(header.magic, MAGIC, sizeof(MAGIC)), path << " is not a binary global lexical model");
+  UTIL_THROW_IF2(size != sizeof(Header) + header.outputBytes + header.inputBytes + header.weights * sizeof(Weight),
+                 path << " has the wrong size, it may be truncated");
+
+  char *base = static_cast<char*>(m_memory.get()) + sizeof(Header);
+  m_outputSize = header.outputSize;
+  m_outputs = OutputTable(base, header.outputBytes);
+  base += header.outputBytes;
+  m_inputs = InputTable(base, header.inputBytes);
+  base += header.inputBytes;
+  m_weights = reinterpret_cast<const Weight*>(base);
+}
+
+uint32_t GlobalLexicalModelBinary::GetOutputId(uint64_t hash) const
+{
+  OutputTable::ConstIterator entry;
+  if (m_outputs.Find(hash, entry)) {
+    return entry->id;
+  }
+  return NOT_FOUND_ID;
+}
+
+bool GlobalLexicalModelBinary::GetWeights(uint64_t inputHash, const Weight *&begin, const Weight *&end) const
+{
+  InputTable::ConstIterator entry;
+  if (!m_inputs.Find(inputHash, entry)) {
+    return false;
+  }
+  begin = m_weights + entry->begin;
+  end = m_weights + entry->end;
+  return true;
+}
+
+}
@@ -0,0 +1,89 @@
+#ifndef moses_GlobalLexicalModelBinary_h
+#define moses_GlobalLexicalModelBinary_h
+
+#include <string>
+
+#include <stdint.h>
+
+#include "util/mmap.hh"
+#include "util/probing_hash_table.hh"
+#include "util/string_piece.hh"
+
+namespace Moses
+{
+
+/** Global lexical model weights in a flat file that is mapped into memory.
+ * Weights are grouped by input word, so all weights that depend on a
+ * sentence are found with one probe per input word.  Output words are
+ * numbered densely so that feature functions can keep per sentence arrays.
+ * Words are identified by a hash of their factor strings, as written in the
+ * text model.
+ */
+class GlobalLexicalModelBinary
+{
+public:
+  static const uint32_t NOT_FOUND_ID = 0xffffffff;
+
+  struct Weight {
+    uint32_t output;
+    float weight;
+  };
+
+  // Convert the text model, one "output input weight" line each
+  static void Create(const std::string &textPath, const std::string &binaryPath);
+
+  static bool IsBinary(const std::string &path);
+
+  static uint64_t HashWord(const StringPiece &word);
+
+  explicit GlobalLexicalModelBinary(const std::string &path);
+
+  size_t GetOutputSize() const {
+    return m_outputSize;
+  }
+
+  // dense id of an output word, or NOT_FOUND_ID
+  uint32_t GetOutputId(uint64_t hash) const;
+
+  // the weights of all output words given an input word
+  bool GetWeights(uint64_t inputHash, const Weight *&begin, const Weight *&end) const;
+
+private:
+  struct OutputEntry {
+    typedef uint64_t Key;
+    uint64_t key;
+    uint64_t id;
+    uint64_t GetKey() const {
+      return key;
+    }
+    void SetKey(uint64_t to) {
+      key = to;
+    }
+  };
+
+  struct InputEntry {
+    typedef uint64_t Key;
+    uint64_t key;
+    uint64_t begin, end;
+    uint64_t GetKey() const {
+      return key;
+    }
+    void SetKey(uint64_t to) {
+      key = to;
+    }
+  };
+
+  typedef util::ProbingHashTable<OutputEntry, util::IdentityHash> OutputTable;
+  typedef util::ProbingHashTable<InputEntry, util::IdentityHash> InputTable;
+
+  struct Header;
+
+  util::scoped_memory m_memory;
+  size_t m_outputSize;
+  OutputTable m_outputs;
+  InputTable m_inputs;
+  const Weight *m_weights;
+};
+
+}
+#endif
@@ -83,6 +83,11 @@ Scores LexicalReordering::GetProb(const Phrase& f, const Phrase& e) const
   return m_table->GetScore(f, e, Phrase(ARRAY_SIZE_INCR));
 }
 
+void LexicalReordering::GetProbs(const Phrase& f, const std::vector<const Phrase*>& e, std::vector<Scores>& scores) const
+{
+  m_table->GetScores(f, e, scores);
+}
+
 FFState* LexicalReordering::EvaluateWhenApplied(const Hypothesis& hypo,
                                      const FFState* prev_state,
                                      ScoreComponentCollection* out) const
@@ -44,6 +44,8 @@ public:
   }
 
   Scores GetProb(const Phrase& f, const Phrase& e) const;
+  //! scores[i] for each e[i], all translations of f at once
+  void GetProbs(const Phrase& f, const std::vector<const Phrase*>& e, std::vector<Scores>& scores) const;
 
   virtual FFState* EvaluateWhenApplied(const Hypothesis& cur_hypo,
                             const FFState* prev_state,
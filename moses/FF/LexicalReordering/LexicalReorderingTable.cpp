@@ -7,6 +7,10 @@
 #include "moses/GenerationDictionary.h"
 #include "moses/TargetPhrase.h"
 #include "moses/TargetPhraseCollection.h"
+#include "util/exception.hh"
+#include "util/tokenize_piece.hh"
+
+#include <boost/functional/hash.hpp>
 
 #if !defined WIN32 || defined __MINGW32__ || defined HAVE_CMPH
 #include "moses/TranslationModel/CompactPT/LexicalReorderingTableCompact.h"
@@ -58,15 +62,28 @@ LexicalReorderingTable* LexicalReorderingTable::LoadAvailable(const std::string&
 #endif
   if(compactLexr)
     return compactLexr;
+  const std::string& sharedDir = StaticData::Instance().GetSharedModelDir();
   if(FileExists(filePath+".binlexr.idx")) {
     //there exists a binary version use that
     return new LexicalReorderingTableTree(filePath, f_factors, e_factors, c_factors);
+  } else if(!sharedDir.empty()) {
+    //build the text table once, then share it between processes
+    return new LexicalReorderingTableShared(filePath, sharedDir, f_factors, e_factors, c_factors);
   } else {
     //use plain memory
     return new LexicalReorderingTableMemory(filePath, f_factors, e_factors, c_factors);
   }
 }
 
+void LexicalReorderingTable::GetScores(const Phrase& f, const std::vector<const Phrase*>& e, std::vector<Scores>& scores)
+{
+  const Phrase empty(ARRAY_SIZE_INCR);
+  scores.resize(e.size());
+  for(size_t i = 0; i < e.size(); ++i) {
+    scores[i] = GetScore(f, *e[i], empty);
+  }
+}
+
 /*
  * functions for LexicalReorderingTableMemory
  */
@@ -75,7 +92,7 @@ LexicalReorderingTableMemory::LexicalReorderingTableMemory(
   const std::vector<FactorType>& f_factors,
   const std::vector<FactorType>& e_factors,
   const std::vector<FactorType>& c_factors)
-  : LexicalReorderingTable(f_factors, e_factors, c_factors)
+  : LexicalReorderingTable(f_factors, e_factors, c_factors), m_NumScores(0)
 {
   LoadFromFile(filePath);
 }
@@ -84,91 +101,117 @@ LexicalReorderingTableMemory::~LexicalReorderingTableMemory()
 {
 }
 
-std::vector<float>  LexicalReorderingTableMemory::GetScore(const Phrase& f,
-    const Phrase& e,
-    const Phrase& c)
+size_t LexicalReorderingTableMemory::KeyHash::operator()(const Key& key) const
 {
-  //rather complicated because of const can't use []... as [] might enter new things into std::map
-  //also can't have to be careful with words range if c is empty can't use c.GetSize()-1 will underflow and be large
-  TableType::const_iterator r;
-  std::string key;
-  if(0 == c.GetSize()) {
-    key = MakeKey(f,e,c);
-    r = m_Table.find(key);
-    if(m_Table.end() != r) {
-      return r->second;
-    }
-  } else {
-    //right try from large to smaller context
-    for(size_t i = 0; i <= c.GetSize(); ++i) {
-      Phrase sub_c(c.GetSubString(WordsRange(i,c.GetSize()-1)));
-      key = MakeKey(f,e,sub_c);
-      r = m_Table.find(key);
-      if(m_Table.end() != r) {
-        return r->second;
-      }
+  return boost::hash_range(key.begin(), key.end());
+}
+
+void LexicalReorderingTableMemory::AppendKey(const Phrase& p, const FactorList& factors, Key& key) const
+{
+  for(size_t i = 0; i < p.GetSize(); ++i) {
+    const Word& word = p.GetWord(i);
+    for(size_t j = 0; j < factors.size(); ++j) {
+      key.push_back(word[factors[j]]);
     }
   }
-  return Scores();
 }
 
-void LexicalReorderingTableMemory::DbgDump(std::ostream* out) const
+void LexicalReorderingTableMemory::AppendKey(const std::string& p, FactorDirection direction, const FactorList& factors, Key& key) const
 {
-  TableType::const_iterator i;
-  for(i = m_Table.begin(); i != m_Table.end(); ++i) {
-    *out << " key: '" << i->first << "' score: ";
-    *out << "(num scores: " << (i->second).size() << ")";
-    for(size_t j = 0; j < (i->second).size(); ++j) {
-      *out << (i->second)[j] << " ";
+  Word word;
+  for (util::TokenIter<util::AnyCharacter, true> it(p, "\t "); it; ++it) {
+    word.CreateFromString(direction, factors, *it, false, false);
+    for(size_t j = 0; j < factors.size(); ++j) {
+      key.push_back(word[factors[j]]);
     }
-    *out << "\n";
   }
-};
+}
 
-std::string  LexicalReorderingTableMemory::MakeKey(const Phrase& f,
-    const Phrase& e,
-    const Phrase& c) const
+void LexicalReorderingTableMemory::MakeTargetKey(const Phrase& e, const Phrase& c, Key& key) const
 {
-  /*
-  std::string key;
-  if(!m_FactorsF.empty()){
-    key += f.GetStringRep(m_FactorsF);
+  key.clear();
+  AppendKey(e, m_FactorsE, key);
+  if(!m_FactorsC.empty()) {
+    key.push_back(NULL);
+    AppendKey(c, m_FactorsC, key);
   }
-  if(!m_FactorsE.empty()){
-    if(!key.empty()){
-      key += " ||| ";
-    }
-    key += e.GetStringRep(m_FactorsE);
+}
+
+Scores LexicalReorderingTableMemory::Lookup(const TargetMap& targets, const Key& key) const
+{
+  TargetMap::const_iterator r = targets.find(key);
+  if(targets.end() == r) {
+    return Scores();
   }
-  */
-  return MakeKey(auxClearString(f.GetStringRep(m_FactorsF)),
-                 auxClearString(e.GetStringRep(m_FactorsE)),
-                 auxClearString(c.GetStringRep(m_FactorsC)));
+  std::vector<float>::const_iterator begin = m_Scores.begin() + r->second;
+  return Scores(begin, begin + m_NumScores);
 }
 
-std::string  LexicalReorderingTableMemory::MakeKey(const std::string& f,
-    const std::string& e,
-    const std::string& c) const
+std::vector<float>  LexicalReorderingTableMemory::GetScore(const Phrase& f,
+    const Phrase& e,
+    const Phrase& c)
 {
-  std::string key;
-  if(!f.empty()) {
-    key += f;
+  Key key;
+  AppendKey(f, m_FactorsF, key);
+  TableType::const_iterator source = m_Table.find(key);
+  if(m_Table.end() == source) {
+    return Scores();
   }
-  if(!m_FactorsE.empty()) {
-    if(!key.empty()) {
-      key += "|||";
-    }
-    key += e;
+  if(0 == c.GetSize()) {
+    MakeTargetKey(e, c, key);
+    return Lookup(source->second, key);
   }
-  if(!m_FactorsC.empty()) {
-    if(!key.empty()) {
-      key += "|||";
+  //right try from large to smaller context
+  //also can't have to be careful with words range if c is empty can't use c.GetSize()-1 will underflow and be large
+  for(size_t i = 0; i <= c.GetSize(); ++i) {
+    Phrase sub_c(i < c.GetSize() ? c.GetSubString(WordsRange(i,c.GetSize()-1)) : Phrase(ARRAY_SIZE_INCR));
+    MakeTargetKey(e, sub_c, key);
+    Scores ret(Lookup(source->second, key));
+    if(!ret.empty()) {
+      return ret;
     }
-    key += c;
   }
-  return key;
+  return Scores();
 }
 
+void LexicalReorderingTableMemory::GetScores(const Phrase& f, const std::vector<const Phrase*>& e, std::vector<Scores>& scores)
+{
+  scores.clear();
+  scores.resize(e.size());
+  Key key;
+  AppendKey(f, m_FactorsF, key);
+  TableType::const_iterator source = m_Table.find(key);
+  if(m_Table.end() == source) {
+    return;
+  }
+  const Phrase empty(ARRAY_SIZE_INCR);
+  for(size_t i = 0; i < e.size(); ++i) {
+    MakeTargetKey(*e[i], empty, key);
+    scores[i] = Lookup(source->second, key);
+  }
+}
+
+void LexicalReorderingTableMemory::DbgDump(std::ostream* out) const
+{
+  for(TableType::const_iterator i = m_Table.begin(); i != m_Table.end(); ++i) {
+    for(TargetMap::const_iterator j = i->second.begin(); j != i->second.end(); ++j) {
+      *out << " key: '";
+      for(size_t k = 0; k < i->first.size(); ++k) {
+        *out << i->first[k]->GetString() << " ";
+      }
+      *out << "|||";
+      for(size_t k = 0; k < j->first.size(); ++k) {
+        *out << " " << (j->first[k] ? j->first[k]->GetString() : StringPiece("|||"));
+      }
+      *out << "' score: (num scores: " << m_NumScores << ")";
+      for(size_t k = 0; k < m_NumScores; ++k) {
+        *out << m_Scores[j->second + k] << " ";
+      }
+      *out << "\n";
+    }
+  }
+};
+
 void  LexicalReorderingTableMemory::LoadFromFile(const std::string& filePath)
 {
   std::string fileName = filePath;
@@ -176,27 +219,30 @@ void  LexicalReorderingTableMemory::LoadFromFile(const std::string& filePath)
     fileName += ".gz";
   }
   InputFileStream file(fileName);
-  std::string line(""), key("");
+  std::string line("");
   int numScores = -1;
+  Key fKey, eKey;
   std::cerr << "Loading table into memory...";
   while(!getline(file, line).eof()) {
     std::vector<std::string> tokens = TokenizeMultiCharSeparator(line, "|||");
     int t = 0 ;
-    std::string f(""),e(""),c("");
+    fKey.clear();
+    eKey.clear();
 
     if(!m_FactorsF.empty()) {
       //there should be something for f
-      f = auxClearString(tokens.at(t));
+      AppendKey(tokens.at(t), Input, m_FactorsF, fKey);
       ++t;
     }
     if(!m_FactorsE.empty()) {
       //there should be something for e
-      e = auxClearString(tokens.at(t));
+      AppendKey(tokens.at(t), Output, m_FactorsE, eKey);
       ++t;
     }
     if(!m_FactorsC.empty()) {
       //there should be something for c
-      c = auxClearString(tokens.at(t));
+      eKey.push_back(NULL);
+      AppendKey(tokens.at(t), Output, m_FactorsC, eKey);
       ++t;
     }
     //last token are the probs
@@ -204,6 +250,7 @@ void  LexicalReorderingTableMemory::LoadFromFile(const std::string& filePath)
     //sanity check: all lines must have equall number of probs
     if(-1 == numScores) {
       numScores = (int)p.size(); //set in first line
+      m_NumScores = p.size();
     }
     if((int)p.size() != numScores) {
       TRACE_ERR( "found inconsistent number of probabilities... found " << p.size() << " expected " << numScores << std::endl);
@@ -211,12 +258,197 @@ void  LexicalReorderingTableMemory::LoadFromFile(const std::string& filePath)
     }
     std::transform(p.begin(),p.end(),p.begin(),TransformScore);
     std::transform(p.begin(),p.end(),p.begin(),FloorScore);
-    //save it all into our map
-    m_Table[MakeKey(f,e,c)] = p;
+    //save it all into our map; a repeated key keeps the last scores like before
+    std::pair<TargetMap::iterator, bool> r = m_Table[fKey].insert(std::make_pair(eKey, m_Scores.size()));
+    if(r.second) {
+      m_Scores.insert(m_Scores.end(), p.begin(), p.end());
+    } else {
+      std::copy(p.begin(), p.end(), m_Scores.begin() + r.first->second);
+    }
   }
   std::cerr << "done.\n";
 }
 
+/*
+ * functions for LexicalReorderingTableShared
+ */
+namespace
+{
+const char SHARED_MAGIC[8] = {'m', 'o', 's', 'e', 's', 'L', 'R', '3'};
+
+void WriteFactors(std::ostream& out, const FactorList& factors)
+{
+  for(size_t i = 0; i < factors.size(); ++i) {
+    out << factors[i] << ',';
+  }
+  out << '\n';
+}
+}
+
+//sections of the image, in the order they are written
+enum {
+  SHARED_SCORES, SHARED_TABLE, SHARED_KEYS, SHARED_NUM_SCORES, SHARED_SECTIONS
+};
+
+LexicalReorderingTableShared::LexicalReorderingTableShared(
+  const std::string& filePath,
+  const std::string& sharedDir,
+  const std::vector<FactorType>& f_factors,
+  const std::vector<FactorType>& e_factors,
+  const std::vector<FactorType>& c_factors)
+  : LexicalReorderingTable(f_factors, e_factors, c_factors), m_NumScores(0), m_Scores(NULL)
+{
+  const std::string imagePath = GetImagePath(filePath, sharedDir);
+  if(!Map(imagePath)) {
+    std::cerr << "Building shared table " << imagePath << "...";
+    Create(filePath, imagePath);
+    std::cerr << "done.\n";
+    UTIL_THROW_IF2(!Map(imagePath), "Could not map the shared table " << imagePath);
+  }
+}
+
+void LexicalReorderingTableShared::AppendWords(const std::string& p, FactorDirection direction, const FactorList& factors, SharedModelImage::Key& key) const
+{
+  Word word;
+  for (util::TokenIter<util::AnyCharacter, true> it(p, "\t "); it; ++it) {
+    word.CreateFromString(direction, factors, *it, false, false);
+    key.Append(word, factors);
+  }
+}
+
+SharedModelImage::Key LexicalReorderingTableShared::MakeKey(const SharedModelImage::Key& source, const Phrase& e, const Phrase& c) const
+{
+  SharedModelImage::Key key(source);
+  key.Append("|||");
+  key.Append(e, m_FactorsE);
+  if(!m_FactorsC.empty()) {
+    key.Append("|||");
+    key.Append(c, m_FactorsC);
+  }
+  return key;
+}
+
+Scores LexicalReorderingTableShared::Lookup(const SharedModelImage::Key& key) const
+{
+  const SharedModelImage::Entry* entry = m_Table.Find(key);
+  if(!entry) {
+    return Scores();
+  }
+  return Scores(m_Scores + entry->begin, m_Scores + entry->end);
+}
+
+std::vector<float> LexicalReorderingTableShared::GetScore(const Phrase& f, const Phrase& e, const Phrase& c)
+{
+  SharedModelImage::Key source;
+  source.Append(f, m_FactorsF);
+  if(0 == c.GetSize()) {
+    return Lookup(MakeKey(source, e, c));
+  }
+  //from large to smaller context, as LexicalReorderingTableMemory
+  for(size_t i = 0; i <= c.GetSize(); ++i) {
+    Phrase sub_c(i < c.GetSize() ? c.GetSubString(WordsRange(i,c.GetSize()-1)) : Phrase(ARRAY_SIZE_INCR));
+    Scores ret(Lookup(MakeKey(source, e, sub_c)));
+    if(!ret.empty()) {
+      return ret;
+    }
+  }
+  return Scores();
+}
+
+void LexicalReorderingTableShared::GetScores(const Phrase& f, const std::vector<const Phrase*>& e, std::vector<Scores>& scores)
+{
+  scores.clear();
+  scores.resize(e.size());
+  SharedModelImage::Key source;
+  source.Append(f, m_FactorsF);
+  const Phrase empty(ARRAY_SIZE_INCR);
+  for(size_t i = 0; i < e.size(); ++i) {
+    scores[i] = Lookup(MakeKey(source, *e[i], empty));
+  }
+}
+
+std::string LexicalReorderingTableShared::GetImagePath(const std::string& filePath, const std::string& sharedDir) const
+{
+  std::string fileName = filePath;
+  if(!FileExists(fileName) && FileExists(fileName+".gz")) {
+    fileName += ".gz";
+  }
+  std::ostringstream id;
+  WriteFactors(id, m_FactorsF);
+  WriteFactors(id, m_FactorsE);
+  WriteFactors(id, m_FactorsC);
+  return SharedModelImage::GetPath(sharedDir, "moses-lexr", SHARED_MAGIC, fileName, id.str());
+}
+
+void LexicalReorderingTableShared::Create(const std::string& filePath, const std::string& imagePath) const
+{
+  std::string fileName = filePath;
+  if(!FileExists(fileName) && FileExists(fileName+".gz")) {
+    fileName += ".gz";
+  }
+  InputFileStream file(fileName);
+  SharedModelImage::TableBuilder keys;
+  std::vector<float> scores;
+  int numScores = -1;
+  std::string line;
+  while(getline(file, line)) {
+    std::vector<std::string> tokens = TokenizeMultiCharSeparator(line, "|||");
+    int t = 0;
+    // the same key as MakeKey
+    SharedModelImage::Key key;
+    if(!m_FactorsF.empty()) {
+      AppendWords(tokens.at(t), Input, m_FactorsF, key);
+      ++t;
+    }
+    key.Append("|||");
+    if(!m_FactorsE.empty()) {
+      AppendWords(tokens.at(t), Output, m_FactorsE, key);
+      ++t;
+    }
+    if(!m_FactorsC.empty()) {
+      key.Append("|||");
+      AppendWords(tokens.at(t), Output, m_FactorsC, key);
+      ++t;
+    }
+    std::vector<float> p = Scan<float>(Tokenize(tokens.at(t)));
+    if(-1 == numScores) {
+      numScores = (int)p.size();
+    }
+    UTIL_THROW_IF2((int)p.size() != numScores, "Found inconsistent number of probabilities in " << fileName
+                   << ": " << p.size() << " instead of " << numScores);
+    std::transform(p.begin(),p.end(),p.begin(),TransformScore);
+    std::transform(p.begin(),p.end(),p.begin(),FloorScore);
+    // a repeated key keeps the last scores, as in LexicalReorderingTableMemory
+    const size_t known = keys.GetSize();
+    SharedModelImage::Entry& entry = keys.GetEntry(keys.Insert(key));
+    if(keys.GetSize() != known) {
+      entry.begin = scores.size();
+      entry.end = entry.begin + p.size();
+      scores.insert(scores.end(), p.begin(), p.end());
+    } else {
+      std::copy(p.begin(), p.end(), scores.begin() + entry.begin);
+    }
+  }
+
+  const uint64_t numScoresOut = std::max(numScores, 0);
+  SharedModelImage::Writer writer(imagePath, SHARED_MAGIC, SHARED_SECTIONS);
+  writer.Add(scores.empty() ? NULL : &scores[0], scores.size() * sizeof(float));
+  keys.Write(writer);
+  writer.Add(&numScoresOut, sizeof(numScoresOut));
+  writer.Commit();
+}
+
+bool LexicalReorderingTableShared::Map(const std::string& imagePath)
+{
+  if(!m_Image.Map(imagePath, SHARED_MAGIC, SHARED_SECTIONS)) {
+    return false;
+  }
+  m_NumScores = *reinterpret_cast<const uint64_t*>(m_Image.GetSection(SHARED_NUM_SCORES));
+  m_Table = SharedModelImage::Table(m_Image, SHARED_TABLE);
+  m_Scores = reinterpret_cast<const float*>(m_Image.GetSection(SHARED_SCORES));
+  return true;
+}
+
 /*
  * functions for LexicalReorderingTableTree
  */
@@ -311,6 +543,44 @@ Scores LexicalReorderingTableTree::auxFindScoreForContext(const Candidates& cand
   }
 }
 
+void LexicalReorderingTableTree::GetScores(const Phrase& f, const std::vector<const Phrase*>& e, std::vector<Scores>& scores)
+{
+  if(!m_FactorsC.empty() || m_FactorsE.empty() || m_FactorsF.empty() || 0 == f.GetSize()) {
+    LexicalReorderingTable::GetScores(f, e, scores);
+    return;
+  }
+  scores.clear();
+  scores.resize(e.size());
+  //1) goto subtree for f once
+  PPimp* source = m_Table->GetRoot();
+  for(size_t i = 0; i < f.GetSize() && 0 != source && source->isValid(); ++i) {
+    source = m_Table->Extend(source, f.GetWord(i).GetString(m_FactorsF, false), SourceVocId);
+  }
+  if(0 != source && source->isValid()) {
+    source = m_Table->Extend(source, PrefixTreeMap::MagicWord);
+  }
+  if(0 == source || !source->isValid()) {
+    return;
+  }
+  //2) continue from there for each e
+  Candidates cands;
+  for(size_t i = 0; i < e.size(); ++i) {
+    PPimp* pos = source;
+    for(size_t j = 0; j < e[i]->GetSize() && 0 != pos && pos->isValid(); ++j) {
+      pos = m_Table->Extend(pos, e[i]->GetWord(j).GetString(m_FactorsE, false), TargetVocId);
+    }
+    if(0 == e[i]->GetSize() || 0 == pos || !pos->isValid()) {
+      continue;
+    }
+    cands.clear();
+    m_Table->GetCandidates(*pos, &cands);
+    if(!cands.empty()) {
+      UTIL_THROW_IF2(1 != cands.size(), "Error");
+      scores[i] = cands[0].GetScore(0);
+    }
+  }
+}
+
 void LexicalReorderingTableTree::InitializeForInput(const InputType& input)
 {
   ClearCache();
@@ -8,6 +8,10 @@
 #include <string>
 #include <iostream>
 
+#include <boost/unordered_map.hpp>
+
+#include <stdint.h>
+
 #ifdef WITH_THREADS
 #include <boost/thread/tss.hpp>
 #endif
@@ -19,10 +23,12 @@
 #include "moses/ConfusionNet.h"
 #include "moses/Sentence.h"
 #include "moses/PrefixTreeMap.h"
+#include "moses/SharedModelImage.h"
 
 namespace Moses
 {
 
+class Factor;
 class Phrase;
 class InputType;
 class ConfusionNet;
@@ -40,6 +46,9 @@ public:
   static LexicalReorderingTable* LoadAvailable(const std::string& filePath, const FactorList& f_factors, const FactorList& e_factors, const FactorList& c_factors);
 public:
   virtual Scores GetScore(const Phrase& f, const Phrase& e, const Phrase& c) = 0;
+  //! scores[i] = GetScore(f, *e[i], empty context) for all target phrases of f at once.
+  //! Tables that can find f once and then each target override this.
+  virtual void GetScores(const Phrase& f, const std::vector<const Phrase*>& e, std::vector<Scores>& scores);
   virtual void InitializeForInput(const InputType&) {
     /* override for on-demand loading */
   };
@@ -81,15 +90,65 @@ public:
   virtual ~LexicalReorderingTableMemory();
 public:
   virtual std::vector<float> GetScore(const Phrase& f, const Phrase& e, const Phrase& c);
+  virtual void GetScores(const Phrase& f, const std::vector<const Phrase*>& e, std::vector<Scores>& scores);
   void DbgDump(std::ostream* out) const;
 private:
-  std::string MakeKey(const Phrase& f, const Phrase& e, const Phrase& c) const;
-  std::string MakeKey(const std::string& f, const std::string& e, const std::string& c) const;
+  //! interned factors of each word, so keys are built without strings
+  typedef std::vector<const Factor*> Key;
+  struct KeyHash {
+    size_t operator()(const Key& key) const;
+  };
+  //! target (and context) key to offset in m_Scores
+  typedef boost::unordered_map<Key, size_t, KeyHash> TargetMap;
+  //! everything for one source phrase is found with one lookup
+  typedef boost::unordered_map<Key, TargetMap, KeyHash> TableType;
+
+  void AppendKey(const Phrase& p, const FactorList& factors, Key& key) const;
+  void AppendKey(const std::string& p, FactorDirection direction, const FactorList& factors, Key& key) const;
+  //! e and c are separated by NULL
+  void MakeTargetKey(const Phrase& e, const Phrase& c, Key& key) const;
+  Scores Lookup(const TargetMap& targets, const Key& key) const;
 
   void LoadFromFile(const std::string& filePath);
 private:
-  typedef std::map< std::string, std::vector<float> > TableType;
   TableType m_Table;
+  size_t m_NumScores;
+  std::vector<float> m_Scores;
+};
+
+class LexicalReorderingTableShared : public LexicalReorderingTable
+{
+  //implements LexicalReorderingTable over an image of a text table that is
+  //built once in a shared directory (eg. /dev/shm) and mapped read-only by
+  //every decoder process afterwards. Phrase pairs are keyed by 64 bit hashes
+  //of their factor strings, and the image keeps the strings to check them,
+  //so it holds no pointers.
+public:
+  LexicalReorderingTableShared(const std::string& filePath,
+                               const std::string& sharedDir,
+                               const std::vector<FactorType>& f_factors,
+                               const std::vector<FactorType>& e_factors,
+                               const std::vector<FactorType>& c_factors);
+public:
+  virtual std::vector<float> GetScore(const Phrase& f, const Phrase& e, const Phrase& c);
+  virtual void GetScores(const Phrase& f, const std::vector<const Phrase*>& e, std::vector<Scores>& scores);
+
+  //! name of the image of filePath in sharedDir; changes with the file
+  std::string GetImagePath(const std::string& filePath, const std::string& sharedDir) const;
+  //! convert the text table filePath into an image at imagePath
+  void Create(const std::string& filePath, const std::string& imagePath) const;
+private:
+  //! key of the phrase pair with context c, given the key of the source phrase
+  SharedModelImage::Key MakeKey(const SharedModelImage::Key& source, const Phrase& e, const Phrase& c) const;
+  void AppendWords(const std::string& p, FactorDirection direction, const FactorList& factors, SharedModelImage::Key& key) const;
+  Scores Lookup(const SharedModelImage::Key& key) const;
+
+  bool Map(const std::string& imagePath);
+private:
+  SharedModelImage m_Image;
+  SharedModelImage::Table m_Table;
+  size_t m_NumScores;
+  const float* m_Scores;
 };
 
 class LexicalReorderingTableTree : public LexicalReorderingTable
@@ -118,6 +177,7 @@ public:
   };
 
   virtual std::vector<float> GetScore(const Phrase& f, const Phrase& e, const Phrase& c);
+  virtual void GetScores(const Phrase& f, const std::vector<const Phrase*>& e, std::vector<Scores>& scores);
 
   virtual void InitializeForInput(const InputType& input);
   virtual void InitializeForInputPhrase(const Phrase& f) {
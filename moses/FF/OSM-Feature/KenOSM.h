@@ -11,6 +11,11 @@ class KenOSMBase {
   public:  
     virtual float Score(const lm::ngram::State&, const std::string&,
                         lm::ngram::State&) const = 0;
+
+    virtual float Score(const lm::ngram::State&, lm::WordIndex,
+                        lm::ngram::State&) const = 0;
+
+    virtual lm::WordIndex Index(const std::string&) const = 0;
     
     virtual const lm::ngram::State &BeginSentenceState() const = 0;
     
@@ -29,6 +34,16 @@ class KenOSM : public KenOSMBase {
         return m_kenlm->Score(in_state, m_kenlm->GetVocabulary().Index(word),
                               out_state);
     }
+
+    virtual float Score(const lm::ngram::State &in_state,
+                        lm::WordIndex word,
+                        lm::ngram::State &out_state) const {
+        return m_kenlm->Score(in_state, word, out_state);
+    }
+
+    virtual lm::WordIndex Index(const std::string& word) const {
+        return m_kenlm->GetVocabulary().Index(word);
+    }
     
     virtual const lm::ngram::State &BeginSentenceState() const {
         return m_kenlm->BeginSentenceState();
@@ -31,6 +31,8 @@ void OpSequenceModel :: readLanguageModel(const char *lmFile)
   State startState = OSM->NullContextState();
   State endState;
   unkOpProb = OSM->Score(startState,unkOp,endState);
+
+  m_reorderingOps.Load(*OSM);
 }
 
 
@@ -41,10 +43,8 @@ void OpSequenceModel::Load()
 
 
 
-void OpSequenceModel:: EvaluateInIsolation(const Phrase &source
-                                , const TargetPhrase &targetPhrase
-                                , ScoreComponentCollection &scoreBreakdown
-                                , ScoreComponentCollection &estimatedFutureScore) const
+boost::shared_ptr<osmPhrase> OpSequenceModel::EncodePhrase(const Phrase &source
+    , const TargetPhrase &targetPhrase) const
 {
 
   osmHypothesis obj;
@@ -52,7 +52,6 @@ void OpSequenceModel:: EvaluateInIsolation(const Phrase &source
   WordsBitmap myBitmap(source.GetSize());
   vector <string> mySourcePhrase;
   vector <string> myTargetPhrase;
-  vector<float> scores;
   vector <int> alignments;
   int startIndex = 0;
   int endIndex = source.GetSize();
@@ -79,10 +78,26 @@ void OpSequenceModel:: EvaluateInIsolation(const Phrase &source
   obj.setPhrases(mySourcePhrase , myTargetPhrase);
   obj.constructCepts(alignments,startIndex,endIndex-1,targetPhrase.GetSize());
   obj.computeOSMFeature(startIndex,myBitmap);
-  obj.calculateOSMProb(*OSM);
-  obj.populateScores(scores,numFeatures);
+
+  boost::shared_ptr<osmPhrase> phrase(new osmPhrase);
+  obj.encode(*OSM, *phrase);
+  return phrase;
+}
+
+void OpSequenceModel:: EvaluateInIsolation(const Phrase &source
+                                , const TargetPhrase &targetPhrase
+                                , ScoreComponentCollection &scoreBreakdown
+                                , ScoreComponentCollection &estimatedFutureScore) const
+{
+  boost::shared_ptr<osmPhrase> phrase = EncodePhrase(source, targetPhrase);
+  osmState state(OSM->NullContextState());
+  vector<float> scores;
+
+  phrase->apply(*OSM, m_reorderingOps, 0, NULL, state, scores, numFeatures);
   estimatedFutureScore.PlusEquals(this, scores);
 
+  // everything but the gaps and jumps is the same wherever the phrase is applied
+  targetPhrase.SetFFData(this, phrase);
 }
 
 
@@ -92,105 +107,26 @@ FFState* OpSequenceModel::EvaluateWhenApplied(
   ScoreComponentCollection* accumulator) const
 {
   const TargetPhrase &target = cur_hypo.GetCurrTargetPhrase();
-  const WordsBitmap &bitmap = cur_hypo.GetWordsBitmap();
-  WordsBitmap myBitmap = bitmap;
-  const Manager &manager = cur_hypo.GetManager();
-  const InputType &source = manager.GetSource();
-  const Sentence &sourceSentence = static_cast<const Sentence&>(source);
-  osmHypothesis obj;
-  vector <string> mySourcePhrase;
-  vector <string> myTargetPhrase;
-  vector<float> scores;
-
-
-  //target.GetWord(0)
-
-  //cerr << target <<" --- "<<target.GetSourcePhrase()<< endl;  // English ...
-
-  //cerr << align << endl;   // Alignments ...
-  //cerr << cur_hypo.GetCurrSourceWordsRange() << endl;
-
-  //cerr << source <<endl;
-
-// int a = sourceRange.GetStartPos();
-// cerr << source.GetWord(a);
-  //cerr <<a<<endl;
-
-  //const Sentence &sentence = static_cast<const Sentence&>(curr_hypo.GetManager().GetSource());
-
-
   const WordsRange & sourceRange = cur_hypo.GetCurrSourceWordsRange();
-  int startIndex  = sourceRange.GetStartPos();
-  int endIndex = sourceRange.GetEndPos();
-  const AlignmentInfo &align = cur_hypo.GetCurrTargetPhrase().GetAlignTerm();
-  osmState * statePtr;
-
-  vector <int> alignments;
-
-
-
-  AlignmentInfo::const_iterator iter;
-
-  for (iter = align.begin(); iter != align.end(); ++iter) {
-    //cerr << iter->first << "----" << iter->second << " ";
-    alignments.push_back(iter->first);
-    alignments.push_back(iter->second);
-  }
-
-
-  //cerr<<bitmap<<endl;
-  //cerr<<startIndex<<" "<<endIndex<<endl;
-
-
-  for (int i = startIndex; i <= endIndex; i++) {
-    myBitmap.SetValue(i,0); // resetting coverage of this phrase ...
-    mySourcePhrase.push_back(source.GetWord(i).GetFactor(sFactor)->GetString().as_string());
-    // cerr<<mySourcePhrase[i]<<endl;
-  }
-
-  for (int i = 0; i < target.GetSize(); i++) {
+  vector<float> scores;
 
-    if (target.GetWord(i).IsOOV() && sFactor == 0 && tFactor == 0)
-      myTargetPhrase.push_back("_TRANS_SLF_");
-    else
-      myTargetPhrase.push_back(target.GetWord(i).GetFactor(tFactor)->GetString().as_string());
+  const osmPhrase *phrase = static_cast<const osmPhrase*>(target.GetFFData(this));
+  boost::shared_ptr<osmPhrase> encoded;
 
+  if (phrase == NULL) { // not scored in isolation by us
+    const InputType &source = cur_hypo.GetManager().GetSource();
+    encoded = EncodePhrase(source.GetSubString(sourceRange), target);
+    phrase = encoded.get();
   }
 
-
-  //cerr<<myBitmap<<endl;
-
-  obj.setState(prev_state);
-  obj.constructCepts(alignments,startIndex,endIndex,target.GetSize());
-  obj.setPhrases(mySourcePhrase , myTargetPhrase);
-  obj.computeOSMFeature(startIndex,myBitmap);
-  obj.calculateOSMProb(*OSM);
-  obj.populateScores(scores,numFeatures);
-  //obj.print();
-
-  /*
-    if (bitmap.GetFirstGapPos() == NOT_FOUND)
-    {
-
-      int xx;
-  	 cerr<<bitmap<<endl;
-  	 int a = bitmap.GetFirstGapPos();
-  	 obj.print();
-      cin>>xx;
-    }
-    */
-
-
+  // Words of this phrase are covered in the hypothesis' bitmap, which is only
+  // consulted for the rest of the sentence.
+  osmState *state = new osmState(*static_cast<const osmState*>(prev_state));
+  phrase->apply(*OSM, m_reorderingOps, sourceRange.GetStartPos(), &cur_hypo.GetWordsBitmap(), *state, scores, numFeatures);
 
   accumulator->PlusEquals(this, scores);
 
-  return obj.saveState();
-
-
-
-
-  //return statePtr;
-// return NULL;
+  return state;
 }
 
 FFState* OpSequenceModel::EvaluateWhenApplied(
@@ -219,7 +155,7 @@ std::string OpSequenceModel::GetScoreProducerWeightShortName(unsigned idx) const
 std::vector<float> OpSequenceModel::GetFutureScores(const Phrase &source, const Phrase &target) const
 {
   ParallelPhrase pp(source, target);
-  std::map<ParallelPhrase, Scores>::const_iterator iter;
+  boost::unordered_map<ParallelPhrase, Scores>::const_iterator iter;
   iter = m_futureCost.find(pp);
 //iter = m_coll.find(pp);
   if (iter == m_futureCost.end()) {
@@ -3,6 +3,8 @@
 #include <string>
 #include <map>
 #include <vector>
+#include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
 #include "moses/FF/StatefulFeatureFunction.h"
 #include "moses/Manager.h"
 #include "moses/FF/OSM-Feature/osmHyp.h"
@@ -61,7 +63,11 @@ public:
 protected:
   typedef std::pair<Phrase, Phrase> ParallelPhrase;
   typedef std::vector<float> Scores;
-  std::map<ParallelPhrase, Scores> m_futureCost;
+  boost::unordered_map<ParallelPhrase, Scores> m_futureCost;
+
+  osmReorderingOps m_reorderingOps;
+
+  boost::shared_ptr<osmPhrase> EncodePhrase(const Phrase &source, const TargetPhrase &targetPhrase) const;
 
   std::vector < std::pair < std::set <int> , std::set <int> > > ceptsInPhrase;
   std::set <int> targetNullWords;
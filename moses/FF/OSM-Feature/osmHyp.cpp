@@ -1,4 +1,7 @@
 #include "osmHyp.h"
+#include "moses/Util.h"
+#include <algorithm>
+#include <limits>
 #include <sstream>
 
 using namespace std;
@@ -14,14 +17,6 @@ osmState::osmState(const State & val)
 
 }
 
-void osmState::saveState(int jVal, int eVal, map <int , string> & gapVal)
-{
-  gap.clear();
-  gap = gapVal;
-  j = jVal;
-  E = eVal;
-}
-
 int osmState::Compare(const FFState& otherBase) const
 {
   const osmState &other = static_cast<const osmState&>(otherBase);
@@ -61,26 +56,6 @@ osmHypothesis :: osmHypothesis()
   gap.clear();
 }
 
-void osmHypothesis :: setState(const FFState* prev_state)
-{
-
-  if(prev_state != NULL) {
-
-    j = static_cast <const osmState *> (prev_state)->getJ();
-    E =  static_cast <const osmState *> (prev_state)->getE();
-    gap = static_cast <const osmState *> (prev_state)->getGap();
-    lmState = static_cast <const osmState *> (prev_state)->getLMState();
-  }
-}
-
-osmState * osmHypothesis :: saveState()
-{
-
-  osmState * statePtr = new osmState(lmState);
-  statePtr->saveState(j,E,gap);
-  return statePtr;
-}
-
 int osmHypothesis :: isTranslationOperation(int x)
 {
   if (operations[x].find("_JMP_BCK_") != -1)
@@ -220,6 +195,7 @@ void osmHypothesis :: generateOperations(int & startIndex , int j1 , int contFla
     } else {
       operations.push_back("_TRANS_" + english + "_TO_" + german);
     }
+    addStep(j - startIndex, contFlag);
 
     //ans = firstOpenGap(coverageVector);
     ans = coverageVector.GetFirstGapPos();
@@ -230,6 +206,7 @@ void osmHypothesis :: generateOperations(int & startIndex , int j1 , int contFla
   } else if (contFlag == 2) {
 
     operations.push_back("_INS_" + german);
+    addStep(j - startIndex, contFlag);
     ans = coverageVector.GetFirstGapPos();
 
     if (ans != -1)
@@ -237,6 +214,7 @@ void osmHypothesis :: generateOperations(int & startIndex , int j1 , int contFla
     deletionCount++;
   } else {
     operations.push_back("_CONT_CEPT_");
+    addStep(j - startIndex, contFlag);
   }
 
   //coverageVector[j]=1;
@@ -345,6 +323,7 @@ void osmHypothesis :: generateDeleteOperations(std::string english, int currTarg
 {
 
   operations.push_back("_DEL_" + english);
+  addStep(-1, 0);
   currTargetIndex++;
 
   while(doneTargetIndexes.find(currTargetIndex) != doneTargetIndexes.end()) {
@@ -596,6 +575,244 @@ void osmHypothesis :: populateScores(vector <float> & scores , const int numFeat
   scores.push_back(deletionCount);
 }
 
+void osmHypothesis :: addStep(int offset, int contFlag)
+{
+  osmPhrase::Step step;
+  step.offset = offset;
+  step.contFlag = contFlag;
+  step.firstGap = 0;
+  step.op = 0;
+  steps.push_back(step);
+  stepOperations.push_back(operations.back());
+}
+
+void osmHypothesis :: encode(const OSMLM& ptrOp, osmPhrase & phrase)
+{
+  phrase.steps = steps;
+  phrase.generatedBy.clear();
+
+  for (int i = 0; i < steps.size(); i++) {
+    phrase.steps[i].op = ptrOp.Index(stepOperations[i]);
+
+    if (steps[i].offset >= 0) {
+      if (phrase.generatedBy.size() <= steps[i].offset)
+        phrase.generatedBy.resize(steps[i].offset + 1, -1);
+      phrase.generatedBy[steps[i].offset] = i;
+    }
+  }
+
+  for (int i = 0; i < steps.size(); i++) {
+    int firstGap = 0;
+
+    while (firstGap < phrase.generatedBy.size() && phrase.generatedBy[firstGap] < i)
+      firstGap++;
+
+    phrase.steps[i].firstGap = firstGap;
+  }
+}
+
+//////////////////////////////////////////////////
+
+void osmReorderingOps :: Load(const OSMLM &lm)
+{
+  insertGap = lm.Index("_INS_GAP_");
+  jumpForward = lm.Index("_JMP_FWD_");
+
+  jumpBackIds.clear();
+
+  for (int i = 0; i < 64; i++) {
+    jumpBackIds.push_back(lm.Index("_JMP_BCK_" + SPrint(i)));
+  }
+}
+
+lm::WordIndex osmReorderingOps :: jumpBack(int gaps, const OSMLM &lm) const
+{
+  if (gaps < jumpBackIds.size())
+    return jumpBackIds[gaps];
+
+  return lm.Index("_JMP_BCK_" + SPrint(gaps));
+}
+
+namespace
+{
+
+void setGap(vector <int> & gap, int pos, bool unfilled)
+{
+  vector <int> :: iterator iter = lower_bound(gap.begin(), gap.end(), 2 * pos);
+
+  if (iter != gap.end() && (*iter == 2 * pos || *iter == 2 * pos + 1))
+    *iter = 2 * pos + unfilled;
+  else
+    gap.insert(iter, 2 * pos + unfilled);
+}
+
+// Same as osmHypothesis::closestGap()
+int closestGap(const vector <int> & gap, int j1, int & gp)
+{
+  int dist=1172;
+  int value=-1;
+  int temp=0;
+  gp=0;
+  int opGap=0;
+
+  for (vector <int> :: const_reverse_iterator iter = gap.rbegin(); iter != gap.rend(); ++iter) {
+    if (!(*iter & 1))
+      continue;
+
+    int pos = (*iter - 1) / 2;
+    opGap++;
+
+    if (pos == j1) {
+      gp = opGap;
+      return j1;
+    }
+
+    temp = pos - j1;
+
+    if(temp<0)
+      temp=temp * -1;
+
+    if(dist>temp && pos < j1) {
+      dist=temp;
+      value=pos;
+      gp=opGap;
+    }
+  }
+
+  return value;
+}
+
+int openGaps(const vector <int> & gap)
+{
+  int nd = 0;
+
+  for (vector <int> :: const_iterator iter = gap.begin(); iter != gap.end(); ++iter) {
+    if (*iter & 1)
+      nd++;
+  }
+
+  return nd;
+}
+
+void score(const OSMLM &lm, lm::WordIndex op, State &currState, double &opProb)
+{
+  State temp = currState;
+  opProb += lm.Score(temp, op, currState);
+}
 
 } // namespace
 
+// Whether source word x was generated before step
+bool osmPhrase :: covered(int x, int step, int startIndex, const WordsBitmap *outside) const
+{
+  if (x >= startIndex && x < startIndex + (int) generatedBy.size())
+    return generatedBy[x - startIndex] < step;
+
+  return outside && outside->GetValue(x);
+}
+
+void osmPhrase :: apply(const OSMLM &lm, const osmReorderingOps &ops, int startIndex, const WordsBitmap *outside, osmState &state, vector <float> & scores, const int numFeatures) const
+{
+  int &j = state.j;
+  int &E = state.E;
+  vector <int> &gap = state.gap;
+  State currState = state.lmState;
+
+  double opProb = 0;
+  int gapWidth = 0;
+  int gapCount = 0;
+  int openGapCount = 0;
+  int deletionCount = 0;
+
+  // Words this phrase generates are uncovered in outside's view of them.
+  int outsideGap = std::numeric_limits<int>::max();
+
+  if (outside) {
+    size_t pos = outside->GetFirstGapPos();
+    if (pos != NOT_FOUND)
+      outsideGap = pos;
+  }
+
+  for (int i = 0; i < steps.size(); i++) {
+    const Step &step = steps[i];
+
+    if (step.offset < 0) {
+      score(lm, step.op, currState, opProb);
+      continue;
+    }
+
+    const int j1 = startIndex + step.offset;
+    int gFlag = 0;
+    int gp = 0;
+
+    if (j < j1) {
+      if (!covered(j, i, startIndex, outside)) {
+        score(lm, ops.insertGap, currState, opProb);
+        gFlag++;
+        setGap(gap, j, true);
+      }
+      if (j == E) {
+        j = j1;
+      } else {
+        score(lm, ops.jumpForward, currState, opProb);
+        j = E;
+      }
+    }
+
+    if (j1 < j) {
+      if (j < E && !covered(j, i, startIndex, outside)) {
+        score(lm, ops.insertGap, currState, opProb);
+        gFlag++;
+        setGap(gap, j, true);
+      }
+
+      j = closestGap(gap, j1, gp);
+      score(lm, ops.jumpBack(gp, lm), currState, opProb);
+
+      if (j == j1)
+        setGap(gap, j, false);
+    }
+
+    if (j < j1) {
+      score(lm, ops.insertGap, currState, opProb);
+      setGap(gap, j, true);
+      gFlag++;
+      j = j1;
+    }
+
+    score(lm, step.op, currState, opProb);
+    if (step.contFlag != 1) {
+      int ans = min(outsideGap, startIndex + step.firstGap);
+      gapWidth += j - ans;
+
+      if (step.contFlag == 2)
+        deletionCount++;
+    }
+
+    j += 1;
+
+    if (E < j)
+      E = j;
+
+    if (gFlag > 0)
+      gapCount++;
+
+    openGapCount += openGaps(gap);
+  }
+
+  state.lmState = currState;
+
+  scores.clear();
+  scores.push_back(opProb);
+
+  if (numFeatures == 1)
+    return;
+
+  scores.push_back(gapWidth);
+  scores.push_back(gapCount);
+  scores.push_back(openGapCount);
+  scores.push_back(deletionCount);
+}
+
+
+} // namespace
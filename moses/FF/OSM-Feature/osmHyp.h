@@ -14,21 +14,19 @@ namespace Moses
 
 class osmState : public FFState
 {
+  friend class osmPhrase;
+
 public:
   osmState(const lm::ngram::State & val);
   int Compare(const FFState& other) const;
-  void saveState(int jVal, int eVal, std::map <int , std::string> & gapVal);
   int getJ()const {
     return j;
   }
   int getE()const {
     return E;
   }
-  std::map <int , std::string> getGap() const {
-    return gap;
-  }
 
-  lm::ngram::State getLMState() const {
+  const lm::ngram::State &getLMState() const {
     return lmState;
   }
 
@@ -37,10 +35,50 @@ public:
 
 protected:
   int j, E;
-  std::map <int,std::string> gap;
+  // Positions where a gap was inserted, in increasing order, each stored as
+  // 2 * position + 1 while the gap is unfilled and 2 * position once filled.
+  std::vector <int> gap;
   lm::ngram::State lmState;
 };
 
+// Vocabulary ids of the operations that depend on the hypothesis being extended.
+class osmReorderingOps
+{
+public:
+  void Load(const OSMLM &lm);
+
+  lm::WordIndex insertGap, jumpForward;
+  lm::WordIndex jumpBack(int gaps, const OSMLM &lm) const;
+
+private:
+  std::vector <lm::WordIndex> jumpBackIds;  // by number of gaps jumped
+};
+
+/** The operations of a phrase pair that are the same wherever the phrase is
+ *  applied, encoded once by OpSequenceModel::EvaluateInIsolation().  Only the
+ *  gap and jump operations in between are generated for each hypothesis.
+ */
+class osmPhrase
+{
+public:
+  struct Step {
+    int offset;  // source word generated, relative to the phrase start. -1 for _DEL_
+    int contFlag;  // as in osmHypothesis::generateOperations()
+    int firstGap;  // first offset not generated by an earlier step
+    lm::WordIndex op;
+  };
+
+  std::vector <Step> steps;
+  std::vector <int> generatedBy;  // step generating each source offset
+
+  // Extends state by the phrase at startIndex.  outside is the coverage of
+  // the other source words, NULL if the phrase is scored on its own.
+  void apply(const OSMLM &lm, const osmReorderingOps &ops, int startIndex, const WordsBitmap *outside, osmState &state, std::vector <float> &scores, const int numFeatures) const;
+
+private:
+  bool covered(int x, int step, int startIndex, const WordsBitmap *outside) const;
+};
+
 class osmHypothesis
 {
 
@@ -48,6 +86,8 @@ private:
 
 
   std::vector <std::string> operations;	// List of operations required to generated this hyp ...
+  std::vector <osmPhrase::Step> steps;	// Translation and deletion operations, op unset ...
+  std::vector <std::string> stepOperations;
   std::map <int,std::string> gap;	// Maintains gap history ...
   int j;	// Position after the last source word generated ...
   int E; // Position after the right most source word so far generated ...
@@ -65,6 +105,7 @@ private:
   std::set <int> targetNullWords;
   std::set <int> sourceNullWords;
 
+  void addStep(int offset, int contFlag);
   int closestGap(std::map <int,std::string> gap,int j1, int & gp);
   int firstOpenGap(std::vector <int> & coverageVector);
   std::string intToString(int);
@@ -87,8 +128,7 @@ public:
     currF = val1;
     currE = val2;
   }
-  void setState(const FFState* prev_state);
-  osmState * saveState();
+  void encode(const OSMLM& ptrOp, osmPhrase & phrase);
   void print();
   void populateScores(std::vector <float> & scores , const int numFeatures);
   void setState(const lm::ngram::State & val) {
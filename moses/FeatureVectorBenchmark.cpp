@@ -0,0 +1,82 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2014 University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#include "Benchmark.h"
+#include "FeatureVector.h"
+#include "Util.h"
+
+using namespace Moses;
+
+namespace MosesBenchmark
+{
+
+namespace
+{
+
+// dense core features, as in the scores of every hypothesis
+class DenseInnerProductBenchmark : public Benchmark
+{
+public:
+  DenseInnerProductBenchmark() : Benchmark("FVector/InnerProductDense") {}
+  void SetUp() {
+    const size_t size = 20;
+    m_a.resize(size);
+    m_b.resize(size);
+    Random random;
+    for (size_t i = 0; i < size; ++i) {
+      m_a[i] = random.Next(1000) / 100.0;
+      m_b[i] = random.Next(1000) / 100.0;
+    }
+  }
+  void Run(size_t iterations) {
+    for (size_t i = 0; i < iterations; ++i) {
+      Use(m_a.inner_product(m_b));
+    }
+  }
+private:
+  FVector m_a, m_b;
+};
+
+// sparse features, half of them shared, as with sparse feature weights
+class SparseInnerProductBenchmark : public Benchmark
+{
+public:
+  SparseInnerProductBenchmark() : Benchmark("FVector/InnerProductSparse") {}
+  void SetUp() {
+    Random random;
+    for (size_t i = 0; i < 50; ++i) {
+      m_a[FName("benchmark", SPrint(i))] = random.Next(1000) / 100.0;
+      m_b[FName("benchmark", SPrint(i + 25))] = random.Next(1000) / 100.0;
+    }
+  }
+  void Run(size_t iterations) {
+    for (size_t i = 0; i < iterations; ++i) {
+      Use(m_a.inner_product(m_b));
+    }
+  }
+private:
+  FVector m_a, m_b;
+};
+
+DenseInnerProductBenchmark s_dense;
+SparseInnerProductBenchmark s_sparse;
+
+}
+
+}
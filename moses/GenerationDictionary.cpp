@@ -19,8 +19,13 @@ License along with this library; if not, write to the Free Software
 Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 ***********************************************************************/
 
+#include <algorithm>
 #include <fstream>
+#include <sstream>
 #include <string>
+#ifdef WITH_THREADS
+#include <boost/thread/locks.hpp>
+#endif
 #include "GenerationDictionary.h"
 #include "FactorCollection.h"
 #include "Word.h"
@@ -36,20 +41,81 @@ namespace Moses
 {
 std::vector<GenerationDictionary*> GenerationDictionary::s_staticColl;
 
+namespace
+{
+const char SHARED_MAGIC[8] = {'m', 'o', 's', 'e', 's', 'G', 'E', '2'};
+
+//sections of the image, in the order they are written
+enum {
+  SHARED_TEXT, SHARED_OFFSETS, SHARED_SCORES, SHARED_OUTPUTS, SHARED_TABLE, SHARED_KEYS, SHARED_META, SHARED_SECTIONS
+};
+}
+
 GenerationDictionary::GenerationDictionary(const std::string &line)
   : DecodeFeature(line)
+  , m_shared(false)
+  , m_sharedSize(0)
+  , m_sharedOffsets(NULL)
+  , m_sharedScores(NULL)
+  , m_sharedText(NULL)
+  , m_sharedOutputs(NULL)
 {
   s_staticColl.push_back(this);
 
   ReadParameters();
 }
 
-void GenerationDictionary::Load()
+void GenerationDictionary::ParseLine(const string &line, size_t lineNum,
+                                     vector<string> &input, vector<string> &output,
+                                     vector<float> &scores) const
 {
-  FactorCollection &factorCollection = FactorCollection::Instance();
-
   const size_t numFeatureValuesInConfig = this->GetNumScoreComponents();
+  vector<string> token = Tokenize( line );
+
+  // inputs
+  vector<string> factorString = Tokenize( token[0], "|" );
+  input.assign(factorString.begin(), factorString.begin() + GetInput().size());
+
+  factorString = Tokenize( token[1], "|" );
+  output.assign(factorString.begin(), factorString.begin() + GetOutput().size());
+
+  size_t numFeaturesInFile = token.size() - 2;
+  if (numFeaturesInFile < numFeatureValuesInConfig) {
+    stringstream strme;
+    strme << m_filePath << ":" << lineNum << ": expected " << numFeatureValuesInConfig
+          << " feature values, but found " << numFeaturesInFile << std::endl;
+    throw strme.str();
+  }
+  scores.assign(numFeatureValuesInConfig, 0.0f);
+  for (size_t i = 0; i < numFeatureValuesInConfig; i++)
+    scores[i] = FloorScore(TransformScore(Scan<float>(token[2+i])));
+}
+
+void GenerationDictionary::Load()
+{
+  const std::string &sharedDir = StaticData::Instance().GetSharedModelDir();
+  if (!sharedDir.empty()) {
+    // build the table once, then share it between processes
+    std::ostringstream id;
+    for (size_t i = 0; i < GetInput().size(); ++i) {
+      id << GetInput()[i] << ',';
+    }
+    id << '\n';
+    for (size_t i = 0; i < GetOutput().size(); ++i) {
+      id << GetOutput()[i] << ',';
+    }
+    id << '\n' << GetNumScoreComponents();
+    const std::string imagePath = SharedModelImage::GetPath(sharedDir, "moses-gen", SHARED_MAGIC, m_filePath, id.str());
+    if (!MapImage(imagePath)) {
+      std::cerr << "Building shared table " << imagePath << "...";
+      CreateImage(imagePath);
+      std::cerr << "done.\n";
+      UTIL_THROW_IF2(!MapImage(imagePath), "Could not map the shared table " << imagePath);
+    }
+    return;
+  }
 
+  FactorCollection &factorCollection = FactorCollection::Instance();
 
   // data from file
   InputFileStream inFile(m_filePath);
@@ -57,9 +123,11 @@ void GenerationDictionary::Load()
 
   string line;
   size_t lineNum = 0;
+  vector<string> inputString, outputString;
+  std::vector<float> scores;
   while(getline(inFile, line)) {
     ++lineNum;
-    vector<string> token = Tokenize( line );
+    ParseLine(line, lineNum, inputString, outputString, scores);
 
     // add each line in generation file into class
     Word *inputWord = new Word();  // deleted in destructor
@@ -68,32 +136,19 @@ void GenerationDictionary::Load()
     // create word with certain factors filled out
 
     // inputs
-    vector<string> factorString = Tokenize( token[0], "|" );
     for (size_t i = 0 ; i < GetInput().size() ; i++) {
       FactorType factorType = GetInput()[i];
-      const Factor *factor = factorCollection.AddFactor( Output, factorType, factorString[i]);
+      const Factor *factor = factorCollection.AddFactor( Output, factorType, inputString[i]);
       inputWord->SetFactor(factorType, factor);
     }
 
-    factorString = Tokenize( token[1], "|" );
     for (size_t i = 0 ; i < GetOutput().size() ; i++) {
       FactorType factorType = GetOutput()[i];
 
-      const Factor *factor = factorCollection.AddFactor( Output, factorType, factorString[i]);
+      const Factor *factor = factorCollection.AddFactor( Output, factorType, outputString[i]);
       outputWord.SetFactor(factorType, factor);
     }
 
-    size_t numFeaturesInFile = token.size() - 2;
-    if (numFeaturesInFile < numFeatureValuesInConfig) {
-      stringstream strme;
-      strme << m_filePath << ":" << lineNum << ": expected " << numFeatureValuesInConfig
-            << " feature values, but found " << numFeaturesInFile << std::endl;
-      throw strme.str();
-    }
-    std::vector<float> scores(numFeatureValuesInConfig, 0.0f);
-    for (size_t i = 0; i < numFeatureValuesInConfig; i++)
-      scores[i] = FloorScore(TransformScore(Scan<float>(token[2+i])));
-
     Collection::iterator iterWord = m_collection.find(inputWord);
     if (iterWord == m_collection.end()) {
       m_collection[inputWord][outputWord].Assign(this, scores);
@@ -107,6 +162,138 @@ void GenerationDictionary::Load()
   inFile.Close();
 }
 
+void GenerationDictionary::CreateImage(const std::string &imagePath) const
+{
+  // the text of the output words is written as it is read
+  SharedModelImage::Writer writer(imagePath, SHARED_MAGIC, SHARED_SECTIONS);
+  SharedModelImage::TableBuilder inputs;
+  // input word of each line, and the line
+  std::vector<std::pair<uint64_t, uint64_t> > lines;
+  std::vector<uint64_t> offsets;
+  std::vector<float> allScores;
+  uint64_t textSize = 0;
+
+  InputFileStream inFile(m_filePath);
+  UTIL_THROW_IF2(!inFile.good(), "Couldn't read " << m_filePath);
+
+  string line;
+  size_t lineNum = 0;
+  vector<string> inputString, outputString;
+  std::vector<float> scores;
+  while(getline(inFile, line)) {
+    ++lineNum;
+    ParseLine(line, lineNum, inputString, outputString, scores);
+    SharedModelImage::Key key;
+    for (size_t i = 0; i < inputString.size(); ++i) {
+      key.Append(inputString[i]);
+    }
+    lines.push_back(std::make_pair(inputs.Insert(key), lines.size()));
+    offsets.push_back(textSize);
+    const string text = Join("|", outputString);
+    writer.Append(text.data(), text.size());
+    textSize += text.size();
+    allScores.insert(allScores.end(), scores.begin(), scores.end());
+  }
+  inFile.Close();
+  offsets.push_back(textSize);
+  writer.EndSection();
+
+  writer.Add(&offsets[0], offsets.size() * sizeof(uint64_t));
+  writer.Add(allScores.empty() ? NULL : &allScores[0], allScores.size() * sizeof(float));
+  std::vector<uint64_t>().swap(offsets);
+  std::vector<float>().swap(allScores);
+
+  // group the output words of each input word in file order, so a repeated
+  // output word keeps its last scores as in Load
+  std::sort(lines.begin(), lines.end());
+  for (size_t i = 0; i < lines.size(); ++i) {
+    SharedModelImage::Entry &entry = inputs.GetEntry(lines[i].first);
+    if (i == 0 || lines[i].first != lines[i - 1].first) {
+      entry.begin = i;
+    }
+    entry.end = i + 1;
+    writer.Append(&lines[i].second, sizeof(uint64_t));
+  }
+  writer.EndSection();
+  inputs.Write(writer);
+
+  const uint64_t meta[2] = { GetNumScoreComponents(), inputs.GetSize() };
+  writer.Add(meta, sizeof(meta));
+  writer.Commit();
+}
+
+bool GenerationDictionary::MapImage(const std::string &imagePath)
+{
+  if (!m_image.Map(imagePath, SHARED_MAGIC, SHARED_SECTIONS)) {
+    return false;
+  }
+  const uint64_t *meta = reinterpret_cast<const uint64_t*>(m_image.GetSection(SHARED_META));
+  UTIL_THROW_IF2(meta[0] != GetNumScoreComponents(), "Shared table " << imagePath << " has " << meta[0]
+                 << " scores instead of " << GetNumScoreComponents());
+  m_sharedSize = meta[1];
+  m_sharedTable = SharedModelImage::Table(m_image, SHARED_TABLE);
+  m_sharedOffsets = reinterpret_cast<const uint64_t*>(m_image.GetSection(SHARED_OFFSETS));
+  m_sharedScores = reinterpret_cast<const float*>(m_image.GetSection(SHARED_SCORES));
+  m_sharedText = m_image.GetSection(SHARED_TEXT);
+  m_sharedOutputs = reinterpret_cast<const uint64_t*>(m_image.GetSection(SHARED_OUTPUTS));
+  m_shared = true;
+  return true;
+}
+
+const OutputWordCollection *GenerationDictionary::FindSharedWord(const Word &word) const
+{
+#ifdef WITH_THREADS
+  {
+    boost::shared_lock<boost::shared_mutex> read_lock(m_accessLock);
+#endif
+    Collection::const_iterator iter = m_collection.find(&word);
+    if (iter != m_collection.end()) {
+      return &iter->second;
+    }
+#ifdef WITH_THREADS
+  }
+#endif
+
+  SharedModelImage::Key key;
+  key.Append(word, GetInput());
+  const SharedModelImage::Entry *entry = m_sharedTable.Find(key);
+  if (!entry) {
+    return NULL;
+  }
+
+  // build the output words outside the lock
+  FactorCollection &factorCollection = FactorCollection::Instance();
+  const size_t numScores = GetNumScoreComponents();
+  OutputWordCollection outputs;
+  for (uint64_t i = entry->begin; i < entry->end; ++i) {
+    const uint64_t output = m_sharedOutputs[i];
+    const string text(m_sharedText + m_sharedOffsets[output], m_sharedText + m_sharedOffsets[output + 1]);
+    vector<string> factorString = Tokenize(text, "|");
+    Word outputWord;
+    for (size_t j = 0 ; j < GetOutput().size() ; j++) {
+      outputWord.SetFactor(GetOutput()[j], factorCollection.AddFactor( Output, GetOutput()[j], factorString[j]));
+    }
+    const float *scores = m_sharedScores + output * numScores;
+    outputs[outputWord].Assign(this, std::vector<float>(scores, scores + numScores));
+  }
+
+  Word *inputWord = new Word();  // deleted in destructor
+  for (size_t i = 0 ; i < GetInput().size() ; i++) {
+    inputWord->SetFactor(GetInput()[i], word[GetInput()[i]]);
+  }
+#ifdef WITH_THREADS
+  boost::unique_lock<boost::shared_mutex> lock(m_accessLock);
+#endif
+  std::pair<Collection::iterator, bool> ret = m_collection.insert(std::make_pair(inputWord, OutputWordCollection()));
+  if (ret.second) {
+    ret.first->second.swap(outputs);
+  } else {
+    // another thread was faster
+    delete inputWord;
+  }
+  return &ret.first->second;
+}
+
 GenerationDictionary::~GenerationDictionary()
 {
   Collection::const_iterator iter;
@@ -117,6 +304,10 @@ GenerationDictionary::~GenerationDictionary()
 
 const OutputWordCollection *GenerationDictionary::FindWord(const Word &word) const
 {
+  if (m_shared) {
+    return FindSharedWord(word);
+  }
+
   const OutputWordCollection *ret;
 
   Collection::const_iterator iter = m_collection.find(&word);
@@ -26,9 +26,13 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <map>
 #include <stdexcept>
 #include <vector>
+#ifdef WITH_THREADS
+#include <boost/thread/shared_mutex.hpp>
+#endif
 #include "ScoreComponentCollection.h"
 #include "Phrase.h"
 #include "TypeDef.h"
+#include "SharedModelImage.h"
 #include "moses/FF/DecodeFeature.h"
 
 namespace Moses
@@ -48,11 +52,33 @@ class GenerationDictionary : public DecodeFeature
 protected:
   static std::vector<GenerationDictionary*> s_staticColl;
 
-  Collection m_collection;
+  mutable Collection m_collection;
   // 1st = source
   // 2nd = target
   std::string						m_filePath;
 
+  // with shared-model-dir the table is an image, and m_collection only
+  // holds the input words looked up so far
+  bool m_shared;
+  SharedModelImage m_image;
+  SharedModelImage::Table m_sharedTable;
+  size_t m_sharedSize;
+  const uint64_t *m_sharedOffsets;
+  const float *m_sharedScores;
+  const char *m_sharedText;
+  // output words in the order of the entries, which index this
+  const uint64_t *m_sharedOutputs;
+#ifdef WITH_THREADS
+  mutable boost::shared_mutex m_accessLock;
+#endif
+
+  void ParseLine(const std::string &line, size_t lineNum,
+                 std::vector<std::string> &input, std::vector<std::string> &output,
+                 std::vector<float> &scores) const;
+  void CreateImage(const std::string &imagePath) const;
+  bool MapImage(const std::string &imagePath);
+  const OutputWordCollection *FindSharedWord(const Word &word) const;
+
 public:
   static const std::vector<GenerationDictionary*>& GetColl() {
 	return s_staticColl;
@@ -68,7 +94,7 @@ public:
   * NOT the number of lines in the generation table
   */
   size_t GetSize() const {
-    return m_collection.size();
+    return m_shared ? m_sharedSize : m_collection.size();
   }
   /** returns a bag of output words, OutputWordCollection, for a particular input word.
   *	Or NULL if the input word isn't found. The search function used is the WordComparer functor
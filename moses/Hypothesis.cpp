@@ -32,6 +32,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "StaticData.h"
 #include "InputType.h"
 #include "Manager.h"
+#include "Profiler.h"
 #include "moses/FF/FFState.h"
 #include "moses/FF/StatefulFeatureFunction.h"
 #include "moses/FF/StatelessFeatureFunction.h"
@@ -162,7 +163,8 @@ Hypothesis* Hypothesis::Create(const Hypothesis &prevHypo, const TranslationOpti
   Hypothesis *ptr = s_objectPool.getPtr();
   return new(ptr) Hypothesis(prevHypo, transOpt);
 #else
-  return new Hypothesis(prevHypo, transOpt);
+  void *ptr = prevHypo.m_manager.GetContext().Allocate(sizeof(Hypothesis));
+  return new(ptr) Hypothesis(prevHypo, transOpt);
 #endif
 }
 /***
@@ -175,10 +177,19 @@ Hypothesis* Hypothesis::Create(Manager& manager, InputType const& m_source, cons
   Hypothesis *ptr = s_objectPool.getPtr();
   return new(ptr) Hypothesis(manager, m_source, initialTransOpt);
 #else
-  return new Hypothesis(manager, m_source, initialTransOpt);
+  void *ptr = manager.GetContext().Allocate(sizeof(Hypothesis));
+  return new(ptr) Hypothesis(manager, m_source, initialTransOpt);
 #endif
 }
 
+void Hypothesis::Delete(Hypothesis *hypo)
+{
+  if (hypo == NULL) return;
+  DecodingContext &context = hypo->m_manager.GetContext();
+  hypo->~Hypothesis();
+  context.Free(hypo, sizeof(Hypothesis));
+}
+
 /** check, if two hypothesis can be recombined.
     this is actually a sorting function that allows us to
     keep an ordered list of hypotheses. This makes recombination
@@ -210,6 +221,7 @@ void Hypothesis::EvaluateWhenApplied(const StatefulFeatureFunction &sfff,
 {
   const StaticData &staticData = StaticData::Instance();
   if (! staticData.IsFeatureFunctionIgnored( sfff )) {
+    Profiler::Scope profile(sfff, Profiler::EvaluateWhenApplied);
     m_ffStates[state_idx] = sfff.EvaluateWhenApplied(
                               *this,
                               m_prevHypo ? m_prevHypo->m_ffStates[state_idx] : NULL,
@@ -221,6 +233,7 @@ void Hypothesis::EvaluateWhenApplied(const StatelessFeatureFunction& slff)
 {
   const StaticData &staticData = StaticData::Instance();
   if (! staticData.IsFeatureFunctionIgnored( slff )) {
+    Profiler::Scope profile(slff, Profiler::EvaluateWhenApplied);
     slff.EvaluateWhenApplied(*this, &m_currScoreBreakdown);
   }
 }
@@ -253,6 +266,7 @@ void Hypothesis::EvaluateWhenApplied(const SquareMatrix &futureScore)
     const StatefulFeatureFunction &ff = *ffs[i];
     const StaticData &staticData = StaticData::Instance();
     if (! staticData.IsFeatureFunctionIgnored(ff)) {
+      Profiler::Scope profile(ff, Profiler::EvaluateWhenApplied);
       m_ffStates[i] = ff.EvaluateWhenApplied(*this,
                                   m_prevHypo ? m_prevHypo->m_ffStates[i] : NULL,
                                   &m_currScoreBreakdown);
@@ -330,9 +344,9 @@ void Hypothesis::CleanupArcList()
    * However, may not be enough if only unique candidates are needed,
    * so we'll keep all of arc list if nedd distinct n-best list
    */
-  const StaticData &staticData = StaticData::Instance();
-  size_t nBestSize = staticData.GetNBestSize();
-  bool distinctNBest = staticData.GetDistinctNBest() || staticData.GetLatticeSamplesSize() ||  staticData.UseMBR() || staticData.GetOutputSearchGraph() || staticData.GetOutputSearchGraphSLF() || staticData.GetOutputSearchGraphHypergraph() || staticData.UseLatticeMBR() ;
+  const DecodingOptions &options = m_manager.GetOptions();
+  size_t nBestSize = options.nBestSize;
+  bool distinctNBest = options.KeepAllArcs();
 
   if (!distinctNBest && m_arcList->size() > nBestSize * 5) {
     // prune arc list only if there too many arcs
@@ -114,6 +114,10 @@ public:
   /** return the subclass of Hypothesis most appropriate to the given translation option */
   Hypothesis* CreateNext(const TranslationOption &transOpt) const;
 
+  /** delete a hypothesis from Create(), keeping its memory in the decoding
+   * context of its manager for the next one */
+  static void Delete(Hypothesis *hypo);
+
   void PrintHypothesis() const;
 
   const InputType& GetInput() const {
@@ -289,7 +293,7 @@ struct CompareHypothesisTotalScore {
 } \
  
 #else
-#define FREEHYPO(hypo) delete hypo
+#define FREEHYPO(hypo) Hypothesis::Delete(hypo)
 #endif
 
 /** defines less-than relation on hypotheses.
@@ -1,8 +1,15 @@
 
 #include "HypothesisStack.h"
+#include "Manager.h"
 
 namespace Moses
 {
+HypothesisStack::HypothesisStack(Manager& manager)
+  : m_hypos(HypothesisRecombinationOrderer(), _HCType::allocator_type(manager.GetContext()))
+  , m_manager(manager)
+{
+}
+
 HypothesisStack::~HypothesisStack()
 {
   // delete all hypos
@@ -4,6 +4,7 @@
 #include <vector>
 #include <set>
 #include "Hypothesis.h"
+#include "DecodingContext.h"
 #include "WordsBitmap.h"
 
 namespace Moses
@@ -18,12 +19,12 @@ class HypothesisStack
 {
 
 protected:
-  typedef std::set< Hypothesis*, HypothesisRecombinationOrderer > _HCType;
-  _HCType m_hypos; /**< contains hypotheses */
+  typedef std::set< Hypothesis*, HypothesisRecombinationOrderer, DecodingContext::Allocator<Hypothesis*> > _HCType;
+  _HCType m_hypos; /**< contains hypotheses, in the memory of the decoding context */
   Manager& m_manager;
 
 public:
-  HypothesisStack(Manager& manager): m_manager(manager) {}
+  HypothesisStack(Manager& manager);
   typedef _HCType::iterator iterator;
   typedef _HCType::const_iterator const_iterator;
   //! iterators
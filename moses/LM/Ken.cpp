@@ -67,7 +67,7 @@ struct KenLMState : public FFState {
 //template <class Model> class LanguageModelKen : public LanguageModel
 //{
 //public:
-//  LanguageModelKen(const std::string &line, const std::string &file, FactorType factorType, bool lazy);
+//  LanguageModelKen(const std::string &line, const std::string &file, FactorType factorType, util::LoadMethod load_method);
 //
 //  const FFState *EmptyHypothesisState(const InputType &/*input*/) const {
 //    KenLMState *ret = new KenLMState();
@@ -140,7 +140,7 @@ private:
 
 } // namespace
 
-template <class Model> LanguageModelKen<Model>::LanguageModelKen(const std::string &line, const std::string &file, FactorType factorType, bool lazy)
+template <class Model> LanguageModelKen<Model>::LanguageModelKen(const std::string &line, const std::string &file, FactorType factorType, util::LoadMethod load_method)
   :LanguageModel(line)
   ,m_factorType(factorType)
 {
@@ -154,7 +154,7 @@ template <class Model> LanguageModelKen<Model>::LanguageModelKen(const std::stri
   FactorCollection &collection = FactorCollection::Instance();
   MappingBuilder builder(collection, m_lmIdLookup);
   config.enumerate_vocab = &builder;
-  config.load_method = lazy ? util::LAZY : util::POPULATE_OR_READ;
+  config.load_method = load_method;
 
   m_ngram.reset(new Model(file.c_str(), config));
 
@@ -390,6 +390,7 @@ LanguageModel *ConstructKenLM(const std::string &line)
 {
   FactorType factorType = 0;
   string filePath;
+  util::LoadMethod load_method = util::POPULATE_OR_READ;
   bool lazy = false;
 
   vector<string> toks = Tokenize(line);
@@ -406,37 +407,60 @@ LanguageModel *ConstructKenLM(const std::string &line)
       filePath = args[1];
     } else if (args[0] == "lazyken") {
       lazy = Scan<bool>(args[1]);
+    } else if (args[0] == "load") {
+      if (args[1] == "lazy") {
+        load_method = util::LAZY;
+      } else if (args[1] == "populate") {
+        load_method = util::POPULATE_OR_READ;
+      } else if (args[1] == "read") {
+        load_method = util::READ;
+      } else if (args[1] == "parallel_read") {
+        load_method = util::PARALLEL_READ;
+      } else if (args[1] == "huge") {
+        load_method = util::HUGE_READ;
+      } else if (args[1] == "huge_interleave") {
+        load_method = util::HUGE_INTERLEAVE_READ;
+      } else {
+        UTIL_THROW2("Unknown KenLM load method " << args[1] << ".  Use lazy, populate, read, parallel_read, huge, or huge_interleave.");
+      }
     } else if (args[0] == "name") {
       // that's ok. do nothing, passes onto LM constructor
     }
   }
 
-  return ConstructKenLM(line, filePath, factorType, lazy);
+  if (lazy) {
+    // lazyken keeps the model on disk, so it cannot be read into huge pages
+    UTIL_THROW_IF2(load_method == util::HUGE_READ || load_method == util::HUGE_INTERLEAVE_READ,
+                   "lazyken=true conflicts with load=huge and load=huge_interleave in " << line);
+    load_method = util::LAZY;
+  }
+
+  return ConstructKenLM(line, filePath, factorType, load_method);
 }
 
-LanguageModel *ConstructKenLM(const std::string &line, const std::string &file, FactorType factorType, bool lazy)
+LanguageModel *ConstructKenLM(const std::string &line, const std::string &file, FactorType factorType, util::LoadMethod load_method)
 {
     lm::ngram::ModelType model_type;
     if (lm::ngram::RecognizeBinary(file.c_str(), model_type)) {
 
       switch(model_type) {
       case lm::ngram::PROBING:
-        return new LanguageModelKen<lm::ngram::ProbingModel>(line, file, factorType, lazy);
+        return new LanguageModelKen<lm::ngram::ProbingModel>(line, file, factorType, load_method);
       case lm::ngram::REST_PROBING:
-        return new LanguageModelKen<lm::ngram::RestProbingModel>(line, file, factorType, lazy);
+        return new LanguageModelKen<lm::ngram::RestProbingModel>(line, file, factorType, load_method);
       case lm::ngram::TRIE:
-        return new LanguageModelKen<lm::ngram::TrieModel>(line, file, factorType, lazy);
+        return new LanguageModelKen<lm::ngram::TrieModel>(line, file, factorType, load_method);
       case lm::ngram::QUANT_TRIE:
-        return new LanguageModelKen<lm::ngram::QuantTrieModel>(line, file, factorType, lazy);
+        return new LanguageModelKen<lm::ngram::QuantTrieModel>(line, file, factorType, load_method);
       case lm::ngram::ARRAY_TRIE:
-        return new LanguageModelKen<lm::ngram::ArrayTrieModel>(line, file, factorType, lazy);
+        return new LanguageModelKen<lm::ngram::ArrayTrieModel>(line, file, factorType, load_method);
       case lm::ngram::QUANT_ARRAY_TRIE:
-        return new LanguageModelKen<lm::ngram::QuantArrayTrieModel>(line, file, factorType, lazy);
+        return new LanguageModelKen<lm::ngram::QuantArrayTrieModel>(line, file, factorType, load_method);
       default:
     	UTIL_THROW2("Unrecognized kenlm model type " << model_type);
       }
     } else {
-      return new LanguageModelKen<lm::ngram::ProbingModel>(line, file, factorType, lazy);
+      return new LanguageModelKen<lm::ngram::ProbingModel>(line, file, factorType, load_method);
     }
 }
 
@@ -0,0 +1,73 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2014 University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#include <memory>
+#include <vector>
+
+#include "Benchmark.h"
+#include "lm/model.hh"
+#include "util/tokenize_piece.hh"
+
+namespace MosesBenchmark
+{
+
+namespace
+{
+
+// KenLM queries for every word of the synthetic sentences, with their
+// words replaced by target words
+class FullScoreBenchmark : public Benchmark
+{
+public:
+  FullScoreBenchmark() : Benchmark("KenLM/FullScore") {}
+  void SetUp() {
+    const SyntheticModel &synthetic = GetSyntheticModel();
+    lm::ngram::Config config;
+    config.messages = NULL;
+    m_model.reset(new lm::ngram::ProbingModel(synthetic.languageModel.c_str(), config));
+    for (size_t s = 0; s < synthetic.sentences.size(); ++s) {
+      for (util::TokenIter<util::SingleCharacter, true> word(synthetic.sentences[s], ' '); word; ++word) {
+        // s123 -> t123
+        m_words.push_back(m_model->GetVocabulary().Index("t" + word->substr(1).as_string()));
+      }
+    }
+  }
+  void Run(size_t iterations) {
+    const lm::ngram::ProbingModel &model = *m_model;
+    lm::ngram::State state[2];
+    for (size_t i = 0; i < iterations; ++i) {
+      state[0] = model.BeginSentenceState();
+      float total = 0;
+      for (size_t w = 0; w < m_words.size(); ++w) {
+        total += model.FullScore(state[w % 2], m_words[w], state[(w + 1) % 2]).prob;
+      }
+      Use(total);
+    }
+  }
+  size_t GetOpsPerIteration() const {
+    return m_words.size();
+  }
+private:
+  std::auto_ptr<lm::ngram::ProbingModel> m_model;
+  std::vector<lm::WordIndex> m_words;
+} s_fullScore;
+
+}
+
+}
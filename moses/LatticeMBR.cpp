@@ -51,30 +51,36 @@ void extract_ngrams(const vector<Word >& sentence, map < Phrase, int >  & allngr
 
 
 
-void NgramScores::addScore(const Hypothesis* node, const Phrase& ngram, float score)
+size_t NgramScores::GetId(const Phrase& ngram)
 {
-  set<Phrase>::const_iterator ngramIter = m_ngrams.find(ngram);
-  if (ngramIter == m_ngrams.end()) {
-    ngramIter = m_ngrams.insert(ngram).first;
-  }
-  map<const Phrase*,float>& ngramScores = m_scores[node];
-  map<const Phrase*,float>::iterator scoreIter = ngramScores.find(&(*ngramIter));
-  if (scoreIter == ngramScores.end()) {
-    ngramScores[&(*ngramIter)] = score;
-  } else {
-    ngramScores[&(*ngramIter)] = log_sum(score,scoreIter->second);
+  pair<boost::unordered_map<Phrase, size_t>::iterator, bool> ins =
+    m_ids.insert(make_pair(ngram, m_ngrams.size()));
+  if (ins.second) {
+    m_ngrams.push_back(&ins.first->first);
+    m_position.push_back(-1);
   }
+  return ins.first->second;
 }
 
-NgramScores::NodeScoreIterator NgramScores::nodeBegin(const Hypothesis* node)
+void NgramScores::addScore(size_t node, size_t ngramId, float score)
 {
-  return m_scores[node].begin();
+  vector<pair<size_t, float> >& nodeScores = m_scores[node];
+  int& position = m_position[ngramId];
+  if (position == -1) {
+    position = nodeScores.size();
+    nodeScores.push_back(make_pair(ngramId, score));
+  } else {
+    float& currScore = nodeScores[position].second;
+    currScore = log_sum(score, currScore);
+  }
 }
 
-
-NgramScores::NodeScoreIterator NgramScores::nodeEnd(const Hypothesis* node)
+void NgramScores::finishNode(size_t node)
 {
-  return m_scores[node].end();
+  const vector<pair<size_t, float> >& nodeScores = m_scores[node];
+  for (size_t i = 0; i < nodeScores.size(); ++i) {
+    m_position[nodeScores[i].first] = -1;
+  }
 }
 
 LatticeMBRSolution::LatticeMBRSolution(const TrellisPath& path, bool isMap) :
@@ -131,7 +137,32 @@ void LatticeMBRSolution::CalcScore(map<Phrase, float>& finalNgramScores, const v
 }
 
 
-void pruneLatticeFB(Lattice & connectedHyp, map < const Hypothesis*, set <const Hypothesis* > > & outgoingHyps, map<const Hypothesis*, vector<Edge> >& incomingEdges,
+namespace
+{
+// an edge of the pruned lattice, before the edges are grouped by head node
+struct PendingEdge {
+  const Hypothesis* tail;
+  const Hypothesis* head;
+  float score;
+  const TargetPhrase* phrase;
+
+  PendingEdge(const Hypothesis* tail, const Hypothesis* head, float score, const TargetPhrase& phrase)
+    : tail(tail), head(head), score(score), phrase(&phrase) {}
+};
+
+int GetHypIndex(const vector<int>& hypIndex, const Hypothesis* hyp)
+{
+  if (hyp == NULL || (size_t) hyp->GetId() >= hypIndex.size()) return -1;
+  return hypIndex[hyp->GetId()];
+}
+
+bool ascendingScoreCmp(const pair<float, size_t>& a, const pair<float, size_t>& b)
+{
+  return a.first < b.first;
+}
+}
+
+void pruneLatticeFB(const Lattice & connectedHyp, const map < const Hypothesis*, set <const Hypothesis* > > & outgoingHyps, LatticeGraph& lattice,
                     const vector< float> & estimatedScores, const Hypothesis* bestHypo, size_t edgeDensity, float scale)
 {
 
@@ -141,35 +172,69 @@ void pruneLatticeFB(Lattice & connectedHyp, map < const Hypothesis*, set <const
   while (emptyHyp->GetId() != 0) {
     emptyHyp = emptyHyp->GetPrevHypo();
   }
-  connectedHyp.push_back(emptyHyp); //Add it to list of hyps
+  Lattice hyps(connectedHyp);
+  hyps.push_back(emptyHyp); //Add it to list of hyps
+
+  //number the hyps, so that everything about them is kept in arrays
+  size_t maxId = 0;
+  for (size_t i = 0; i < hyps.size(); ++i) {
+    maxId = max(maxId, (size_t) hyps[i]->GetId());
+  }
+  vector<int> hypIndex(maxId + 1, -1);
+  for (size_t i = 0; i < hyps.size(); ++i) {
+    hypIndex[hyps[i]->GetId()] = i;
+  }
 
-  //Need hyp 0's outgoing Hyps
+  //successors of hyp i are successors[successorStart[i]] to successors[successorStart[i+1]-1],
+  //in the order of the sets of outgoingHyps. Need hyp 0's outgoing Hyps too
+  set<const Hypothesis*> emptyHypSuccessors;
+  map < const Hypothesis*, set < const Hypothesis* > >::const_iterator outgoingIt = outgoingHyps.find(emptyHyp);
+  if (outgoingIt != outgoingHyps.end()) {
+    emptyHypSuccessors = outgoingIt->second;
+  }
   for (size_t i = 0; i < connectedHyp.size(); ++i) {
     if (connectedHyp[i]->GetId() > 0 && connectedHyp[i]->GetPrevHypo()->GetId() == 0)
-      outgoingHyps[emptyHyp].insert(connectedHyp[i]);
+      emptyHypSuccessors.insert(connectedHyp[i]);
+  }
+  vector<size_t> successorStart(hyps.size() + 1);
+  vector<size_t> successors;
+  for (size_t i = 0; i < hyps.size(); ++i) {
+    successorStart[i] = successors.size();
+    const set<const Hypothesis*>* outHyps = &emptyHypSuccessors;
+    if (hyps[i] != emptyHyp) {
+      outgoingIt = outgoingHyps.find(hyps[i]);
+      if (outgoingIt == outgoingHyps.end()) continue;
+      outHyps = &outgoingIt->second;
+    }
+    for (set<const Hypothesis*>::const_iterator outHypIts = outHyps->begin(); outHypIts != outHyps->end(); ++outHypIts) {
+      int succ = GetHypIndex(hypIndex, *outHypIts);
+      if (succ != -1) successors.push_back(succ); //only hyps of the lattice can make the cut
+    }
   }
+  successorStart[hyps.size()] = successors.size();
 
-  //sort hyps based on estimated scores - do so by copying to multimap
-  multimap<float, const Hypothesis*> sortHypsByVal;
+  //sort hyps based on estimated scores, keeping hyps of equal score in reverse order
+  vector<pair<float, size_t> > sortHypsByVal;
   for (size_t i =0; i < estimatedScores.size(); ++i) {
-    sortHypsByVal.insert(make_pair(estimatedScores[i], connectedHyp[i]));
+    sortHypsByVal.push_back(make_pair(estimatedScores[i], i));
   }
+  stable_sort(sortHypsByVal.begin(), sortHypsByVal.end(), ascendingScoreCmp);
 
-  multimap<float, const Hypothesis*>::const_iterator it = --sortHypsByVal.end();
-  float bestScore = it->first;
+  float bestScore = sortHypsByVal.back().first;
   //store best score as score of hyp 0
-  sortHypsByVal.insert(make_pair(bestScore, emptyHyp));
+  sortHypsByVal.push_back(make_pair(bestScore, hyps.size() - 1));
 
 
   IFVERBOSE(3) {
-    for (multimap<float, const Hypothesis*>::const_iterator it = --sortHypsByVal.end(); it != --sortHypsByVal.begin(); --it) {
-      const Hypothesis* currHyp =  it->second;
-      cerr << "Hyp " << currHyp->GetId() << ", estimated score: " << it->first << endl;
+    for (size_t i = sortHypsByVal.size(); i-- > 0; ) {
+      const Hypothesis* currHyp = hyps[sortHypsByVal[i].second];
+      cerr << "Hyp " << currHyp->GetId() << ", estimated score: " << sortHypsByVal[i].first << endl;
     }
   }
 
 
-  set <const Hypothesis*> survivingHyps; //store hyps that make the cut in this
+  vector<bool> survivingHyps(hyps.size(), false); //store hyps that make the cut in this
+  vector<PendingEdge> edges;
 
   VERBOSE(2, "BEST HYPO TARGET LENGTH : " << bestHypo->GetSize() << endl)
   size_t numEdgesTotal = edgeDensity * bestHypo->GetSize(); //as per Shankar, aim for (density * target length of MAP solution) arcs
@@ -178,25 +243,25 @@ void pruneLatticeFB(Lattice & connectedHyp, map < const Hypothesis*, set <const
 
   float prevScore = -999999;
 
-  //now iterate over multimap
-  for (multimap<float, const Hypothesis*>::const_iterator it = --sortHypsByVal.end(); it != --sortHypsByVal.begin(); --it) {
-    float currEstimatedScore = it->first;
-    const Hypothesis* currHyp =  it->second;
+  //now iterate over the hyps, best first
+  for (size_t s = sortHypsByVal.size(); s-- > 0; ) {
+    float currEstimatedScore = sortHypsByVal[s].first;
+    size_t curr = sortHypsByVal[s].second;
+    const Hypothesis* currHyp = hyps[curr];
 
     if (numEdgesCreated >= numEdgesTotal && prevScore > currEstimatedScore) //if this hyp has equal estimated score to previous, include its edges too
       break;
 
     prevScore = currEstimatedScore;
     VERBOSE(3, "Num edges created : "<< numEdgesCreated << ", numEdges wanted " << numEdgesTotal << endl)
-    VERBOSE(3, "Considering hyp " << currHyp->GetId() << ", estimated score: " << it->first << endl)
+    VERBOSE(3, "Considering hyp " << currHyp->GetId() << ", estimated score: " << currEstimatedScore << endl)
 
-    survivingHyps.insert(currHyp); //CurrHyp made the cut
+    survivingHyps[curr] = true; //CurrHyp made the cut
 
     // is its best predecessor already included ?
-    if (survivingHyps.find(currHyp->GetPrevHypo()) != survivingHyps.end()) { //yes, then add an edge
-      vector <Edge>& edges = incomingEdges[currHyp];
-      Edge winningEdge(currHyp->GetPrevHypo(),currHyp,scale*(currHyp->GetScore() - currHyp->GetPrevHypo()->GetScore()),currHyp->GetCurrTargetPhrase());
-      edges.push_back(winningEdge);
+    int prev = GetHypIndex(hypIndex, currHyp->GetPrevHypo());
+    if (prev != -1 && survivingHyps[prev]) { //yes, then add an edge
+      edges.push_back(PendingEdge(currHyp->GetPrevHypo(),currHyp,scale*(currHyp->GetScore() - currHyp->GetPrevHypo()->GetScore()),currHyp->GetCurrTargetPhrase()));
       ++numEdgesCreated;
     }
 
@@ -207,68 +272,82 @@ void pruneLatticeFB(Lattice & connectedHyp, map < const Hypothesis*, set <const
       for (iterArcList = arcList->begin() ; iterArcList != arcList->end() ; ++iterArcList) {
         const Hypothesis *loserHypo = *iterArcList;
         const Hypothesis* loserPrevHypo = loserHypo->GetPrevHypo();
-        if (survivingHyps.find(loserPrevHypo) != survivingHyps.end()) { //found it, add edge
+        int loserPrev = GetHypIndex(hypIndex, loserPrevHypo);
+        if (loserPrev != -1 && survivingHyps[loserPrev]) { //found it, add edge
           double arcScore = loserHypo->GetScore() - loserPrevHypo->GetScore();
-          Edge losingEdge(loserPrevHypo, currHyp, arcScore*scale, loserHypo->GetCurrTargetPhrase());
-          vector <Edge>& edges = incomingEdges[currHyp];
-          edges.push_back(losingEdge);
+          edges.push_back(PendingEdge(loserPrevHypo, currHyp, arcScore*scale, loserHypo->GetCurrTargetPhrase()));
           ++numEdgesCreated;
         }
       }
     }
 
     //Now if a successor node has already been visited, add an edge connecting the two
-    map < const Hypothesis*, set < const Hypothesis* > >::const_iterator outgoingIt = outgoingHyps.find(currHyp);
-
-    if (outgoingIt != outgoingHyps.end()) {//currHyp does have successors
-      const set<const Hypothesis*> & outHyps = outgoingIt->second; //the successors
-      for (set<const Hypothesis*>::const_iterator outHypIts = outHyps.begin(); outHypIts != outHyps.end(); ++outHypIts) {
-        const Hypothesis* succHyp = *outHypIts;
-
-        if (survivingHyps.find(succHyp) == survivingHyps.end()) //Have we encountered the successor yet?
-          continue; //No, move on to next
-
-        //Curr Hyp can be : a) the best predecessor  of succ b) or an arc attached to succ
-        if (succHyp->GetPrevHypo() == currHyp) { //best predecessor
-          vector <Edge>& succEdges = incomingEdges[succHyp];
-          Edge succWinningEdge(currHyp, succHyp, scale*(succHyp->GetScore() - currHyp->GetScore()), succHyp->GetCurrTargetPhrase());
-          succEdges.push_back(succWinningEdge);
-          survivingHyps.insert(succHyp);
-          ++numEdgesCreated;
-        }
+    for (size_t o = successorStart[curr]; o < successorStart[curr + 1]; ++o) {
+      if (!survivingHyps[successors[o]]) //Have we encountered the successor yet?
+        continue; //No, move on to next
+      const Hypothesis* succHyp = hyps[successors[o]];
+
+      //Curr Hyp can be : a) the best predecessor  of succ b) or an arc attached to succ
+      if (succHyp->GetPrevHypo() == currHyp) { //best predecessor
+        edges.push_back(PendingEdge(currHyp, succHyp, scale*(succHyp->GetScore() - currHyp->GetScore()), succHyp->GetCurrTargetPhrase()));
+        ++numEdgesCreated;
+      }
 
-        //now, let's find an arc
-        const ArcList *arcList = succHyp->GetArcList();
-        if (arcList != NULL) {
-          ArcList::const_iterator iterArcList;
-          //QUESTION: What happens if there's more than one loserPrevHypo?
-          for (iterArcList = arcList->begin() ; iterArcList != arcList->end() ; ++iterArcList) {
-            const Hypothesis *loserHypo = *iterArcList;
-            const Hypothesis* loserPrevHypo = loserHypo->GetPrevHypo();
-            if (loserPrevHypo == currHyp) { //found it
-              vector <Edge>& succEdges = incomingEdges[succHyp];
-              double arcScore = loserHypo->GetScore() - currHyp->GetScore();
-              Edge losingEdge(currHyp, succHyp,scale* arcScore, loserHypo->GetCurrTargetPhrase());
-              succEdges.push_back(losingEdge);
-              ++numEdgesCreated;
-            }
+      //now, let's find an arc
+      const ArcList *arcList = succHyp->GetArcList();
+      if (arcList != NULL) {
+        ArcList::const_iterator iterArcList;
+        //QUESTION: What happens if there's more than one loserPrevHypo?
+        for (iterArcList = arcList->begin() ; iterArcList != arcList->end() ; ++iterArcList) {
+          const Hypothesis *loserHypo = *iterArcList;
+          const Hypothesis* loserPrevHypo = loserHypo->GetPrevHypo();
+          if (loserPrevHypo == currHyp) { //found it
+            double arcScore = loserHypo->GetScore() - currHyp->GetScore();
+            edges.push_back(PendingEdge(currHyp, succHyp,scale* arcScore, loserHypo->GetCurrTargetPhrase()));
+            ++numEdgesCreated;
           }
         }
       }
     }
   }
 
-  connectedHyp.clear();
-  for (set <const Hypothesis*>::iterator it =  survivingHyps.begin(); it != survivingHyps.end(); ++it) {
-    connectedHyp.push_back(*it);
+  //number the surviving hyps by increasing source coverage
+  lattice.nodes.clear();
+  for (size_t i = 0; i < hyps.size(); ++i) {
+    if (survivingHyps[i]) lattice.nodes.push_back(hyps[i]);
+  }
+  stable_sort(lattice.nodes.begin(), lattice.nodes.end(), ascendingCoverageCmp);
+  lattice.nodeIndex.assign(maxId + 1, -1);
+  for (size_t i = 0; i < lattice.nodes.size(); ++i) {
+    lattice.nodeIndex[lattice.nodes[i]->GetId()] = i;
+  }
+
+  //group the edges by head node, keeping the order in which they were created
+  lattice.edgeStart.assign(lattice.nodes.size() + 1, 0);
+  for (size_t e = 0; e < edges.size(); ++e) {
+    ++lattice.edgeStart[lattice.GetIndex(edges[e].head) + 1];
+  }
+  for (size_t i = 0; i < lattice.nodes.size(); ++i) {
+    lattice.edgeStart[i + 1] += lattice.edgeStart[i];
+  }
+  vector<size_t> order(edges.size());
+  vector<size_t> next(lattice.edgeStart.begin(), lattice.edgeStart.end() - 1);
+  for (size_t e = 0; e < edges.size(); ++e) {
+    order[next[lattice.GetIndex(edges[e].head)]++] = e;
+  }
+  lattice.edges.clear();
+  lattice.edges.reserve(edges.size());
+  for (size_t e = 0; e < order.size(); ++e) {
+    const PendingEdge& edge = edges[order[e]];
+    lattice.edges.push_back(Edge(edge.tail, edge.head, edge.score, *edge.phrase));
   }
 
   VERBOSE(2, "Done! Num edges created : "<< numEdgesCreated << ", numEdges wanted " << numEdgesTotal << endl)
 
   IFVERBOSE(3) {
     cerr << "Surviving hyps: " ;
-    for (set <const Hypothesis*>::iterator it =  survivingHyps.begin(); it != survivingHyps.end(); ++it) {
-      cerr << (*it)->GetId() << " ";
+    for (size_t i = 0; i < lattice.nodes.size(); ++i) {
+      cerr << lattice.nodes[i]->GetId() << " ";
     }
     cerr << endl;
   }
@@ -276,105 +355,124 @@ void pruneLatticeFB(Lattice & connectedHyp, map < const Hypothesis*, set <const
 
 }
 
-void calcNgramExpectations(Lattice & connectedHyp, map<const Hypothesis*, vector<Edge> >& incomingEdges,
-                           map<Phrase, float>& finalNgramScores, bool posteriors)
+void calcNgramExpectations(LatticeGraph& lattice, map<Phrase, float>& finalNgramScores, bool posteriors)
 {
-
-  sort(connectedHyp.begin(),connectedHyp.end(),ascendingCoverageCmp); //sort by increasing source word cov
+  //nodes are sorted by increasing source word cov
+  const Lattice& connectedHyp = lattice.nodes;
 
   /*cerr << "Lattice:" << endl;
-  for (Lattice::const_iterator i = connectedHyp.begin(); i != connectedHyp.end(); ++i) {
-      const Hypothesis* h = *i;
-      cerr << *h << endl;
-      const vector<Edge>& edges = incomingEdges[h];
-      for (size_t e = 0; e < edges.size(); ++e) {
-          cerr << edges[e];
+  for (size_t i = 0; i < connectedHyp.size(); ++i) {
+      cerr << *connectedHyp[i] << endl;
+      for (size_t e = lattice.edgeStart[i]; e < lattice.edgeStart[i+1]; ++e) {
+          cerr << lattice.edges[e];
       }
   }*/
 
-  map<const Hypothesis*, float> forwardScore;
-  forwardScore[connectedHyp[0]] = 0.0f; //forward score of hyp 0 is 1 (or 0 in logprob space)
-  set< const Hypothesis *> finalHyps; //store completed hyps
+  vector<float> forwardScore(connectedHyp.size(), 0.0f); //forward score of hyp 0 is 1 (or 0 in logprob space)
+  vector<bool> hasForwardScore(connectedHyp.size(), false);
+  hasForwardScore[0] = true;
+  vector<size_t> finalHyps; //store completed hyps
 
-  NgramScores ngramScores;//ngram scores for each hyp
+  NgramScores ngramScores(connectedHyp.size());//ngram scores for each hyp
+  vector<bool> isEdgeNgram; //ngrams introduced by the edge being processed
+  vector<size_t> edgeNgrams;
 
   for (size_t i = 1; i < connectedHyp.size(); ++i) {
     const Hypothesis* currHyp = connectedHyp[i];
     if (currHyp->GetWordsBitmap().IsComplete()) {
-      finalHyps.insert(currHyp);
+      finalHyps.push_back(i);
     }
 
     VERBOSE(3, "Processing hyp: " << currHyp->GetId() << ", num words cov= " << currHyp->GetWordsBitmap().GetNumWordsCovered() <<  endl)
 
-    vector <Edge> & edges = incomingEdges[currHyp];
-    for (size_t e = 0; e < edges.size(); ++e) {
-      const Edge& edge = edges[e];
-      if (forwardScore.find(currHyp) == forwardScore.end()) {
-        forwardScore[currHyp] = forwardScore[edge.GetTailNode()] + edge.GetScore();
+    for (size_t e = lattice.edgeStart[i]; e < lattice.edgeStart[i+1]; ++e) {
+      const Edge& edge = lattice.edges[e];
+      int tail = lattice.GetIndex(edge.GetTailNode());
+      float tailScore = tail == -1 ? 0.0f : forwardScore[tail];
+      if (!hasForwardScore[i]) {
+        forwardScore[i] = tailScore + edge.GetScore();
+        hasForwardScore[i] = true;
         VERBOSE(3, "Fwd score["<<currHyp->GetId()<<"] = fwdScore["<<edge.GetTailNode()->GetId() << "] + edge Score: " << edge.GetScore() << endl)
       } else {
-        forwardScore[currHyp] = log_sum(forwardScore[currHyp], forwardScore[edge.GetTailNode()] + edge.GetScore());
+        forwardScore[i] = log_sum(forwardScore[i], tailScore + edge.GetScore());
         VERBOSE(3, "Fwd score["<<currHyp->GetId()<<"] += fwdScore["<<edge.GetTailNode()->GetId() << "] + edge Score: " << edge.GetScore() << endl)
       }
     }
 
     //Process ngrams now
-    for (size_t j =0 ; j < edges.size(); ++j) {
-      Edge& edge = edges[j];
-      const NgramHistory & incomingPhrases = edge.GetNgrams(incomingEdges);
+    for (size_t j = lattice.edgeStart[i]; j < lattice.edgeStart[i+1]; ++j) {
+      Edge& edge = lattice.edges[j];
+      const NgramHistory & incomingPhrases = edge.GetNgrams(lattice);
 
       //let's first score ngrams introduced by this edge
       for (NgramHistory::const_iterator it = incomingPhrases.begin(); it != incomingPhrases.end(); ++it) {
-        const Phrase& ngram = it->first;
         const PathCounts& pathCounts = it->second;
+        size_t ngramId = ngramScores.GetId(it->first);
+        if (ngramId >= isEdgeNgram.size()) {
+          isEdgeNgram.resize(ngramId + 1, false);
+        }
+        isEdgeNgram[ngramId] = true;
+        edgeNgrams.push_back(ngramId);
         VERBOSE(4, "Calculating score for: " << it->first << endl)
 
         for (PathCounts::const_iterator pathCountIt = pathCounts.begin(); pathCountIt != pathCounts.end(); ++pathCountIt) {
           //Score of an n-gram is forward score of head node of leftmost edge + all edge scores
           const Path&  path = pathCountIt->first;
           //cerr << "path count for " << ngram << " is " << pathCountIt->second << endl;
-          float score = forwardScore[path[0]->GetTailNode()];
-          for (size_t i = 0; i < path.size(); ++i) {
-            score += path[i]->GetScore();
+          int pathTail = lattice.GetIndex(path[0]->GetTailNode());
+          float score = pathTail == -1 ? 0.0f : forwardScore[pathTail];
+          for (size_t p = 0; p < path.size(); ++p) {
+            score += path[p]->GetScore();
           }
           //if we're doing expectations, then the number of times the ngram
           //appears on the path is relevant.
           size_t count = posteriors ? 1 : pathCountIt->second;
           for (size_t k = 0; k < count; ++k) {
-            ngramScores.addScore(currHyp,ngram,score);
+            ngramScores.addScore(i,ngramId,score);
           }
         }
       }
 
       //Now score ngrams that are just being propagated from the history
-      for (NgramScores::NodeScoreIterator it = ngramScores.nodeBegin(edge.GetTailNode());
-           it != ngramScores.nodeEnd(edge.GetTailNode()); ++it) {
-        const Phrase & currNgram = *(it->first);
-        float currNgramScore = it->second;
-        VERBOSE(4, "Calculating score for: " << currNgram << endl)
-
-        // For posteriors, don't double count ngrams
-        if (!posteriors || incomingPhrases.find(currNgram) == incomingPhrases.end()) {
-          float score = edge.GetScore() + currNgramScore;
-          ngramScores.addScore(currHyp,currNgram,score);
+      int tail = lattice.GetIndex(edge.GetTailNode());
+      if (tail != -1) {
+        for (NgramScores::NodeScoreIterator it = ngramScores.nodeBegin(tail);
+             it != ngramScores.nodeEnd(tail); ++it) {
+          size_t currNgram = it->first;
+          float currNgramScore = it->second;
+          VERBOSE(4, "Calculating score for: " << ngramScores.GetNgram(currNgram) << endl)
+
+          // For posteriors, don't double count ngrams
+          if (!posteriors || currNgram >= isEdgeNgram.size() || !isEdgeNgram[currNgram]) {
+            float score = edge.GetScore() + currNgramScore;
+            ngramScores.addScore(i,currNgram,score);
+          }
         }
       }
 
+      for (size_t k = 0; k < edgeNgrams.size(); ++k) {
+        isEdgeNgram[edgeNgrams[k]] = false;
+      }
+      edgeNgrams.clear();
     }
+    ngramScores.finishNode(i);
   }
 
   float Z = 9999999; //the total score of the lattice
 
   //Done - Print out ngram posteriors for final hyps
-  for (set< const Hypothesis *>::iterator finalHyp = finalHyps.begin(); finalHyp != finalHyps.end(); ++finalHyp) {
-    const Hypothesis* hyp = *finalHyp;
+  vector<float> finalScores(ngramScores.GetSize());
+  vector<bool> hasFinalScore(ngramScores.GetSize(), false);
+  for (size_t f = 0; f < finalHyps.size(); ++f) {
+    size_t hyp = finalHyps[f];
 
     for (NgramScores::NodeScoreIterator it = ngramScores.nodeBegin(hyp); it != ngramScores.nodeEnd(hyp); ++it) {
-      const Phrase& ngram = *(it->first);
-      if (finalNgramScores.find(ngram) == finalNgramScores.end()) {
-        finalNgramScores[ngram] = it->second;
+      size_t ngram = it->first;
+      if (!hasFinalScore[ngram]) {
+        finalScores[ngram] = it->second;
+        hasFinalScore[ngram] = true;
       } else {
-        finalNgramScores[ngram] = log_sum(it->second,  finalNgramScores[ngram]);
+        finalScores[ngram] = log_sum(it->second, finalScores[ngram]);
       }
     }
 
@@ -387,16 +485,19 @@ void calcNgramExpectations(Lattice & connectedHyp, map<const Hypothesis*, vector
 
   //Z *= scale;  //scale the score
 
-  for (map<Phrase, float>::iterator finalScoresIt = finalNgramScores.begin();  finalScoresIt != finalNgramScores.end(); ++finalScoresIt) {
-    finalScoresIt->second =  finalScoresIt->second - Z;
+  for (size_t ngram = 0; ngram < finalScores.size(); ++ngram) {
+    if (!hasFinalScore[ngram]) continue;
+    const Phrase& ngramPhrase = ngramScores.GetNgram(ngram);
+    float& finalScore = finalNgramScores[ngramPhrase];
+    finalScore = finalScores[ngram] - Z;
     IFVERBOSE(2) {
-      VERBOSE(2,finalScoresIt->first << " [" << finalScoresIt->second << "]" << endl);
+      VERBOSE(2,ngramPhrase << " [" << finalScore << "]" << endl);
     }
   }
 
 }
 
-const NgramHistory& Edge::GetNgrams(map<const Hypothesis*, vector<Edge> > & incomingEdges)
+const NgramHistory& Edge::GetNgrams(LatticeGraph& lattice)
 {
 
   if (m_ngrams.size() > 0)
@@ -421,12 +522,11 @@ const NgramHistory& Edge::GetNgrams(map<const Hypothesis*, vector<Edge> > & inco
     }
   }
 
-  map<const Hypothesis*, vector<Edge> >::iterator it = incomingEdges.find(m_tailNode);
-  if (it != incomingEdges.end()) { //node has incoming edges
-    vector<Edge> & inEdges = it->second;
-
-    for (vector<Edge>::iterator edge = inEdges.begin(); edge != inEdges.end(); ++edge) {//add the ngrams straddling prev and curr edge
-      const NgramHistory & edgeIncomingNgrams = edge->GetNgrams(incomingEdges);
+  int tail = lattice.GetIndex(m_tailNode);
+  if (tail != -1) { //node has incoming edges
+    for (size_t e = lattice.edgeStart[tail]; e < lattice.edgeStart[tail+1]; ++e) {//add the ngrams straddling prev and curr edge
+      Edge* edge = &lattice.edges[e];
+      const NgramHistory & edgeIncomingNgrams = edge->GetNgrams(lattice);
       for (NgramHistory::const_iterator edgeInNgramHist = edgeIncomingNgrams.begin(); edgeInNgramHist != edgeIncomingNgrams.end(); ++edgeInNgramHist) {
         const Phrase& edgeIncomingNgram = edgeInNgramHist->first;
         const PathCounts &  edgeIncomingNgramPaths = edgeInNgramHist->second;
@@ -500,24 +600,40 @@ bool ascendingCoverageCmp(const Hypothesis* a, const Hypothesis* b)
   return a->GetWordsBitmap().GetNumWordsCovered() <  b->GetWordsBitmap().GetNumWordsCovered();
 }
 
+LatticeMBRParams::LatticeMBRParams()
+{
+  const StaticData& staticData = StaticData::Instance();
+  precision = staticData.GetLatticeMBRPrecision();
+  ratio = staticData.GetLatticeMBRPRatio();
+  pruningFactor = staticData.GetLatticeMBRPruningFactor();
+  scale = staticData.GetMBRScale();
+  mapWeight = staticData.GetLatticeMBRMapWeight();
+  thetas = staticData.GetLatticeMBRThetas();
+}
+
 void getLatticeMBRNBest(Manager& manager, TrellisPathList& nBestList,
                         vector<LatticeMBRSolution>& solutions, size_t n)
 {
-  const StaticData& staticData = StaticData::Instance();
+  getLatticeMBRNBest(manager, nBestList, solutions, n, LatticeMBRParams());
+}
+
+void getLatticeMBRNBest(const Manager& manager, const TrellisPathList& nBestList,
+                        vector<LatticeMBRSolution>& solutions, size_t n, const LatticeMBRParams& params)
+{
   std::map < int, bool > connected;
   std::vector< const Hypothesis *> connectedList;
   map<Phrase, float> ngramPosteriors;
   std::map < const Hypothesis*, set <const Hypothesis*> > outgoingHyps;
-  map<const Hypothesis*, vector<Edge> > incomingEdges;
+  LatticeGraph lattice;
   vector< float> estimatedScores;
   manager.GetForwardBackwardSearchGraph(&connected, &connectedList, &outgoingHyps, &estimatedScores);
-  pruneLatticeFB(connectedList, outgoingHyps, incomingEdges, estimatedScores, manager.GetBestHypothesis(), staticData.GetLatticeMBRPruningFactor(),staticData.GetMBRScale());
-  calcNgramExpectations(connectedList, incomingEdges, ngramPosteriors,true);
+  pruneLatticeFB(connectedList, outgoingHyps, lattice, estimatedScores, manager.GetBestHypothesis(), params.pruningFactor, params.scale);
+  calcNgramExpectations(lattice, ngramPosteriors,true);
 
-  vector<float> mbrThetas = staticData.GetLatticeMBRThetas();
-  float p = staticData.GetLatticeMBRPrecision();
-  float r = staticData.GetLatticeMBRPRatio();
-  float mapWeight = staticData.GetLatticeMBRMapWeight();
+  vector<float> mbrThetas = params.thetas;
+  float p = params.precision;
+  float r = params.ratio;
+  float mapWeight = params.mapWeight;
   if (mbrThetas.size() == 0) { //thetas not specified on the command line, use p and r instead
     mbrThetas.push_back(-1); //Theta 0
     mbrThetas.push_back(1/(bleu_order*p));
@@ -548,10 +664,15 @@ void getLatticeMBRNBest(Manager& manager, TrellisPathList& nBestList,
 }
 
 vector<Word> doLatticeMBR(Manager& manager, TrellisPathList& nBestList)
+{
+  return doLatticeMBR(manager, nBestList, LatticeMBRParams());
+}
+
+vector<Word> doLatticeMBR(const Manager& manager, const TrellisPathList& nBestList, const LatticeMBRParams& params)
 {
 
   vector<LatticeMBRSolution> solutions;
-  getLatticeMBRNBest(manager, nBestList, solutions,1);
+  getLatticeMBRNBest(manager, nBestList, solutions,1,params);
   return solutions.at(0).GetWords();
 }
 
@@ -566,11 +687,11 @@ const TrellisPath doConsensusDecoding(Manager& manager, TrellisPathList& nBestLi
   std::vector< const Hypothesis *> connectedList;
   map<Phrase, float> ngramExpectations;
   std::map < const Hypothesis*, set <const Hypothesis*> > outgoingHyps;
-  map<const Hypothesis*, vector<Edge> > incomingEdges;
+  LatticeGraph lattice;
   vector< float> estimatedScores;
   manager.GetForwardBackwardSearchGraph(&connected, &connectedList, &outgoingHyps, &estimatedScores);
-  pruneLatticeFB(connectedList, outgoingHyps, incomingEdges, estimatedScores, manager.GetBestHypothesis(), staticData.GetLatticeMBRPruningFactor(),staticData.GetMBRScale());
-  calcNgramExpectations(connectedList, incomingEdges, ngramExpectations,false);
+  pruneLatticeFB(connectedList, outgoingHyps, lattice, estimatedScores, manager.GetBestHypothesis(), staticData.GetLatticeMBRPruningFactor(),staticData.GetMBRScale());
+  calcNgramExpectations(lattice, ngramExpectations,false);
 
   //expected length is sum of expected unigram counts
   //cerr << "Thread " << pthread_self() <<  " Ngram expectations size: " << ngramExpectations.size() << endl;
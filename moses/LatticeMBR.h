@@ -13,6 +13,7 @@
 #include <map>
 #include <vector>
 #include <set>
+#include <boost/unordered_map.hpp>
 #include "moses/Hypothesis.h"
 #include "moses/Manager.h"
 #include "moses/TrellisPathList.h"
@@ -23,6 +24,7 @@ namespace MosesCmd
 {
 
 class Edge;
+struct LatticeGraph;
 
 typedef std::vector< const Moses::Hypothesis *> Lattice;
 typedef std::vector<const Edge*> Path;
@@ -64,7 +66,7 @@ public:
 
   friend std::ostream& operator<< (std::ostream& out, const Edge& edge);
 
-  const NgramHistory&  GetNgrams(  std::map<const Moses::Hypothesis*, std::vector<Edge> > & incomingEdges) ;
+  const NgramHistory&  GetNgrams(LatticeGraph& lattice) ;
 
   bool operator < (const Edge & compare) const;
 
@@ -77,24 +79,62 @@ public:
 };
 
 /**
-* Data structure to hold the ngram scores as we traverse the lattice. Maps (hypo,ngram) to score
+* The pruned lattice, with flat adjacency arrays. Nodes are numbered by their position in
+* nodes, which is sorted by increasing source coverage, so the empty hypothesis is node 0.
+* The incoming edges of node i are edges[edgeStart[i]] to edges[edgeStart[i+1]-1].
+*/
+struct LatticeGraph {
+  Lattice nodes;
+  std::vector<Edge> edges;
+  std::vector<size_t> edgeStart;
+  std::vector<int> nodeIndex; //< number of node by hypothesis id, or -1
+
+  /** number of the node of hypo, or -1 if it isn't in the lattice */
+  int GetIndex(const Moses::Hypothesis* hypo) const {
+    size_t id = hypo->GetId();
+    return id < nodeIndex.size() ? nodeIndex[id] : -1;
+  }
+};
+
+/**
+* Data structure to hold the ngram scores as we traverse the lattice. Ngrams are mapped to
+* dense ids and the scores of each node (index into the sorted lattice) are kept in a flat
+* buffer of (ngram id, score) pairs. Scores are only added to one node at a time, so a single
+* table from ngram id to buffer position serves all nodes.
 */
 class NgramScores
 {
 public:
-  NgramScores() {}
+  NgramScores(size_t numNodes) : m_scores(numNodes) {}
+
+  /** id of ngram, a new one is assigned if it hasn't been seen */
+  size_t GetId(const Moses::Phrase& ngram);
+  const Moses::Phrase& GetNgram(size_t id) const {
+    return *m_ngrams[id];
+  }
+  size_t GetSize() const {
+    return m_ngrams.size();
+  }
 
   /** logsum this score to the existing score */
-  void addScore(const Moses::Hypothesis* node, const Moses::Phrase& ngram, float score);
+  void addScore(size_t node, size_t ngramId, float score);
+  /** call once all scores of node have been added */
+  void finishNode(size_t node);
 
   /** Iterate through ngrams for selected node */
-  typedef std::map<const Moses::Phrase*, float>::const_iterator NodeScoreIterator;
-  NodeScoreIterator nodeBegin(const Moses::Hypothesis* node);
-  NodeScoreIterator nodeEnd(const Moses::Hypothesis* node);
+  typedef std::vector<std::pair<size_t, float> >::const_iterator NodeScoreIterator;
+  NodeScoreIterator nodeBegin(size_t node) const {
+    return m_scores[node].begin();
+  }
+  NodeScoreIterator nodeEnd(size_t node) const {
+    return m_scores[node].end();
+  }
 
 private:
-  std::set<Moses::Phrase> m_ngrams;
-  std::map<const Moses::Hypothesis*, std::map<const Moses::Phrase*, float> > m_scores;
+  boost::unordered_map<Moses::Phrase, size_t> m_ids;
+  std::vector<const Moses::Phrase*> m_ngrams;
+  std::vector<std::vector<std::pair<size_t, float> > > m_scores;
+  std::vector<int> m_position; //< position of ngram in buffer of the node being scored, or -1
 };
 
 
@@ -127,24 +167,40 @@ private:
   float m_score;
 };
 
+/** The lattice MBR parameters, by default those of the configuration. The grid search
+* decodes with several of them at once, so they are passed explicitly instead of read
+* from StaticData */
+struct LatticeMBRParams {
+  LatticeMBRParams();
+
+  float precision;
+  float ratio;
+  size_t pruningFactor;
+  float scale;
+  float mapWeight;
+  std::vector<float> thetas;
+};
+
 struct LatticeMBRSolutionComparator {
   bool operator()(const LatticeMBRSolution& a, const LatticeMBRSolution& b) {
     return a.GetScore() > b.GetScore();
   }
 };
 
-void pruneLatticeFB(Lattice & connectedHyp, std::map < const Moses::Hypothesis*, std::set <const Moses::Hypothesis* > > & outgoingHyps, std::map<const Moses::Hypothesis*, std::vector<Edge> >& incomingEdges,
+void pruneLatticeFB(const Lattice & connectedHyp, const std::map < const Moses::Hypothesis*, std::set <const Moses::Hypothesis* > > & outgoingHyps, LatticeGraph& lattice,
                     const std::vector< float> & estimatedScores, const Moses::Hypothesis*, size_t edgeDensity,float scale);
 
 //Use the ngram scores to rerank the nbest list, return at most n solutions
 void getLatticeMBRNBest(Moses::Manager& manager, Moses::TrellisPathList& nBestList, std::vector<LatticeMBRSolution>& solutions, size_t n);
+void getLatticeMBRNBest(const Moses::Manager& manager, const Moses::TrellisPathList& nBestList, std::vector<LatticeMBRSolution>& solutions, size_t n,
+                        const LatticeMBRParams& params);
 //calculate expectated ngram counts, clipping at 1 (ie calculating posteriors) if posteriors==true.
-void calcNgramExpectations(Lattice & connectedHyp, std::map<const Moses::Hypothesis*, std::vector<Edge> >& incomingEdges, std::map<Moses::Phrase,
-                           float>& finalNgramScores, bool posteriors);
+void calcNgramExpectations(LatticeGraph& lattice, std::map<Moses::Phrase, float>& finalNgramScores, bool posteriors);
 void GetOutputFactors(const Moses::TrellisPath &path, std::vector <Moses::Word> &translation);
 void extract_ngrams(const std::vector<Moses::Word >& sentence, std::map < Moses::Phrase, int >  & allngrams);
 bool ascendingCoverageCmp(const Moses::Hypothesis* a, const Moses::Hypothesis* b);
 std::vector<Moses::Word> doLatticeMBR(Moses::Manager& manager, Moses::TrellisPathList& nBestList);
+std::vector<Moses::Word> doLatticeMBR(const Moses::Manager& manager, const Moses::TrellisPathList& nBestList, const LatticeMBRParams& params);
 const Moses::TrellisPath doConsensusDecoding(Moses::Manager& manager, Moses::TrellisPathList& nBestList);
 //std::vector<Moses::Word> doConsensusDecoding(Moses::Manager& manager, Moses::TrellisPathList& nBestList);
 
@@ -39,6 +39,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "TranslationOption.h"
 #include "TranslationOptionCollection.h"
 #include "Timer.h"
+#include "Profiler.h"
 #include "moses/FF/DistortionScoreProducer.h"
 #include "moses/LM/Base.h"
 #include "moses/TranslationModel/PhraseDictionary.h"
@@ -54,8 +55,12 @@ using namespace std;
 
 namespace Moses
 {
-Manager::Manager(size_t lineNumber, InputType const& source, SearchAlgorithm searchAlgorithm)
-  :m_transOptColl(source.CreateTranslationOptionCollection())
+Manager::Manager(size_t lineNumber, InputType const& source, SearchAlgorithm searchAlgorithm,
+                 const DecodingOptions &options)
+  :m_options(options)
+  ,m_threadWeights(m_options)
+  ,m_context(DecodingContext::Local())
+  ,m_transOptColl(source.CreateTranslationOptionCollection())
   ,m_search(Search::CreateSearch(*this, source, searchAlgorithm, *m_transOptColl))
   ,interrupted_flag(0)
   ,m_hypoId(0)
@@ -72,6 +77,9 @@ Manager::~Manager()
   // this is a comment ...
 
   StaticData::Instance().CleanUpAfterSentenceProcessing(m_source);
+
+  Profiler::Count(Profiler::Sentence);
+  Profiler::WriteIfRequested();
 }
 
 /**
@@ -233,6 +241,8 @@ void Manager::CalcNBest(size_t count, TrellisPathList &ret,bool onlyDistinct) co
   if (sortedPureHypo.size() == 0)
     return;
 
+  // paths that are not returned but may still be expanded by their deviations
+  TrellisPathList discarded;
   TrellisPathCollection contenders;
 
   set<Phrase> distinctHyps;
@@ -254,6 +264,7 @@ void Manager::CalcNBest(size_t count, TrellisPathList &ret,bool onlyDistinct) co
     // get next best from list of contenders
     TrellisPath *path = contenders.pop();
     UTIL_THROW_IF2(path == NULL, "path is NULL");
+    path->Expand();
     // create deviations from current best
     path->CreateDeviantPaths(contenders);
     if(onlyDistinct) {
@@ -261,7 +272,7 @@ void Manager::CalcNBest(size_t count, TrellisPathList &ret,bool onlyDistinct) co
       if (distinctHyps.insert(tgtPhrase).second) {
         ret.Add(path);
       } else {
-        delete path;
+        discarded.Add(path);
         path = NULL;
       }
     } else {
@@ -34,6 +34,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "WordsBitmap.h"
 #include "Search.h"
 #include "SearchCubePruning.h"
+#include "DecodingContext.h"
+#include "DecodingOptions.h"
 
 namespace Moses
 {
@@ -111,6 +113,9 @@ private:
 protected:
   // data
 //	InputType const& m_source; /**< source sentence to be translated */
+  DecodingOptions m_options; /**< search settings for this sentence */
+  ThreadWeightsGuard m_threadWeights; /**< installs m_options.weights while the manager exists */
+  DecodingContext &m_context; /**< memory kept between sentences by the thread that decodes this one */
   TranslationOptionCollection *m_transOptColl; /**< pre-computed list of translation options for the phrases in this sentence */
   Search *m_search;
 
@@ -130,8 +135,15 @@ protected:
 
 public:
   InputType const& m_source; /**< source sentence to be translated */
-  Manager(size_t lineNumber, InputType const& source, SearchAlgorithm searchAlgorithm);
+  Manager(size_t lineNumber, InputType const& source, SearchAlgorithm searchAlgorithm,
+          const DecodingOptions &options = DecodingOptions());
   ~Manager();
+  const DecodingOptions &GetOptions() const {
+    return m_options;
+  }
+  DecodingContext &GetContext() const {
+    return m_context;
+  }
   const  TranslationOptionCollection* getSntTranslationOptions();
 
   void ProcessSentence();
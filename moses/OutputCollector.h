@@ -29,6 +29,9 @@
 #include <pthread.h>
 #endif
 
+#include <boost/atomic.hpp>
+#include <boost/scoped_array.hpp>
+
 #include <iostream>
 #include <map>
 #include <ostream>
@@ -37,14 +40,23 @@
 namespace Moses
 {
 /**
-* Makes sure output goes in the correct order when multi-threading
+* Makes sure output goes in the correct order when multi-threading.
+*
+* Finished outputs are published into a ring buffer of slots indexed by
+* sourceId, without taking a lock. Whichever thread completes the output
+* that is next in line becomes the writer and streams out all consecutive
+* ready slots; the others return immediately. Outputs too far ahead of the
+* next expected one to fit into the ring go to a mutex-protected overflow
+* map, as before.
 **/
 class OutputCollector
 {
 public:
-  OutputCollector(std::ostream* outStream= &std::cout, std::ostream* debugStream=&std::cerr) :
+  OutputCollector(std::ostream* outStream= &std::cout, std::ostream* debugStream=&std::cerr, size_t bufferSize = 4096) :
     m_nextOutput(0),m_outStream(outStream),m_debugStream(debugStream),
-    m_isHoldingOutputStream(false), m_isHoldingDebugStream(false) {}
+    m_isHoldingOutputStream(false), m_isHoldingDebugStream(false),
+    m_slots(new Slot[bufferSize]), m_numSlots(bufferSize),
+    m_numOverflow(0), m_writing(false) {}
 
   ~OutputCollector() {
     if (m_isHoldingOutputStream)
@@ -69,40 +81,108 @@ public:
     * Write or cache the output, as appropriate.
     **/
   void Write(int sourceId,const std::string& output,const std::string& debug="") {
-#ifdef WITH_THREADS
-    boost::mutex::scoped_lock lock(m_mutex);
-#endif
-    if (sourceId == m_nextOutput) {
-      //This is the one we were expecting
-      *m_outStream << output << std::flush;
-      *m_debugStream << debug << std::flush;
-      ++m_nextOutput;
-      //see if there's any more
-      std::map<int,std::string>::iterator iter;
-      while ((iter = m_outputs.find(m_nextOutput)) != m_outputs.end()) {
-        *m_outStream << iter->second << std::flush;
-        ++m_nextOutput;
-        std::map<int,std::string>::iterator debugIter = m_debugs.find(iter->first);
-        m_outputs.erase(iter);
-        if (debugIter != m_debugs.end()) {
-          *m_debugStream << debugIter->second << std::flush;
-          m_debugs.erase(debugIter);
-        }
-      }
+    int next = m_nextOutput.load(boost::memory_order_acquire);
+    if (sourceId >= next && sourceId - next < (int)m_numSlots) {
+      // the previous user of this slot has already been written out
+      Slot &slot = m_slots[sourceId % m_numSlots];
+      slot.output = output;
+      slot.debug = debug;
+      slot.sourceId.store(sourceId);
     } else {
       //save for later
+#ifdef WITH_THREADS
+      boost::mutex::scoped_lock lock(m_mutex);
+#endif
       m_outputs[sourceId] = output;
       m_debugs[sourceId] = debug;
+      ++m_numOverflow;
+    }
+
+    // become the writer unless another thread already is. The writer
+    // re-checks after stepping down, so an output published while it was
+    // finishing up is never left behind.
+    while (!m_writing.exchange(true)) {
+      bool more = WriteReady();
+      m_writing.store(false);
+      if (!more && !IsReady(m_nextOutput.load()))
+        break;
     }
   }
 private:
+  struct Slot {
+    Slot() : sourceId(-1) {}
+    boost::atomic<int> sourceId;
+    std::string output;
+    std::string debug;
+  };
+
+  bool IsReady(int sourceId) {
+    if (m_slots[sourceId % m_numSlots].sourceId.load() == sourceId)
+      return true;
+    if (m_numOverflow.load() == 0)
+      return false;
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_mutex);
+#endif
+    return m_outputs.find(sourceId) != m_outputs.end();
+  }
+
+  //! stream out all consecutive outputs, only called by the current writer
+  bool WriteReady() {
+    int next = m_nextOutput.load(boost::memory_order_relaxed);
+    bool wrote = false;
+    while (true) {
+      Slot &slot = m_slots[next % m_numSlots];
+      if (slot.sourceId.load(boost::memory_order_acquire) == next) {
+        *m_outStream << slot.output;
+        *m_debugStream << slot.debug;
+        slot.output.clear();
+        slot.debug.clear();
+        slot.sourceId.store(-1, boost::memory_order_relaxed);
+      } else if (!WriteOverflow(next)) {
+        break;
+      }
+      wrote = true;
+      m_nextOutput.store(++next, boost::memory_order_release);
+    }
+    if (wrote) {
+      *m_outStream << std::flush;
+      *m_debugStream << std::flush;
+    }
+    return wrote;
+  }
+
+  bool WriteOverflow(int sourceId) {
+    if (m_numOverflow.load(boost::memory_order_acquire) == 0)
+      return false;
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_mutex);
+#endif
+    std::map<int,std::string>::iterator iter = m_outputs.find(sourceId);
+    if (iter == m_outputs.end())
+      return false;
+    *m_outStream << iter->second;
+    m_outputs.erase(iter);
+    std::map<int,std::string>::iterator debugIter = m_debugs.find(sourceId);
+    if (debugIter != m_debugs.end()) {
+      *m_debugStream << debugIter->second;
+      m_debugs.erase(debugIter);
+    }
+    m_numOverflow.fetch_sub(1, boost::memory_order_relaxed);
+    return true;
+  }
+
   std::map<int,std::string> m_outputs;
   std::map<int,std::string> m_debugs;
-  int m_nextOutput;
+  boost::atomic<int> m_nextOutput;
   std::ostream* m_outStream;
   std::ostream* m_debugStream;
   bool m_isHoldingOutputStream;
   bool m_isHoldingDebugStream;
+  boost::scoped_array<Slot> m_slots;
+  size_t m_numSlots;
+  boost::atomic<size_t> m_numOverflow;
+  boost::atomic<bool> m_writing;
 #ifdef WITH_THREADS
   boost::mutex m_mutex;
 #endif
@@ -204,6 +204,8 @@ Parameter::Parameter()
 
   AddParam("placeholder-factor", "Which source factor to use to store the original text for placeholders. The factor must not be used by a translation or gen model");
   AddParam("no-cache", "Disable all phrase-table caching. Default = false (ie. enable caching)");
+  AddParam("profile", "Write the time spent in each feature function and phrase table, and hypothesis counts, to this file as JSON at the end of the run and on SIGUSR1");
+  AddParam("shared-model-dir", "Directory, eg. /dev/shm, in which text phrase tables (phrase-based only), generation tables and lexical reordering tables are built once into images that all decoder processes map read-only. Building the image of a changed model deletes the images of its older versions");
   AddParam("default-non-term-for-empty-range-only", "Don't add [X] to all ranges, just ranges where there isn't a source non-term. Default = false (ie. add [X] everywhere)");
 
 }
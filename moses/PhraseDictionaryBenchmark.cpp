@@ -0,0 +1,99 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2014 University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#include <memory>
+
+#include "Benchmark.h"
+#include "InputPath.h"
+#include "Sentence.h"
+#include "Util.h"
+#include "WordsRange.h"
+#include "TranslationModel/PhraseDictionary.h"
+
+using namespace Moses;
+
+namespace MosesBenchmark
+{
+
+namespace
+{
+
+/** Batch lookup of every phrase of a sentence, as in collecting
+ * translation options. The tables are built from the same synthetic
+ * phrase table, so their times can be compared. */
+class LookupBenchmark : public Benchmark
+{
+public:
+  LookupBenchmark(const std::string &name, const std::string &table)
+    : Benchmark(name, PhraseBased), m_table(table) {}
+
+  ~LookupBenchmark() {
+    RemoveAllInColl(m_paths);
+  }
+
+  void SetUp() {
+    m_dictionary = dynamic_cast<PhraseDictionary*>(&FeatureFunction::FindFeatureFunction(m_table));
+    m_sentence.reset(CreateSentence(GetSyntheticModel().sentences[0]));
+
+    // in the order of TranslationOptionCollectionText, so that tables can
+    // continue from the lookup of the phrase without its last word
+    const size_t size = m_sentence->GetSize();
+    std::vector<std::vector<InputPath*> > byStart(size);
+    for (size_t length = 1; length <= size; ++length) {
+      for (size_t start = 0; start + length <= size; ++start) {
+        WordsRange range(start, start + length - 1);
+        const InputPath *prev = length == 1 ? NULL : byStart[start].back();
+        InputPath *path = new InputPath(m_sentence->GetSubString(range), m_sentence->GetLabelSet(start, start + length - 1),
+                                        range, prev, NULL);
+        byStart[start].push_back(path);
+        m_paths.push_back(path);
+      }
+    }
+  }
+
+  void Run(size_t iterations) {
+    for (size_t i = 0; i < iterations; ++i) {
+      m_dictionary->InitializeForInput(*m_sentence);
+      m_dictionary->GetTargetPhraseCollectionBatch(m_paths);
+      m_dictionary->CleanUpAfterSentenceProcessing(*m_sentence);
+    }
+  }
+
+  size_t GetOpsPerIteration() const {
+    return m_paths.size();
+  }
+
+private:
+  std::string m_table;
+  PhraseDictionary *m_dictionary;
+  std::auto_ptr<Sentence> m_sentence;
+  InputPathList m_paths;
+};
+
+LookupBenchmark s_memory("PhraseDictionaryMemory/Lookup", "TranslationModel0");
+#ifdef HAVE_CMPH
+LookupBenchmark s_compact("PhraseDictionaryCompact/Lookup", "CompactTable");
+#endif
+#ifdef HAVE_PROBINGPT
+LookupBenchmark s_probing("ProbingPT/Lookup", "ProbingTable");
+#endif
+
+}
+
+}
@@ -0,0 +1,284 @@
+// $Id$
+
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2014 University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#include <algorithm>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include <time.h>
+#ifdef __MACH__
+#include <sys/time.h>
+#endif
+#ifdef WITH_THREADS
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+#endif
+
+#include "Profiler.h"
+#include "FF/FeatureFunction.h"
+#include "util/exception.hh"
+
+using namespace std;
+
+namespace Moses
+{
+
+bool Profiler::s_enabled = false;
+
+namespace
+{
+const char *CALL_NAMES[Profiler::NumCalls] = {
+  "evaluate-in-isolation", "evaluate-with-source-context", "evaluate-when-applied", "lookup"
+};
+const char *EVENT_NAMES[Profiler::NumEvents] = {
+  "sentences", "hypotheses-created", "hypotheses-recombined", "hypotheses-pruned", "hypotheses-discarded"
+};
+
+struct ThreadProfile {
+  std::vector<Profiler::FeatureProfile> features; // by FeatureFunction::GetIndex()
+  uint64_t events[Profiler::NumEvents];
+
+  ThreadProfile() {
+    memset(events, 0, sizeof(events));
+  }
+};
+
+std::string s_path;
+volatile sig_atomic_t s_writeRequested = 0;
+
+// thread profiles are never deleted, so that the work of finished threads
+// is still in the profile
+std::vector<ThreadProfile*> s_profiles;
+
+#ifdef WITH_THREADS
+// guards s_profiles and growing the features of any thread
+boost::mutex s_mutex;
+boost::mutex s_writeMutex;
+
+void KeepProfile(ThreadProfile *)
+{
+}
+boost::thread_specific_ptr<ThreadProfile> s_local(&KeepProfile);
+#else
+ThreadProfile *s_local = NULL;
+#endif
+
+ThreadProfile &Local()
+{
+#ifdef WITH_THREADS
+  ThreadProfile *profile = s_local.get();
+  if (!profile) {
+    profile = new ThreadProfile();
+    boost::mutex::scoped_lock lock(s_mutex);
+    s_profiles.push_back(profile);
+    s_local.reset(profile);
+  }
+  return *profile;
+#else
+  if (!s_local) {
+    s_local = new ThreadProfile();
+    s_profiles.push_back(s_local);
+  }
+  return *s_local;
+#endif
+}
+
+Profiler::FeatureProfile &LocalFeature(const FeatureFunction &ff)
+{
+  ThreadProfile &profile = Local();
+  size_t index = ff.GetIndex();
+  if (index >= profile.features.size()) {
+    // all feature functions exist before decoding, so this happens once per thread
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(s_mutex);
+#endif
+    Profiler::FeatureProfile zero;
+    memset(&zero, 0, sizeof(zero));
+    profile.features.resize(std::max(index + 1, FeatureFunction::GetFeatureFunctions().size()), zero);
+  }
+  return profile.features[index];
+}
+
+void RequestWrite(int)
+{
+  s_writeRequested = 1;
+}
+
+void WriteString(std::ostream &out, const std::string &str)
+{
+  out << '"';
+  for (size_t i = 0; i < str.size(); ++i) {
+    if (str[i] == '"' || str[i] == '\\') out << '\\';
+    out << str[i];
+  }
+  out << '"';
+}
+
+}
+
+void Profiler::Enable(const std::string &path)
+{
+  s_path = path;
+  s_enabled = true;
+#ifdef SIGUSR1
+  signal(SIGUSR1, &RequestWrite);
+#endif
+}
+
+void Profiler::Scope::Start(const FeatureFunction &ff, Call call, size_t calls)
+{
+  m_profile = &LocalFeature(ff);
+  m_call = call;
+  m_calls = calls;
+  m_start = Now();
+}
+
+void Profiler::Scope::Stop()
+{
+  m_profile->nanoseconds[m_call] += Now() - m_start;
+  m_profile->calls[m_call] += m_calls;
+}
+
+void Profiler::Increment(Event event)
+{
+  ++Local().events[event];
+}
+
+void Profiler::IncrementCache(const FeatureFunction &pt, bool hit)
+{
+  FeatureProfile &profile = LocalFeature(pt);
+  if (hit) {
+    ++profile.cacheHits;
+  } else {
+    ++profile.cacheMisses;
+  }
+}
+
+uint64_t Profiler::Now()
+{
+#ifdef __MACH__
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (uint64_t) tv.tv_sec * 1000000000ULL + tv.tv_usec * 1000ULL;
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+void Profiler::Dump(std::ostream &out)
+{
+#ifdef WITH_THREADS
+  boost::mutex::scoped_lock lock(s_mutex);
+#endif
+  // counters of other threads may still be moving, so the sums are only
+  // exact once decoding has finished
+  const std::vector<FeatureFunction*> &ffs = FeatureFunction::GetFeatureFunctions();
+  std::vector<FeatureProfile> features(ffs.size());
+  uint64_t events[NumEvents];
+  memset(events, 0, sizeof(events));
+
+  for (size_t t = 0; t < s_profiles.size(); ++t) {
+    const ThreadProfile &profile = *s_profiles[t];
+    for (size_t e = 0; e < NumEvents; ++e) {
+      events[e] += profile.events[e];
+    }
+    for (size_t i = 0; i < profile.features.size() && i < features.size(); ++i) {
+      const FeatureProfile &from = profile.features[i];
+      for (size_t c = 0; c < NumCalls; ++c) {
+        features[i].calls[c] += from.calls[c];
+        features[i].nanoseconds[c] += from.nanoseconds[c];
+      }
+      features[i].cacheHits += from.cacheHits;
+      features[i].cacheMisses += from.cacheMisses;
+    }
+  }
+
+  out << "{\n  \"threads\": " << s_profiles.size();
+  for (size_t e = 0; e < NumEvents; ++e) {
+    out << ",\n  \"" << EVENT_NAMES[e] << "\": " << events[e];
+  }
+
+  out << ",\n  \"per-thread\": [";
+  for (size_t t = 0; t < s_profiles.size(); ++t) {
+    out << (t ? ",\n    {" : "\n    {");
+    for (size_t e = 0; e < NumEvents; ++e) {
+      out << (e ? ", \"" : "\"") << EVENT_NAMES[e] << "\": " << s_profiles[t]->events[e];
+    }
+    out << "}";
+  }
+  out << "\n  ]";
+
+  out << ",\n  \"features\": [";
+  for (size_t i = 0; i < features.size(); ++i) {
+    const FeatureProfile &feature = features[i];
+    out << (i ? ",\n    {\"name\": " : "\n    {\"name\": ");
+    WriteString(out, ffs[i]->GetScoreProducerDescription());
+    for (size_t c = 0; c < NumCalls; ++c) {
+      if (!feature.calls[c]) continue;
+      out << ", \"" << CALL_NAMES[c] << "\": {\"calls\": " << feature.calls[c]
+          << ", \"seconds\": " << feature.nanoseconds[c] / 1e9
+          << ", \"ns-per-call\": " << feature.nanoseconds[c] / feature.calls[c] << "}";
+    }
+    if (feature.cacheHits || feature.cacheMisses) {
+      out << ", \"cache-hits\": " << feature.cacheHits
+          << ", \"cache-misses\": " << feature.cacheMisses
+          << ", \"cache-hit-rate\": " << (double) feature.cacheHits / (feature.cacheHits + feature.cacheMisses);
+    }
+    out << "}";
+  }
+  out << "\n  ]\n}\n";
+}
+
+void Profiler::Write()
+{
+  if (!s_enabled) return;
+#ifdef WITH_THREADS
+  boost::mutex::scoped_lock lock(s_writeMutex);
+#endif
+  // write next to the old profile and rename, so readers never see half of one
+  const std::string tmpPath = s_path + ".tmp";
+  {
+    std::ofstream out(tmpPath.c_str());
+    UTIL_THROW_IF2(!out, "Cannot write profile to " << tmpPath);
+    Dump(out);
+  }
+  UTIL_THROW_IF2(rename(tmpPath.c_str(), s_path.c_str()), "Cannot rename " << tmpPath << " to " << s_path);
+}
+
+void Profiler::WriteIfRequested()
+{
+  if (s_enabled && s_writeRequested) {
+    s_writeRequested = 0;
+    // called from destructors, so a failure must not end the run
+    try {
+      Write();
+    } catch (const util::Exception &e) {
+      std::cerr << e.what() << std::endl;
+    }
+  }
+}
+
+}
@@ -0,0 +1,131 @@
+// $Id$
+
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2014 University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#ifndef moses_Profiler_h
+#define moses_Profiler_h
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <stdint.h>
+
+namespace Moses
+{
+
+class FeatureFunction;
+
+/** Time spent in each feature function, phrase table lookups and counts of
+ * what happened to hypotheses, for both the phrase-based and chart decoders.
+ * Nothing is recorded unless a file was given with the profile parameter.
+ * Each thread then adds to its own counters, without locking, and the
+ * counters of all threads are summed when the profile is written as JSON:
+ * at the end of the run, and after the next sentence when the process gets
+ * SIGUSR1.
+ */
+class Profiler
+{
+public:
+  //! timed calls of a feature function
+  enum Call {
+    EvaluateInIsolation,
+    EvaluateWithSourceContext,
+    EvaluateWhenApplied,
+    Lookup, //!< phrase table lookups, for phrase dictionaries only
+    NumCalls
+  };
+
+  //! counted events
+  enum Event {
+    Sentence,
+    HypothesisCreated,
+    HypothesisRecombined,
+    HypothesisPruned,
+    HypothesisDiscarded,
+    NumEvents
+  };
+
+  struct FeatureProfile {
+    uint64_t calls[NumCalls];
+    uint64_t nanoseconds[NumCalls];
+    uint64_t cacheHits, cacheMisses;
+  };
+
+  /** Times calls of a feature function, from construction to destruction.
+   * Costs a test of a static flag when profiling is off. */
+  class Scope
+  {
+  public:
+    //! calls: how many calls the time is for, eg. phrases looked up in one batch
+    Scope(const FeatureFunction &ff, Call call, size_t calls = 1)
+      : m_profile(NULL) {
+      if (s_enabled) Start(ff, call, calls);
+    }
+    ~Scope() {
+      if (m_profile) Stop();
+    }
+  private:
+    FeatureProfile *m_profile;
+    Call m_call;
+    size_t m_calls;
+    uint64_t m_start;
+
+    void Start(const FeatureFunction &ff, Call call, size_t calls);
+    void Stop();
+  };
+
+  //! record from now on, writing to path
+  static void Enable(const std::string &path);
+
+  static bool IsEnabled() {
+    return s_enabled;
+  }
+
+  static void Count(Event event) {
+    if (s_enabled) Increment(event);
+  }
+
+  //! a phrase table answered a lookup from its cache (hit) or not
+  static void CountCache(const FeatureFunction &pt, bool hit) {
+    if (s_enabled) IncrementCache(pt, hit);
+  }
+
+  //! the profile as JSON
+  static void Dump(std::ostream &out);
+
+  //! replace the file given to Enable() with the current profile
+  static void Write();
+
+  //! Write() if SIGUSR1 arrived since the last call, reporting failures to
+  //! stderr. Called after each sentence
+  static void WriteIfRequested();
+
+  //! monotonic clock, in nanoseconds
+  static uint64_t Now();
+
+private:
+  static bool s_enabled;
+
+  static void Increment(Event event);
+  static void IncrementCache(const FeatureFunction &pt, bool hit);
+};
+
+}
+#endif
@@ -0,0 +1,205 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2014 University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#include <memory>
+
+#include "Benchmark.h"
+#include "ChartManager.h"
+#include "Hypothesis.h"
+#include "HypothesisStackNormal.h"
+#include "Manager.h"
+#include "Sentence.h"
+#include "StaticData.h"
+#include "TranslationOption.h"
+#include "TranslationOptionCollection.h"
+#include "Util.h"
+
+using namespace Moses;
+
+namespace MosesBenchmark
+{
+
+namespace
+{
+
+// sentences of the synthetic model, read with the loaded configuration
+void CreateSentences(std::vector<Sentence*> &sentences)
+{
+  const std::vector<std::string> &text = GetSyntheticModel().sentences;
+  for (size_t i = 0; i < text.size(); ++i) {
+    sentences.push_back(CreateSentence(text[i]));
+  }
+}
+
+//! looking up, scoring and pruning the translation options of a sentence
+class CollectBenchmark : public Benchmark
+{
+public:
+  CollectBenchmark() : Benchmark("TranslationOptionCollection/Create", PhraseBased), m_next(0) {}
+  ~CollectBenchmark() {
+    RemoveAllInColl(m_sentences);
+  }
+  void SetUp() {
+    CreateSentences(m_sentences);
+  }
+  void Run(size_t iterations) {
+    const StaticData &staticData = StaticData::Instance();
+    for (size_t i = 0; i < iterations; ++i) {
+      const Sentence &sentence = *m_sentences[m_next++ % m_sentences.size()];
+      staticData.InitializeForInput(sentence);
+      std::auto_ptr<TranslationOptionCollection> collection(sentence.CreateTranslationOptionCollection());
+      collection->CreateTranslationOptions();
+      staticData.CleanUpAfterSentenceProcessing(sentence);
+    }
+  }
+private:
+  std::vector<Sentence*> m_sentences;
+  size_t m_next;
+} s_collect;
+
+/** Adding hypotheses to a stack that is full, as in the middle of a search.
+ * AddPrune() takes new hypotheses, so their creation and scoring is timed
+ * too: subtract Hypothesis/CreateAndEvaluate for the stack alone. */
+class StackBenchmark : public Benchmark
+{
+public:
+  StackBenchmark(const std::string &name, bool addToStack)
+    : Benchmark(name, PhraseBased), m_addToStack(addToStack), m_next(0) {}
+
+  void SetUp() {
+    const std::string &text = GetSyntheticModel().sentences[0];
+    m_sentence.reset(CreateSentence(text));
+    m_manager.reset(new Manager(0, *m_sentence, Normal));
+    m_manager->ResetSentenceStats(*m_sentence);
+    m_collection.reset(m_sentence->CreateTranslationOptionCollection());
+    m_collection->CreateTranslationOptions();
+    m_stack.reset(new HypothesisStackNormal(*m_manager));
+    m_stack->SetMaxHypoStackSize(m_manager->GetOptions().maxHypoStackSize, m_manager->GetOptions().minHypoStackDiversity);
+    m_stack->SetBeamWidth(m_manager->GetOptions().beamWidth);
+
+    // the predecessors: one option after the empty hypothesis
+    const SquareMatrix &futureScore = m_collection->GetFutureScore();
+    Hypothesis *empty = Hypothesis::Create(*m_manager, *m_sentence, m_initialOption);
+    std::vector<const TranslationOption*> options;
+    const size_t size = m_sentence->GetSize();
+    for (size_t start = 0; start < size; ++start) {
+      for (size_t end = start; end < size; ++end) {
+        const TranslationOptionList &list = m_collection->GetTranslationOptionList(WordsRange(start, end));
+        for (size_t i = 0; i < list.size(); ++i) {
+          options.push_back(list.Get(i));
+        }
+      }
+    }
+    for (size_t i = 0; i < options.size(); ++i) {
+      Hypothesis *prev = Hypothesis::Create(*empty, *options[i]);
+      prev->EvaluateWhenApplied(futureScore);
+      m_prevs.push_back(prev);
+    }
+
+    // and the options that can follow each of them
+    for (size_t p = 0; p < m_prevs.size(); ++p) {
+      for (size_t i = 0; i < options.size(); ++i) {
+        if (!m_prevs[p]->GetWordsBitmap().Overlap(options[i]->GetSourceWordsRange())) {
+          m_extensions.push_back(std::make_pair(m_prevs[p], options[i]));
+        }
+      }
+    }
+  }
+
+  void Run(size_t iterations) {
+    const SquareMatrix &futureScore = m_collection->GetFutureScore();
+    for (size_t i = 0; i < iterations; ++i) {
+      const std::pair<const Hypothesis*, const TranslationOption*> &extension = m_extensions[m_next++ % m_extensions.size()];
+      Hypothesis *hypo = Hypothesis::Create(*extension.first, *extension.second);
+      hypo->EvaluateWhenApplied(futureScore);
+      if (m_addToStack) {
+        m_stack->AddPrune(hypo);
+      } else {
+        FREEHYPO(hypo);
+      }
+    }
+  }
+
+private:
+  bool m_addToStack;
+  size_t m_next;
+  TranslationOption m_initialOption;
+  std::auto_ptr<Sentence> m_sentence;
+  std::auto_ptr<Manager> m_manager;
+  std::auto_ptr<TranslationOptionCollection> m_collection;
+  std::auto_ptr<HypothesisStackNormal> m_stack;
+  std::vector<Hypothesis*> m_prevs;
+  std::vector<std::pair<const Hypothesis*, const TranslationOption*> > m_extensions;
+};
+
+StackBenchmark s_evaluate("Hypothesis/CreateAndEvaluate", false);
+StackBenchmark s_addPrune("HypothesisStackNormal/AddPrune", true);
+
+//! whole phrase-based search of a sentence
+class SearchBenchmark : public Benchmark
+{
+public:
+  SearchBenchmark() : Benchmark("Manager/ProcessSentence", PhraseBased), m_next(0) {}
+  ~SearchBenchmark() {
+    RemoveAllInColl(m_sentences);
+  }
+  void SetUp() {
+    CreateSentences(m_sentences);
+  }
+  void Run(size_t iterations) {
+    for (size_t i = 0; i < iterations; ++i) {
+      Manager manager(m_next, *m_sentences[m_next % m_sentences.size()], Normal);
+      ++m_next;
+      manager.ProcessSentence();
+      Use(manager.GetBestHypothesis());
+    }
+  }
+private:
+  std::vector<Sentence*> m_sentences;
+  size_t m_next;
+} s_search;
+
+/** Whole chart search of a sentence. Most of the time is in cube pruning
+ * (ChartCell::Decode), with the rule lookup second. */
+class ChartBenchmark : public Benchmark
+{
+public:
+  ChartBenchmark() : Benchmark("ChartManager/ProcessSentence", Chart), m_next(0) {}
+  ~ChartBenchmark() {
+    RemoveAllInColl(m_sentences);
+  }
+  void SetUp() {
+    CreateSentences(m_sentences);
+  }
+  void Run(size_t iterations) {
+    for (size_t i = 0; i < iterations; ++i) {
+      ChartManager manager(m_next, *m_sentences[m_next % m_sentences.size()]);
+      ++m_next;
+      manager.ProcessSentence();
+      Use(manager.GetBestHypothesis());
+    }
+  }
+private:
+  std::vector<Sentence*> m_sentences;
+  size_t m_next;
+} s_chart;
+
+}
+
+}
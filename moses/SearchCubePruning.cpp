@@ -43,13 +43,13 @@ SearchCubePruning::SearchCubePruning(Manager& manager, const InputType &source,
   ,m_hypoStackColl(source.GetSize() + 1)
   ,m_transOptColl(transOptColl)
 {
-  const StaticData &staticData = StaticData::Instance();
+  const DecodingOptions &options = m_manager.GetOptions();
 
   std::vector < HypothesisStackCubePruning >::iterator iterStack;
   for (size_t ind = 0 ; ind < m_hypoStackColl.size() ; ++ind) {
     HypothesisStackCubePruning *sourceHypoColl = new HypothesisStackCubePruning(m_manager);
-    sourceHypoColl->SetMaxHypoStackSize(staticData.GetMaxHypoStackSize());
-    sourceHypoColl->SetBeamWidth(staticData.GetBeamWidth());
+    sourceHypoColl->SetMaxHypoStackSize(options.maxHypoStackSize);
+    sourceHypoColl->SetBeamWidth(options.beamWidth);
 
     m_hypoStackColl[ind] = sourceHypoColl;
   }
@@ -77,10 +77,10 @@ void SearchCubePruning::ProcessSentence()
   firstStack.CleanupArcList();
   CreateForwardTodos(firstStack);
 
-  const size_t PopLimit = StaticData::Instance().GetCubePruningPopLimit();
+  const size_t PopLimit = m_manager.GetOptions().cubePruningPopLimit;
   VERBOSE(3,"Cube Pruning pop limit is " << PopLimit << std::endl)
 
-  const size_t Diversity = StaticData::Instance().GetCubePruningDiversity();
+  const size_t Diversity = m_manager.GetOptions().cubePruningDiversity;
   VERBOSE(3,"Cube Pruning diversity is " << Diversity << std::endl)
 
   // go through each stack
@@ -144,7 +144,7 @@ void SearchCubePruning::ProcessSentence()
     IFVERBOSE(2) {
       m_manager.GetSentenceStats().StartTimeStack();
     }
-    sourceHypoColl.PruneToSize(staticData.GetMaxHypoStackSize());
+    sourceHypoColl.PruneToSize(m_manager.GetOptions().maxHypoStackSize);
     VERBOSE(3,std::endl);
     sourceHypoColl.CleanupArcList();
     IFVERBOSE(2) {
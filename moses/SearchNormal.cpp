@@ -21,7 +21,7 @@ SearchNormal::SearchNormal(Manager& manager, const InputType &source, const Tran
   ,m_transOptColl(transOptColl)
 {
   VERBOSE(1, "Translating: " << m_source << endl);
-  const StaticData &staticData = StaticData::Instance();
+  const DecodingOptions &options = m_manager.GetOptions();
 
   // only if constraint decoding (having to match a specified output)
   // long sentenceID = source.GetTranslationId();
@@ -30,9 +30,9 @@ SearchNormal::SearchNormal(Manager& manager, const InputType &source, const Tran
   std::vector < HypothesisStackNormal >::iterator iterStack;
   for (size_t ind = 0 ; ind < m_hypoStackColl.size() ; ++ind) {
     HypothesisStackNormal *sourceHypoColl = new HypothesisStackNormal(m_manager);
-    sourceHypoColl->SetMaxHypoStackSize(staticData.GetMaxHypoStackSize(),
-                                        staticData.GetMinHypoStackDiversity());
-    sourceHypoColl->SetBeamWidth(staticData.GetBeamWidth());
+    sourceHypoColl->SetMaxHypoStackSize(options.maxHypoStackSize,
+                                        options.minHypoStackDiversity);
+    sourceHypoColl->SetBeamWidth(options.beamWidth);
 
     m_hypoStackColl[ind] = sourceHypoColl;
   }
@@ -73,7 +73,7 @@ void SearchNormal::ProcessSentence()
     IFVERBOSE(2) {
       stats.StartTimeStack();
     }
-    sourceHypoColl.PruneToSize(staticData.GetMaxHypoStackSize());
+    sourceHypoColl.PruneToSize(m_manager.GetOptions().maxHypoStackSize);
     VERBOSE(3,std::endl);
     sourceHypoColl.CleanupArcList();
     IFVERBOSE(2) {
@@ -295,7 +295,7 @@ void SearchNormal::ExpandHypothesis(const Hypothesis &hypothesis, const Translat
     // worst possible score may have changed -> recompute
     size_t wordsTranslated = hypothesis.GetWordsBitmap().GetNumWordsCovered() + transOpt.GetSize();
     float allowedScore = m_hypoStackColl[wordsTranslated]->GetWorstScore();
-    if (staticData.GetMinHypoStackDiversity()) {
+    if (m_manager.GetOptions().minHypoStackDiversity) {
       WordsBitmapID id = hypothesis.GetWordsBitmap().GetIDPlus(transOpt.GetStartPos(), transOpt.GetEndPos());
       float allowedScoreForBitmap = m_hypoStackColl[wordsTranslated]->GetWorstScoreForBitmap( id );
       allowedScore = std::min( allowedScore, allowedScoreForBitmap );
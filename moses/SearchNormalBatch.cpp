@@ -14,7 +14,7 @@ SearchNormalBatch::SearchNormalBatch(Manager& manager, const InputType &source,
   :SearchNormal(manager, source, transOptColl)
   ,m_batch_size(10000)
 {
-  m_max_stack_size = StaticData::Instance().GetMaxHypoStackSize();
+  m_max_stack_size = m_manager.GetOptions().maxHypoStackSize;
 
   // Split the feature functions into sets of stateless, stateful
   // distributed lm, and stateful non-distributed.
@@ -66,7 +66,7 @@ void SearchNormalBatch::ProcessSentence()
     IFVERBOSE(2) {
       stats.StartTimeStack();
     }
-    sourceHypoColl.PruneToSize(staticData.GetMaxHypoStackSize());
+    sourceHypoColl.PruneToSize(m_manager.GetOptions().maxHypoStackSize);
     VERBOSE(3,std::endl);
     sourceHypoColl.CleanupArcList();
     IFVERBOSE(2) {
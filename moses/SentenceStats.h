@@ -28,6 +28,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <time.h>
 #include "Timer.h"
 #include "Phrase.h"
+#include "Profiler.h"
 #include "Hypothesis.h"
 #include "TypeDef.h" //FactorArray
 #include "InputType.h"
@@ -144,15 +145,18 @@ public:
   void AddRecombination(const Hypothesis& worseHypo, const Hypothesis& betterHypo) {
     m_recombinationInfos.push_back(RecombinationInfo(worseHypo.GetWordsBitmap().GetNumWordsCovered(),
                                    betterHypo.GetTotalScore(), worseHypo.GetTotalScore()));
+    Profiler::Count(Profiler::HypothesisRecombined);
   }
   void AddCreated() {
     m_numHyposCreated++;
+    Profiler::Count(Profiler::HypothesisCreated);
   }
   void AddPopped() {
     m_numHyposPopped++;
   }
   void AddPruning() {
     m_numHyposPruned++;
+    Profiler::Count(Profiler::HypothesisPruned);
   }
   void AddEarlyDiscarded() {
     m_numHyposEarlyDiscarded++;
@@ -162,6 +166,7 @@ public:
   }
   void AddDiscarded() {
     m_numHyposDiscarded++;
+    Profiler::Count(Profiler::HypothesisDiscarded);
   }
 
   void StartTimeCollectOpts() {
@@ -0,0 +1,256 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2014- University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <boost/filesystem.hpp>
+
+#include "SharedModelImage.h"
+#include "Factor.h"
+#include "Phrase.h"
+#include "Util.h"
+#include "Word.h"
+#include "util/exception.hh"
+#include "util/file.hh"
+#include "util/murmur_hash.hh"
+
+namespace Moses
+{
+namespace
+{
+const size_t MAGIC_SIZE = 8;
+// written to the file when it is full
+const size_t WRITE_BUFFER_SIZE = 1 << 20;
+
+uint64_t Padded(uint64_t size)
+{
+  return (size + 7) & ~uint64_t(7);
+}
+}
+
+SharedModelImage::Key::Key(uint64_t parent)
+  : m_hash(parent)
+  , m_text(reinterpret_cast<const char*>(&parent), sizeof(parent))
+{
+}
+
+void SharedModelImage::Key::Append(const StringPiece &str)
+{
+  m_hash = util::MurmurHashNative(str.data(), str.size(), m_hash);
+  // the length keeps the strings apart
+  const uint32_t length = str.size();
+  m_text.append(reinterpret_cast<const char*>(&length), sizeof(length));
+  m_text.append(str.data(), str.size());
+}
+
+void SharedModelImage::Key::Append(const Word &word, const FactorList &factors)
+{
+  for (size_t i = 0; i < factors.size(); ++i) {
+    const Factor *factor = word[factors[i]];
+    Append(factor ? factor->GetString() : StringPiece());
+  }
+}
+
+void SharedModelImage::Key::Append(const Phrase &phrase, const FactorList &factors)
+{
+  for (size_t i = 0; i < phrase.GetSize(); ++i) {
+    Append(phrase.GetWord(i), factors);
+  }
+}
+
+SharedModelImage::Writer::Writer(const std::string &path, const char *magic, size_t numSections)
+  : m_path(path)
+  , m_sizes(numSections + 1, 0)
+  , m_section(0)
+  , m_committed(false)
+{
+  std::ostringstream tmpPath;
+  tmpPath << path << ".tmp" << getpid();
+  m_tmpPath = tmpPath.str();
+  m_file.reset(util::CreateOrThrow(m_tmpPath.c_str()));
+  m_sizes[0] = numSections;
+  // the sizes are filled in by Commit
+  m_buffer.append(magic, MAGIC_SIZE);
+  m_buffer.append(reinterpret_cast<const char*>(&m_sizes[0]), m_sizes.size() * sizeof(uint64_t));
+}
+
+SharedModelImage::Writer::~Writer()
+{
+  if (!m_committed) {
+    unlink(m_tmpPath.c_str());
+  }
+}
+
+void SharedModelImage::Writer::Append(const void *data, uint64_t size)
+{
+  UTIL_THROW_IF2(m_section + 1 >= m_sizes.size(), "Too many sections for " << m_path);
+  if (size) {
+    m_buffer.append(static_cast<const char*>(data), size);
+  }
+  m_sizes[m_section + 1] += size;
+  if (m_buffer.size() >= WRITE_BUFFER_SIZE) {
+    Flush();
+  }
+}
+
+void SharedModelImage::Writer::EndSection()
+{
+  UTIL_THROW_IF2(m_section + 1 >= m_sizes.size(), "Too many sections for " << m_path);
+  const uint64_t size = m_sizes[++m_section];
+  const char padding[8] = {0};
+  m_buffer.append(padding, Padded(size) - size);
+}
+
+void SharedModelImage::Writer::Flush()
+{
+  util::WriteOrThrow(m_file.get(), m_buffer.data(), m_buffer.size());
+  m_buffer.clear();
+}
+
+void SharedModelImage::Writer::Commit()
+{
+  UTIL_THROW_IF2(m_section + 1 != m_sizes.size(), "Wrote " << m_section << " sections instead of "
+                 << m_sizes[0] << " for " << m_path);
+  Flush();
+  util::ErsatzPWrite(m_file.get(), &m_sizes[0], m_sizes.size() * sizeof(uint64_t), MAGIC_SIZE);
+  m_file.reset();
+  UTIL_THROW_IF2(rename(m_tmpPath.c_str(), m_path.c_str()),
+                 "Could not rename " << m_tmpPath << " to " << m_path);
+  m_committed = true;
+
+  // Images of older versions of the model share the name up to the last '-'.
+  // Processes that still map them keep their pages until they exit.
+  const boost::filesystem::path path(m_path);
+  const std::string name = path.filename().string();
+  const std::string stem = name.substr(0, name.rfind('-') + 1);
+  boost::system::error_code error;
+  boost::filesystem::directory_iterator end;
+  for (boost::filesystem::directory_iterator i(path.parent_path(), error); !error && i != end; i.increment(error)) {
+    const std::string other = i->path().filename().string();
+    // temporary files are images that other processes are still writing
+    if (other != name && other.compare(0, stem.size(), stem) == 0 && other.find(".tmp") == std::string::npos) {
+      boost::filesystem::remove(i->path(), error);
+    }
+  }
+}
+
+size_t SharedModelImage::TableBuilder::Insert(const Key &key)
+{
+  const std::string &text = key.GetText();
+  std::pair<boost::unordered_map<uint64_t, size_t>::iterator, bool> added
+    = m_index.insert(std::make_pair(key.GetHash(), m_entries.size()));
+  if (!added.second) {
+    const Entry &entry = m_entries[added.first->second];
+    UTIL_THROW_IF2(StringPiece(m_text.data() + entry.textBegin, entry.textEnd - entry.textBegin) != text,
+                   "Two keys have the same hash " << key.GetHash() << ", so the model cannot be shared");
+    return added.first->second;
+  }
+  Entry entry;
+  entry.key = key.GetHash();
+  entry.begin = entry.end = 0;
+  entry.textBegin = m_text.size();
+  m_text += text;
+  entry.textEnd = m_text.size();
+  m_entries.push_back(entry);
+  return m_entries.size() - 1;
+}
+
+void SharedModelImage::TableBuilder::Write(Writer &writer) const
+{
+  std::vector<char> tableMem(Table::Probing::Size(m_entries.size(), 1.5));
+  Table::Probing table(&tableMem[0], tableMem.size());
+  table.Clear();
+  for (size_t i = 0; i < m_entries.size(); ++i) {
+    table.Insert(m_entries[i]);
+  }
+  writer.Add(&tableMem[0], tableMem.size());
+  writer.Add(m_text.data(), m_text.size());
+}
+
+SharedModelImage::Table::Table(const SharedModelImage &image, size_t section)
+  : m_table(const_cast<char*>(image.GetSection(section)), image.GetSectionSize(section))
+  , m_text(image.GetSection(section + 1))
+{
+}
+
+const SharedModelImage::Entry *SharedModelImage::Table::Find(const Key &key) const
+{
+  Probing::ConstIterator entry;
+  if (!m_table.Find(key.GetHash(), entry)
+      || StringPiece(m_text + entry->textBegin, entry->textEnd - entry->textBegin) != key.GetText()) {
+    return NULL;
+  }
+  return &*entry;
+}
+
+std::string SharedModelImage::GetPath(const std::string &sharedDir, const std::string &prefix,
+                                      const char *magic, const std::string &filePath,
+                                      const std::string &id)
+{
+  struct stat info;
+  UTIL_THROW_IF2(stat(filePath.c_str(), &info), "Could not stat " << filePath);
+
+  // the model, then its version: a new version of the file gets a new image
+  std::ostringstream model, version;
+  model << std::string(magic, MAGIC_SIZE) << '\n' << filePath << '\n' << id;
+  version << info.st_size << ' ' << info.st_mtime;
+  const std::string modelString = model.str(), versionString = version.str();
+  char name[48];
+  sprintf(name, "-%016llx-%016llx",
+          (unsigned long long) util::MurmurHashNative(modelString.data(), modelString.size()),
+          (unsigned long long) util::MurmurHashNative(versionString.data(), versionString.size()));
+  return sharedDir + "/" + prefix + name;
+}
+
+bool SharedModelImage::Map(const std::string &path, const char *magic, size_t numSections)
+{
+  if (!FileExists(path)) {
+    return false;
+  }
+  util::scoped_fd fd(util::OpenReadOrThrow(path.c_str()));
+  const uint64_t size = util::SizeOrThrow(fd.get());
+  uint64_t offset = MAGIC_SIZE + (numSections + 1) * sizeof(uint64_t);
+  if (size < offset) {
+    return false;
+  }
+  util::MapRead(util::LAZY, fd.get(), 0, size, m_memory);
+  const char *base = static_cast<const char*>(m_memory.get());
+  const uint64_t *sizes = reinterpret_cast<const uint64_t*>(base + MAGIC_SIZE);
+  if (memcmp(base, magic, MAGIC_SIZE) || sizes[0] != numSections) {
+    m_memory.reset();
+    return false;
+  }
+  m_sections.clear();
+  m_sectionSizes.clear();
+  for (size_t i = 0; i < numSections; ++i) {
+    m_sections.push_back(base + offset);
+    m_sectionSizes.push_back(sizes[i + 1]);
+    offset += Padded(sizes[i + 1]);
+  }
+  if (offset != size) {
+    m_memory.reset();
+    return false;
+  }
+  return true;
+}
+
+}
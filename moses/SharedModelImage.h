@@ -0,0 +1,198 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2014- University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+#include <boost/unordered_map.hpp>
+
+#include "TypeDef.h"
+#include "util/file.hh"
+#include "util/mmap.hh"
+#include "util/probing_hash_table.hh"
+#include "util/string_piece.hh"
+
+namespace Moses
+{
+class Phrase;
+class Word;
+
+/** Read-only image of a text model that is built once into the directory
+ * given by shared-model-dir (eg. /dev/shm) and then mapped by every decoder
+ * process on the host. The image is a magic string, the number and sizes of
+ * its sections, and the sections, each aligned to 8 bytes. It holds no
+ * pointers, so it can be mapped at any address.
+ */
+class SharedModelImage
+{
+public:
+  //! entry of the hash tables in images: a key, its text and a range of records
+  struct Entry {
+    typedef uint64_t Key;
+    uint64_t key;
+    uint64_t begin, end;
+    //! range of the text of the key in the key section
+    uint64_t textBegin, textEnd;
+    uint64_t GetKey() const {
+      return key;
+    }
+    void SetKey(uint64_t to) {
+      key = to;
+    }
+  };
+
+  /** Key of an entry: a hash of factor strings, and the strings themselves
+   * so that keys whose hashes collide are told apart.
+   */
+  class Key
+  {
+  public:
+    //! key of the empty sequence
+    Key() : m_hash(0) {}
+    //! key continuing the key of a parent entry, for keys built word by word
+    explicit Key(uint64_t parent);
+
+    void Append(const StringPiece &str);
+    //! the given factors of a word
+    void Append(const Word &word, const FactorList &factors);
+    //! the given factors of the words of a phrase
+    void Append(const Phrase &phrase, const FactorList &factors);
+
+    uint64_t GetHash() const {
+      // 0 marks empty buckets
+      return m_hash ? m_hash : 1;
+    }
+    const std::string &GetText() const {
+      return m_text;
+    }
+  private:
+    uint64_t m_hash;
+    std::string m_text;
+  };
+
+  /** Writes an image section by section to a temporary file, which Commit
+   * renames into place, so other processes only ever see a complete image.
+   * Commit then deletes the images of older versions of the same model.
+   */
+  class Writer
+  {
+  public:
+    Writer(const std::string &path, const char *magic, size_t numSections);
+    //! deletes the temporary file unless the image was committed
+    ~Writer();
+
+    //! append to the current section
+    void Append(const void *data, uint64_t size);
+    //! end the current section; the next Append starts the next one
+    void EndSection();
+    //! a whole section
+    void Add(const void *data, uint64_t size) {
+      Append(data, size);
+      EndSection();
+    }
+
+    void Commit();
+  private:
+    Writer(const Writer &);
+    void operator=(const Writer &);
+
+    void Flush();
+
+    std::string m_path, m_tmpPath;
+    util::scoped_fd m_file;
+    std::string m_buffer;
+    // number of sections, then the size of each
+    std::vector<uint64_t> m_sizes;
+    size_t m_section;
+    bool m_committed;
+  };
+
+  /** Collects the entries of a hash table while an image is built.
+   * Throws if two different keys have the same hash.
+   */
+  class TableBuilder
+  {
+  public:
+    //! index of the entry of key, which is added with an empty range if it is new
+    size_t Insert(const Key &key);
+
+    Entry &GetEntry(size_t i) {
+      return m_entries[i];
+    }
+    size_t GetSize() const {
+      return m_entries.size();
+    }
+
+    //! write the hash table and the text of the keys as two sections
+    void Write(Writer &writer) const;
+  private:
+    std::vector<Entry> m_entries;
+    boost::unordered_map<uint64_t, size_t> m_index;
+    std::string m_text;
+  };
+
+  //! hash table of an image, with the text of its keys
+  class Table
+  {
+  public:
+    Table() : m_text(NULL) {}
+    //! the sections written by TableBuilder::Write, starting with section
+    Table(const SharedModelImage &image, size_t section);
+
+    //! entry of key, NULL if there is none
+    const Entry *Find(const Key &key) const;
+
+    typedef util::ProbingHashTable<Entry, util::IdentityHash> Probing;
+  private:
+    Probing m_table;
+    const char *m_text;
+  };
+
+  /** Name of the image of filePath in sharedDir. It changes with the
+   * magic, the size and modification time of the file, and id, which
+   * should describe every setting the image depends on. Images of older
+   * versions of the file differ only in the part after the last '-'.
+   */
+  static std::string GetPath(const std::string &sharedDir, const std::string &prefix,
+                             const char *magic, const std::string &filePath,
+                             const std::string &id);
+
+  /** Map the image at path. False if there is no image there, or it is
+   * not a complete image with this magic and number of sections.
+   */
+  bool Map(const std::string &path, const char *magic, size_t numSections);
+
+  const char *GetSection(size_t i) const {
+    return m_sections[i];
+  }
+  uint64_t GetSectionSize(size_t i) const {
+    return m_sectionSizes[i];
+  }
+
+private:
+  util::scoped_memory m_memory;
+  std::vector<const char*> m_sections;
+  std::vector<uint64_t> m_sectionSizes;
+};
+
+}
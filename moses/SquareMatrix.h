@@ -23,6 +23,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #define moses_SquareMatrix_h
 
 #include <iostream>
+#include <vector>
 #include "TypeDef.h"
 #include "Util.h"
 #include "WordsBitmap.h"
@@ -36,18 +37,27 @@ class SquareMatrix
   friend std::ostream& operator<<(std::ostream &out, const SquareMatrix &matrix);
 protected:
   const size_t m_size; /**< length of the square (sentence length) */
-  float *m_array; /**< two-dimensional array to store floats */
+  std::vector<float> m_array; /**< two-dimensional array to store floats */
 
   SquareMatrix(); // not implemented
   SquareMatrix(const SquareMatrix &copy); // not implemented
 
 public:
   SquareMatrix(size_t size)
+    :m_size(size)
+    ,m_array(size * size) {
+  }
+  /** a matrix in the memory of buffer, which is swapped with the matrix.
+   * Used to reuse the memory of an earlier matrix, see ReleaseBuffer() */
+  SquareMatrix(size_t size, std::vector<float> &buffer)
     :m_size(size) {
-    m_array = (float*) malloc(sizeof(float) * size * size);
+    m_array.swap(buffer);
+    m_array.resize(size * size);
   }
-  ~SquareMatrix() {
-    free(m_array);
+  /** swap the memory of the matrix with buffer, for a later matrix.
+   * The matrix must not be used afterwards */
+  void ReleaseBuffer(std::vector<float> &buffer) {
+    m_array.swap(buffer);
   }
   /** Returns length of the square: typically the sentence length */
   inline size_t GetSize() const {
@@ -38,6 +38,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "TranslationOption.h"
 #include "DecodeGraph.h"
 #include "InputFileStream.h"
+#include "Profiler.h"
 #include "ScoreComponentCollection.h"
 #include "DecodeGraph.h"
 #include "TranslationModel/PhraseDictionary.h"
@@ -145,6 +146,14 @@ bool StaticData::LoadData(Parameter *parameter)
       m_factorDelimiter = "";
   }
 
+  if (m_parameter->GetParam("shared-model-dir").size() > 0) {
+    m_sharedModelDir = m_parameter->GetParam("shared-model-dir")[0];
+  }
+
+  if (m_parameter->GetParam("profile").size() > 0) {
+    Profiler::Enable(m_parameter->GetParam("profile")[0]);
+  }
+
   SetBooleanParameter( &m_continuePartialTranslation, "continue-partial-translation", false );
   SetBooleanParameter( &m_outputHypoScore, "output-hypo-score", false );
 
@@ -612,6 +621,25 @@ void StaticData::SetWeights(const FeatureFunction* sp, const std::vector<float>&
   m_allWeights.Assign(sp,weights);
 }
 
+StaticData::ThreadWeights &StaticData::GetThreadWeightsState() const
+{
+#ifdef WITH_THREADS
+  if (!m_threadWeights.get()) {
+    m_threadWeights.reset(new ThreadWeights);
+  }
+  return *m_threadWeights;
+#else
+  return m_threadWeights;
+#endif
+}
+
+void StaticData::SetThreadWeights(const ScoreComponentCollection *weights) const
+{
+  ThreadWeights &state = GetThreadWeightsState();
+  state.weights = weights;
+  state.id = weights ? ++state.lastId : 0;
+}
+
 void StaticData::LoadNonTerminals()
 {
   string defaultNonTerminals;
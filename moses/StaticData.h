@@ -68,6 +68,18 @@ protected:
   Parameter *m_parameter;
   std::vector<FactorType>	m_inputFactorOrder, m_outputFactorOrder;
   mutable ScoreComponentCollection m_allWeights;
+  //! weights installed by SetThreadWeights() on one thread
+  struct ThreadWeights {
+    ThreadWeights() : weights(NULL), id(0), lastId(0) {}
+    const ScoreComponentCollection *weights;
+    size_t id, lastId;
+  };
+#ifdef WITH_THREADS
+  mutable boost::thread_specific_ptr<ThreadWeights> m_threadWeights;
+#else
+  mutable ThreadWeights m_threadWeights;
+#endif
+  ThreadWeights &GetThreadWeightsState() const;
 
   std::vector<DecodeGraph*> m_decodeGraphs;
 
@@ -133,6 +145,7 @@ protected:
   std::string m_alignmentOutputFile;
 
   std::string m_factorDelimiter; //! by default, |, but it can be changed
+  std::string m_sharedModelDir; //! where to keep model images shared between processes, if anywhere
 
   XmlInputType m_xmlInputType; //! method for handling sentence XML input
   std::pair<std::string,std::string> m_xmlBrackets; //! strings to use as XML tags' opening and closing brackets. Default are "<" and ">"
@@ -428,16 +441,43 @@ public:
   }
 
   const ScoreComponentCollection& GetAllWeights() const {
-    return m_allWeights;
+    const ScoreComponentCollection *threadWeights = GetThreadWeights();
+    return threadWeights ? *threadWeights : m_allWeights;
+  }
+
+  //! weights set with SetThreadWeights() on the calling thread, or NULL
+  const ScoreComponentCollection *GetThreadWeights() const {
+#ifdef WITH_THREADS
+    return m_threadWeights.get() ? m_threadWeights->weights : NULL;
+#else
+    return m_threadWeights.weights;
+#endif
   }
 
+  /** identifies the weights that GetAllWeights() returns on the calling
+   * thread: 0 for the configured weights, and a new number every time
+   * SetThreadWeights() installs weights. Caches of weighted scores that
+   * live longer than an input compare it to tell whether they are stale */
+  size_t GetThreadWeightsId() const {
+#ifdef WITH_THREADS
+    return m_threadWeights.get() ? m_threadWeights->id : 0;
+#else
+    return m_threadWeights.id;
+#endif
+  }
+
+  /** weights that GetAllWeights() returns on the calling thread, instead of
+   * the configured ones, until reset with NULL. Not owned.
+   * Use ThreadWeightsGuard rather than calling this directly */
+  void SetThreadWeights(const ScoreComponentCollection *weights) const;
+
   void SetAllWeights(const ScoreComponentCollection& weights) {
     m_allWeights = weights;
   }
 
   //Weight for a single-valued feature
   float GetWeight(const FeatureFunction* sp) const {
-    return m_allWeights.GetScoreForProducer(sp);
+    return GetAllWeights().GetScoreForProducer(sp);
   }
 
   //Weight for a single-valued feature
@@ -446,7 +486,7 @@ public:
 
   //Weights for feature with fixed number of values
   std::vector<float> GetWeights(const FeatureFunction* sp) const {
-    return m_allWeights.GetScoresForProducer(sp);
+    return GetAllWeights().GetScoresForProducer(sp);
   }
 
   //Weights for feature with fixed number of values
@@ -458,6 +498,9 @@ public:
   const std::string& GetFactorDelimiter() const {
     return m_factorDelimiter;
   }
+  const std::string& GetSharedModelDir() const {
+    return m_sharedModelDir;
+  }
   bool UseMBR() const {
     return m_mbr;
   }
@@ -32,6 +32,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "Util.h"
 #include "AlignmentInfoCollection.h"
 #include "InputPath.h"
+#include "Profiler.h"
 #include "moses/TranslationModel/PhraseDictionary.h"
 
 using namespace std;
@@ -69,6 +70,7 @@ TargetPhrase::TargetPhrase(const TargetPhrase &copy)
   , m_scoreBreakdown(copy.m_scoreBreakdown)
   , m_alignTerm(copy.m_alignTerm)
   , m_alignNonTerm(copy.m_alignNonTerm)
+  , m_ffData(copy.m_ffData)
   , m_container(copy.m_container)
 {
   if (copy.m_lhsTarget) {
@@ -115,6 +117,7 @@ void TargetPhrase::EvaluateInIsolation(const Phrase &source, const std::vector<F
     for (size_t i = 0; i < ffs.size(); ++i) {
       const FeatureFunction &ff = *ffs[i];
       if (! staticData.IsFeatureFunctionIgnored( ff )) {
+        Profiler::Scope profile(ff, Profiler::EvaluateInIsolation);
         ff.EvaluateInIsolation(source, *this, m_scoreBreakdown, futureScoreBreakdown);
       }
     }
@@ -134,6 +137,7 @@ void TargetPhrase::EvaluateWithSourceContext(const InputType &input, const Input
   for (size_t i = 0; i < ffs.size(); ++i) {
     const FeatureFunction &ff = *ffs[i];
     if (! staticData.IsFeatureFunctionIgnored( ff )) {
+      Profiler::Scope profile(ff, Profiler::EvaluateWithSourceContext);
       ff.EvaluateWithSourceContext(input, inputPath, *this, NULL, m_scoreBreakdown, &futureScoreBreakdown);
     }
   }
@@ -252,6 +256,20 @@ void TargetPhrase::SetRuleSource(const Phrase &ruleSource) const
   }
 }
 
+void TargetPhrase::SetFFData(const FeatureFunction *ff, const boost::shared_ptr<const void> &data) const
+{
+  m_ffData[ff] = data;
+}
+
+const void *TargetPhrase::GetFFData(const FeatureFunction *ff) const
+{
+  FFData::const_iterator iter = m_ffData.find(ff);
+  if (iter != m_ffData.end()) {
+    return iter->second.get();
+  }
+  return NULL;
+}
+
 void swap(TargetPhrase &first, TargetPhrase &second)
 {
   first.SwapWords(second);
@@ -261,6 +279,7 @@ void swap(TargetPhrase &first, TargetPhrase &second)
   std::swap(first.m_alignTerm, second.m_alignTerm);
   std::swap(first.m_alignNonTerm, second.m_alignNonTerm);
   std::swap(first.m_lhsTarget, second.m_lhsTarget);
+  std::swap(first.m_ffData, second.m_ffData);
 }
 
 TO_STRING_BODY(TargetPhrase);
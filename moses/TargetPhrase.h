@@ -63,6 +63,10 @@ private:
   typedef std::map<std::string, boost::shared_ptr<PhraseProperty> > Properties;
   Properties m_properties;
 
+  // data a FF derived from this phrase. To be set by the FF that needs it.
+  typedef std::map<const FeatureFunction*, boost::shared_ptr<const void> > FFData;
+  mutable FFData m_ffData;
+
   const PhraseDictionary *m_container;
 
 public:
@@ -159,6 +163,13 @@ public:
   // make a copy of the source side of the rule
   void SetRuleSource(const Phrase &ruleSource) const;
 
+  // To be set by the FF that needs it, eg. in EvaluateInIsolation(), so work
+  // that only depends on the phrase isn't repeated for every hypothesis.
+  // Copies of this phrase share the data.
+  void SetFFData(const FeatureFunction *ff, const boost::shared_ptr<const void> &data) const;
+  // NULL if ff hasn't set anything
+  const void *GetFFData(const FeatureFunction *ff) const;
+
   void SetProperties(const StringPiece &str);
   void SetProperty(const std::string &key, const std::string &value);
   const PhraseProperty *GetProperty(const std::string &key) const;
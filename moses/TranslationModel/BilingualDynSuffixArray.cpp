@@ -376,6 +376,9 @@ TargetPhrase*
 BilingualDynSuffixArray::
 GetMosesFactorIDs(const SAPhrase& phrase, const Phrase& sourcePhrase, const PhraseDictionary *pt) const
 {
+#ifdef WITH_THREADS
+  boost::shared_lock<boost::shared_mutex> read_lock(m_accessLock);
+#endif
   TargetPhrase* targetPhrase = new TargetPhrase(pt);
   for(size_t i=0; i < phrase.words.size(); ++i) { // look up trg words
     Word& word = m_trgVocab->GetWord( phrase.words[i]);
@@ -397,6 +400,9 @@ GatherCands(Phrase const& src, map<SAPhrase, vector<float> >& pstats) const
 {
   typedef map<SAPhrase, vector<float> >::iterator   pstat_iter;
   typedef map<SAPhrase, vector<float> >::value_type pstat_entry;
+#ifdef WITH_THREADS
+  boost::shared_lock<boost::shared_mutex> read_lock(m_accessLock);
+#endif
   pair<float,float> ret(0,0);
   float& sampleRate   = ret.first;
   float& totalPhrases = ret.second;
@@ -493,11 +499,65 @@ void
 BilingualDynSuffixArray::
 addSntPair(string& source, string& target, string& alignment)
 {
-  vuint_t srcFactor, trgFactor;
+#ifdef WITH_THREADS
+  boost::unique_lock<boost::shared_mutex> lock(m_accessLock);
+#endif
   cerr << "source, target, alignment = " << source << ", "
        << target << ", " << alignment << endl;
   const unsigned oldSrcCrpSize = m_srcCorpus->size(), oldTrgCrpSize = m_trgCorpus->size();
   cerr << "old source corpus size = " << oldSrcCrpSize << "\told target size = " << oldTrgCrpSize << endl;
+  AppendSntPair(source, target, alignment);
+  vuint_t srcFactor(m_srcCorpus->begin() + oldSrcCrpSize, m_srcCorpus->end());
+  vuint_t trgFactor(m_trgCorpus->begin() + oldTrgCrpSize, m_trgCorpus->end());
+  m_srcSA->Insert(&srcFactor, oldSrcCrpSize);
+  m_trgSA->Insert(&trgFactor, oldTrgCrpSize);
+}
+
+/// Add a batch of sentence pairs. The sentences are appended to the corpora
+/// in one go and merged into the suffix arrays with a single sort-and-merge
+/// pass per side instead of one in-place insertion per sentence. The merged
+/// arrays are built while lookups continue; the write lock is only held
+/// while appending to the corpora and while swapping in the new arrays.
+void
+BilingualDynSuffixArray::
+addSntPairs(vector<string>& sources, vector<string>& targets,
+            vector<string>& alignments)
+{
+  UTIL_THROW_IF2(sources.size() != targets.size() ||
+                 sources.size() != alignments.size(),
+                 "Batch sizes of sources, targets and alignments differ");
+#ifdef WITH_THREADS
+  boost::upgrade_lock<boost::shared_mutex> lock(m_accessLock);
+#endif
+  const unsigned oldSrcCrpSize = m_srcCorpus->size(), oldTrgCrpSize = m_trgCorpus->size();
+  {
+#ifdef WITH_THREADS
+    // readers must not see the corpus vectors while they may reallocate
+    boost::upgrade_to_unique_lock<boost::shared_mutex> wlock(lock);
+#endif
+    for(size_t i = 0; i < sources.size(); ++i)
+      AppendSntPair(sources[i], targets[i], alignments[i]);
+  }
+  DynSuffixArray* srcSA = m_srcSA->Extend(oldSrcCrpSize);
+  DynSuffixArray* trgSA = m_trgSA->Extend(oldTrgCrpSize);
+  {
+#ifdef WITH_THREADS
+    boost::upgrade_to_unique_lock<boost::shared_mutex> wlock(lock);
+#endif
+    std::swap(m_srcSA, srcSA);
+    std::swap(m_trgSA, trgSA);
+  }
+  delete srcSA;
+  delete trgSA;
+}
+
+/// Append a sentence pair to the corpora, vocabularies, alignments and
+/// co-occurrence counts; the suffix arrays are left to the caller.
+void
+BilingualDynSuffixArray::
+AppendSntPair(string& source, string& target, string& alignment)
+{
+  const unsigned oldSrcCrpSize = m_srcCorpus->size(), oldTrgCrpSize = m_trgCorpus->size();
   Phrase sphrase(ARRAY_SIZE_INCR);
   sphrase.CreateFromString(Input, m_inputFactors, source, NULL);
   m_srcVocab->MakeOpen();
@@ -507,9 +567,7 @@ addSntPair(string& source, string& target, string& alignment)
     sIDs[i] = m_srcVocab->GetWordID(sphrase.GetWord(i));  // get vocab id backwards
   }
   for(size_t i = 0; i < sphrase.GetSize(); ++i) {
-    srcFactor.push_back(sIDs[i]);
-    cerr << "srcFactor[" << (srcFactor.size() - 1) << "] = " << srcFactor.back() << endl;
-    m_srcCorpus->push_back(srcFactor.back()); // add word to corpus
+    m_srcCorpus->push_back(sIDs[i]); // add word to corpus
   }
   m_srcSntBreaks.push_back(oldSrcCrpSize); // former end of corpus is index of new sentence
   m_srcVocab->MakeClosed();
@@ -521,16 +579,9 @@ addSntPair(string& source, string& target, string& alignment)
     tIDs[i] = m_trgVocab->GetWordID(tphrase.GetWord(i));  // get vocab id
   }
   for(size_t i = 0; i < tphrase.GetSize(); ++i) {
-    trgFactor.push_back(tIDs[i]);
-    cerr << "trgFactor[" << (trgFactor.size() - 1) << "] = " << trgFactor.back() << endl;
-    m_trgCorpus->push_back(trgFactor.back());
+    m_trgCorpus->push_back(tIDs[i]);
   }
-  cerr << "gets to 1\n";
   m_trgSntBreaks.push_back(oldTrgCrpSize);
-  cerr << "gets to 2\n";
-  m_srcSA->Insert(&srcFactor, oldSrcCrpSize);
-  cerr << "gets to 3\n";
-  m_trgSA->Insert(&trgFactor, oldTrgCrpSize);
   LoadRawAlignments(alignment);
   m_trgVocab->MakeClosed();
 
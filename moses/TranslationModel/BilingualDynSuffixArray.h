@@ -13,6 +13,10 @@
 #include "moses/TargetPhraseCollection.h"
 #include <map>
 
+#ifdef WITH_THREADS
+#include <boost/thread/shared_mutex.hpp>
+#endif
+
 using namespace std;
 namespace Moses
 {
@@ -124,6 +128,8 @@ public:
 
   void CleanUp(const InputType& source);
   void addSntPair(string& source, string& target, string& alignment);
+  void addSntPairs(vector<string>& sources, vector<string>& targets,
+                   vector<string>& alignments);
   pair<float,float>
   GatherCands(Phrase const& src, map<SAPhrase, vector<float> >& pstats) const;
 
@@ -153,6 +159,10 @@ private:
   mutable set<wordID_t> m_freqWordsCached;
   const size_t m_maxPhraseLength, m_maxSampleSize;
   const size_t m_maxPTEntries;
+#ifdef WITH_THREADS
+  //reader-writer lock: lookups share it, corpus updates take it exclusively
+  mutable boost::shared_mutex m_accessLock;
+#endif
   int LoadCorpus(FactorDirection direction,
                  InputFileStream&, const vector<FactorType>& factors,
                  vector<wordID_t>&, vector<wordID_t>&,
@@ -160,6 +170,7 @@ private:
   int LoadAlignments(InputFileStream& aligs);
   int LoadRawAlignments(InputFileStream& aligs);
   int LoadRawAlignments(string& aligs);
+  void AppendSntPair(string& source, string& target, string& alignment);
 
   bool ExtractPhrases(const int&, const int&, const int&, vector<PhrasePair*>&, bool=false) const;
   SentenceAlignment GetSentenceAlignment(const int, bool=false) const;
@@ -0,0 +1,144 @@
+// vim:tabstop=2
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2014 University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#ifndef moses_HugePageAllocator_h
+#define moses_HugePageAllocator_h
+
+#include <limits>
+#include <map>
+#include <new>
+#include <boost/shared_ptr.hpp>
+
+#include "util/mmap.hh"
+
+namespace Moses
+{
+
+/** Allocator for arrays that are read once and then probed at random, such
+ * as the target phrases of PhraseDictionaryCompact. With HUGE_READ or
+ * HUGE_INTERLEAVE_READ every allocation is a mapping of its own from
+ * util::HugeMalloc, so the pages are placed before they are first touched.
+ * With any other method it allocates from the heap like std::allocator.
+ */
+template <class T>
+class HugePageAllocator
+{
+protected:
+  struct Blocks {
+    Blocks(util::LoadMethod method) : m_method(method), m_kind(util::NORMAL_PAGES) {}
+
+    util::LoadMethod m_method;
+    util::PageKind m_kind;
+    std::map<void*, boost::shared_ptr<util::scoped_memory> > m_memory;
+  };
+
+  // shared by the copies and rebinds of one allocator
+  boost::shared_ptr<Blocks> m_blocks;
+
+  template <class U> friend class HugePageAllocator;
+
+public:
+  typedef T        value_type;
+  typedef T*       pointer;
+  typedef const T* const_pointer;
+  typedef T&       reference;
+  typedef const T& const_reference;
+  typedef std::size_t    size_type;
+  typedef std::ptrdiff_t difference_type;
+
+  HugePageAllocator() throw()
+    : m_blocks(new Blocks(util::READ)) {
+  }
+
+  HugePageAllocator(util::LoadMethod method) throw()
+    : m_blocks(new Blocks(method)) {
+  }
+
+  template <class U>
+  HugePageAllocator(const HugePageAllocator<U>& c) throw()
+    : m_blocks(c.m_blocks) {
+  }
+
+  template <class U>
+  struct rebind {
+    typedef HugePageAllocator<U> other;
+  };
+
+  //! what backs the last allocation
+  util::PageKind GetPageKind() const {
+    return m_blocks->m_kind;
+  }
+
+  pointer address (reference value) const {
+    return &value;
+  }
+
+  const_pointer address (const_reference value) const {
+    return &value;
+  }
+
+  size_type max_size () const throw() {
+    return std::numeric_limits<size_t>::max() / sizeof(value_type);
+  }
+
+  pointer allocate (size_type num, const void* = 0) {
+    if(m_blocks->m_method != util::HUGE_READ && m_blocks->m_method != util::HUGE_INTERLEAVE_READ)
+      return static_cast<pointer>(::operator new(num * sizeof(T)));
+
+    boost::shared_ptr<util::scoped_memory> memory(new util::scoped_memory());
+    m_blocks->m_kind = util::HugeMalloc(num * sizeof(T),
+                                        m_blocks->m_method == util::HUGE_INTERLEAVE_READ, *memory);
+    m_blocks->m_memory[memory->get()] = memory;
+    return static_cast<pointer>(memory->get());
+  }
+
+  void deallocate (pointer p, size_type) {
+    if(!m_blocks->m_memory.erase(p))
+      ::operator delete(p);
+  }
+
+  void construct (pointer p, const T& value) {
+    new(p) value_type(value);
+  }
+  void destroy (pointer p) {
+    p->~T();
+  }
+
+  template <class T1, class T2>
+  friend bool operator== (const HugePageAllocator<T1>&, const HugePageAllocator<T2>&) throw();
+};
+
+template <class T1, class T2>
+bool operator== (const HugePageAllocator<T1>& a1,
+                 const HugePageAllocator<T2>& a2) throw()
+{
+  return a1.m_blocks == a2.m_blocks;
+}
+
+template <class T1, class T2>
+bool operator!=(const HugePageAllocator<T1>& a1,
+                const HugePageAllocator<T2>& a2) throw()
+{
+  return !(a1 == a2);
+}
+
+}
+
+#endif
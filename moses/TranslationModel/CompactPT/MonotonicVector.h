@@ -223,6 +223,10 @@ public:
 
     m_diffs.swap(mv.m_diffs);
     m_anchors.swap(mv.m_anchors);
+    m_tempDiffs.swap(mv.m_tempDiffs);
+    std::swap(m_size, mv.m_size);
+    std::swap(m_last, mv.m_last);
+    std::swap(m_final, mv.m_final);
   }
 };
 
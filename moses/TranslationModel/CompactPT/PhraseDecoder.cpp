@@ -198,7 +198,11 @@ TargetPhraseVectorPtr PhraseDecoder::CreateTargetPhraseCollection(const Phrase &
   TargetPhraseVectorPtr tpv(new TargetPhraseVector());
   size_t bitsLeft = 0;
 
-  if(m_coding == PREnc) {
+  // Phrases scored with weights overridden for this input stay out of the
+  // cache, which is kept across inputs
+  bool useCache = m_coding == PREnc && !StaticData::Instance().GetThreadWeights();
+
+  if(useCache) {
     std::pair<TargetPhraseVectorPtr, size_t> cachedPhraseColl
     = m_decodingCache.Retrieve(sourcePhrase);
 
@@ -436,7 +440,7 @@ TargetPhraseVectorPtr PhraseDecoder::DecodeCollection(
     }
   }
 
-  if(m_coding == PREnc && !extending) {
+  if(useCache && !extending) {
     bitsLeft = bitsLeft > 8 ? bitsLeft : 0;
     m_decodingCache.Cache(sourcePhrase, tpv, bitsLeft, m_maxRank);
   }
@@ -46,6 +46,7 @@ PhraseDictionaryCompact::PhraseDictionaryCompact(const std::string &line)
   :PhraseDictionary(line)
   ,m_inMemory(true)
   ,m_useAlignmentInfo(true)
+  ,m_loadMethod(util::READ)
   ,m_hash(10, 16)
   ,m_phraseDecoder(0)
   ,m_weight(0)
@@ -93,17 +94,46 @@ void PhraseDictionaryCompact::Load()
   size_t coderSize = m_phraseDecoder->Load(pFile);
 
   size_t phraseSize;
-  if(m_inMemory)
-    // Load target phrase collections into memory
-    phraseSize = m_targetPhrasesMemory.load(pFile, false);
-  else
+  if(m_inMemory) {
+    // Load target phrase collections into memory. They are most of the
+    // table and are probed at random, so they go to huge pages on request.
+    HugePageAllocator<unsigned char> alloc(m_loadMethod);
+    StringVector<unsigned char, size_t, HugePageAllocator> targetPhrases(alloc);
+    phraseSize = targetPhrases.load(pFile, false);
+    m_targetPhrasesMemory.swap(targetPhrases);
+    if(m_loadMethod == util::HUGE_READ || m_loadMethod == util::HUGE_INTERLEAVE_READ) {
+      VERBOSE(1, "Loaded " << m_targetPhrasesMemory.size2() << " bytes of target phrases into "
+              << util::PageKindName(alloc.GetPageKind())
+              << (m_loadMethod == util::HUGE_INTERLEAVE_READ ? " interleaved across NUMA nodes" : "") << std::endl);
+    }
+  } else {
     // Keep target phrase collections on disk
+    UTIL_THROW_IF2(m_loadMethod != util::READ, "load=huge and load=huge_interleave need "
+                   << GetScoreProducerDescription() << " to be in memory");
     phraseSize = m_targetPhrasesMapped.load(pFile, true);
+  }
 
   UTIL_THROW_IF2(indexSize == 0 || coderSize == 0 || phraseSize == 0,
 		  "Not successfully loaded");
 }
 
+void PhraseDictionaryCompact::SetParameter(const std::string& key, const std::string& value)
+{
+  if (key == "load") {
+    if (value == "read") {
+      m_loadMethod = util::READ;
+    } else if (value == "huge") {
+      m_loadMethod = util::HUGE_READ;
+    } else if (value == "huge_interleave") {
+      m_loadMethod = util::HUGE_INTERLEAVE_READ;
+    } else {
+      UTIL_THROW2("Unknown load method " << value << " for " << GetScoreProducerDescription() << ".  Use read, huge, or huge_interleave.");
+    }
+  } else {
+    PhraseDictionary::SetParameter(key, value);
+  }
+}
+
 // now properly declared in TargetPhraseCollection.h
 // and defined in TargetPhraseCollection.cpp
 // struct CompareTargetPhrase {
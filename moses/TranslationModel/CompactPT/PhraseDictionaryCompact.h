@@ -35,8 +35,10 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "BlockHashIndex.h"
 #include "StringVector.h"
+#include "HugePageAllocator.h"
 #include "PhraseDecoder.h"
 #include "TargetPhraseCollectionCache.h"
+#include "util/mmap.hh"
 
 namespace Moses
 {
@@ -50,6 +52,8 @@ protected:
 
   bool m_inMemory;
   bool m_useAlignmentInfo;
+  // READ, HUGE_READ, or HUGE_INTERLEAVE_READ for the in-memory tables.
+  util::LoadMethod m_loadMethod;
 
   typedef std::vector<TargetPhraseCollection*> PhraseCache;
 #ifdef WITH_THREADS
@@ -64,7 +68,7 @@ protected:
   PhraseDecoder* m_phraseDecoder;
 
   StringVector<unsigned char, size_t, MmapAllocator>  m_targetPhrasesMapped;
-  StringVector<unsigned char, size_t, std::allocator> m_targetPhrasesMemory;
+  StringVector<unsigned char, size_t, HugePageAllocator> m_targetPhrasesMemory;
 
   std::vector<float> m_weight;
 public:
@@ -74,6 +78,8 @@ public:
 
   void Load();
 
+  void SetParameter(const std::string& key, const std::string& value);
+
   const TargetPhraseCollection* GetTargetPhraseCollectionNonCacheLEGACY(const Phrase &source) const;
   TargetPhraseVectorPtr GetTargetPhraseCollectionRaw(const Phrase &source) const;
 
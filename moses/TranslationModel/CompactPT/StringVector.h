@@ -209,9 +209,11 @@ public:
     return size;
   }
 
-  size_t loadCharArray(std::vector<ValueT, std::allocator<ValueT> >& c,
+  template <class CharAllocator>
+  size_t loadCharArray(std::vector<ValueT, CharAllocator>& c,
                        std::FILE* in, bool map = false) {
-    // Can only be read into memory. Mapping not possible with std:allocator.
+    // Can only be read into memory. Mapping not possible with std:allocator
+    // or HugePageAllocator.
     assert(map == false);
 
     size_t byteSize = 0;
@@ -43,6 +43,45 @@ DynSuffixArray::DynSuffixArray(vuint_t* crp)
   //printAuxArrays();
 }
 
+DynSuffixArray::DynSuffixArray(vuint_t* crp, vuint_t* sa)
+{
+  m_corpus = crp;
+  m_SA = sa;
+  BuildAuxArrays();
+}
+
+DynSuffixArray* DynSuffixArray::Extend(unsigned oldCorpusSize) const
+{
+  // suffixes are only sorted on their first SORT_WINDOW words (see Qsort), so
+  // old suffixes whose window reaches the former end of corpus must be
+  // re-sorted together with the new ones
+  const int SORT_WINDOW = 20;
+  int size = m_corpus->size();
+  UTIL_THROW_IF2(oldCorpusSize > (unsigned)size || m_SA->size() != oldCorpusSize,
+                 "Suffix array and corpus out of sync");
+  int cutoff = std::max(0, (int)oldCorpusSize - SORT_WINDOW);
+
+  int numNew = size - cutoff;
+  int* tmpArr = new int[numNew];
+  for(int i=0 ; i < numNew; ++i) tmpArr[i] = cutoff + i;
+  Qsort(tmpArr, 0, numNew-1);
+
+  // merge the untouched part of the old array with the freshly sorted suffixes
+  vuint_t* sa = new vuint_t();
+  sa->reserve(size);
+  int j = 0;
+  for (vuint_t::const_iterator itr = m_SA->begin(); itr != m_SA->end(); ++itr) {
+    if((int)*itr >= cutoff) continue;
+    while(j < numNew && Compare(tmpArr[j], *itr, SORT_WINDOW) < 0)
+      sa->push_back(tmpArr[j++]);
+    sa->push_back(*itr);
+  }
+  while(j < numNew) sa->push_back(tmpArr[j++]);
+  delete[] tmpArr;
+
+  return new DynSuffixArray(m_corpus, sa);
+}
+
 void DynSuffixArray::BuildAuxArrays()
 {
   int size = m_SA->size();
@@ -301,7 +340,7 @@ void DynSuffixArray::Load(FILE* fin)
   fReadVector(fin, *m_SA);
 }
 
-int DynSuffixArray::Compare(int pos1, int pos2, int max)
+int DynSuffixArray::Compare(int pos1, int pos2, int max) const
 {
   for (size_t i = 0; i < (unsigned)max; ++i) {
     if((pos1 + i < m_corpus->size()) && (pos2 + i >= m_corpus->size()))
@@ -315,7 +354,7 @@ int DynSuffixArray::Compare(int pos1, int pos2, int max)
   return 0;
 }
 
-void DynSuffixArray::Qsort(int* array, int begin, int end)
+void DynSuffixArray::Qsort(int* array, int begin, int end) const
 {
   if(end > begin) {
     int index;
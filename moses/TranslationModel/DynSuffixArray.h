@@ -45,18 +45,25 @@ public:
   void Insert(vuint_t*, unsigned);
   void Delete(unsigned, unsigned);
   void Substitute(vuint_t*, unsigned);
+  /// Build a new suffix array over the corpus after a batch of sentences
+  /// has been appended at /oldCorpusSize/, by sorting only the new suffixes
+  /// and merging them with the existing ones. The current object is left
+  /// untouched so that lookups can proceed while the batch is merged.
+  DynSuffixArray* Extend(unsigned oldCorpusSize) const;
 
   size_t GetCount(vuint_t const& phrase) const;
 
 private:
+  DynSuffixArray(vuint_t* crp, vuint_t* sa);
+
   vuint_t* m_SA;
   vuint_t* m_ISA;
   vuint_t* m_F;
   vuint_t* m_L;
   vuint_t* m_corpus;
   void BuildAuxArrays();
-  void Qsort(int* array, int begin, int end);
-  int Compare(int, int, int);
+  void Qsort(int* array, int begin, int end) const;
+  int Compare(int, int, int) const;
   void Reorder(unsigned, unsigned);
   int LastFirstFunc(unsigned);
   int Rank(unsigned, unsigned);
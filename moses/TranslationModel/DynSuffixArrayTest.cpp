@@ -0,0 +1,95 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2014- University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#include <algorithm>
+#include <memory>
+#include <boost/test/unit_test.hpp>
+
+#include "DynSuffixArray.h"
+
+using namespace Moses;
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(dyn_suffix_array)
+
+namespace
+{
+
+// a corpus with few word types, so that phrases occur often and suffixes
+// share long prefixes
+void AppendWords(vuint_t &corpus, size_t count, unsigned seed)
+{
+  for (size_t i = 0; i < count; ++i) {
+    seed = seed * 1103515245 + 12345;
+    corpus.push_back((seed >> 8) % 4);
+  }
+}
+
+// every phrase of up to maxLength words of the corpus has the same
+// occurrences in both arrays
+void CheckSameOccurrences(DynSuffixArray &extended, DynSuffixArray &rebuilt,
+                          const vuint_t &corpus, size_t maxLength)
+{
+  for (size_t start = 0; start < corpus.size(); ++start) {
+    for (size_t length = 1; length <= maxLength && start + length <= corpus.size(); ++length) {
+      vuint_t phrase(corpus.begin() + start, corpus.begin() + start + length);
+      BOOST_CHECK_EQUAL(extended.GetCount(phrase), rebuilt.GetCount(phrase));
+
+      vuint_t extendedIndices, rebuiltIndices;
+      extended.GetCorpusIndex(&phrase, &extendedIndices);
+      rebuilt.GetCorpusIndex(&phrase, &rebuiltIndices);
+      sort(extendedIndices.begin(), extendedIndices.end());
+      sort(rebuiltIndices.begin(), rebuiltIndices.end());
+      BOOST_CHECK(extendedIndices == rebuiltIndices);
+    }
+  }
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(extend_matches_rebuild)
+{
+  vuint_t corpus;
+  AppendWords(corpus, 200, 1);
+  auto_ptr<DynSuffixArray> extended(new DynSuffixArray(&corpus));
+
+  // several batches, including one shorter than the sort window of Extend
+  const size_t batches[] = { 50, 5, 120 };
+  for (size_t i = 0; i < sizeof(batches) / sizeof(batches[0]); ++i) {
+    const unsigned oldSize = corpus.size();
+    AppendWords(corpus, batches[i], i + 2);
+    extended.reset(extended->Extend(oldSize));
+
+    DynSuffixArray rebuilt(&corpus);
+    CheckSameOccurrences(*extended, rebuilt, corpus, 4);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(extend_empty_corpus)
+{
+  vuint_t corpus;
+  auto_ptr<DynSuffixArray> extended(new DynSuffixArray(&corpus));
+  AppendWords(corpus, 30, 7);
+  extended.reset(extended->Extend(0));
+
+  DynSuffixArray rebuilt(&corpus);
+  CheckSameOccurrences(*extended, rebuilt, corpus, 3);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -27,6 +27,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "moses/DecodeStep.h"
 #include "moses/DecodeGraph.h"
 #include "moses/InputPath.h"
+#include "moses/Profiler.h"
 #include "util/exception.hh"
 
 using namespace std;
@@ -44,6 +45,14 @@ CacheColl::~CacheColl()
 	}
 }
 
+void CacheColl::Clear()
+{
+	for (iterator iter = begin(); iter != end(); ++iter) {
+		delete iter->second.first;
+	}
+	clear();
+}
+
 PhraseDictionary::PhraseDictionary(const std::string &line)
   :DecodeFeature(line)
   ,m_tableLimit(20) // default
@@ -60,6 +69,18 @@ ProvidesPrefixCheck() const
   return false;
 }
 
+std::vector<PhraseDictionary const*>
+PhraseDictionary::
+GetPrefixCheckers()
+{
+  std::vector<PhraseDictionary const*> ret;
+  for (size_t i = 0; i < s_staticColl.size(); ++i) {
+    if (!s_staticColl[i]->ProvidesPrefixCheck()) return std::vector<PhraseDictionary const*>();
+    ret.push_back(s_staticColl[i]);
+  }
+  return ret;
+}
+
 const TargetPhraseCollection *PhraseDictionary::GetTargetPhraseCollectionLEGACY(const Phrase& src) const
 {
   const TargetPhraseCollection *ret;
@@ -70,6 +91,7 @@ const TargetPhraseCollection *PhraseDictionary::GetTargetPhraseCollectionLEGACY(
 
     CacheColl::iterator iter;
     iter = cache.find(hash);
+    Profiler::CountCache(*this, iter != cache.end());
 
     if (iter == cache.end()) {
       // not in cache, need to look up from phrase table
@@ -241,6 +263,12 @@ CacheColl &PhraseDictionary::GetCache() const
     m_cache.reset(cache);
   }
   assert(cache);
+  // entries scored with other weights than the current ones are stale
+  size_t weightsId = StaticData::Instance().GetThreadWeightsId();
+  if (cache->m_weightsId != weightsId) {
+    cache->Clear();
+    cache->m_weightsId = weightsId;
+  }
   return *cache;
 }
 
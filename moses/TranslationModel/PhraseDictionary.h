@@ -62,7 +62,14 @@ class CacheColl : public boost::unordered_map<size_t, std::pair<const TargetPhra
 // 3rd = time of last access
 
 public:
+	CacheColl() : m_weightsId(0) {}
 	~CacheColl();
+
+	//! deletes all entries
+	void Clear();
+
+	//! StaticData::GetThreadWeightsId() of the weights the entries were scored with
+	size_t m_weightsId;
 };
 
 /**
@@ -77,6 +84,11 @@ public:
 	return s_staticColl;
   }
 
+  /** the dictionaries to ask with PrefixExists() before an input path of a
+   * confusion network or lattice is extended. Empty if some dictionary
+   * cannot check prefixes, as no path may be pruned then */
+  static std::vector<PhraseDictionary const*> GetPrefixCheckers();
+
   PhraseDictionary(const std::string &line);
 
   virtual ~PhraseDictionary() {
@@ -95,6 +107,14 @@ public:
   void
   Release(TargetPhraseCollection const* tpc) const;
 
+  /** whether the target phrases were scored with the configured weights
+   * when the table was loaded, so their scores cannot follow weights that
+   * are overridden for an input */
+  virtual
+  bool
+  ScoresWhenLoading() const
+  { return false; }
+
   /// return true if phrase table entries starting with /phrase/ 
   //  exist in the table.
   virtual
@@ -92,6 +92,14 @@ insertSnt(string& source, string& target, string& alignment)
   //StaticData::Instance().ClearTransOptionCache(); // clear translation option cache
 }
 
+void
+PhraseDictionaryDynSuffixArray::
+insertSnts(vector<string>& source, vector<string>& target,
+           vector<string>& alignment)
+{
+  m_biSA->addSntPairs(source, target, alignment); // merge batch into suffix arrays
+}
+
 void
 PhraseDictionaryDynSuffixArray::
 deleteSnt(unsigned /* idx */, unsigned /* num2Del */)
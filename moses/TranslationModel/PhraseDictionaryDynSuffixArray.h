@@ -23,6 +23,8 @@ public:
   // functions below required by base class
   const TargetPhraseCollection* GetTargetPhraseCollectionLEGACY(const Phrase& src) const;
   void insertSnt(string&, string&, string&);
+  void insertSnts(std::vector<std::string>&, std::vector<std::string>&,
+                  std::vector<std::string>&);
   void deleteSnt(unsigned, unsigned);
   ChartRuleLookupManager *CreateRuleLookupManager(const ChartParser &, const ChartCellCollectionBase&, std::size_t);
   void SetParameter(const std::string& key, const std::string& value);
@@ -80,6 +80,18 @@ GetTargetPhraseCollectionLEGACY(const Phrase& sourceOrig) const
   return &currNode->GetTargetPhraseCollection();
 }
 
+bool PhraseDictionaryMemory::PrefixExists(const Phrase &phrase) const
+{
+  // a node of the trie exists for every prefix of a source phrase
+  const PhraseDictionaryNodeMemory *currNode = &m_collection;
+  for (size_t pos = 0 ; pos < phrase.GetSize() && currNode ; ++pos) {
+    Word word(phrase.GetWord(pos));
+    word.OnlyTheseFactors(m_inputFactors);
+    currNode = currNode->GetChild(word);
+  }
+  return currNode != NULL;
+}
+
 PhraseDictionaryNodeMemory &PhraseDictionaryMemory::GetOrCreateNode(const Phrase &source
     , const TargetPhrase &target
     , const Word *sourceLHS)
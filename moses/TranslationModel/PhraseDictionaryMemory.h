@@ -59,6 +59,11 @@ public:
   const TargetPhraseCollection *GetTargetPhraseCollectionLEGACY(const Phrase& src) const;
   void GetTargetPhraseCollectionBatch(const InputPathList &inputPathQueue) const;
 
+  bool ProvidesPrefixCheck() const {
+    return true;
+  }
+  bool PrefixExists(const Phrase &phrase) const;
+
   TO_STRING();
 
 protected:
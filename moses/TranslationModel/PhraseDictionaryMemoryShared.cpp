@@ -0,0 +1,373 @@
+/***********************************************************************
+ Moses - statistical machine translation system
+ Copyright (C) 2006-2014 University of Edinburgh
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "PhraseDictionaryMemoryShared.h"
+#include "moses/InputPath.h"
+#include "moses/StaticData.h"
+#include "moses/TargetPhrase.h"
+#include "moses/TargetPhraseCollection.h"
+#include "moses/Util.h"
+#include "moses/Word.h"
+#include "util/double-conversion/double-conversion.h"
+#include "util/exception.hh"
+#include "util/file_piece.hh"
+#include "util/string_piece.hh"
+#include "util/tokenize_piece.hh"
+
+using namespace std;
+
+namespace Moses
+{
+namespace
+{
+const char SHARED_MAGIC[8] = {'m', 'o', 's', 'e', 's', 'P', 'T', '2'};
+
+//sections of the image, in the order they are written
+enum {
+  SHARED_TEXT, SHARED_OFFSETS, SHARED_SCORES, SHARED_RULES, SHARED_TABLE, SHARED_KEYS, SHARED_NUM_SCORES, SHARED_SECTIONS
+};
+}
+
+PhraseDictionaryMemoryShared::PhraseDictionaryMemoryShared(const std::string &line)
+  : PhraseDictionary(line)
+  , m_offsets(NULL)
+  , m_scores(NULL)
+  , m_text(NULL)
+  , m_rules(NULL)
+{
+  ReadParameters();
+
+  m_root.key = 0;
+  m_root.begin = m_root.end = 0;
+  m_root.textBegin = m_root.textEnd = 0;
+}
+
+void PhraseDictionaryMemoryShared::Load()
+{
+  SetFeaturesToApply();
+
+  const std::string imagePath = GetImagePath();
+  if (!MapImage(imagePath)) {
+    std::cerr << "Building shared table " << imagePath << "...";
+    CreateImage(imagePath);
+    std::cerr << "done.\n";
+    UTIL_THROW_IF2(!MapImage(imagePath), "Could not map the shared table " << imagePath);
+  }
+}
+
+void PhraseDictionaryMemoryShared::InitializeForInput(InputType const& source)
+{
+  if (m_maxCacheSize) {
+    ReduceCache();
+  } else {
+    // nothing is kept between sentences
+    GetCache().Clear();
+  }
+}
+
+SharedModelImage::Key PhraseDictionaryMemoryShared::NextKey(uint64_t parent, const Word &word) const
+{
+  SharedModelImage::Key key(parent);
+  key.Append(word, m_input);
+  return key;
+}
+
+const SharedModelImage::Entry *PhraseDictionaryMemoryShared::Find(const Phrase &phrase) const
+{
+  const SharedModelImage::Entry *entry = &m_root;
+  for (size_t pos = 0 ; entry && pos < phrase.GetSize() ; ++pos) {
+    entry = m_table.Find(NextKey(entry->key, phrase.GetWord(pos)));
+  }
+  return entry;
+}
+
+const TargetPhraseCollection*
+PhraseDictionaryMemoryShared::
+GetTargetPhraseCollectionLEGACY(const Phrase& src) const
+{
+  const SharedModelImage::Entry *entry = Find(src);
+  return entry ? GetTargetPhrases(*entry, src) : NULL;
+}
+
+bool PhraseDictionaryMemoryShared::PrefixExists(const Phrase &phrase) const
+{
+  // an entry exists for every prefix of a source phrase
+  return phrase.GetSize() == 0 || Find(phrase) != NULL;
+}
+
+void
+PhraseDictionaryMemoryShared::
+GetTargetPhraseCollectionBatch(const InputPathList &inputPathQueue) const
+{
+  InputPathList::const_iterator iter;
+  for (iter = inputPathQueue.begin(); iter != inputPathQueue.end(); ++iter) {
+    InputPath &inputPath = **iter;
+    const Phrase &phrase = inputPath.GetPhrase();
+    const InputPath *prevPath = inputPath.GetPrevPath();
+
+    const SharedModelImage::Entry *prevEntry = NULL;
+
+    if (prevPath) {
+      prevEntry = static_cast<const SharedModelImage::Entry*>(prevPath->GetPtNode(*this));
+    } else {
+      // Starting subphrase.
+      assert(phrase.GetSize() == 1);
+      prevEntry = &m_root;
+    }
+
+    // backoff
+    if (!SatisfyBackoff(inputPath)) {
+      continue;
+    }
+
+    if (prevEntry) {
+      const Word &lastWord = phrase.GetWord(phrase.GetSize() - 1);
+      const SharedModelImage::Entry *entry = m_table.Find(NextKey(prevEntry->key, lastWord));
+      if (entry) {
+        inputPath.SetTargetPhrases(*this, GetTargetPhrases(*entry, phrase), entry);
+      } else {
+        inputPath.SetTargetPhrases(*this, NULL, NULL);
+      }
+    }
+  }
+}
+
+const TargetPhraseCollection *PhraseDictionaryMemoryShared::GetTargetPhrases(const SharedModelImage::Entry &entry, const Phrase &sourceOrig) const
+{
+  if (entry.begin == entry.end) {
+    // only a prefix of source phrases
+    return NULL;
+  }
+
+  CacheColl &cache = GetCache();
+  CacheColl::iterator iter = cache.find(entry.key);
+  if (iter != cache.end()) {
+    iter->second.second = clock();
+    return iter->second.first;
+  }
+
+  Phrase source(sourceOrig);
+  source.OnlyTheseFactors(m_inputFactors);
+
+  TargetPhraseCollection *ret = new TargetPhraseCollection();
+  for (uint64_t i = entry.begin; i < entry.end; ++i) {
+    ret->Add(CreateTargetPhrase(m_rules[i], source));
+  }
+  // sort and prune, as PhraseDictionaryMemory does after loading
+  if (GetTableLimit()) {
+    ret->Sort(true, GetTableLimit());
+  }
+
+  std::pair<const TargetPhraseCollection*, clock_t> value(ret, clock());
+  cache[entry.key] = value;
+  return ret;
+}
+
+TargetPhrase *PhraseDictionaryMemoryShared::CreateTargetPhrase(uint64_t rule, const Phrase &source) const
+{
+  // the text is the target phrase and the columns after the scores
+  const StringPiece text(m_text + m_offsets[rule], m_offsets[rule + 1] - m_offsets[rule]);
+  util::TokenIter<util::MultiCharacter> pipes(text, "|||");
+  StringPiece targetPhraseString(*pipes);
+
+  StringPiece alignString;
+  if (++pipes) {
+    StringPiece temp(*pipes);
+    alignString = temp;
+  }
+
+  if (++pipes) {
+    StringPiece str(*pipes); //counts
+  }
+
+  Word *targetLHS;
+  TargetPhrase *targetPhrase = new TargetPhrase(this);
+  targetPhrase->CreateFromString(Output, m_output, targetPhraseString, &targetLHS);
+  targetPhrase->SetAlignmentInfo(alignString);
+  targetPhrase->SetTargetLHS(targetLHS);
+
+  if (++pipes) {
+    StringPiece sparseString(*pipes);
+    targetPhrase->SetSparseScore(this, sparseString);
+  }
+
+  if (++pipes) {
+    StringPiece propertiesString(*pipes);
+    targetPhrase->SetProperties(propertiesString);
+  }
+
+  const float *scores = m_scores + rule * m_numScoreComponents;
+  targetPhrase->GetScoreBreakdown().Assign(this, std::vector<float>(scores, scores + m_numScoreComponents));
+  targetPhrase->EvaluateInIsolation(source, GetFeaturesToApply());
+  return targetPhrase;
+}
+
+std::string PhraseDictionaryMemoryShared::GetImagePath() const
+{
+  std::ostringstream id;
+  for (size_t i = 0; i < m_input.size(); ++i) {
+    id << m_input[i] << ',';
+  }
+  id << '\n';
+  for (size_t i = 0; i < m_output.size(); ++i) {
+    id << m_output[i] << ',';
+  }
+  id << '\n' << m_numScoreComponents << '\n' << StaticData::Instance().GetFactorDelimiter();
+  return SharedModelImage::GetPath(StaticData::Instance().GetSharedModelDir(), "moses-pt", SHARED_MAGIC, m_filePath, id.str());
+}
+
+void PhraseDictionaryMemoryShared::CreateImage(const std::string &imagePath) const
+{
+  const StaticData &staticData = StaticData::Instance();
+
+  // the text of the rules is written as it is read, the rest is kept until the end
+  SharedModelImage::Writer writer(imagePath, SHARED_MAGIC, SHARED_SECTIONS);
+  SharedModelImage::TableBuilder nodes;
+  // node of the source phrase of each rule, and the rule in file order
+  std::vector<std::pair<uint64_t, uint64_t> > rules;
+  std::vector<uint64_t> offsets;
+  std::vector<float> scores;
+  uint64_t textSize = 0;
+
+  size_t count = 0;
+  std::ostream *progress = NULL;
+  IFVERBOSE(1) progress = &std::cerr;
+  util::FilePiece in(m_filePath.c_str(), progress);
+
+  // reused variables
+  vector<float> scoreVector;
+  StringPiece line;
+
+  double_conversion::StringToDoubleConverter converter(double_conversion::StringToDoubleConverter::NO_FLAGS, NAN, NAN, "inf", "nan");
+
+  while(true) {
+    try {
+      line = in.ReadLine();
+    } catch (const util::EndOfFileException &e) {
+      break;
+    }
+
+    if (count == 0) {
+      UTIL_THROW_IF2(line.find("|||") == StringPiece::npos,
+                     m_filePath << " is not a text phrase table, which shared-model-dir needs");
+    }
+
+    util::TokenIter<util::MultiCharacter> pipes(line, "|||");
+    StringPiece sourcePhraseString(*pipes);
+    StringPiece targetPhraseString(*++pipes);
+    StringPiece scoreString(*++pipes);
+
+    // empty source phrases are never looked up in phrase-based decoding
+    bool isLHSEmpty = (sourcePhraseString.find_first_not_of(" \t", 0) == string::npos);
+    if (isLHSEmpty) {
+      if (!staticData.IsWordDeletionEnabled()) {
+        TRACE_ERR( m_filePath << ":" << count << ": pt entry contains empty target, skipping\n");
+      }
+      continue;
+    }
+
+    scoreVector.clear();
+    for (util::TokenIter<util::AnyCharacter, true> s(scoreString, " \t"); s; ++s) {
+      int processed;
+      float score = converter.StringToFloat(s->data(), s->length(), &processed);
+      UTIL_THROW_IF2(isnan(score), "Bad score " << *s << " on line " << count);
+      scoreVector.push_back(FloorScore(TransformScore(score)));
+    }
+    if (scoreVector.size() != m_numScoreComponents) {
+      UTIL_THROW2("Size of scoreVector != number (" << scoreVector.size() << "!="
+                  << m_numScoreComponents << ") of score components on line " << count);
+    }
+
+    // a node for the source phrase and each of its prefixes
+    Word *sourceLHS = NULL;
+    Phrase sourcePhrase;
+    sourcePhrase.CreateFromString(Input, m_input, sourcePhraseString, &sourceLHS);
+    delete sourceLHS;
+    uint64_t parent = m_root.key;
+    size_t node = 0;
+    for (size_t pos = 0 ; pos < sourcePhrase.GetSize() ; ++pos) {
+      const SharedModelImage::Key key = NextKey(parent, sourcePhrase.GetWord(pos));
+      node = nodes.Insert(key);
+      parent = key.GetHash();
+    }
+
+    rules.push_back(std::make_pair(node, rules.size()));
+    offsets.push_back(textSize);
+    const char *rest = scoreString.data() + scoreString.size();
+    writer.Append(targetPhraseString.data(), targetPhraseString.size());
+    writer.Append(rest, line.data() + line.size() - rest);
+    textSize += targetPhraseString.size() + (line.data() + line.size() - rest);
+    scores.insert(scores.end(), scoreVector.begin(), scoreVector.end());
+
+    count++;
+  }
+  offsets.push_back(textSize);
+  writer.EndSection();
+
+  writer.Add(&offsets[0], offsets.size() * sizeof(uint64_t));
+  writer.Add(scores.empty() ? NULL : &scores[0], scores.size() * sizeof(float));
+  std::vector<uint64_t>().swap(offsets);
+  std::vector<float>().swap(scores);
+
+  // group the rules of each source phrase, keeping them in file order
+  std::sort(rules.begin(), rules.end());
+  for (size_t i = 0; i < rules.size(); ++i) {
+    SharedModelImage::Entry &entry = nodes.GetEntry(rules[i].first);
+    if (i == 0 || rules[i].first != rules[i - 1].first) {
+      entry.begin = i;
+    }
+    entry.end = i + 1;
+    writer.Append(&rules[i].second, sizeof(uint64_t));
+  }
+  writer.EndSection();
+  nodes.Write(writer);
+
+  const uint64_t numScores = m_numScoreComponents;
+  writer.Add(&numScores, sizeof(numScores));
+  writer.Commit();
+}
+
+bool PhraseDictionaryMemoryShared::MapImage(const std::string &imagePath)
+{
+  if (!m_image.Map(imagePath, SHARED_MAGIC, SHARED_SECTIONS)) {
+    return false;
+  }
+  const uint64_t numScores = *reinterpret_cast<const uint64_t*>(m_image.GetSection(SHARED_NUM_SCORES));
+  UTIL_THROW_IF2(numScores != m_numScoreComponents, "Shared table " << imagePath << " has " << numScores
+                 << " scores instead of " << m_numScoreComponents);
+  m_table = SharedModelImage::Table(m_image, SHARED_TABLE);
+  m_offsets = reinterpret_cast<const uint64_t*>(m_image.GetSection(SHARED_OFFSETS));
+  m_scores = reinterpret_cast<const float*>(m_image.GetSection(SHARED_SCORES));
+  m_text = m_image.GetSection(SHARED_TEXT);
+  m_rules = reinterpret_cast<const uint64_t*>(m_image.GetSection(SHARED_RULES));
+  return true;
+}
+
+ChartRuleLookupManager* PhraseDictionaryMemoryShared::CreateRuleLookupManager(const ChartParser &,
+    const ChartCellCollectionBase &,
+    std::size_t /*maxChartSpan*/)
+{
+  UTIL_THROW2("shared-model-dir only shares phrase tables for phrase-based decoding");
+}
+
+}
@@ -0,0 +1,82 @@
+/***********************************************************************
+ Moses - statistical machine translation system
+ Copyright (C) 2006-2014 University of Edinburgh
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#pragma once
+
+#include "moses/TranslationModel/PhraseDictionary.h"
+#include "moses/SharedModelImage.h"
+
+namespace Moses
+{
+class ChartParser;
+class ChartCellCollectionBase;
+class ChartRuleLookupManager;
+
+/** Text phrase table for phrase-based decoding with shared-model-dir. It
+ * is loaded as PhraseDictionaryMemory would be, but into an image that is
+ * built once and mapped read-only by every decoder process. The image has
+ * an entry for every prefix of a source phrase, keyed by the key of the
+ * prefix one word shorter and the last word, so looking up a phrase of n
+ * words takes n look-ups as in the trie. Target phrases are created from
+ * the image when their source phrase is first looked up and then kept in
+ * the phrase table cache.
+ */
+class PhraseDictionaryMemoryShared : public PhraseDictionary
+{
+public:
+  PhraseDictionaryMemoryShared(const std::string &line);
+
+  void Load();
+
+  void InitializeForInput(InputType const& source);
+
+  // only used by multi-model phrase table, and other meta-features
+  const TargetPhraseCollection *GetTargetPhraseCollectionLEGACY(const Phrase& src) const;
+  void GetTargetPhraseCollectionBatch(const InputPathList &inputPathQueue) const;
+
+  bool ProvidesPrefixCheck() const {
+    return true;
+  }
+  bool PrefixExists(const Phrase &phrase) const;
+
+  //! not supported, the table is only shared for phrase-based decoding
+  ChartRuleLookupManager* CreateRuleLookupManager(const ChartParser&, const ChartCellCollectionBase&, std::size_t);
+
+protected:
+  SharedModelImage::Key NextKey(uint64_t parent, const Word &word) const;
+  const SharedModelImage::Entry *Find(const Phrase &phrase) const;
+  const TargetPhraseCollection *GetTargetPhrases(const SharedModelImage::Entry &entry, const Phrase &sourceOrig) const;
+  TargetPhrase *CreateTargetPhrase(uint64_t rule, const Phrase &source) const;
+
+  std::string GetImagePath() const;
+  void CreateImage(const std::string &imagePath) const;
+  bool MapImage(const std::string &imagePath);
+
+  SharedModelImage m_image;
+  SharedModelImage::Table m_table;
+  const uint64_t *m_offsets;
+  const float *m_scores;
+  const char *m_text;
+  // rules in the order of the entries, which index this
+  const uint64_t *m_rules;
+  // node of the empty phrase, which starts every look-up
+  SharedModelImage::Entry m_root;
+};
+
+}  // namespace Moses
@@ -27,6 +27,11 @@ public:
   void InitializeForInput(InputType const& source);
   void CleanUpAfterSentenceProcessing(const InputType& source);
 
+  //! the rules of each input are loaded and scored with its weights
+  bool ScoresWhenLoading() const {
+    return false;
+  }
+
 protected:
 
 };
@@ -48,6 +48,11 @@ public:
 
   void Load();
 
+  //! the rules are scored and pruned by the loader
+  bool ScoresWhenLoading() const {
+    return true;
+  }
+
 private:
   friend class RuleTableLoader;
 
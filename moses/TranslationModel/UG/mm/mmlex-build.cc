@@ -4,8 +4,10 @@
 // mm2dTable<uint32_t> (ug_mm_2d_table.h) 
 // 
 // (c) 2010-2012 Ulrich Germann
-
-// to do: multi-threading
+// 
+// Each thread counts a share of the sentences into its own table; the
+// tables are merged when they are written, so the output does not
+// depend on the number of threads.
 
 #include <queue>
 #include <iomanip>
@@ -71,6 +73,9 @@ public:
   countlist_t & LEX;
   size_t  offset;
   size_t    skip;
+  // word counts of the current sentence pair; all zero between sentences,
+  // so that they need not be allocated for each sentence 
+  vector<ushort> cnt1, cnt2;
   Counter(countlist_t& lex, size_t o, size_t s) 
     : LEX(lex), offset(o), skip(s) {}
   void processSentence(id_type sid);
@@ -86,6 +91,8 @@ void
 Counter::
 operator()()
 {
+  cnt1.assign(V1.ksize(),0);
+  cnt2.assign(V2.ksize(),0);
   for (size_t sid = offset; sid < min(truncat,T1.size()); sid += skip)
     processSentence(sid);
 
@@ -220,8 +227,6 @@ processSentence(id_type sid)
   Token const* e1 = T1.sntEnd(sid);
   Token const* s2 = T2.sntStart(sid);
   Token const* e2 = T2.sntEnd(sid);
-  vector<ushort> cnt1(V1.ksize(),0);
-  vector<ushort> cnt2(V2.ksize(),0);
   for (Token const* x = s1; x < e1; ++x) 
     ++cnt1.at(x->id());
   for (Token const* x = s2; x < e2; ++x) 
@@ -264,6 +269,11 @@ processSentence(id_type sid)
        i < check2.size(); 
        i = check2.find_next(i))
     CNT[wpair(0,(s2+i)->id())].a++;
+
+  for (Token const* x = s1; x < e1; ++x) 
+    cnt1[x->id()] = 0;
+  for (Token const* x = s2; x < e2; ++x) 
+    cnt2[x->id()] = 0;
 }
 
 // void
@@ -38,6 +38,8 @@ int with_pfas;
 int with_dcas;
 int with_sfas;
 
+size_t num_threads; // for sorting the suffix arrays
+
 bool incremental = false; // build / grow vocabs automatically
 bool is_conll    = false; // text or conll format?
 bool quiet       = false; // no progress reporting
@@ -364,7 +366,7 @@ build_mmTSA(string infile, string outfile)
   boost::shared_ptr<mmTtrack<Token> > T(new mmTtrack<Token>(infile));
   bdBitset filter;
   filter.resize(T->size(),true);
-  imTSA<Token> S(T,&filter,(quiet?NULL:&cerr));
+  imTSA<Token> S(T,&filter,(quiet?NULL:&cerr),num_threads);
   S.save_as_mm_tsa(outfile);
   exit(0);
 }
@@ -466,6 +468,9 @@ interpret_args(int ac, char* av[])
     ("unk,u", po::value<string>(&UNK)->default_value("UNK"),
      "label for unknown tokens")
 
+    ("threads,t", po::value<size_t>(&num_threads)->default_value(4),
+     "sort each array in <N> parallel threads (the output is the same)")
+
     // ("map,m", po::value<string>(&vmap), 
     // "map words to word classes for indexing")
     
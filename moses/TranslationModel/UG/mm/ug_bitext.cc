@@ -74,6 +74,25 @@ namespace Moses
       return true;
     }
 
+    void
+    pstats::
+    merge(pstats const& other)
+    {
+      boost::lock_guard<boost::mutex> guard(this->lock);
+      this->raw_cnt    += other.raw_cnt;
+      this->sample_cnt += other.sample_cnt;
+      this->good       += other.good;
+      this->sum_pairs  += other.sum_pairs;
+      for (int i = po_first; i <= po_other; i++)
+	{
+	  this->ofwd[i] += other.ofwd[i];
+	  this->obwd[i] += other.obwd[i];
+	}
+      trg_map_t::const_iterator m;
+      for (m = other.trg.begin(); m != other.trg.end(); ++m)
+	this->trg[m->first].merge(m->second);
+    }
+
     jstats::
     jstats()
       : my_rcnt(0), my_wcnt(0), my_cnt2(0)
@@ -136,6 +155,32 @@ namespace Moses
       ++ofwd[fwd_orient];
       ++obwd[bwd_orient];
     }
+
+    void 
+    jstats::
+    merge(jstats const& other)
+    {
+      boost::lock_guard<boost::mutex> lk(this->lock);
+      my_rcnt += other.my_rcnt;
+      my_wcnt += other.my_wcnt;
+      my_cnt2  = other.my_cnt2;
+      for (size_t k = 0; k < other.my_aln.size(); ++k)
+	{
+	  vector<uchar> const& a = other.my_aln[k].second;
+	  size_t i = 0;
+	  while (i < my_aln.size() && my_aln[i].second != a) ++i;
+	  if (i == my_aln.size()) 
+	    my_aln.push_back(pair<size_t,vector<uchar> >(0,a));
+	  my_aln[i].first += other.my_aln[k].first;
+	  if (my_aln[i].first > my_aln[i/2].first)
+	    push_heap(my_aln.begin(),my_aln.begin()+i+1);
+	}
+      for (int i = po_first; i <= po_other; i++)
+	{
+	  ofwd[i] += other.ofwd[i];
+	  obwd[i] += other.obwd[i];
+	}
+    }
     
     uint32_t 
     jstats::
@@ -13,8 +13,8 @@
 // - set up threads at startup time that force the 
 //   data in to memory sequentially
 //
-// - use multiple agendas for better load balancing and to avoid 
-//   competition for locks
+// - split the occurrences of very frequent phrases among more than
+//   four workers
 // 
 
 
@@ -127,6 +127,7 @@ namespace Moses {
       vector<pair<size_t, vector<uchar> > > const & aln() const;
       void add(float w, vector<uchar> const& a, uint32_t const cnt2,
 	       uint32_t fwd_orient, uint32_t bwd_orient);
+      void merge(jstats const& other); // add the counts of other
       void invalidate();
       void validate();
       bool valid();
@@ -167,6 +168,9 @@ namespace Moses {
 	  vector<uchar> const& a, 
 	  uint32_t      const cnt2,
 	  uint32_t fwd_o, uint32_t bwd_o);
+
+      // add the counts of other, which must not change meanwhile
+      void merge(pstats const& other);
     };
     
 
@@ -422,13 +426,10 @@ namespace Moses {
       typedef typename TSA<Token>::tree_iterator iter;
 
       class agenda;
-      // stores the list of unfinished jobs;
-      // maintains a pool of workers and assigns the jobs to them
-      
-      // to be done: work with multiple agendas for faster lookup
-      // (multiplex jobs); not sure if an agenda having more than 
-      // four or so workers is efficient, because workers get into 
-      // each other's way. 
+      // stores the unfinished jobs, split into parts that can be
+      // sampled independently; maintains a pool of workers, each with
+      // its own queue of parts, that take parts from each other's
+      // queues when their own is empty
       mutable sptr<agenda> ag; 
       
       sptr<Ttrack<char> >  Tx; // word alignments
@@ -577,13 +578,23 @@ namespace Moses {
       , m_pstats_cache_threshold(PSTATS_CACHE_THRESHOLD)
     { }
 
-    // agenda is a pool of jobs 
+    // agenda is a pool of jobs; each job samples the occurrences of one
+    // phrase. The occurrences of a frequent phrase are split into up to
+    // max_partitions contiguous parts of the index range, each with a
+    // share of the samples in proportion to its size, its own random
+    // number generator and its own statistics, so that several workers
+    // can sample one phrase without sharing any counters. The statistics
+    // of the parts are merged in a fixed order once the last part is done,
+    // so the result does not depend on the number of workers or on their
+    // timing.
     template<typename Token>
     class 
     Bitext<Token>::
     agenda
     {
-      boost::mutex lock; 
+      static size_t const max_partitions = 4;
+      static size_t const min_diverse = 10; // minimum number of distinct translations
+
       class job 
       {
 #if UG_BITEXT_TRACK_ACTIVE_THREADS
@@ -591,56 +602,88 @@ namespace Moses {
 #endif
 	boost::mutex lock; 
 	friend class agenda;
-	boost::taus88 rnd;  // every job has its own pseudo random generator 
-	double rnddenom;    // denominator for scaling random sampling
-	size_t min_diverse; // minimum number of distinct translations
+	size_t unfinished; // number of partitions not sampled yet
       public:
-	size_t         workers; // how many workers are working on this job?
+	// a part of the occurrences, sampled by one worker at a time
+	class partition
+	{
+	public:
+	  boost::taus88 rnd;  // seeded with the partition's index
+	  char const*  next;  // next position to read from 
+	  char const*  stop;  // end of the partition's index range
+	  size_t max_samples; // the partition's share of the samples
+	  size_t min_diverse; // and of the distinct translations
+	  size_t         ctr; // # of phrase occurrences considered so far
+	  pstats       stats; // statistics of this partition only
+	  partition(size_t const index) 
+	    : rnd(index), next(NULL), stop(NULL), max_samples(0)
+	    , min_diverse(0), ctr(0) { }
+	};
+
 	sptr<TSA<Token> const> root; // root of the underlying suffix array
-	char const*       next; // next position to read from 
-	char const*       stop; // end of index range
 	size_t     max_samples; // how many samples to extract at most
-	size_t             ctr; /* # of phrase occurrences considered so far
-				 * # of samples chosen is stored in stats->good 
-				 */
 	size_t             len; // phrase length
 	bool               fwd; // if true, source phrase is L1 
-	sptr<pstats>     stats; // stores statistics collected during sampling
+	sptr<pstats>     stats; // merged statistics, ready when all partitions are done
 	vector<float> const* bias; // sentence-level bias for sampling
+	vector<sptr<partition> > partitions;
 
-	bool step(uint64_t & sid, uint64_t & offset); // select another occurrence
-	bool done() const;
+	// select another occurrence from partition p
+	bool step(partition& p, uint64_t & sid, uint64_t & offset) const; 
+	// partition p is done; merge the statistics after the last one
+	void finish(); 
 	job(typename TSA<Token>::tree_iterator const& m, 
 	    sptr<TSA<Token> > const& r, size_t maxsmpl, bool isfwd, 
 	    vector<float> const* const bias);
 	~job();
       };
+
+      // a partition of a job
+      typedef pair<sptr<job>, size_t> task;
+
+      class queue
+      {
+      public:
+	boost::mutex lock;
+	deque<task> tasks;
+      };
+
     public:      
       class 
       worker
       {
 	agenda& ag;
+	size_t slot; // position in ag.workers; none for a thread lending a hand
+	void sample(job& j, typename job::partition& p);
       public:
-	worker(agenda& a) : ag(a) {}
+	static size_t const none = size_t(-1);
+	worker(agenda& a, size_t const s = none) : ag(a), slot(s) {}
 	void operator()();
       };
+      friend class worker;
     private:
-      list<sptr<job> > joblist;
+      boost::mutex lock; // for adding jobs and workers
+      // one queue per worker; a worker takes tasks from the front of its
+      // own queue and steals from the back of the others
+      vector<sptr<queue> > queues; 
+      size_t next_queue; // where the next task goes
       vector<sptr<boost::thread> > workers;
+      vector<bool> retired; // workers that have finished for lack of tasks
       bool shutdown;
-      size_t doomed;
+
+      bool get_task(size_t const slot, task& t);
+      bool retire(size_t const slot);
     public:
       Bitext<Token>   const& bt;
       agenda(Bitext<Token> const& bitext);
       ~agenda();
+      // start up to n more workers, at most one per queue
       void add_workers(int n);
 
       sptr<pstats> 
       add_job(typename TSA<Token>::tree_iterator const& phrase, 
 	      size_t const max_samples, 
 	      vector<float> const* const bias);
-
-      sptr<job> get_job();
     };
     
     template<typename Token>
@@ -648,59 +691,62 @@ namespace Moses {
     Bitext<Token>::
     agenda::
     job::
-    step(uint64_t & sid, uint64_t & offset)
+    step(partition& p, uint64_t & sid, uint64_t & offset) const
     {
-      boost::lock_guard<boost::mutex> jguard(lock);
-      bool ret = (max_samples == 0) && (next < stop);
-      if (ret)
+      // only one worker at a time samples a partition, so there is
+      // nothing to lock here
+      if (max_samples == 0)
 	{
-	  next = root->readSid(next,stop,sid);
-	  next = root->readOffset(next,stop,offset);
-	  boost::lock_guard<boost::mutex> sguard(stats->lock);
-	  if (stats->raw_cnt == ctr) ++stats->raw_cnt;
-	  if (bias && bias->at(sid) == 0)
-	    return false;
-	  stats->sample_cnt++;
+	  while (p.next < p.stop)
+	    {
+	      p.next = root->readSid(p.next,p.stop,sid);
+	      p.next = root->readOffset(p.next,p.stop,offset);
+	      if (p.stats.raw_cnt == p.ctr) ++p.stats.raw_cnt;
+	      ++p.ctr;
+	      if (bias && bias->at(sid) == 0)
+		continue;
+	      p.stats.sample_cnt++;
+	      return true;
+	    }
+	  return false;
 	}
-      else 
+      while (p.next < p.stop && (p.stats.good < p.max_samples || 
+				 p.stats.trg.size() < p.min_diverse))
 	{
-	  while (next < stop && (stats->good < max_samples || 
-				 stats->trg.size() < min_diverse))
+	  p.next = root->readSid(p.next,p.stop,sid);
+	  p.next = root->readOffset(p.next,p.stop,offset);
+	  if (p.stats.raw_cnt == p.ctr) ++p.stats.raw_cnt;
+	  size_t scalefac = (p.stats.raw_cnt - p.ctr++);
+	  size_t rnum = scalefac * (p.rnd()/(p.rnd.max()+1.));
+	  size_t th = (bias == NULL ? p.max_samples
+		       : bias->at(sid) * bias->size() * p.max_samples);
+	  if (rnum + p.stats.good < th)
 	    {
-	      next = root->readSid(next,stop,sid);
-	      next = root->readOffset(next,stop,offset);
-	      { // brackets required for lock scoping; see sguard immediately below
-		boost::lock_guard<boost::mutex> sguard(stats->lock); 
-		if (stats->raw_cnt == ctr) ++stats->raw_cnt;
-		size_t scalefac = (stats->raw_cnt - ctr++);
-		size_t rnum = scalefac * (rnd()/(rnd.max()+1.));
-		size_t th = (bias == NULL ? max_samples
-			     : bias->at(sid) * bias->size() * max_samples);
-#if 0
-		cerr << rnum << "/" << scalefac << " vs. " 
-		     << max_samples - stats->good << " ("
-		     << max_samples << " - " << stats->good << ")" 
-		     << " th=" << th;
-		if (bias) 
-		  cerr << " with bias " << bias->at(sid) 
-		       << " => " << bias->at(sid) * bias->size();
-		else cerr << " without bias";
-		cerr << endl;
-#endif
-		if (rnum + stats->good < th)
-		  {
-		    stats->sample_cnt++;
-		    ret = true;
-		    break;
-		  }
-	      }
+	      p.stats.sample_cnt++;
+	      return true;
 	    }
 	}
-      
-      // boost::lock_guard<boost::mutex> sguard(stats->lock); 
-      // abuse of lock for clean output to cerr
-      // cerr << stats->sample_cnt++;
-      return ret;
+      return false;
+    }
+
+    template<typename Token>
+    void
+    Bitext<Token>::
+    agenda::
+    job::
+    finish()
+    {
+      {
+	boost::lock_guard<boost::mutex> guard(this->lock);
+	if (--unfinished) return;
+      }
+      // the raw counts of the partitions are only estimates,
+      // the counts of their sampling passes are a little better
+      stats->raw_cnt = 0; 
+      for (size_t k = 0; k < partitions.size(); ++k)
+	stats->merge(partitions[k]->stats);
+      partitions.clear();
+      stats->release();
     }
 
     template<typename Token>
@@ -709,30 +755,59 @@ namespace Moses {
     agenda::
     add_workers(int n)
     {
-      static boost::posix_time::time_duration nodelay(0,0,0,0); 
       boost::lock_guard<boost::mutex> guard(this->lock);
+      for (; n > 0 && workers.size() < queues.size(); --n)
+	{
+	  sptr<boost::thread> w(new boost::thread(worker(*this,workers.size())));
+	  workers.push_back(w);
+	  retired.push_back(false);
+	}
+    }
 
-      int target  = max(1, int(n + workers.size() - this->doomed));
-      // house keeping: remove all workers that have finished
-      for (size_t i = 0; i < workers.size(); )
+    template<typename Token>
+    bool
+    Bitext<Token>::
+    agenda::
+    get_task(size_t const slot, task& t)
+    {
+      if (this->shutdown) return false;
+      size_t const home = slot == worker::none ? 0 : slot;
+      for (size_t i = 0; i < queues.size(); ++i)
 	{
-	  if (workers[i]->timed_join(nodelay))
-	    {
-	      if (i + 1 < workers.size())
-		workers[i].swap(workers.back());
-	      workers.pop_back();
+	  queue& q = *queues[(home + i) % queues.size()];
+	  boost::lock_guard<boost::mutex> guard(q.lock);
+	  if (q.tasks.empty()) continue;
+	  if (i == 0) 
+	    { 
+	      t = q.tasks.front(); 
+	      q.tasks.pop_front(); 
+	    }
+	  else // steal the task the owner of the queue would get to last
+	    { 
+	      t = q.tasks.back(); 
+	      q.tasks.pop_back(); 
 	    }
-	  else ++i;
+	  return true;
 	}
-      // cerr << workers.size() << "/" << target << " active" << endl;
-      if (int(workers.size()) > target)
-	this->doomed = workers.size() - target;
-      else 
-	while (int(workers.size()) < target)
-	  {
-	    sptr<boost::thread> w(new boost::thread(worker(*this)));
-	    workers.push_back(w);
-	  }
+      return false;
+    }
+
+    template<typename Token>
+    bool
+    Bitext<Token>::
+    agenda::
+    retire(size_t const slot)
+    {
+      // add_job adds tasks and restarts retired workers under the same
+      // lock, so a task cannot slip in between the check and retiring
+      boost::lock_guard<boost::mutex> guard(this->lock);
+      for (size_t i = 0; i < queues.size(); ++i)
+	{
+	  boost::lock_guard<boost::mutex> qguard(queues[i]->lock);
+	  if (queues[i]->tasks.size()) return false;
+	}
+      retired[slot] = true;
+      return true;
     }
 
     template<typename Token>
@@ -742,123 +817,131 @@ namespace Moses {
     worker::
     operator()()
     {
-      // things to do:
-      // - have each worker maintain their own pstats object and merge results at the end;
-      // - ensure the minimum size of samples considered by a non-locked counter that is only 
-      //   ever incremented -- who cares if we look at more samples than required, as long
-      //   as we look at at least the minimum required
-      // This way, we can reduce the number of lock / unlock operations we need to do during 
-      // sampling. 
+      task t;
+      while (true)
+	{
+	  if (!ag.get_task(slot,t))
+	    {
+	      if (slot == none || ag.shutdown || ag.retire(slot)) 
+		return;
+	      continue;
+	    }
+	  job& j = *t.first;
+	  sample(j, *j.partitions[t.second]);
+	  j.finish();
+	  t.first.reset();
+	}
+    }
+
+    template<typename Token>
+    void
+    Bitext<Token>::
+    agenda::
+    worker::
+    sample(job& j, typename job::partition& p)
+    {
       size_t s1=0, s2=0, e1=0, e2=0;
       uint64_t sid=0, offset=0; // of the source phrase
-      while(sptr<job> j = ag.get_job())
+      vector<uchar> aln;
+      bitvector full_alignment(100*100);
+      while (j.step(p,sid,offset))
 	{
-	  j->stats->register_worker();
-	  vector<uchar> aln;
-	  bitvector full_alignment(100*100);
-	  while (j->step(sid,offset))
+	  aln.clear();
+	  int po_fwd=po_other,po_bwd=po_other;
+	  if (j.fwd)
 	    {
-	      aln.clear();
-	      int po_fwd=po_other,po_bwd=po_other;
-	      if (j->fwd)
-		{
-		  if (!ag.bt.find_trg_phr_bounds
-		      (sid,offset,offset+j->len,s1,s2,e1,e2,po_fwd,po_bwd,
-		       &aln,&full_alignment,false))
-		    continue;
-		}
-	      else if (!ag.bt.find_trg_phr_bounds
-		       (sid,offset,offset+j->len,s1,s2,e1,e2,po_fwd,po_bwd,
-			&aln,NULL,true)) // NULL,NULL,true))
+	      if (!ag.bt.find_trg_phr_bounds
+		  (sid,offset,offset+j.len,s1,s2,e1,e2,po_fwd,po_bwd,
+		   &aln,&full_alignment,false))
 		continue;
-	      j->stats->lock.lock(); 
-	      j->stats->good += 1; 
-	      j->stats->sum_pairs += (s2-s1+1)*(e2-e1+1);
-	      ++j->stats->ofwd[po_fwd];
-	      ++j->stats->obwd[po_bwd];
-	      j->stats->lock.unlock();
-	      // for (size_t k = j->fwd ? 1 : 0; k < aln.size(); k += 2) 
-	      for (size_t k = 1; k < aln.size(); k += 2) 
-		aln[k] += s2 - s1;
-	      Token const* o = (j->fwd ? ag.bt.T2 : ag.bt.T1)->sntStart(sid);
-	      float sample_weight = 1./((s2-s1+1)*(e2-e1+1));
-
-	      vector<uint64_t> seen; 
-	      seen.reserve(100);
-	      // It is possible that the phrase extraction extracts the same
-	      // phrase twice, e.g., when word a co-occurs with sequence b b b
-	      // but is aligned only to the middle word. We can only count
-	      // each phrase pair once per source phrase occurrence, or else
-	      // run the risk of having more joint counts than marginal
-	      // counts.
-
-	      for (size_t s = s1; s <= s2; ++s)
+	    }
+	  else if (!ag.bt.find_trg_phr_bounds
+		   (sid,offset,offset+j.len,s1,s2,e1,e2,po_fwd,po_bwd,
+		    &aln,NULL,true)) // NULL,NULL,true))
+	    continue;
+	  p.stats.good += 1; 
+	  p.stats.sum_pairs += (s2-s1+1)*(e2-e1+1);
+	  ++p.stats.ofwd[po_fwd];
+	  ++p.stats.obwd[po_bwd];
+	  // for (size_t k = j.fwd ? 1 : 0; k < aln.size(); k += 2) 
+	  for (size_t k = 1; k < aln.size(); k += 2) 
+	    aln[k] += s2 - s1;
+	  Token const* o = (j.fwd ? ag.bt.T2 : ag.bt.T1)->sntStart(sid);
+	  float sample_weight = 1./((s2-s1+1)*(e2-e1+1));
+
+	  vector<uint64_t> seen; 
+	  seen.reserve(100);
+	  // It is possible that the phrase extraction extracts the same
+	  // phrase twice, e.g., when word a co-occurs with sequence b b b
+	  // but is aligned only to the middle word. We can only count
+	  // each phrase pair once per source phrase occurrence, or else
+	  // run the risk of having more joint counts than marginal
+	  // counts.
+
+	  for (size_t s = s1; s <= s2; ++s)
+	    {
+	      sptr<iter> b = (j.fwd ? ag.bt.I2 : ag.bt.I1)->find(o+s,e1-s);
+	      if (!b || b->size() < e1 -s)
+		UTIL_THROW(util::Exception, "target phrase not found");
+	      // assert(b);
+	      for (size_t i = e1; i <= e2; ++i)
 		{
-		  sptr<iter> b = (j->fwd ? ag.bt.I2 : ag.bt.I1)->find(o+s,e1-s);
-		  if (!b || b->size() < e1 -s)
-		    UTIL_THROW(util::Exception, "target phrase not found");
-		  // assert(b);
-		  for (size_t i = e1; i <= e2; ++i)
+		  uint64_t tpid = b->getPid();
+		  size_t s = 0;
+		  while (s < seen.size() && seen[s] != tpid) ++s;
+		  if (s < seen.size())
 		    {
-		      uint64_t tpid = b->getPid();
-		      size_t s = 0;
-		      while (s < seen.size() && seen[s] != tpid) ++s;
-		      if (s < seen.size())
-			{
 #if 0
-			  size_t sid, off, len;
-			  parse_pid(tpid,sid,off,len);
-			  cerr << "HA, gotcha! " << sid << ":" << off << " at " << HERE << endl;
-			  for (size_t z = 0; z < len; ++z)
-			    {
-			      id_type tid = ag.bt.T2->sntStart(sid)[off+z].id();
-			      cerr << (*ag.bt.V2)[tid] << " "; 
-			    }
-			  cerr << endl;
-#endif
-			  continue;
-			}
-		      seen.push_back(tpid);
-		      if (! j->stats->add(tpid,sample_weight,aln,
-					  b->approxOccurrenceCount(),
-					  po_fwd,po_bwd))
+		      size_t sid, off, len;
+		      parse_pid(tpid,sid,off,len);
+		      cerr << "HA, gotcha! " << sid << ":" << off << " at " << HERE << endl;
+		      for (size_t z = 0; z < len; ++z)
 			{
-			  cerr << "FATAL ERROR AT " << __FILE__ 
-			       << ":" << __LINE__ << endl;
-			  assert(0);
-			  ostringstream msg;
-			  for (size_t z = 0; z < j->len; ++z)
-			    {
-			      id_type tid = ag.bt.T1->sntStart(sid)[offset+z].id();
-			      cerr << (*ag.bt.V1)[tid] << " "; 
-			    }
-			  cerr << endl;
-			  for (size_t z = s; z <= i; ++z)
-			    cerr << (*ag.bt.V2)[(o+z)->id()] << " "; 
-			  cerr << endl;
-			  assert(0);
-			  UTIL_THROW(util::Exception,"Error in sampling.");
+			  id_type tid = ag.bt.T2->sntStart(sid)[off+z].id();
+			  cerr << (*ag.bt.V2)[tid] << " "; 
 			}
-		      if (i < e2)
+		      cerr << endl;
+#endif
+		      continue;
+		    }
+		  seen.push_back(tpid);
+		  if (! p.stats.add(tpid,sample_weight,aln,
+				    b->approxOccurrenceCount(),
+				    po_fwd,po_bwd))
+		    {
+		      cerr << "FATAL ERROR AT " << __FILE__ 
+			   << ":" << __LINE__ << endl;
+		      assert(0);
+		      ostringstream msg;
+		      for (size_t z = 0; z < j.len; ++z)
 			{
+			  id_type tid = ag.bt.T1->sntStart(sid)[offset+z].id();
+			  cerr << (*ag.bt.V1)[tid] << " "; 
+			}
+		      cerr << endl;
+		      for (size_t z = s; z <= i; ++z)
+			cerr << (*ag.bt.V2)[(o+z)->id()] << " "; 
+		      cerr << endl;
+		      assert(0);
+		      UTIL_THROW(util::Exception,"Error in sampling.");
+		    }
+		  if (i < e2)
+		    {
 #ifndef NDEBUG
-			  bool ok = b->extend(o[i].id());
-			  assert(ok);
+		      bool ok = b->extend(o[i].id());
+		      assert(ok);
 #else
-			  b->extend(o[i].id());
-			  // cerr << "boo" << endl;
+		      b->extend(o[i].id());
+		      // cerr << "boo" << endl;
 #endif 
-			}
 		    }
-		  // if (j->fwd && s < s2) 
-		  // for (size_t k = j->fwd ? 1 : 0; k < aln.size(); k += 2) 
-		  if (s < s2)
-		    for (size_t k = 1; k < aln.size(); k += 2) 
-		      --aln[k];
 		}
-	      // j->stats->lock.unlock();
+	      // if (j.fwd && s < s2) 
+	      // for (size_t k = j.fwd ? 1 : 0; k < aln.size(); k += 2) 
+	      if (s < s2)
+		for (size_t k = 1; k < aln.size(); k += 2) 
+		  --aln[k];
 	    }
-	  j->stats->release();
 	}
     }
 
@@ -882,21 +965,53 @@ namespace Moses {
     job(typename TSA<Token>::tree_iterator const& m, 
 	sptr<TSA<Token> > const& r, size_t maxsmpl, 
 	bool isfwd, vector<float> const* const sntbias)
-      : rnd(0)
-      , rnddenom(rnd.max() + 1.)
-      , min_diverse(10)
-      , workers(0)
+      : unfinished(0)
       , root(r)
-      , next(m.lower_bound(-1))
-      , stop(m.upper_bound(-1))
       , max_samples(maxsmpl)
-      , ctr(0)
       , len(m.size())
       , fwd(isfwd)
       , bias(sntbias)
     {
       stats.reset(new pstats());
       stats->raw_cnt = m.approxOccurrenceCount();
+
+      // Split only if there are many more occurrences than samples to
+      // take; a phrase with a single partition is sampled exactly as 
+      // if there were no partitions.
+      size_t n = 1;
+      if (max_samples)
+	n = max(size_t(1), min(size_t(max_partitions), stats->raw_cnt / max_samples));
+      char const* start = m.lower_bound(-1);
+      char const* stop  = m.upper_bound(-1);
+      partitions.reserve(n);
+      for (size_t k = 0; k < n; ++k)
+	{
+	  sptr<partition> p(new partition(k));
+	  p->next = k ? partitions.back()->stop : start;
+	  p->stop = (k + 1 == n ? stop 
+		     : max(p->next, root->splitPosition(start,stop,float(k+1)/n)));
+	  p->min_diverse = (min_diverse + n - 1) / n;
+	  partitions.push_back(p);
+	}
+      // The split positions are only approximate, so give each partition
+      // a share of the samples and of the estimated raw count in proportion
+      // to its part of the index range (which is what the estimate is
+      // based on); equal shares would sample small partitions more densely.
+      // Rounding the running totals makes the shares add up exactly.
+      double const span = stop - start;
+      size_t samples_before = 0, cnt_before = 0;
+      for (size_t k = 0; k < n; ++k)
+	{
+	  partition& p = *partitions[k];
+	  double const f = k + 1 == n ? 1 : (p.stop - start) / span;
+	  size_t const samples_upto = size_t(max_samples * f + .5);
+	  size_t const cnt_upto = size_t(stats->raw_cnt * f + .5);
+	  p.max_samples = samples_upto - samples_before;
+	  p.stats.raw_cnt = cnt_upto - cnt_before;
+	  samples_before = samples_upto;
+	  cnt_before = cnt_upto;
+	}
+      unfinished = n;
 #if UG_BITEXT_TRACK_ACTIVE_THREADS
       // if (++active%5 == 0) 
       ++active;
@@ -911,72 +1026,32 @@ namespace Moses {
     add_job(typename TSA<Token>::tree_iterator const& phrase, 
 	    size_t const max_samples, vector<float> const* const bias)
     {
-      boost::unique_lock<boost::mutex> lk(this->lock);
-      static boost::posix_time::time_duration nodelay(0,0,0,0); 
+      // the job and its partitions are set up before taking the lock
       bool fwd = phrase.root == bt.I1.get();
       sptr<job> j(new job(phrase, fwd ? bt.I1 : bt.I2, max_samples, fwd, bias));
-      j->stats->register_worker();
-      
-      joblist.push_back(j);
-      if (joblist.size() == 1)
-	{
-	  size_t i = 0;
-	  while (i < workers.size())
-	    {
-	      if (workers[i]->timed_join(nodelay))
-		{
-		  if (doomed)
-		    {
-		      if (i+1 < workers.size())
-			workers[i].swap(workers.back());
-		      workers.pop_back();
-		      --doomed;
-		    }
-		  else
-		    workers[i++] = sptr<boost::thread>(new boost::thread(worker(*this)));
-		}
-	      else ++i;
-	    }
-	}
-      return j->stats;
-    }
-    
-    template<typename Token>
-    sptr<typename Bitext<Token>::agenda::job>
-    Bitext<Token>::
-    agenda::
-    get_job()
-    {
-      // cerr << workers.size() << " workers on record" << endl;
-      sptr<job> ret;
-      if (this->shutdown) return ret;
-      boost::unique_lock<boost::mutex> lock(this->lock);
-      if (this->doomed) 
-	{
-	  --this->doomed;
-	  return ret;
-	}
-      typename list<sptr<job> >::iterator j = joblist.begin();
-      while (j != joblist.end())
+      j->stats->register_worker(); // released when the last partition is done
+
+      boost::unique_lock<boost::mutex> lk(this->lock);
+
+      // spread the partitions over the queues, so that idle workers
+      // pick them up right away
+      for (size_t k = 0; k < j->partitions.size(); ++k)
 	{
-	  if ((*j)->done()) 
-	    {
-	      (*j)->stats->release();
-	      joblist.erase(j++);
-	    } 
-	  else if ((*j)->workers >= 4) 
-	    {
-	      ++j;
-	    }
-	  else break;
+	  queue& q = *queues[next_queue];
+	  next_queue = (next_queue + 1) % queues.size();
+	  boost::lock_guard<boost::mutex> qguard(q.lock);
+	  q.tasks.push_back(task(j,k));
 	}
-      if (joblist.size())
+
+      // restart the workers that ran out of tasks
+      for (size_t i = 0; i < workers.size(); ++i)
 	{
-	  ret = j == joblist.end() ? joblist.front() : *j;
-	  boost::lock_guard<boost::mutex> jguard(ret->lock);
-	  ++ret->workers;
+	  if (!retired[i]) continue;
+	  workers[i]->join();
+	  workers[i].reset(new boost::thread(worker(*this,i)));
+	  retired[i] = false;
 	}
-      return ret;
+      return j->stats;
     }
 
    
@@ -1549,7 +1624,7 @@ namespace Moses {
     lookup(iter const& phrase, size_t const max_sample,
 	   vector<float> const* const bias) const
     {
-      sptr<pstats> ret = prep2(phrase, max_sample);
+      sptr<pstats> ret = prep2(phrase, max_sample, bias);
       boost::lock_guard<boost::mutex> guard(this->lock);
       if (this->num_workers <= 1)
 	typename agenda::worker(*this->ag)();
@@ -1578,17 +1653,11 @@ namespace Moses {
     Bitext<Token>::
     agenda::
     agenda(Bitext<Token> const& thebitext)
-      : shutdown(false), doomed(0), bt(thebitext)
-    { }
-    
-    template<typename Token>
-    bool
-    Bitext<Token>::
-    agenda::
-    job::
-    done() const
+      : next_queue(0), shutdown(false), bt(thebitext)
     { 
-      return (max_samples && stats->good >= max_samples) || next == stop; 
+      queues.resize(max(size_t(1), bt.num_workers));
+      for (size_t i = 0; i < queues.size(); ++i)
+	queues[i].reset(new queue);
     }
 
 #if UG_BITEXT_TRACK_ACTIVE_THREADS
@@ -3,12 +3,10 @@
 #ifndef _ug_im_tsa_h
 #define _ug_im_tsa_h
 
-// TO DO:
-// - multi-threaded sorting during TSA construction (currently painfully slow!)
-
 #include <iostream>
 
 #include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/thread.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/dynamic_bitset.hpp>
 #include <boost/foreach.hpp>
@@ -49,12 +47,16 @@ namespace ugdiss
 
     char const* 
     getUpperBound(id_type id) const;
+
+    class section_sorter;
     
   public:
     imTSA();
+    // num_threads: how many sections of the array to sort in parallel
     imTSA(boost::shared_ptr<Ttrack<TOKEN> const> c, 
 	  bdBitset const* filt, 
-	  ostream* log = NULL);
+	  ostream* log = NULL,
+	  size_t const num_threads = 1);
 
     imTSA(imTSA<TOKEN> const& prior, 
 	  boost::shared_ptr<imTtrack<TOKEN> const> const&   crp,
@@ -108,6 +110,44 @@ namespace ugdiss
   tree_iterator(imTSA<TOKEN> const* s)
     : TSA<TOKEN>::tree_iterator::tree_iterator(reinterpret_cast<TSA<TOKEN> const*>(s))
   {};
+
+  // Sorts the sections of the array (all entries starting with the same
+  // token id) on the to-do list; several threads can share one 
+  // section_sorter, each taking the next section from the list.
+  template<typename TOKEN>
+  class
+  imTSA<TOKEN>::
+  section_sorter
+  {
+    imTSA<TOKEN>& tsa;
+    vector<pair<count_type,id_type> > const& todo; // (size, id) of each section 
+    ostream* log;
+    boost::mutex lock;
+    size_t next; // next section on the to-do list
+  public:
+    section_sorter(imTSA<TOKEN>& t, 
+		   vector<pair<count_type,id_type> > const& sections, 
+		   ostream* l)
+      : tsa(t), todo(sections), log(l), next(0) {}
+
+    void operator()()
+    {
+      typename ttrack::Position::LESS<Ttrack<TOKEN> > sorter(tsa.corpus.get());
+      while (true)
+	{
+	  id_type i;
+	  { // brackets needed for lock scoping
+	    boost::lock_guard<boost::mutex> guard(lock);
+	    if (next == todo.size()) return;
+	    i = todo[next++].second;
+	    if (log && todo[next-1].first > 5000)
+	      *log << "sorting " << todo[next-1].first 
+		   << " entries starting with id " << i << "." << endl;
+	  }
+	  sort(tsa.sufa.begin()+tsa.index[i],tsa.sufa.begin()+tsa.index[i+1],sorter);
+	}
+    }
+  };
   
   /** jump to the point 1/ratio in a tightly packed index
    *  assumes that keys are flagged with '1', values with '0'
@@ -140,7 +180,8 @@ namespace ugdiss
   // specified in filter
   template<typename TOKEN>
   imTSA<TOKEN>::
-  imTSA(boost::shared_ptr<Ttrack<TOKEN> const> c, bdBitset const* filter, ostream* log)
+  imTSA(boost::shared_ptr<Ttrack<TOKEN> const> c, bdBitset const* filter, 
+	ostream* log, size_t const num_threads)
   {
     assert(c);
     this->corpus = c;
@@ -197,19 +238,29 @@ namespace ugdiss
 	  }
       }
 
-    // Now sort the array
+    // Now sort the array. Each section is still sorted by a single call
+    // to sort(), so the result does not depend on the number of threads.
+    // The largest sections go first, so that no thread is left sorting
+    // a large section when all others are done.
     if (log) *log << "sorting ...." << endl;
     index.resize(wcnt.size()+1,0);
-    typename ttrack::Position::LESS<Ttrack<TOKEN> > sorter(c.get());
+    vector<pair<count_type,id_type> > todo;
     for (size_t i = 0; i < wcnt.size(); i++)
       {
-        if (log && wcnt[i] > 5000)
-          *log << "sorting " << wcnt[i] 
-               << " entries starting with id " << i << "." << endl;
         index[i+1] = index[i]+wcnt[i];
         assert(index[i+1]==tmp[i]); // sanity check
         if (wcnt[i]>1)
-          sort(sufa.begin()+index[i],sufa.begin()+index[i+1],sorter);
+	  todo.push_back(pair<count_type,id_type>(wcnt[i],i));
+      }
+    sort(todo.begin(),todo.end(),greater<pair<count_type,id_type> >());
+    section_sorter worker(*this,todo,log);
+    if (num_threads <= 1) worker();
+    else
+      {
+	boost::thread_group workers;
+	for (size_t t = 0; t < min(num_threads,todo.size()); ++t)
+	  workers.create_thread(boost::ref(worker));
+	workers.join_all();
       }
     this->startArray = reinterpret_cast<char const*>(&(*sufa.begin()));
     this->endArray   = reinterpret_cast<char const*>(&(*sufa.end()));
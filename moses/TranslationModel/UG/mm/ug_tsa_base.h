@@ -218,6 +218,15 @@ namespace ugdiss
     char const* 
     readOffset(char const* p, char const* q, uint64_t& offset) const = 0;
 
+    /** @return the start of the index entry approximately /fraction/
+     *  between /startRange/ and /endRange/, e.g. for splitting a range
+     *  into parts that can be read independently
+     */
+    char const*
+    splitPosition(char const* startRange, char const* endRange,
+                  float fraction) const
+    { return fraction > 0 ? index_jump(startRange,endRange,fraction) : startRange; }
+
     /** @return sentence count 
      */
     count_type
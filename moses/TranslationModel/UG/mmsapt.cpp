@@ -4,6 +4,8 @@
 #include <boost/tokenizer.hpp>
 #include <algorithm>
 #include "moses/TranslationModel/UG/mm/ug_phrasepair.h"
+#include "moses/Profiler.h"
+#include "moses/StaticData.h"
 #include "util/exception.hh"
 #include <set>
 
@@ -67,7 +69,6 @@ namespace Moses
   Mmsapt(string const& line)
     : PhraseDictionary(line)
     , ofactor(1,0)
-    , m_tpc_ctr(0)
   {
     this->init(line);
   }
@@ -171,7 +172,8 @@ namespace Moses
 
     dflt = pair<string,string>("cache","10000");
     size_t hsize = max(1000,atoi(param.insert(dflt).first->second.c_str()));
-    m_history.reserve(hsize);
+    for (size_t i = 0; i < num_cache_shards; ++i)
+      m_cache[i].history.reserve((hsize + num_cache_shards - 1) / num_cache_shards);
     // in plain language: cache size is at least 1000, and 10,000 by default
     // this cache keeps track of the most frequently used target phrase collections
     // even when not actively in use
@@ -533,19 +535,25 @@ namespace Moses
     // cache lookup:
     uint64_t phrasekey = (mfix.size() == sphrase.size() ? (mfix.getPid()<<1) 
 			  : (mdyn.getPid()<<1)+1);
-    size_t revision = dyn->revision();
+    // The dynamic bitext only grows, so the phrase's statistics can only
+    // have changed if the sentences added since the entry was stored
+    // contain the phrase, i.e., if it occurs more often now. Entries of
+    // phrases that the new sentences do not touch stay valid.
+    // (Dynamic counts of the target phrases alone, which some features
+    // use, are not checked; they are updated with the next change of the
+    // source phrase or when the entry leaves the cache.)
+    size_t revision = mdyn.size() == sphrase.size() ? mdyn.rawCnt() : 0;
+    tpc_cache_shard& shard = cache_shard(phrasekey);
+    // The cache is shared by all inputs, so phrases scored with weights
+    // that were overridden for this input neither come from it nor go in.
+    bool cacheable = !StaticData::Instance().GetThreadWeights();
+    if (cacheable)
     {
-      boost::lock_guard<boost::mutex> guard(this->lock);
-      tpc_cache_t::iterator c = m_cache.find(phrasekey);
-      // TO DO: we should revise the revision mechanism: we take the length
-      // of the dynamic bitext (in sentences) at the time the PT entry
-      // was stored as the time stamp. For each word in the
-      // vocabulary, we also store its most recent occurrence in the
-      // bitext. Only if the timestamp of each word in the phrase is
-      // newer than the timestamp of the phrase itself we must update 
-      // the entry. 
-      if (c != m_cache.end() && c->second->revision == revision)
-	return encache(c->second);
+      boost::lock_guard<boost::mutex> guard(shard.lock);
+      tpc_cache_t::iterator c = shard.cache.find(phrasekey);
+      bool hit = c != shard.cache.end() && c->second->revision == revision;
+      Profiler::CountCache(*this, hit);
+      if (hit) return encache(shard, c->second);
     }
     
     // OK: pt entry not found or not up to date
@@ -610,9 +618,15 @@ namespace Moses
 #endif
 
     // put the result in the cache and return
-    boost::lock_guard<boost::mutex> guard(this->lock);
-    m_cache[phrasekey] = ret;
-    return encache(ret);
+    boost::lock_guard<boost::mutex> guard(shard.lock);
+    if (!cacheable)
+      { // Release() deletes it, as it is neither in the cache nor in history
+	++ret->refCount;
+	++shard.tpc_ctr;
+	return ret;
+      }
+    shard.cache[phrasekey] = ret;
+    return encache(shard, ret);
   }
 
   size_t 
@@ -701,9 +715,18 @@ namespace Moses
       }
   }
 
+  Mmsapt::
+  tpc_cache_shard&
+  Mmsapt::
+  cache_shard(uint64_t const key) const
+  {
+    // phrase keys are (sid<<32) + (offset<<16) + length, shifted left by one
+    return m_cache[(key ^ (key >> 17) ^ (key >> 33)) % num_cache_shards];
+  }
+
   void
   Mmsapt::
-  decache(TargetPhraseCollectionWrapper* ptr) const
+  decache(tpc_cache_shard& shard, TargetPhraseCollectionWrapper* ptr) const
   {
     if (ptr->refCount || ptr->idx >= 0) return;
     // if (t.tv_nsec < v[0]->tstamp.tv_nsec)
@@ -716,33 +739,32 @@ namespace Moses
 	 << " clock resolution is " << r.tv_sec << ":" << r.tv_nsec 
 	 << " at " << __FILE__ << ":" << __LINE__ << endl;
 #endif
-    tpc_cache_t::iterator m = m_cache.find(ptr->key);
-    if (m != m_cache.end())
+    tpc_cache_t::iterator m = shard.cache.find(ptr->key);
+    if (m != shard.cache.end())
       if (m->second == ptr)
-	m_cache.erase(m);
+	shard.cache.erase(m);
     delete ptr;
-    --m_tpc_ctr;
   }
   
 
   Mmsapt::
   TargetPhraseCollectionWrapper*
   Mmsapt::
-  encache(TargetPhraseCollectionWrapper* ptr) const
+  encache(tpc_cache_shard& shard, TargetPhraseCollectionWrapper* ptr) const
   {
-    // Calling process must lock for thread safety!!
+    // Calling process must lock the shard for thread safety!!
     if (!ptr) return NULL;
     ++ptr->refCount;
-    ++m_tpc_ctr;
+    ++shard.tpc_ctr;
 #if defined(timespec)
     clock_gettime(CLOCK_MONOTONIC, &ptr->tstamp);
 #else
     gettimeofday(&ptr->tstamp, NULL);
 #endif
     // update history
-    if (m_history.capacity() > 1)
+    if (shard.history.capacity() > 1)
       {
-	vector<TargetPhraseCollectionWrapper*>& v = m_history;
+	vector<TargetPhraseCollectionWrapper*>& v = shard.history;
 	if (ptr->idx >= 0) // ptr is already in history
 	  { 
 	    assert(ptr == v[ptr->idx]);
@@ -759,7 +781,7 @@ namespace Moses
 	else 
 	  {
 	    v[0]->idx = -1;
-	    decache(v[0]);
+	    decache(shard, v[0]);
 	    v[0] = ptr;
 	    bubble_down(v,0);
 	  }
@@ -812,17 +834,19 @@ namespace Moses
   Release(TargetPhraseCollection const* tpc) const
   {
     if (!tpc) return;
-    boost::lock_guard<boost::mutex> guard(this->lock);
     TargetPhraseCollectionWrapper* ptr 
       = (reinterpret_cast<TargetPhraseCollectionWrapper*>
 	 (const_cast<TargetPhraseCollection*>(tpc)));
+    tpc_cache_shard& shard = cache_shard(ptr->key);
+    boost::lock_guard<boost::mutex> guard(shard.lock);
+    --shard.tpc_ctr;
     if (--ptr->refCount == 0 && ptr->idx < 0)
-      decache(ptr);
+      decache(shard, ptr);
 #if 0
     cerr << ptr->refCount << " references at " 
 	 << __FILE__ << ":" << __LINE__ 
-	 << "; " << m_tpc_ctr << " TPC references still in circulation; "
-	 << m_history.size() << " instances in history."
+	 << "; " << shard.tpc_ctr << " TPC references of the shard still in circulation; "
+	 << shard.history.size() << " instances in history."
 	 << endl;
 #endif
   }
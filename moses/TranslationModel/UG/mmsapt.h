@@ -132,7 +132,7 @@ namespace Moses
       : public TargetPhraseCollection
     {
     public:
-      size_t   const revision; // time stamp from dynamic bitext
+      size_t   const revision; // occurrences of the phrase in the dynamic bitext
       uint64_t const      key; // phrase key
       uint32_t       refCount; // reference count
 #if defined(timespec)
@@ -149,15 +149,33 @@ namespace Moses
 
     void read_config_file(string fname, map<string,string>& param);
 
+    typedef map<uint64_t, TargetPhraseCollectionWrapper*> tpc_cache_t;
+
+    // The cache of target phrase collections is split into shards with
+    // their own locks, so that threads looking up different phrases do
+    // not wait for each other. Each shard keeps a bounded history of the
+    // most recently used collections, even when they are not in use.
+    struct tpc_cache_shard
+    {
+      boost::mutex lock;
+      tpc_cache_t cache;
+      vector<TargetPhraseCollectionWrapper*> history;
+      size_t tpc_ctr; // references to collections of this shard in circulation
+      tpc_cache_shard() : tpc_ctr(0) { }
+    };
+    static size_t const num_cache_shards = 16;
+    mutable tpc_cache_shard m_cache[num_cache_shards];
+
+    tpc_cache_shard& 
+    cache_shard(uint64_t const key) const;
+
+    // Calling process must lock the shard for all of these:
     TargetPhraseCollectionWrapper*
-    encache(TargetPhraseCollectionWrapper* const ptr) const;
+    encache(tpc_cache_shard& shard, TargetPhraseCollectionWrapper* const ptr) const;
 
     void
-    decache(TargetPhraseCollectionWrapper* ptr) const;
+    decache(tpc_cache_shard& shard, TargetPhraseCollectionWrapper* ptr) const;
 
-    typedef map<uint64_t, TargetPhraseCollectionWrapper*> tpc_cache_t;
-    mutable tpc_cache_t m_cache;
-    mutable vector<TargetPhraseCollectionWrapper*> m_history;
     // phrase table feature weights for alignment:
     vector<float> feature_weights; 
 
@@ -221,7 +239,6 @@ namespace Moses
     void
     load_extra_data(string bname, bool locking);
 
-    mutable size_t m_tpc_ctr;
   public:
     // Mmsapt(string const& description, string const& line);
     Mmsapt(string const& line);
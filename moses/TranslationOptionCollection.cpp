@@ -35,6 +35,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "DecodeStepGeneration.h"
 #include "DecodeGraph.h"
 #include "InputPath.h"
+#include "Profiler.h"
 #include "moses/FF/UnknownWordPenaltyProducer.h"
 #include "moses/FF/LexicalReordering/LexicalReordering.h"
 #include "moses/FF/InputFeature.h"
@@ -56,23 +57,24 @@ bool CompareTranslationOption(const TranslationOption *a, const TranslationOptio
 */
 TranslationOptionCollection::TranslationOptionCollection(
   InputType const& src, size_t maxNoTransOptPerCoverage, float translationOptionThreshold)
-  : m_source(src)
-  ,m_futureScore(src.GetSize())
+  : m_context(DecodingContext::Local())
+  ,m_source(src)
+  ,m_futureScore(src.GetSize(), m_context.GetFutureScoreBuffer())
   ,m_maxNoTransOptPerCoverage(maxNoTransOptPerCoverage)
   ,m_translationOptionThreshold(translationOptionThreshold)
 {
-  // create 2-d vector
+  // create 2-d vector, from the empty lists of the previous sentence
+  m_context.TakeOptionMatrix(m_collection);
   size_t size = src.GetSize();
+  if (m_collection.size() < size) {
+    m_collection.resize(size);
+  }
   for (size_t startPos = 0 ; startPos < size ; ++startPos) {
-    m_collection.push_back( vector< TranslationOptionList >() );
-
     size_t maxSize = size - startPos;
     size_t maxSizePhrase = StaticData::Instance().GetMaxPhraseLength();
     maxSize = std::min(maxSize, maxSizePhrase);
 
-    for (size_t endPos = 0 ; endPos < maxSize ; ++endPos) {
-      m_collection[startPos].push_back( TranslationOptionList() );
-    }
+    m_collection[startPos].resize(maxSize);
   }
 }
 
@@ -80,6 +82,8 @@ TranslationOptionCollection::TranslationOptionCollection(
 TranslationOptionCollection::~TranslationOptionCollection()
 {
   RemoveAllInColl(m_inputPathQueue);
+  m_futureScore.ReleaseBuffer(m_context.GetFutureScoreBuffer());
+  m_context.ReturnOptionMatrix(m_collection);
 }
 
 void TranslationOptionCollection::Prune()
@@ -672,16 +676,27 @@ void TranslationOptionCollection::CacheLexReordering()
 
         for (size_t endPos = startPos ; endPos < startPos + maxSize; endPos++) {
           TranslationOptionList &transOptList = GetTranslationOptionList( startPos, endPos);
+          // look up all targets of a source phrase together so the table finds the source once
+          std::map<const InputPath*, std::vector<TranslationOption*> > bySource;
           TranslationOptionList::iterator iterTransOpt;
           for(iterTransOpt = transOptList.begin() ; iterTransOpt != transOptList.end() ; ++iterTransOpt) {
-            TranslationOption &transOpt = **iterTransOpt;
-            //Phrase sourcePhrase =  m_source.GetSubString(WordsRange(startPos,endPos));
-            const Phrase &sourcePhrase = transOpt.GetInputPath().GetPhrase();
-            Scores score = lexreordering.GetProb(sourcePhrase
-                                                 , transOpt.GetTargetPhrase());
-            if (!score.empty())
-              transOpt.CacheLexReorderingScores(lexreordering, score);
-          } // for(iterTransOpt
+            bySource[&(*iterTransOpt)->GetInputPath()].push_back(*iterTransOpt);
+          }
+          std::vector<const Phrase*> targets;
+          std::vector<Scores> scores;
+          std::map<const InputPath*, std::vector<TranslationOption*> >::const_iterator iterSource;
+          for (iterSource = bySource.begin(); iterSource != bySource.end(); ++iterSource) {
+            const std::vector<TranslationOption*> &transOpts = iterSource->second;
+            targets.clear();
+            for (size_t i = 0; i < transOpts.size(); ++i) {
+              targets.push_back(&transOpts[i]->GetTargetPhrase());
+            }
+            lexreordering.GetProbs(iterSource->first->GetPhrase(), targets, scores);
+            for (size_t i = 0; i < transOpts.size(); ++i) {
+              if (!scores[i].empty())
+                transOpts[i]->CacheLexReorderingScores(lexreordering, scores[i]);
+            }
+          } // for (iterSource
         } // for (size_t endPos = startPos ; endPos < startPos + maxSize; endPos++) {
       } // for (size_t startPos = 0 ; startPos < size ; startPos++) {
     } // if (typeid(ff) == typeid(LexicalReordering)) {
@@ -723,6 +738,7 @@ void TranslationOptionCollection::GetTargetPhraseCollectionBatch()
       const DecodeStepTranslation *transStep = dynamic_cast<const DecodeStepTranslation *>(&decodeStep);
       if (transStep) {
         const PhraseDictionary &phraseDictionary = *transStep->GetPhraseDictionaryFeature();
+        Profiler::Scope profile(phraseDictionary, Profiler::Lookup, m_inputPathQueue.size());
         phraseDictionary.GetTargetPhraseCollectionBatch(m_inputPathQueue);
       }
     }
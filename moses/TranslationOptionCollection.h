@@ -25,6 +25,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <list>
 #include <boost/unordered_map.hpp>
 #include "TypeDef.h"
+#include "DecodingContext.h"
 #include "TranslationOption.h"
 #include "TranslationOptionList.h"
 #include "SquareMatrix.h"
@@ -64,7 +65,8 @@ class TranslationOptionCollection
   friend std::ostream& operator<<(std::ostream& out, const TranslationOptionCollection& coll);
   TranslationOptionCollection(const TranslationOptionCollection&); /*< no copy constructor */
 protected:
-  std::vector< std::vector< TranslationOptionList > >	m_collection; /*< contains translation options */
+  DecodingContext &m_context; /*< memory kept between sentences by the thread that creates the collection */
+  std::vector< std::vector< TranslationOptionList > >	m_collection; /*< contains translation options. May have unused rows after the last word, left from a longer sentence */
   InputType const			&m_source; /*< reference to the input */
   SquareMatrix				m_futureScore; /*< matrix of future costs for contiguous parts (span) of the input */
   const size_t				m_maxNoTransOptPerCoverage; /*< maximum number of translation options per input span */
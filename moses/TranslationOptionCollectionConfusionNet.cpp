@@ -11,7 +11,6 @@
 #include "FF/InputFeature.h"
 #include "TranslationModel/PhraseDictionaryTreeAdaptor.h"
 #include "util/exception.hh"
-#include <boost/foreach.hpp>
 
 using namespace std;
 
@@ -29,10 +28,10 @@ TranslationOptionCollectionConfusionNet(const ConfusionNet &input,
   // Prefix checkers are phrase dictionaries that provide a prefix check
   // to indicate that a phrase table entry with a given prefix exists.
   // If no entry with the given prefix exists, there is no point in
-  // expanding it further.
-  vector<PhraseDictionary*> prefixCheckers;
-  BOOST_FOREACH(PhraseDictionary* pd, PhraseDictionary::GetColl())
-    if (pd->ProvidesPrefixCheck()) prefixCheckers.push_back(pd);
+  // expanding it further. Paths are only extended from the paths that
+  // passed the check, so a pruned prefix is never expanded again.
+  vector<PhraseDictionary const*> prefixCheckers
+    = PhraseDictionary::GetPrefixCheckers();
   
   const InputFeature &inputFeature = InputFeature::Instance();
   UTIL_THROW_IF2(&inputFeature == NULL, "Input feature must be specified");
@@ -95,13 +94,15 @@ TranslationOptionCollectionConfusionNet(const ConfusionNet &input,
         UTIL_THROW_IF2(prevInputScore == NULL,
         		"No input score for path: " << prevPath);
 
-        // loop thru every word at this position
+        // loop thru every word at this position. The phrase of the previous
+        // path is copied once, only the last word changes per alternative
         const ConfusionNet::Column &col = input.GetColumn(endPos);
+        Phrase subphrase(prevPhrase);
+        subphrase.AddWord();
 
         for (size_t i = 0; i < col.size(); ++i) {
           const Word &word = col[i].first;
-          Phrase subphrase(prevPhrase);
-          subphrase.AddWord(word);
+          subphrase.GetWord(phraseSize - 1) = word;
 
 	  bool OK = prefixCheckers.size() == 0;
 	  for (size_t k = 0; !OK && k < prefixCheckers.size(); ++k)
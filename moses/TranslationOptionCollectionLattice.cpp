@@ -22,6 +22,7 @@ TranslationOptionCollectionLattice::TranslationOptionCollectionLattice(
   const WordLattice &input
   , size_t maxNoTransOptPerCoverage, float translationOptionThreshold)
   : TranslationOptionCollection(input, maxNoTransOptPerCoverage, translationOptionThreshold)
+  , m_prefixCheckers(PhraseDictionary::GetPrefixCheckers())
 {
   UTIL_THROW_IF2(StaticData::Instance().GetUseLegacyPT(),
 		  "Not for models using the legqacy binary phrase table");
@@ -87,6 +88,10 @@ void TranslationOptionCollectionLattice::Extend(const InputPath &prevPath, const
 
 	const std::vector<size_t> &nextNodes = input.GetNextNodes(nextPos);
 
+    // the phrase of the previous path is copied once, only the last word changes per edge
+    Phrase subphrase(prevPhrase);
+    subphrase.AddWord();
+
     const ConfusionNet::Column &col = input.GetColumn(nextPos);
     for (size_t i = 0; i < col.size(); ++i) {
       const Word &word = col[i].first;
@@ -102,10 +107,19 @@ void TranslationOptionCollectionLattice::Extend(const InputPath &prevPath, const
     	  continue;
       }
 
-      const NonTerminalSet &labels = input.GetLabelSet(startPos, endPos);
+      subphrase.GetWord(subphrase.GetSize() - 1) = word;
 
-      Phrase subphrase(prevPhrase);
-      subphrase.AddWord(word);
+      // no table has an entry starting with the phrase, so neither the path
+      // nor any of its extensions are created
+      bool prefixExists = m_prefixCheckers.empty();
+      for (size_t k = 0; !prefixExists && k < m_prefixCheckers.size(); ++k) {
+        prefixExists = m_prefixCheckers[k]->PrefixExists(subphrase);
+      }
+      if (!prefixExists) {
+        continue;
+      }
+
+      const NonTerminalSet &labels = input.GetLabelSet(startPos, endPos);
 
       const ScorePair &scores = col[i].second;
       ScorePair *inputScore = new ScorePair(*prevInputScore);
@@ -1,6 +1,7 @@
 // $Id$
 #pragma once
 
+#include <vector>
 #include "TranslationOptionCollection.h"
 #include "InputPath.h"
 
@@ -8,6 +9,7 @@ namespace Moses
 {
 
 class WordLattice;
+class PhraseDictionary;
 
 /** Holds all translation options, for all spans, of a lattice input. NOT confusion networks
  * No legacy phrase-tables, CANNOT be used with Zen's binary phrase-table.
@@ -33,6 +35,9 @@ public:
       , size_t graphInd); // do not implement
 
 protected:
+  // dictionaries that tell whether a path is worth extending, see PhraseDictionary::GetPrefixCheckers()
+  std::vector<const PhraseDictionary*> m_prefixCheckers;
+
   void Extend(const InputPath &prevPath, const WordLattice &input);
 
 };
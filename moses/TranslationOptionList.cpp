@@ -23,6 +23,11 @@ TranslationOptionList::~TranslationOptionList()
   RemoveAllInColl(m_coll);
 }
 
+void TranslationOptionList::RemoveAll()
+{
+  RemoveAllInColl(m_coll);
+}
+
 TO_STRING_BODY(TranslationOptionList);
 
 std::ostream& operator<<(std::ostream& out, const TranslationOptionList& coll)
@@ -60,6 +60,8 @@ public:
   void Add(TranslationOption *transOpt) {
     m_coll.push_back(transOpt);
   }
+  //! delete all options, keeping the memory of the list
+  void RemoveAll();
 
   TO_STRING();
 
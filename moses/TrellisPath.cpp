@@ -30,6 +30,8 @@ namespace Moses
 {
 TrellisPath::TrellisPath(const Hypothesis *hypo)
   :	m_prevEdgeChanged(NOT_FOUND)
+  , m_prevPath(NULL)
+  , m_arc(NULL)
 {
   m_scoreBreakdown					= hypo->GetScoreBreakdown();
   m_totalScore = hypo->GetTotalScore();
@@ -63,6 +65,8 @@ void TrellisPath::InitScore()
 
 TrellisPath::TrellisPath(const TrellisPath &copy, size_t edgeIndex, const Hypothesis *arc)
   :m_prevEdgeChanged(edgeIndex)
+  ,m_prevPath(NULL)
+  ,m_arc(NULL)
 {
   m_path.reserve(copy.m_path.size());
   for (size_t currEdge = 0 ; currEdge < edgeIndex ; currEdge++) {
@@ -83,8 +87,51 @@ TrellisPath::TrellisPath(const TrellisPath &copy, size_t edgeIndex, const Hypoth
   InitScore();
 }
 
+TrellisPath::TrellisPath(const TrellisPath *prevPath, size_t edgeIndex, const Hypothesis *arc)
+  :m_prevEdgeChanged(edgeIndex)
+  ,m_totalScore(prevPath->m_totalScore - arc->GetWinningHypo()->GetTotalScore() + arc->GetTotalScore())
+  ,m_prevPath(prevPath)
+  ,m_arc(arc)
+{
+  // edges after the last deviation of prevPath follow the best path back, so
+  // all hypos from edgeIndex onwards are winning hypos and only the arc
+  // changes the score
+}
+
+void TrellisPath::Expand()
+{
+  if (m_prevPath == NULL)
+    return;
+
+  m_path.reserve(m_prevPath->m_path.size());
+  for (size_t currEdge = 0 ; currEdge < m_prevEdgeChanged ; currEdge++) {
+    // copy path from parent
+    m_path.push_back(m_prevPath->m_path[currEdge]);
+  }
+
+  // 1 deviation
+  m_path.push_back(m_arc);
+
+  // rest of path comes from following best path backwards
+  const Hypothesis *prevHypo = m_arc->GetPrevHypo();
+  while (prevHypo != NULL) {
+    m_path.push_back(prevHypo);
+    prevHypo = prevHypo->GetPrevHypo();
+  }
+
+  // same operations, in the same order, as InitScore()
+  m_scoreBreakdown = m_prevPath->m_scoreBreakdown;
+  m_scoreBreakdown.MinusEquals(m_arc->GetWinningHypo()->GetScoreBreakdown());
+  m_scoreBreakdown.PlusEquals(m_arc->GetScoreBreakdown());
+
+  m_prevPath = NULL;
+  m_arc = NULL;
+}
+
 TrellisPath::TrellisPath(const vector<const Hypothesis*> edges)
   :m_prevEdgeChanged(NOT_FOUND)
+  ,m_prevPath(NULL)
+  ,m_arc(NULL)
 {
   m_path.resize(edges.size());
   copy(edges.rbegin(),edges.rend(),m_path.begin());
@@ -96,6 +143,9 @@ TrellisPath::TrellisPath(const vector<const Hypothesis*> edges)
 
 void TrellisPath::CreateDeviantPaths(TrellisPathCollection &pathColl) const
 {
+  // deviations are only expanded once they are popped from the collection,
+  // so this path must outlive them
+
   const size_t sizePath = m_path.size();
 
   if (m_prevEdgeChanged == NOT_FOUND) {
@@ -110,7 +160,7 @@ void TrellisPath::CreateDeviantPaths(TrellisPathCollection &pathColl) const
       ArcList::const_iterator iterArc;
       for (iterArc = arcList.begin() ; iterArc != arcList.end() ; ++iterArc) {
         const Hypothesis *arc = *iterArc;
-        TrellisPath *deviantPath = new TrellisPath(*this, currEdge, arc);
+        TrellisPath *deviantPath = new TrellisPath(this, currEdge, arc);
         pathColl.Add(deviantPath);
       }
     }
@@ -126,7 +176,7 @@ void TrellisPath::CreateDeviantPaths(TrellisPathCollection &pathColl) const
         // copy this Path & change 1 edge
         const Hypothesis *arcReplace = *iterArc;
 
-        TrellisPath *deviantPath = new TrellisPath(*this, currEdge, arcReplace);
+        TrellisPath *deviantPath = new TrellisPath(this, currEdge, arcReplace);
         pathColl.Add(deviantPath);
       } // for (iterArc...
     } // for (currEdge = 0 ...
@@ -53,6 +53,11 @@ protected:
   ScoreComponentCollection	m_scoreBreakdown;
   float m_totalScore;
 
+  const TrellisPath *m_prevPath; /**< path this one deviates from, as long as the list of
+                                  hypos/arcs and score breakdown haven't been created by Expand()
+                                  */
+  const Hypothesis *m_arc; //< arc used at m_prevEdgeChanged, for Expand()
+
   //Used by Manager::LatticeSample()
   TrellisPath(const std::vector<const Hypothesis*> edges);
 
@@ -69,6 +74,15 @@ public:
   	*/
   TrellisPath(const TrellisPath &copy, size_t edgeIndex, const Hypothesis *arc);
 
+  /** create path that deviates from prevPath at edgeIndex by using arc instead, without
+    * copying the path or score breakdown. The score is the score of prevPath plus the difference
+    * between arc and the hypo it was recombined into; call Expand() before using the path
+    */
+  TrellisPath(const TrellisPath *prevPath, size_t edgeIndex, const Hypothesis *arc);
+
+  //! create the list of hypos/arcs and score breakdown of a path created from a previous path
+  void Expand();
+
   //! get score for this path throught trellis
   inline float GetTotalScore() const {
     return m_totalScore;
@@ -0,0 +1,107 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2014 University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#include "Benchmark.h"
+#include "WordsBitmap.h"
+
+using namespace Moses;
+
+namespace MosesBenchmark
+{
+
+namespace
+{
+
+const size_t SIZE = 50;
+
+// half covered, in two blocks, as in the middle of a search
+void Cover(WordsBitmap &bitmap)
+{
+  bitmap.SetValue(0, 14, true);
+  bitmap.SetValue(20, 29, true);
+}
+
+class GetFirstGapPosBenchmark : public Benchmark
+{
+public:
+  GetFirstGapPosBenchmark() : Benchmark("WordsBitmap/GetFirstGapPos"), m_bitmap(SIZE) {
+    Cover(m_bitmap);
+  }
+  void Run(size_t iterations) {
+    for (size_t i = 0; i < iterations; ++i) {
+      Use(m_bitmap.GetFirstGapPos());
+    }
+  }
+private:
+  WordsBitmap m_bitmap;
+} s_getFirstGapPos;
+
+class GetNumWordsCoveredBenchmark : public Benchmark
+{
+public:
+  GetNumWordsCoveredBenchmark() : Benchmark("WordsBitmap/GetNumWordsCovered"), m_bitmap(SIZE) {
+    Cover(m_bitmap);
+  }
+  void Run(size_t iterations) {
+    for (size_t i = 0; i < iterations; ++i) {
+      Use(m_bitmap.GetNumWordsCovered());
+    }
+  }
+private:
+  WordsBitmap m_bitmap;
+} s_getNumWordsCovered;
+
+// equal bitmaps, the most expensive case, as in recombination
+class CompareBenchmark : public Benchmark
+{
+public:
+  CompareBenchmark() : Benchmark("WordsBitmap/Compare"), m_a(SIZE), m_b(SIZE) {
+    Cover(m_a);
+    Cover(m_b);
+  }
+  void Run(size_t iterations) {
+    for (size_t i = 0; i < iterations; ++i) {
+      Use(m_a.Compare(m_b));
+    }
+  }
+private:
+  WordsBitmap m_a, m_b;
+} s_compare;
+
+// what a new hypothesis does with the coverage of its predecessor
+class ExtendBenchmark : public Benchmark
+{
+public:
+  ExtendBenchmark() : Benchmark("WordsBitmap/CopyAndSetValue"), m_bitmap(SIZE) {
+    Cover(m_bitmap);
+  }
+  void Run(size_t iterations) {
+    for (size_t i = 0; i < iterations; ++i) {
+      WordsBitmap copy(m_bitmap);
+      copy.SetValue(15, 17, true);
+      Use(copy);
+    }
+  }
+private:
+  WordsBitmap m_bitmap;
+} s_extend;
+
+}
+
+}
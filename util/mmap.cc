@@ -16,12 +16,14 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <stdlib.h>
+#include <string.h>
 
 #if defined(_WIN32) || defined(_WIN64)
 #include <windows.h>
 #include <io.h>
 #else
 #include <sys/mman.h>
+#include <sys/syscall.h>
 #include <unistd.h>
 #endif
 
@@ -136,7 +138,8 @@ const int kFileFlags =
 #endif
   ;
 
-void MapRead(LoadMethod method, int fd, uint64_t offset, std::size_t size, scoped_memory &out) {
+PageKind MapRead(LoadMethod method, int fd, uint64_t offset, std::size_t size, scoped_memory &out) {
+  PageKind kind = NORMAL_PAGES;
   switch (method) {
     case LAZY:
       out.reset(MapOrThrow(size, false, kFileFlags, false, fd, offset), size, scoped_memory::MMAP_ALLOCATED);
@@ -159,7 +162,120 @@ void MapRead(LoadMethod method, int fd, uint64_t offset, std::size_t size, scope
       out.reset(MallocOrThrow(size), size, scoped_memory::MALLOC_ALLOCATED);
       ParallelRead(fd, out.get(), size, offset);
       break;
+    case HUGE_READ:
+    case HUGE_INTERLEAVE_READ:
+      // Reading faults the pages in, so placement is decided before this.
+      kind = HugeMalloc(size, method == HUGE_INTERLEAVE_READ, out);
+      SeekOrThrow(fd, offset);
+      ReadOrThrow(fd, out.get(), size);
+      break;
+  }
+  return kind;
+}
+
+const char *PageKindName(PageKind kind) {
+  switch (kind) {
+    case NORMAL_PAGES:
+      return "normal pages";
+    case TRANSPARENT_HUGE_PAGES:
+      return "transparent huge pages";
+    case HUGE_PAGES_2MB:
+      return "2 MB huge pages";
+    case HUGE_PAGES_1GB:
+      return "1 GB huge pages";
+  }
+  return "unknown pages";
+}
+
+namespace {
+
+const std::size_t kHugePage = 1ULL << 21;
+
+#if defined(__linux__) && defined(SYS_mbind)
+// From linux/mempolicy.h, which not every system installs.
+const int kInterleave = 3; // MPOL_INTERLEAVE
+
+// Mask of possible NUMA nodes or 0 if there is only one.
+unsigned long NUMANodes() {
+  unsigned long mask = 0;
+  scoped_FILE file(fopen("/sys/devices/system/node/possible", "r"));
+  if (!file.get()) return 0;
+  // Format is a list of ranges like 0-1,4.
+  unsigned long from, to;
+  int got;
+  while ((got = fscanf(file.get(), "%lu-%lu", &from, &to)) >= 1) {
+    if (got == 1) to = from;
+    for (unsigned long i = from; i <= to && i < sizeof(unsigned long) * 8; ++i) {
+      mask |= 1UL << i;
+    }
+    if (fgetc(file.get()) != ',') break;
+  }
+  return (mask & (mask - 1)) ? mask : 0;
+}
+
+// Only for mappings of HugeMalloc that nothing has touched yet.
+void Interleave(void *base, std::size_t size) {
+  unsigned long mask = NUMANodes();
+  if (!mask) return;
+  // maxnode is one more than the number of bits the kernel reads from mask.
+  syscall(SYS_mbind, base, size, kInterleave, &mask, sizeof(mask) * 8 + 1, 0);
+}
+#else
+void Interleave(void *, std::size_t) {}
+#endif
+
+// Ask for transparent huge pages and say whether they will be used: the
+// kernel has to accept the advice and they must not be turned off in sysfs.
+bool AdviseTransparent(void *base, std::size_t size) {
+#ifdef MADV_HUGEPAGE
+  if (madvise(base, size, MADV_HUGEPAGE)) return false;
+  scoped_FILE file(fopen("/sys/kernel/mm/transparent_hugepage/enabled", "r"));
+  if (!file.get()) return true;
+  char mode[128];
+  if (!fgets(mode, sizeof(mode), file.get())) return true;
+  return !strstr(mode, "[never]");
+#else
+  return false;
+#endif
+}
+
+#if defined(MAP_HUGETLB) && !defined(_WIN32) && !defined(_WIN64)
+// Anonymous memory from the hugetlbfs pool.  Fails if the pool is too small.
+bool TryHugeTLB(std::size_t size, std::size_t page, int page_flag, scoped_memory &to) {
+  std::size_t rounded = (size + page - 1) / page * page;
+  if (rounded < size) return false;
+  void *ret = mmap(NULL, rounded, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE | MAP_HUGETLB | page_flag, -1, 0);
+  if (ret == MAP_FAILED) return false;
+  to.reset(ret, rounded, scoped_memory::MMAP_ALLOCATED);
+  return true;
+}
+#endif
+
+} // namespace
+
+PageKind HugeMalloc(std::size_t size, bool interleave, scoped_memory &to) {
+  to.reset();
+  PageKind kind = NORMAL_PAGES;
+#if defined(MAP_HUGETLB) && !defined(_WIN32) && !defined(_WIN64)
+#  ifdef MAP_HUGE_SHIFT
+  const int k1GB = 30 << MAP_HUGE_SHIFT, k2MB = 21 << MAP_HUGE_SHIFT;
+#  else
+  // Only the default huge page size, assumed to be 2 MB.
+  const int k1GB = -1, k2MB = 0;
+#  endif
+  if (k1GB != -1 && size >= (1ULL << 30) && TryHugeTLB(size, 1ULL << 30, k1GB, to)) {
+    kind = HUGE_PAGES_1GB;
+  } else if (TryHugeTLB(size, kHugePage, k2MB, to)) {
+    kind = HUGE_PAGES_2MB;
+  }
+#endif
+  if (kind == NORMAL_PAGES) {
+    // MapOrThrow asks for transparent huge pages too, but ignores the answer.
+    MapAnonymous(size, to);
+    if (AdviseTransparent(to.get(), to.size())) kind = TRANSPARENT_HUGE_PAGES;
   }
+  if (interleave) Interleave(to.get(), to.size());
+  return kind;
 }
 
 // Allocates zeroed memory in to.
@@ -96,17 +96,40 @@ typedef enum {
   READ,
   // malloc and read in parallel (recommended for Lustre)
   PARALLEL_READ,
+  // Read into anonymous memory backed by huge pages if the kernel has them:
+  // 1 GB then 2 MB pages from the hugetlbfs pool, then transparent huge
+  // pages.  Fewer TLB misses for random lookups.  Same as READ off Linux.
+  HUGE_READ,
+  // HUGE_READ with pages interleaved across NUMA nodes so that threads on
+  // every socket see the same mix of local and remote memory.
+  HUGE_INTERLEAVE_READ,
 } LoadMethod;
 
+// What backs memory from MapRead or HugeMalloc.  Huge pages are a request
+// that falls back, so this reports what was obtained.
+typedef enum {
+  NORMAL_PAGES,
+  // Requested with madvise; the kernel decides.
+  TRANSPARENT_HUGE_PAGES,
+  HUGE_PAGES_2MB,
+  HUGE_PAGES_1GB,
+} PageKind;
+
+const char *PageKindName(PageKind kind);
+
 extern const int kFileFlags;
 
 // Wrapper around mmap to check it worked and hide some platform macros.  
 void *MapOrThrow(std::size_t size, bool for_write, int flags, bool prefault, int fd, uint64_t offset = 0);
 
-void MapRead(LoadMethod method, int fd, uint64_t offset, std::size_t size, scoped_memory &out);
+PageKind MapRead(LoadMethod method, int fd, uint64_t offset, std::size_t size, scoped_memory &out);
 
 void MapAnonymous(std::size_t size, scoped_memory &to);
 
+// Zeroed anonymous memory preferring huge pages as described for HUGE_READ.
+// to.size() may be rounded up to the huge page size.
+PageKind HugeMalloc(std::size_t size, bool interleave, scoped_memory &to);
+
 // Open file name with mmap of size bytes, all of which are initially zero.  
 void *MapZeroedWrite(int fd, std::size_t size);
 void *MapZeroedWrite(const char *name, std::size_t size, scoped_fd &file);
@@ -0,0 +1,15 @@
+#ifndef UTIL_PREFETCH_H
+#define UTIL_PREFETCH_H
+
+namespace util {
+
+// Hint that address will be read soon.  Does nothing on compilers without the builtin.
+inline void Prefetch(const void *address) {
+#if defined(__GNUC__)
+  __builtin_prefetch(address);
+#endif
+}
+
+} // namespace util
+
+#endif // UTIL_PREFETCH_H
@@ -2,6 +2,7 @@
 #define UTIL_PROBING_HASH_TABLE_H
 
 #include "util/exception.hh"
+#include "util/prefetch.hh"
 #include "util/scoped.hh"
 
 #include <algorithm>
@@ -139,6 +140,11 @@ template <class EntryT, class HashT, class EqualT = std::equal_to<typename Entry
       }    
     }
 
+    // Prefetch the bucket where Find(key) will start.
+    template <class Key> void Prefetch(const Key key) const {
+      util::Prefetch(begin_ + (hash_(key) % buckets_));
+    }
+
     // Like Find but we're sure it must be there.
     template <class Key> ConstIterator MustFind(const Key key) const {
       for (ConstIterator i(begin_ + (hash_(key) % buckets_));;) {
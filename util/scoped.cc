@@ -16,8 +16,10 @@ MallocException::~MallocException() throw() {}
 namespace {
 void *InspectAddr(void *addr, std::size_t requested, const char *func_name) {
   UTIL_THROW_IF_ARG(!addr && requested, MallocException, (requested), "in " << func_name);
-  // These routines are often used for large chunks of memory where huge pages help.
-#if MADV_HUGEPAGE
+  // These routines are often used for large chunks of memory where huge pages
+  // help.  Only a hint: nothing relies on getting them, so the result is not
+  // reported.
+#ifdef MADV_HUGEPAGE
   madvise(addr, requested, MADV_HUGEPAGE);
 #endif
   return addr;